@@ -0,0 +1,29 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+/* xy = texcoord remapped into the atlas (AtlasRegion::Remap), z = layer */
+layout(location = 1) in vec3 texCoord;
+
+out vec3 v_TexCoord;
+
+void main()
+{
+   gl_Position = position;
+   v_TexCoord = texCoord;
+}
+
+#shader fragment
+#version 330 core
+
+out vec4 color;
+
+in vec3 v_TexCoord;
+
+/* every atlas layer behind one binding, so sprites never switch textures */
+uniform sampler2DArray u_Atlas;
+
+void main()
+{
+    color = texture(u_Atlas, v_TexCoord);
+}
@@ -0,0 +1,69 @@
+#shader compute
+#version 430 core
+
+/* one invocation per object, GpuCuller::Cull */
+layout(local_size_x = 256) in;
+
+struct Object
+{
+    vec4 sphere; /* xyz center, w radius */
+    vec4 transform;
+    vec4 color;
+    uint mesh; /* index of its draw command */
+};
+
+/* DrawElementsIndirectCommand */
+struct Command
+{
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+struct Instance
+{
+    vec4 transform;
+    vec4 color;
+};
+
+layout(std430, binding = 0) readonly buffer Objects
+{
+    Object objects[];
+};
+
+layout(std430, binding = 1) buffer Commands
+{
+    Command commands[];
+};
+
+layout(std430, binding = 2) writeonly buffer Instances
+{
+    Instance instances[];
+};
+
+/* unit normals pointing in, like Frustum */
+uniform vec4 u_Planes[6];
+uniform uint u_ObjectCount;
+
+void main()
+{
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= u_ObjectCount)
+        return;
+
+    Object object = objects[i];
+    for (int p = 0; p < 6; p++)
+    {
+        if (dot(u_Planes[p].xyz, object.sphere.xyz) + u_Planes[p].w + object.sphere.w < 0.0)
+            return;
+    }
+
+    /* visible: take the next slot of the mesh's run, the draw's instance
+       count grows with it */
+    uint slot = atomicAdd(commands[object.mesh].instanceCount, 1u);
+    uint instance = commands[object.mesh].baseInstance + slot;
+    instances[instance].transform = object.transform;
+    instances[instance].color = object.color;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/* block compressed formats we can encode
+	~ BC1 (DXT1): RGB + 1 bit alpha, 8 bytes per 4x4 block (8:1 vs RGBA8)
+	~ BC3 (DXT5): BC1 color + interpolated alpha, 16 bytes per block (4:1)
+	~ BC7 (BPTC): high quality RGBA, 16 bytes per block (4:1), only mode 6
+	  (one subset, 7.7.7.7 + p-bit endpoints, 4 bit indices) is written */
+enum class BlockFormat
+{
+	BC1, BC3, BC7
+};
+
+/* FAST: bounding box endpoints and projected indices, SSE2 for BC1/BC3
+   QUALITY: principal axis endpoints, nearest-color indices, one least
+            squares refinement (and p-bit search for BC7) */
+enum class CompressionQuality
+{
+	FAST, QUALITY
+};
+
+/* CPU encoder for BC1/BC3/BC7
+	~ input is tightly packed RGBA8, images that aren't a multiple of 4
+	  are padded by repeating their last row/column */
+class BlockCompressor
+{
+public:
+	/* bytes per 4x4 block */
+	static unsigned int GetBlockSize(BlockFormat format);
+	static size_t GetCompressedSize(BlockFormat format, unsigned int width, unsigned int height);
+
+	/* GL internal format of the compressed data (linear, not sRGB) */
+	static unsigned int GetGLFormat(BlockFormat format);
+
+	/* compresses a whole image, out needs GetCompressedSize() bytes */
+	static void Compress(BlockFormat format, const unsigned char* rgba, unsigned int width, unsigned int height,
+		unsigned char* out, CompressionQuality quality);
+
+	/* a block is 16 RGBA8 pixels, row by row */
+	static void EncodeBC1(const unsigned char* block, unsigned char* out, CompressionQuality quality);
+	static void EncodeBC3(const unsigned char* block, unsigned char* out, CompressionQuality quality);
+	static void EncodeBC7(const unsigned char* block, unsigned char* out, CompressionQuality quality);
+
+	/* 2x2 box filter for building mip chains on the CPU
+	   (glGenerateMipmap can't produce compressed levels) */
+	static void Downsample(const unsigned char* rgba, unsigned int width, unsigned int height,
+		std::vector<unsigned char>& out);
+};
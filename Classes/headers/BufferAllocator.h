@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+
+/* a range handed out by BufferAllocator, in whatever unit the allocator
+   counts in (bytes, vertices, indices...) */
+struct BufferAllocation
+{
+	unsigned int offset;
+	unsigned int size;
+	unsigned int block;	/* internal, needed by Free */
+};
+
+struct BufferAllocatorStats
+{
+	unsigned int capacity;
+	unsigned int used;
+	unsigned int largestFree;
+	unsigned int allocations;
+	unsigned int freeBlocks;
+	/* 0: all free space is one block, close to 1: free space is scattered
+	   in pieces too small for a big request (1 - largestFree / free) */
+	float fragmentation;
+};
+
+/* two level segregated fit (TLSF) allocator for offsets into one big buffer
+	~ only bookkeeping, no memory is touched, so one instance can manage a
+	  GL buffer, part of one, or anything else addressed by offset
+	~ free ranges are kept in 32 x 8 size classes with a bitmap per level,
+	  finding a fitting range is two bit scans: O(1) allocate and free,
+	  only when no class above the request's has a block is the request's
+	  own class searched for one big enough
+	~ freed ranges merge with free neighbours right away */
+class BufferAllocator
+{
+private:
+	static const unsigned int SECOND_LEVEL_BITS = 3;
+	static const unsigned int SECOND_LEVEL_COUNT = 1 << SECOND_LEVEL_BITS;
+	static const unsigned int FIRST_LEVEL_COUNT = 32 - SECOND_LEVEL_BITS + 1;
+	static const unsigned int NONE = 0xFFFFFFFF;
+
+	struct Block
+	{
+		unsigned int offset, size;
+		unsigned int previous, next;		/* neighbours in the buffer */
+		unsigned int previousFree, nextFree;	/* same size class list */
+		bool free;
+	};
+
+	unsigned int m_Capacity;
+	std::vector<Block> m_Blocks;
+	std::vector<unsigned int> m_UnusedBlocks;	/* recycled Block slots */
+	unsigned int m_FirstLevelBitmap;
+	unsigned int m_SecondLevelBitmaps[FIRST_LEVEL_COUNT];
+	unsigned int m_FreeLists[FIRST_LEVEL_COUNT][SECOND_LEVEL_COUNT];
+	unsigned int m_Used, m_AllocationCount, m_FreeBlockCount;
+
+	unsigned int NewBlock();
+	void InsertFree(unsigned int block);
+	void RemoveFree(unsigned int block);
+public:
+	BufferAllocator(unsigned int capacity); /* constructor */
+
+	/* false when no free range is big enough (fragmentation or full) */
+	bool Allocate(unsigned int size, BufferAllocation& allocation);
+	void Free(const BufferAllocation& allocation);
+
+	/* forgets every allocation */
+	void Reset();
+
+	BufferAllocatorStats GetStats() const;
+	inline unsigned int GetCapacity() const { return m_Capacity; }
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+
+class Frustum;
+class BoundsStore;
+
+/* axis aligned bounding box, min/max corners */
+struct Aabb
+{
+	float min[3];
+	float max[3];
+};
+
+/* direction doesn't need to be normalized, hit distances are then in
+   units of its length */
+struct Ray
+{
+	float origin[3];
+	float direction[3];
+};
+
+struct BvhHit
+{
+	unsigned int object;	/* index the object was built with */
+	float distance;			/* along the ray, where it enters the object's box */
+};
+
+/* 32 bytes, two nodes per cache line
+	~ count == 0: interior node, children are leftFirst and leftFirst + 1
+	~ count > 0: leaf, objects are indices[leftFirst .. leftFirst + count) */
+struct BvhNode
+{
+	float min[3];
+	unsigned int leftFirst;
+	float max[3];
+	unsigned int count;
+};
+
+/* bounding volume hierarchy over object boxes
+	~ built top down with the surface area heuristic (16 bins per axis),
+	  subtrees are built on separate threads once the top splits are done
+	~ Refit() keeps the tree topology and only recomputes boxes bottom up,
+	  good enough for objects that move a bit every frame, rebuild when
+	  queries start getting slow
+	~ queries visit only the nodes they touch, O(log n) for small results */
+class Bvh
+{
+private:
+	std::vector<BvhNode> m_Nodes;
+	std::vector<unsigned int> m_Indices;	/* object indices, grouped by leaf */
+	std::vector<Aabb> m_Objects;			/* object boxes, by object index */
+public:
+	/* threadCount 0 uses every hardware thread */
+	void Build(const Aabb* bounds, unsigned int count, unsigned int threadCount = 0);
+	/* boxes of the objects in a culling BoundsStore, same indices */
+	void Build(const BoundsStore& bounds, unsigned int threadCount = 0);
+
+	/* move an object, call Refit() once after all the updates */
+	void UpdateObject(unsigned int index, const Aabb& bounds);
+	void Refit();
+
+	/* indices of every object whose box intersects the frustum */
+	unsigned int QueryFrustum(const Frustum& frustum, std::vector<unsigned int>& result) const;
+	/* indices of every object whose box overlaps the region */
+	unsigned int QueryRegion(const Aabb& region, std::vector<unsigned int>& result) const;
+	/* closest object box hit by the ray within maxDistance (picking) */
+	bool Raycast(const Ray& ray, BvhHit& hit, float maxDistance = 3.402823466e+38f) const;
+
+	inline unsigned int GetNodeCount() const { return (unsigned int)m_Nodes.size(); }
+	inline unsigned int GetObjectCount() const { return (unsigned int)m_Objects.size(); }
+	inline const BvhNode* GetNodes() const { return m_Nodes.data(); }
+};
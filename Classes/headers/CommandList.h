@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+#include "renderer.h"
+
+class JobSystem;
+
+/* draws recorded on one thread, handed to Renderer::Submit later
+	~ no locks and no GL calls, so every worker can fill its own list at
+	  the same time, e.g. lists[JobSystem::GetWorkerIndex()]
+	~ Clear() keeps the memory, after the first frames recording doesn't
+	  allocate
+	~ cache line aligned so two threads' lists never share a line */
+class alignas(64) CommandList
+{
+private:
+	std::vector<DrawCommand> m_Commands;
+public:
+	void Submit(const VertexArray& va, const IndexBuffer& ib, const Shader& shader);
+	void Submit(const VertexArray& va, const IndexBuffer& ib, const PipelineState& pipeline);
+
+	inline void Clear() { m_Commands.clear(); }
+	inline void Reserve(unsigned int count) { m_Commands.reserve(count); }
+	inline unsigned int GetCount() const { return (unsigned int)m_Commands.size(); }
+	inline const DrawCommand* GetCommands() const { return m_Commands.data(); }
+
+	/* LSD radix sort by key, 8 bits a pass, stable
+		~ passes over bytes that are the same in every key are skipped
+		  (ids are small, most of the 64 bits never change)
+		~ with jobs every pass splits the commands in blocks: histograms
+		  of the blocks in parallel, one prefix sum, then every block
+		  scatters to its own offsets in parallel
+		~ scratch holds count commands, returns whichever of the two
+		  buffers ends up sorted */
+	static DrawCommand* Sort(DrawCommand* commands, DrawCommand* scratch, unsigned int count, JobSystem* jobs = nullptr);
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+
+/* plane n.p + d = 0, normal points into the frustum */
+struct Plane
+{
+	float a, b, c, d;
+};
+
+/* the six planes of a view-projection matrix
+	~ matrix is column major (what glUniformMatrix4fv takes with transpose GL_FALSE) */
+class Frustum
+{
+private:
+	Plane m_Planes[6];	/* left, right, bottom, top, near, far */
+public:
+	Frustum(const float* viewProjection); /* constructor */
+
+	inline const Plane& GetPlane(unsigned int index) const { return m_Planes[index]; }
+};
+
+/* object bounds in structure-of-arrays layout
+	~ every object has an AABB (center + half extents) and a bounding
+	  sphere radius, culling uses whichever of the two is tighter against
+	  each plane
+	~ one array per component, so SIMD code loads 8 objects' worth of a
+	  component with one instruction */
+class BoundsStore
+{
+private:
+	std::vector<float> m_CenterX, m_CenterY, m_CenterZ;
+	std::vector<float> m_ExtentX, m_ExtentY, m_ExtentZ;
+	std::vector<float> m_Radius;
+public:
+	/* axis aligned box, the sphere around it is derived */
+	unsigned int AddBox(const float center[3], const float extents[3]);
+	/* sphere, the box around it is derived */
+	unsigned int AddSphere(const float center[3], float radius);
+
+	void SetBox(unsigned int index, const float center[3], const float extents[3]);
+	void SetSphere(unsigned int index, const float center[3], float radius);
+	void Clear();
+
+	inline unsigned int GetCount() const { return (unsigned int)m_Radius.size(); }
+	inline const float* GetCenterX() const { return m_CenterX.data(); }
+	inline const float* GetCenterY() const { return m_CenterY.data(); }
+	inline const float* GetCenterZ() const { return m_CenterZ.data(); }
+	inline const float* GetExtentX() const { return m_ExtentX.data(); }
+	inline const float* GetExtentY() const { return m_ExtentY.data(); }
+	inline const float* GetExtentZ() const { return m_ExtentZ.data(); }
+	inline const float* GetRadius() const { return m_Radius.data(); }
+};
+
+/* frustum culling over a BoundsStore
+	~ AVX tests 8 objects per instruction, SSE 4, with a scalar fallback
+	  and a scalar tail for counts that aren't a multiple of the width
+	~ visible gets the indices of every object that intersects the frustum,
+	  in order, ready to be turned into Renderer::Submit calls */
+class FrustumCuller
+{
+public:
+	static unsigned int Cull(const BoundsStore& bounds, const Frustum& frustum, std::vector<unsigned int>& visible);
+
+	/* reference implementation, one object at a time */
+	static unsigned int CullScalar(const BoundsStore& bounds, const Frustum& frustum, std::vector<unsigned int>& visible);
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+class FrameSync;
+
+/* kinds of GL names the queue knows how to delete */
+enum class GLObjectType
+{
+	BUFFER, VERTEX_ARRAY, TEXTURE, PROGRAM, FRAMEBUFFER, QUERY
+};
+
+/* deletes GL objects once the GPU is done with them
+	~ destructors of the GL wrappers hand their name to Delete() instead of
+	  calling glDelete* themselves, from any thread, no context needed
+	~ the render thread calls Collect() once a frame (after
+	  FrameSync::EndFrame): names handed over since the last Collect are
+	  tagged with the frame being recorded, names whose frame the GPU has
+	  finished are deleted, batched per type into one glDelete* call
+	~ until a FrameSync is set Delete() deletes right away, like before
+	  (it then has to be called with the context current) */
+class DeletionQueue
+{
+public:
+	/* render thread, nullptr goes back to deleting right away */
+	static void SetFrameSync(FrameSync* sync);
+
+	/* any thread, name 0 is ignored */
+	static void Delete(GLObjectType type, unsigned int rendererID);
+
+	/* render thread, returns how many names were deleted */
+	static unsigned int Collect();
+
+	/* render thread, waits for the GPU and deletes everything queued
+	   (before the context goes away) */
+	static unsigned int Flush();
+
+	/* render thread, names not deleted yet */
+	static unsigned int GetPendingCount();
+
+	/* true while a FrameSync is set, Delete() then waits for the GPU */
+	static bool IsDeferred();
+};
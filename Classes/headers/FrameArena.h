@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/* bump allocator for data that only lives for one frame
+	~ Allocate just moves a pointer forward, Reset() at the end of the frame
+	  throws everything away at once, nothing is freed one by one
+	~ memory comes in chunks, when a frame needed more than one chunk the
+	  next Reset() replaces them with a single chunk big enough for all of
+	  it, so after a few frames a steady scene never touches the heap
+	~ an arena is not thread safe, every thread gets its own through
+	  ForThread(), ResetAll() resets every one of them (call it when no
+	  thread is using its arena, e.g. after the frame's jobs are done) */
+class FrameArena
+{
+private:
+	struct Chunk
+	{
+		unsigned char* data;
+		size_t size;
+	};
+
+	std::vector<Chunk> m_Chunks;
+	size_t m_Offset;		/* into the last chunk */
+	size_t m_Used;			/* this frame, over all chunks */
+	size_t m_Peak;			/* most used in one frame */
+	size_t m_ChunkSize;
+	unsigned int m_ChunkAllocations;	/* heap allocations so far */
+
+	void AddChunk(size_t minimumSize);
+public:
+	FrameArena(size_t chunkSize = 1024 * 1024); /* constructor */
+	~FrameArena(); /* destructor */
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	template<typename T>
+	T* AllocateArray(size_t count)
+	{
+		return (T*)Allocate(count * sizeof(T), alignof(T));
+	}
+
+	/* everything allocated this frame is gone after this */
+	void Reset();
+
+	inline size_t GetUsed() const { return m_Used; }
+	inline size_t GetPeak() const { return m_Peak; }
+	inline unsigned int GetChunkAllocations() const { return m_ChunkAllocations; }
+
+	/* the calling thread's own arena, made on first use */
+	static FrameArena& ForThread();
+	static void ResetAll();
+};
+
+/* lets standard containers take their memory from a FrameArena
+	~ deallocate does nothing, the memory comes back with the next Reset()
+	~ a container using it must be emptied (or gone) before that Reset()
+	~ a null arena falls back to the heap, so the same container type can
+	  be used with and without an arena */
+template<typename T>
+class FrameAllocator
+{
+public:
+	typedef T value_type;
+
+	FrameArena* arena;
+
+	FrameAllocator(FrameArena* arena = nullptr) : arena(arena) {}
+	template<typename U>
+	FrameAllocator(const FrameAllocator<U>& other) : arena(other.arena) {}
+
+	T* allocate(size_t count)
+	{
+		if (arena)
+			return arena->AllocateArray<T>(count);
+		return (T*)::operator new(count * sizeof(T));
+	}
+
+	void deallocate(T* pointer, size_t)
+	{
+		if (!arena)
+			::operator delete(pointer);
+	}
+
+	template<typename U>
+	bool operator==(const FrameAllocator<U>& other) const { return arena == other.arena; }
+	template<typename U>
+	bool operator!=(const FrameAllocator<U>& other) const { return arena != other.arena; }
+};
+
+/* std::vector living in a frame arena */
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <GL/glew.h>
+
+class RenderTarget;
+
+#define MAX_COLOR_ATTACHMENTS 8
+
+/* framebuffer object drawing into RenderTargets instead of the window
+	~ attach color targets (and one depth/stencil target), the draw buffers
+	  follow the color attachments
+	~ the framebuffer doesn't own its targets, they must outlive it (or be
+	  detached) */
+class FrameBuffer
+{
+private:
+	unsigned int m_RendererID;
+	const RenderTarget* m_ColorAttachments[MAX_COLOR_ATTACHMENTS];
+	const RenderTarget* m_DepthAttachment;
+	unsigned int m_Width, m_Height;		/* of the attachments, for the viewport */
+
+	void UpdateDrawBuffers();
+public:
+	FrameBuffer(); /* constructor */
+	~FrameBuffer(); /* destructor */
+
+	FrameBuffer(const FrameBuffer&) = delete;
+	FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+	/* nullptr detaches, every attachment must have the same size and samples */
+	void AttachColor(const RenderTarget* target, unsigned int index = 0);
+	void AttachDepth(const RenderTarget* target);
+
+	/* complete and ready to draw into, prints the status when it isn't */
+	bool IsComplete() const;
+
+	/* binds for drawing and sets the viewport to the attachments' size */
+	void Bind() const;
+	void Unbind() const;
+
+	/* copies color attachment 0 into `target` (nullptr: the window), with
+	   filtering when the sizes differ, resolves multisampled attachments
+		~ mask is GL_COLOR_BUFFER_BIT and/or GL_DEPTH_BUFFER_BIT, depth is
+		  copied unfiltered and needs equal sizes */
+	void Blit(const FrameBuffer* target, unsigned int targetWidth, unsigned int targetHeight,
+		unsigned int mask = GL_COLOR_BUFFER_BIT) const;
+
+	inline const RenderTarget* GetColorAttachment(unsigned int index = 0) const { return m_ColorAttachments[index]; }
+	inline const RenderTarget* GetDepthAttachment() const { return m_DepthAttachment; }
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
+	/* back to drawing into the window */
+	static void BindDefault(unsigned int width, unsigned int height);
+};
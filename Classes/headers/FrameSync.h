@@ -0,0 +1,41 @@
+#pragma once
+
+#include <deque>
+
+#include <GL/glew.h>
+
+/* knows which frames the GPU has finished
+	~ EndFrame() puts a fence behind the frame's commands, Poll() checks the
+	  oldest fences without waiting
+	~ anything the GPU used during frame F can be released once
+	  GetCompletedFrames() > F */
+class FrameSync
+{
+private:
+	struct FrameFence
+	{
+		unsigned long long frame;
+		GLsync fence;
+	};
+
+	std::deque<FrameFence> m_Fences;
+	unsigned long long m_Frame;		/* frame being recorded */
+	unsigned long long m_Completed;	/* every frame before this is done */
+public:
+	FrameSync(); /* constructor */
+	~FrameSync(); /* destructor */
+
+	FrameSync(const FrameSync&) = delete;
+	FrameSync& operator=(const FrameSync&) = delete;
+
+	void EndFrame();
+
+	/* never blocks, returns GetCompletedFrames() */
+	unsigned long long Poll();
+	/* blocks until the GPU has finished everything submitted so far */
+	void WaitIdle();
+
+	inline unsigned long long GetCurrentFrame() const { return m_Frame; }
+	inline unsigned long long GetCompletedFrames() const { return m_Completed; }
+	inline unsigned int GetFramesInFlight() const { return (unsigned int)m_Fences.size(); }
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+
+#include "VertexArray.h"
+#include "vertexbuffer.h"
+#include "indexbuffer.h"
+#include "VertexBufferLayout.h"
+#include "BufferAllocator.h"
+
+/* where one mesh lives inside a GeometryPool */
+struct MeshRange
+{
+	unsigned int firstIndex;	/* in indices */
+	unsigned int indexCount;
+	unsigned int baseVertex;	/* in vertices, indices stay local to the mesh */
+	unsigned int vertexCount;
+};
+
+/* many meshes in one big vertex buffer and one big index buffer
+	~ every mesh shares the pool's layout and its single vertex array, so
+	  drawing any mix of them needs no rebinding between draws and can go
+	  through one glMultiDrawElementsIndirect (see MultiDrawBatch)
+	~ space is handed out by two BufferAllocators (vertices and indices),
+	  meshes can be removed and their space reused
+	~ Compact() slides every mesh down to the start of the buffers on the
+	  GPU, meshes are referred to by handle so their ranges can move */
+class GeometryPool
+{
+private:
+	struct Entry
+	{
+		MeshRange range;
+		BufferAllocation vertices, indices;
+		bool alive;
+	};
+
+	VertexBufferLayout m_Layout;
+	VertexBuffer m_VertexBuffer;
+	IndexBuffer m_IndexBuffer;
+	VertexArray m_VertexArray;
+	BufferAllocator m_VertexAllocator, m_IndexAllocator;
+	std::vector<Entry> m_Meshes;
+	std::vector<unsigned int> m_FreeHandles;
+public:
+	static const unsigned int INVALID_MESH = 0xFFFFFFFF;
+
+	GeometryPool(const VertexBufferLayout& layout, unsigned int vertexCapacity, unsigned int indexCapacity); /* constructor */
+
+	/* copies a mesh in, vertices must match the pool's layout
+		~ compacts once if the space is there but too scattered
+		~ returns the mesh handle, INVALID_MESH when it doesn't fit */
+	unsigned int Add(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+	void Remove(unsigned int mesh);
+
+	/* packs every mesh to the front of the buffers, ranges change, handles don't */
+	void Compact();
+
+	void Bind() const;
+	void Unbind() const;
+
+	inline const MeshRange& GetRange(unsigned int mesh) const { return m_Meshes[mesh].range; }
+
+	/* not const: batches attach their per draw attributes to it */
+	inline VertexArray& GetVertexArray() { return m_VertexArray; }
+	inline const VertexBufferLayout& GetLayout() const { return m_Layout; }
+	inline BufferAllocatorStats GetVertexStats() const { return m_VertexAllocator.GetStats(); }
+	inline BufferAllocatorStats GetIndexStats() const { return m_IndexAllocator.GetStats(); }
+};
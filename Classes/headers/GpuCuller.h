@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+
+#include "IndirectBuffer.h"
+#include "vertexbuffer.h"
+#include "VertexBufferLayout.h"
+#include "ShaderStorageBuffer.h"
+#include "VectorMath.h"
+
+class GeometryPool;
+class Renderer;
+class Shader;
+class Frustum;
+
+/* one object as the cull shader sees it, std430 */
+struct GpuCullObject
+{
+	Vec4 sphere;		/* xyz center, w radius */
+	Vec4 transform;		/* per draw attributes, as in multidraw.shader */
+	Vec4 color;
+	unsigned int mesh;	/* GeometryPool handle */
+	unsigned int padding[3];
+};
+
+/* frustum culling on the GPU that writes its own draw calls
+	~ objects live in a ShaderStorageBuffer, uploaded when they change
+	~ one indirect command per mesh of the pool, Cull resets their
+	  instance counts and cull.shader tests every object's sphere, bumps
+	  its mesh's instanceCount with an atomic and writes transform and
+	  color into that mesh's run of the instance buffer (baseInstance is
+	  the run's start), so nothing visible ever goes through the CPU
+	~ Draw is then one glMultiDrawElementsIndirect with multidraw.shader,
+	  meshes with nothing visible draw 0 instances
+	~ like MultiDrawBatch the instance attributes are attached to the
+	  pool's vertex array, one culler or batch per pool */
+class GpuCuller
+{
+private:
+	GeometryPool& m_Pool;
+	unsigned int m_MaxObjects, m_MaxMeshes;
+	std::vector<GpuCullObject> m_Objects;		/* mesh is the command index here */
+	std::vector<unsigned int> m_MeshHandles;	/* command index -> pool handle */
+	std::vector<unsigned int> m_MeshCommands;	/* pool handle -> command index */
+	std::vector<unsigned int> m_MeshObjects;	/* command index -> objects using it */
+	std::vector<DrawElementsIndirectCommand> m_Commands;
+	bool m_Dirty;
+	ShaderStorageBuffer m_ObjectBuffer;
+	VertexBuffer m_InstanceBuffer;
+	IndirectBuffer m_IndirectBuffer;
+
+	unsigned int GetCommand(unsigned int mesh);
+	void Upload();
+public:
+	static const unsigned int INVALID_OBJECT = 0xFFFFFFFF;
+	/* binding points in cull.shader */
+	static const unsigned int OBJECT_BINDING = 0;
+	static const unsigned int COMMAND_BINDING = 1;
+	static const unsigned int INSTANCE_BINDING = 2;
+
+	/* maxMeshes: how many different pool meshes the objects may use */
+	GpuCuller(GeometryPool& pool, unsigned int maxObjects, unsigned int maxMeshes); /* constructor */
+
+	/* returns the object index, INVALID_OBJECT when full (objects or meshes) */
+	unsigned int Add(const GpuCullObject& object);
+	/* the mesh may change too, as long as there is room for it */
+	void Set(unsigned int index, const GpuCullObject& object);
+	void Clear();
+
+	/* one dispatch of cull (cull.shader) over every object, and the
+	   barrier for the draw that reads the commands and instances */
+	void Cull(const Renderer& renderer, Shader& cull, const Frustum& frustum);
+	/* draws what the last Cull kept, returns the number of commands */
+	unsigned int Draw(const Shader& shader);
+
+	/* reads the instance counts back, waits for the GPU, for checks only */
+	unsigned int GetVisibleCount() const;
+
+	inline unsigned int GetObjectCount() const { return (unsigned int)m_Objects.size(); }
+	inline unsigned int GetMeshCount() const { return (unsigned int)m_Commands.size(); }
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+#include "VectorMath.h"
+#include "ParticleSystem.h"
+#include "ShaderStorageBuffer.h"
+
+class Renderer;
+class Shader;
+class VertexArray;
+class IndexBuffer;
+
+/* one particle as the compute shader sees it, std430 */
+struct GpuParticle
+{
+	Vec4 position;	/* xyz, w = life left in seconds */
+	Vec4 velocity;	/* xyz, w = 1 / lifetime */
+};
+
+/* the ParticleSystem fountain simulated on the GPU
+	~ particles live in a ShaderStorageBuffer, a compute shader
+	  (particle_update.shader) integrates and respawns them and
+	  particle_gpu.shader reads them by gl_InstanceID to draw, they are
+	  never copied to the CPU
+	~ same settings and the same starting particles as ParticleSystem,
+	  respawns use a hash of the index and the frame instead of a per
+	  particle seed, so the two drift apart after the first deaths
+	~ needs GL 4.3 (compute shaders and storage buffers) */
+class GpuParticleSystem
+{
+private:
+	ParticleSettings m_Settings;
+	unsigned int m_Count;
+	unsigned int m_Frame;	/* seeds the respawns */
+	ShaderStorageBuffer m_Particles;
+public:
+	/* the binding point of the particles in both shaders */
+	static const unsigned int PARTICLE_BINDING = 0;
+
+	GpuParticleSystem(unsigned int count, const ParticleSettings& settings = ParticleSettings()); /* constructor */
+
+	/* one dispatch of update (particle_update.shader) and the barrier
+	   that makes its writes visible to the next draw or dispatch */
+	void Simulate(const Renderer& renderer, Shader& update, float dt);
+	/* one instanced draw of quad (corner at location 0), shader is
+	   particle_gpu.shader with u_ViewProjection already set */
+	void Draw(const Renderer& renderer, const VertexArray& quad, const IndexBuffer& ib, Shader& shader) const;
+
+	/* copies every particle back, waits for the GPU, for checks only */
+	void Read(std::vector<GpuParticle>& particles) const;
+
+	inline unsigned int GetCount() const { return m_Count; }
+	inline const ParticleSettings& GetSettings() const { return m_Settings; }
+	inline void SetSettings(const ParticleSettings& settings) { m_Settings = settings; }
+	inline const ShaderStorageBuffer& GetBuffer() const { return m_Particles; }
+};
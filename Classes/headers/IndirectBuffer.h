@@ -0,0 +1,37 @@
+#pragma once
+
+/* one draw of glMultiDrawElementsIndirect, layout is fixed by GL */
+struct DrawElementsIndirectCommand
+{
+	unsigned int count;			/* indices to draw */
+	unsigned int instanceCount;
+	unsigned int firstIndex;	/* offset into the index buffer, in indices */
+	int baseVertex;				/* added to every index */
+	unsigned int baseInstance;	/* first value of the per instance attributes */
+};
+
+/* GL_DRAW_INDIRECT_BUFFER holding draw commands
+	~ glMultiDrawElementsIndirect reads every draw's parameters from here,
+	  so thousands of draws cost one call instead of one call each */
+class IndirectBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_MaxCommands;
+public:
+	IndirectBuffer(unsigned int maxCommands); /* constructor */
+	~IndirectBuffer(); /* destructor */
+
+	IndirectBuffer(const IndirectBuffer&) = delete;
+	IndirectBuffer& operator=(const IndirectBuffer&) = delete;
+
+	/* replaces the contents, the old storage is orphaned so the GPU can
+	   keep reading last frame's commands while we write this frame's */
+	void SetData(const DrawElementsIndirectCommand* commands, unsigned int count);
+
+	void Bind() const;
+	void Unbind() const;
+
+	inline unsigned int GetMaxCommands() const { return m_MaxCommands; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+};
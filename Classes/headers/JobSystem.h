@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#define JOB_DATA_SIZE 48		/* bytes a job's lambda may capture */
+#define JOB_POOL_SIZE 4096		/* jobs in flight per thread, power of two */
+#define JOB_DEQUE_SIZE 4096		/* power of two */
+
+/* counts jobs that haven't finished, JobSystem::Wait until it's zero */
+struct JobCounter
+{
+	std::atomic<int> pending;
+
+	JobCounter() : pending(0) {} /* constructor */
+};
+
+struct Job
+{
+	void (*function)(Job& job);
+	JobCounter* counter;
+	std::atomic<bool> running;		/* pool slot in use */
+	alignas(16) unsigned char data[JOB_DATA_SIZE];
+};
+
+/* Chase-Lev work stealing deque of a fixed size
+	~ the owning thread pushes and pops at the bottom (LIFO, the job it
+	  just made is still in cache), any other thread steals from the top
+	~ Push fails when full, the caller then runs the job itself */
+class JobDeque
+{
+private:
+	alignas(64) std::atomic<long long> m_Top;
+	alignas(64) std::atomic<long long> m_Bottom;
+	std::atomic<Job*> m_Jobs[JOB_DEQUE_SIZE];
+public:
+	JobDeque(); /* constructor */
+
+	bool Push(Job* job);
+	Job* Pop();
+	Job* Steal();
+};
+
+/* work stealing scheduler
+	~ threadCount - 1 worker threads plus the thread that made the system
+	  (worker 0), every one with its own deque and job pool
+	~ Run() puts a job on the calling thread's deque, idle workers steal
+	  from the others, so the threads that run out of work take it from
+	  the busy ones without a shared queue
+	~ Wait() doesn't block: the waiting thread runs jobs (its own, then
+	  stolen) until the counter is done, so jobs can start jobs and wait
+	  for them without tying up a thread
+	~ Run/Wait/ParallelFor must be called from worker 0 or from inside a
+	  job, jobs must not outlive the data their lambdas point to
+	~ systems can nest (a loader making its own inside a job): the newest
+	  one on a thread is the one it uses, destroying it hands the thread
+	  back to the one before */
+class JobSystem
+{
+private:
+	struct Worker
+	{
+		JobDeque deque;
+		std::unique_ptr<Job[]> pool;
+		unsigned int next;					/* pool slot to hand out next */
+		unsigned int random;				/* steal victim picker */
+		std::atomic<unsigned long long> executed;
+		std::atomic<unsigned long long> stolen;
+	};
+
+	std::vector<std::unique_ptr<Worker>> m_Workers;
+	std::vector<std::thread> m_Threads;
+	std::atomic<int> m_Available;		/* jobs sitting in deques */
+	std::atomic<int> m_Sleeping;
+	std::atomic<bool> m_Running;
+	std::mutex m_SleepMutex;
+	std::condition_variable m_WakeUp;
+	JobSystem* m_PreviousSystem;			/* creating thread's system before this one */
+	unsigned int m_PreviousWorkerIndex;
+
+	Job* AllocateJob();
+	void Submit(Job* job);
+	Job* FindJob(unsigned int worker);
+	void Execute(Job* job);
+	void WorkerLoop(unsigned int worker);
+public:
+	/* 0 uses every hardware thread */
+	JobSystem(unsigned int threadCount = 0); /* constructor */
+	~JobSystem(); /* destructor */
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	/* runs function() on some worker, counter (may be nullptr) goes up now
+	   and down when it's done */
+	template<typename F>
+	void Run(F&& function, JobCounter* counter)
+	{
+		typedef typename std::decay<F>::type Function;
+		static_assert(sizeof(Function) <= JOB_DATA_SIZE, "job lambda captures too much, capture a pointer instead");
+		static_assert(alignof(Function) <= 16, "job lambda needs more alignment than a job has");
+
+		Job* job = AllocateJob();
+		new (job->data) Function(std::forward<F>(function));
+		job->function = [](Job& job)
+		{
+			Function* function = (Function*)job.data;
+			(*function)();
+			function->~Function();
+		};
+		job->counter = counter;
+		if (counter)
+			counter->pending.fetch_add(1, std::memory_order_relaxed);
+		Submit(job);
+	}
+
+	/* runs jobs until counter is zero */
+	void Wait(JobCounter& counter);
+
+	/* body(begin, end) over [0, count) in ranges of at most `grain` items
+		~ the range is split in halves, one half becomes a job the other
+		  threads can steal, until pieces are grain sized
+		~ grain trades overhead (small) against balance (large) */
+	template<typename F>
+	void ParallelFor(unsigned int count, unsigned int grain, const F& body)
+	{
+		JobCounter counter;
+		grain = grain > 0 ? grain : 1;
+		Split(0, count, grain, &body, &counter);
+		Wait(counter);
+	}
+
+	inline unsigned int GetThreadCount() const { return (unsigned int)m_Workers.size(); }
+	/* jobs run and jobs stolen by a worker since it started */
+	inline unsigned long long GetExecuted(unsigned int worker) const { return m_Workers[worker]->executed; }
+	inline unsigned long long GetStolen(unsigned int worker) const { return m_Workers[worker]->stolen; }
+
+	/* index of the calling thread in its job system, 0xFFFFFFFF outside */
+	static unsigned int GetWorkerIndex();
+	/* the calling thread's (newest) job system, nullptr outside */
+	static JobSystem* GetCurrent();
+private:
+	template<typename F>
+	void Split(unsigned int begin, unsigned int end, unsigned int grain, const F* body, JobCounter* counter)
+	{
+		while (end - begin > grain)
+		{
+			unsigned int middle = begin + (end - begin) / 2;
+			Run([this, middle, end, grain, body, counter]() { Split(middle, end, grain, body, counter); }, counter);
+			end = middle;
+		}
+		if (begin < end)
+			(*body)(begin, end);
+	}
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "VertexArray.h"
+#include "vertexbuffer.h"
+#include "indexbuffer.h"
+
+struct MeshData;
+
+/* a mesh with a chain of simplified index buffers
+	~ one VertexBuffer and VertexArray, one IndexBuffer per level
+	  (MeshSimplifier only drops vertices, it never makes new ones)
+	~ pick a level once per object per frame with SelectLod, then draw
+	  with GetVertexArray() and GetIndexBuffer(level), Renderer::Draw and
+	  Submit bind the index buffer after the vertex array so the level
+	  sticks */
+class LodMesh
+{
+private:
+	VertexArray m_VertexArray;
+	VertexBuffer m_VertexBuffer;
+	std::vector<std::unique_ptr<IndexBuffer>> m_Levels;
+	std::vector<float> m_Errors;
+	std::vector<unsigned int> m_TriangleCounts;
+public:
+	LodMesh(const MeshData& data, unsigned int maxLevels = 6, float reduction = 0.5f); /* constructor */
+
+	/* see LodSelector, currentLevel is what the object used last frame */
+	unsigned int SelectLod(float distance, float pixelsPerUnit, unsigned int currentLevel,
+		float pixelError = 1.0f, float hysteresis = 0.25f) const;
+
+	void Bind(unsigned int level) const;
+	void Unbind() const;
+
+	inline unsigned int GetLevelCount() const { return (unsigned int)m_Levels.size(); }
+	inline const VertexArray& GetVertexArray() const { return m_VertexArray; }
+	inline const IndexBuffer& GetIndexBuffer(unsigned int level) const { return *m_Levels[level]; }
+	inline float GetError(unsigned int level) const { return m_Errors[level]; }
+	inline unsigned int GetTriangleCount(unsigned int level) const { return m_TriangleCounts[level]; }
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/* read-only memory mapping of a whole file
+	~ the OS pages the file in on demand, nothing is parsed or copied into
+	  our own buffers, so the pointer can be handed straight to glBufferData
+	~ non-copyable: a copy would unmap the view twice */
+class MappedFile
+{
+private:
+	const unsigned char* m_Data;
+	std::size_t m_Size;
+#ifdef _WIN32
+	void* m_FileHandle;
+	void* m_MappingHandle;
+#endif
+public:
+	MappedFile(const std::string& filepath); /* constructor */
+	~MappedFile(); /* destructor */
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/* false when the file could not be opened or is empty */
+	inline bool IsOpen() const { return m_Data != nullptr; }
+
+	inline const unsigned char* GetData() const { return m_Data; }
+	inline std::size_t GetSize() const { return m_Size; }
+};
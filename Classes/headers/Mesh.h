@@ -0,0 +1,35 @@
+#pragma once
+
+#include "VertexArray.h"
+#include "vertexbuffer.h"
+#include "indexbuffer.h"
+#include "VertexBufferLayout.h"
+
+class MeshFile;
+struct MeshData;
+
+/* vertex array, vertex buffer and index buffer of one piece of geometry
+	~ the index buffer is recorded in the vertex array, so binding the
+	  vertex array is all that is needed before glDrawElements */
+class Mesh
+{
+private:
+	VertexArray m_VertexArray;
+	VertexBuffer m_VertexBuffer;
+	IndexBuffer m_IndexBuffer;
+public:
+	Mesh(const void* vertices, unsigned int size, const unsigned int* indices, unsigned int count,
+		const VertexBufferLayout& layout); /* constructor */
+
+	/* uploads straight from the mapped file, no intermediate copies */
+	Mesh(const MeshFile& file);
+
+	/* uploads geometry produced by MeshLoader */
+	Mesh(const MeshData& data);
+
+	void Bind() const;
+	void Unbind() const;
+
+	inline const VertexArray& GetVertexArray() const { return m_VertexArray; }
+	inline const IndexBuffer& GetIndexBuffer() const { return m_IndexBuffer; }
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "MappedFile.h"
+#include "VertexBufferLayout.h"
+
+/* binary mesh container (.mesh)
+	~ [header][vertex blob][index blob], every blob starts on a
+	  MESH_FILE_ALIGNMENT boundary so the mapped pointers can be handed to
+	  glBufferData as they are
+	~ the layout is stored as VertexBufferElements, so the file describes
+	  exactly what VertexArray::addBuffer expects
+	~ everything is little endian, indices are always 32 bit */
+#define MESH_FILE_MAGIC 0x3148534D /* "MSH1" */
+#define MESH_FILE_VERSION 1
+#define MESH_FILE_ALIGNMENT 64
+#define MESH_FILE_MAX_ELEMENTS 8
+
+struct MeshFileElement
+{
+	uint32_t type;			/* GL_FLOAT, GL_UNSIGNED_INT, GL_UNSIGNED_BYTE */
+	uint32_t count;
+	uint32_t normalized;
+};
+
+struct MeshFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t stride;
+	uint32_t elementCount;
+	MeshFileElement elements[MESH_FILE_MAX_ELEMENTS];
+
+	uint64_t vertexOffset;	/* bytes from the start of the file */
+	uint64_t vertexSize;	/* bytes */
+	uint64_t indexOffset;
+	uint32_t indexCount;
+	uint32_t reserved;
+
+	/* object space bounds, handy for culling without touching the vertices */
+	float boundsMin[3];
+	float boundsMax[3];
+};
+
+/* a .mesh file mapped into memory
+	~ nothing is parsed besides the header, GetVertexData/GetIndexData point
+	  straight into the mapping */
+class MeshFile
+{
+private:
+	MappedFile m_File;
+	const MeshFileHeader* m_Header;
+	VertexBufferLayout m_Layout;
+public:
+	MeshFile(const std::string& filepath); /* constructor */
+
+	/* false when the file is missing, truncated or not a .mesh file */
+	inline bool IsValid() const { return m_Header != nullptr; }
+
+	inline const void* GetVertexData() const { return m_File.GetData() + m_Header->vertexOffset; }
+	inline uint64_t GetVertexSize() const { return m_Header->vertexSize; }
+	inline const unsigned int* GetIndexData() const { return (const unsigned int*)(m_File.GetData() + m_Header->indexOffset); }
+	inline unsigned int GetIndexCount() const { return m_Header->indexCount; }
+	inline const VertexBufferLayout& GetLayout() const { return m_Layout; }
+	inline const MeshFileHeader& GetHeader() const { return *m_Header; }
+
+	/* writes a .mesh file, bounds are computed from the first element
+	   when it is a float position */
+	static bool Write(const std::string& filepath, const void* vertices, unsigned int size,
+		const unsigned int* indices, unsigned int count, const VertexBufferLayout& layout);
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "VertexBufferLayout.h"
+
+class JobSystem;
+
+/* geometry loaded on the CPU, ready to be handed to a Mesh or MeshFile::Write */
+struct MeshData
+{
+	std::vector<float> vertices;		/* interleaved, described by layout */
+	std::vector<unsigned int> indices;	/* triangle list */
+	VertexBufferLayout layout;
+};
+
+/* loaders for big text (and binary PLY) meshes
+	~ the file is memory mapped and split into newline aligned chunks that
+	  are parsed in parallel with std::from_chars (no iostreams)
+	~ OBJ corners are then deduplicated into unique vertices, also in parallel
+	~ vertices come out as position(3) [texcoord(2)] [normal(3)] [color(4)]
+	  floats, attributes the file doesn't have are left out of the layout
+	~ the parallel steps run on a JobSystem, engine code passes its own
+	~ the threadCount versions are for tools (meshconvert, benches): they
+	  make a system for the load (0 uses every hardware thread), unless the
+	  calling thread already runs one, then that one is used and
+	  threadCount is ignored */
+class MeshLoader
+{
+public:
+	/* picks the loader by file extension */
+	static bool Load(const std::string& filepath, MeshData& mesh, unsigned int threadCount = 0);
+	static bool Load(const std::string& filepath, MeshData& mesh, JobSystem& jobs);
+
+	static bool LoadObj(const std::string& filepath, MeshData& mesh, unsigned int threadCount = 0);
+	static bool LoadObj(const std::string& filepath, MeshData& mesh, JobSystem& jobs);
+	static bool LoadPly(const std::string& filepath, MeshData& mesh, unsigned int threadCount = 0);
+	static bool LoadPly(const std::string& filepath, MeshData& mesh, JobSystem& jobs);
+};
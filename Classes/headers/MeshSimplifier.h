@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+/* one level of detail, indices into the same vertices as the full mesh */
+struct LodLevel
+{
+	std::vector<unsigned int> indices;
+	float error;	/* how far (in mesh units) the surface may have moved */
+};
+
+/* quadric error edge collapse simplification
+	~ every vertex gets the sum of the planes of its triangles (a quadric),
+	  collapsing edge u -> v costs the squared distance of v from all the
+	  planes u and v had, the cheapest edges go first
+	~ vertices only ever collapse onto other existing vertices, so the
+	  result is just a new index list and every level can share the
+	  original VertexBuffer
+	~ vertices on open borders and on attribute seams (same position, other
+	  texcoord/normal) stay where they are, so silhouettes and UVs hold up
+	~ positions are the first 3 floats of each vertex, stride is in bytes */
+class MeshSimplifier
+{
+public:
+	/* returns the error of the result, stops at targetIndexCount or
+	   when the next collapse would be worse than maxError */
+	static float Simplify(const float* vertices, unsigned int vertexCount, unsigned int stride,
+		const unsigned int* indices, unsigned int indexCount, unsigned int targetIndexCount, float maxError,
+		std::vector<unsigned int>& result);
+
+	/* level 0 is the input, every next level aims for reduction times the
+	   triangles of the one before, stops once a level barely shrinks */
+	static void BuildLodChain(const float* vertices, unsigned int vertexCount, unsigned int stride,
+		const unsigned int* indices, unsigned int indexCount, std::vector<LodLevel>& levels,
+		unsigned int maxLevels = 6, float reduction = 0.5f);
+};
+
+/* picks a level by how big its error is on screen
+	~ pixelsPerUnit is how many pixels one unit covers at distance 1
+	  (GetPixelsPerUnit), the coarsest level with an error under
+	  pixelError pixels wins
+	~ hysteresis keeps objects sitting right at a threshold from flipping
+	  between two levels every frame: going coarser needs the error to be
+	  (1 - hysteresis) under the limit, going finer needs it to be
+	  (1 + hysteresis) over */
+class LodSelector
+{
+public:
+	static unsigned int Select(const float* errors, unsigned int levelCount, float distance, float pixelsPerUnit,
+		unsigned int currentLevel, float pixelError = 1.0f, float hysteresis = 0.25f);
+
+	/* projection is column major, viewportHeight in pixels */
+	static float GetPixelsPerUnit(const float* projection, float viewportHeight);
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+
+#include "IndirectBuffer.h"
+#include "vertexbuffer.h"
+#include "VertexBufferLayout.h"
+
+class GeometryPool;
+class Shader;
+struct MeshRange;
+
+/* draws any number of meshes from a GeometryPool with one
+   glMultiDrawElementsIndirect
+	~ every Add() writes one indirect command plus that draw's per draw
+	  attributes (transform, color, ...) described by instanceLayout
+	~ the attributes sit in an instanced vertex buffer attached to the
+	  pool's vertex array right after the pool's own attributes, draw i
+	  gets baseInstance i, which makes GL fetch the i-th entry for it
+	~ Flush: two buffer uploads, three binds and one draw call, however
+	  many meshes there are
+	~ one batch per pool, the attribute slots of the vertex array are shared */
+class MultiDrawBatch
+{
+private:
+	GeometryPool& m_Pool;
+	VertexBufferLayout m_InstanceLayout;
+	unsigned int m_MaxDraws;
+	VertexBuffer m_InstanceBuffer;
+	IndirectBuffer m_IndirectBuffer;
+	std::vector<DrawElementsIndirectCommand> m_Commands;
+	std::vector<unsigned char> m_InstanceData;
+public:
+	MultiDrawBatch(GeometryPool& pool, const VertexBufferLayout& instanceLayout, unsigned int maxDraws); /* constructor */
+
+	/* instanceData is one vertex of instanceLayout, copied, returns false when full */
+	bool Add(const MeshRange& mesh, const void* instanceData);
+
+	/* submits everything added since the last Flush, returns the draw count */
+	unsigned int Flush(const Shader& shader);
+
+	inline unsigned int GetDrawCount() const { return (unsigned int)m_Commands.size(); }
+};
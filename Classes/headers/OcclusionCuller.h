@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+
+struct Aabb;
+class BoundsStore;
+
+struct OcclusionStats
+{
+	unsigned int occluderTriangles = 0;	/* triangles that reached the rasterizer */
+	unsigned int testedObjects = 0;
+	unsigned int occludedObjects = 0;
+	double rasterizeMs = 0.0;
+	double pyramidMs = 0.0;
+	double testMs = 0.0;
+};
+
+/* occlusion culling against a small depth buffer drawn on the CPU
+	~ a handful of big occluders (walls, buildings, terrain) are rasterized
+	  into a low resolution depth buffer, 4 pixels at a time with SSE2
+	~ rasterization is conservative: only pixels a triangle covers
+	  completely are written, with the farthest depth the triangle has
+	  inside that pixel, so an object is never hidden by mistake
+	~ the depth buffer is reduced into a max (farthest) pyramid, an object
+	  box is tested by its screen rectangle against the level where that
+	  rectangle spans at most 2x2 texels: if the nearest point of the box
+	  is behind all of them, the box is occluded
+	~ frame: BeginFrame, AddOccluder..., BuildPyramid, then IsVisible/Cull
+	  on what the frustum culler let through, before Renderer::Submit */
+class OcclusionCuller
+{
+private:
+	unsigned int m_Width, m_Height;			/* width is rounded up to a multiple of 4 */
+	float m_ViewProjection[16];
+	std::vector<std::vector<float>> m_Levels;	/* level 0 is the depth buffer */
+	std::vector<unsigned int> m_LevelWidth, m_LevelHeight;
+	std::vector<float> m_Transformed;		/* occluder vertices in screen space */
+	OcclusionStats m_Stats;
+
+	void RasterizeTriangle(const float* v0, const float* v1, const float* v2);
+public:
+	OcclusionCuller(unsigned int width = 256, unsigned int height = 128); /* constructor */
+
+	/* clears the depth buffer and the stats, viewProjection is column major */
+	void BeginFrame(const float* viewProjection);
+
+	/* positions are tightly packed world space xyz, triangles are drawn
+	   from both sides, triangles crossing the near plane are skipped */
+	void AddOccluder(const float* positions, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+	void AddOccluder(const Aabb& box);
+
+	void BuildPyramid();
+
+	bool IsVisible(const Aabb& box);
+	/* keeps the candidates (indices into bounds, usually what
+	   FrustumCuller::Cull returned) that aren't occluded */
+	unsigned int Cull(const BoundsStore& bounds, const unsigned int* candidates, unsigned int count,
+		std::vector<unsigned int>& visible);
+
+	inline const OcclusionStats& GetStats() const { return m_Stats; }
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	inline unsigned int GetLevelCount() const { return (unsigned int)m_Levels.size(); }
+	/* depth in [0, 1], 1 is the far plane, rows go bottom to top like GL */
+	inline const float* GetDepth(unsigned int level = 0) const { return m_Levels[level].data(); }
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+
+#include "VectorMath.h"
+
+class JobSystem;
+
+struct ParticleSettings
+{
+	Vec3 origin = { 0.0f, 0.0f, 0.0f };
+	Vec3 velocity = { 0.0f, 4.0f, 0.0f };	/* at spawn, before the spread */
+	float spread = 1.5f;					/* random velocity added per axis, +-spread */
+	float minLife = 1.0f, maxLife = 3.0f;	/* seconds */
+	Vec3 gravity = { 0.0f, -9.81f, 0.0f };
+	float bounce = 0.5f;					/* speed kept when hitting the ground (y = 0) */
+	float size = 0.02f;						/* quad half size at birth, shrinks to half */
+};
+
+/* the per particle data of one Write, two instanced streams:
+	~ positions: x, y, z, size as 4 floats per particle
+	~ colors: RGBA8, 4 normalized bytes per particle
+	~ both usually point into one mapped VertexBuffer, positions first */
+struct ParticleInstances
+{
+	float* positions;
+	unsigned int* colors;
+};
+
+/* a fountain of particles that live, fall, bounce and respawn
+	~ structure of arrays, so the kernels move 8 particles per AVX
+	  instruction (4 with SSE), with a scalar fallback and tail
+	~ the count stays fixed: a particle that dies respawns at the origin
+	  in the same slot, no lists to compact
+	~ Simulate and Write split the particles over a JobSystem's workers,
+	  Write can go straight into mapped GL memory since it makes no GL
+	  calls, Update does both in one pass while the data is in cache */
+class ParticleSystem
+{
+private:
+	ParticleSettings m_Settings;
+	unsigned int m_Count;
+	std::vector<float> m_PositionX, m_PositionY, m_PositionZ;
+	std::vector<float> m_VelocityX, m_VelocityY, m_VelocityZ;
+	std::vector<float> m_Life, m_InverseLifetime;
+	std::vector<unsigned int> m_Seeds;	/* every particle its own random sequence */
+
+	void Spawn(unsigned int i);
+	void SimulateRange(float dt, unsigned int begin, unsigned int end);
+	void SimulateRangeScalar(float dt, unsigned int begin, unsigned int end);
+	void WriteRange(const ParticleInstances& out, unsigned int begin, unsigned int end) const;
+public:
+	ParticleSystem(unsigned int count, const ParticleSettings& settings = ParticleSettings()); /* constructor */
+
+	void Simulate(float dt, JobSystem* jobs = nullptr);
+	/* one particle at a time, to check and time the SIMD kernel against */
+	void SimulateScalar(float dt);
+	void Write(const ParticleInstances& out, JobSystem* jobs = nullptr) const;
+	/* Simulate and Write in one pass */
+	void Update(float dt, const ParticleInstances& out, JobSystem* jobs = nullptr);
+
+	inline unsigned int GetCount() const { return m_Count; }
+	inline const ParticleSettings& GetSettings() const { return m_Settings; }
+	inline void SetSettings(const ParticleSettings& settings) { m_Settings = settings; }
+	inline const float* GetPositionX() const { return m_PositionX.data(); }
+	inline const float* GetPositionY() const { return m_PositionY.data(); }
+	inline const float* GetPositionZ() const { return m_PositionZ.data(); }
+	inline const float* GetLife() const { return m_Life.data(); }
+};
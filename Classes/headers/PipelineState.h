@@ -0,0 +1,123 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <GL/glew.h>
+
+class Shader;
+class VertexBufferLayout;
+
+struct BlendState
+{
+	bool enabled = false;
+	unsigned int srcColor = GL_ONE, dstColor = GL_ZERO, colorOp = GL_FUNC_ADD;
+	unsigned int srcAlpha = GL_ONE, dstAlpha = GL_ZERO, alphaOp = GL_FUNC_ADD;
+	bool writeRed = true, writeGreen = true, writeBlue = true, writeAlpha = true;
+};
+
+struct StencilState
+{
+	bool enabled = false;
+	unsigned int func = GL_ALWAYS;
+	int reference = 0;
+	unsigned int readMask = 0xFF, writeMask = 0xFF;
+	unsigned int stencilFail = GL_KEEP, depthFail = GL_KEEP, pass = GL_KEEP;
+};
+
+struct DepthState
+{
+	bool test = false;
+	bool write = true;
+	unsigned int func = GL_LESS;
+};
+
+struct RasterState
+{
+	bool cull = false;
+	unsigned int cullFace = GL_BACK;
+	unsigned int frontFace = GL_CCW;
+	unsigned int polygonMode = GL_FILL;
+	bool scissor = false;
+	float depthBiasFactor = 0.0f, depthBiasUnits = 0.0f;	/* glPolygonOffset, both 0 is off */
+};
+
+/* everything a PipelineState is made of
+	~ the defaults are GL's own defaults, so a default description changes
+	  nothing
+	~ layout is the vertex format the shader expects, vertex arrays are
+	  still bound per draw (a GL vertex array ties the format to buffers) */
+struct PipelineStateDesc
+{
+	const Shader* shader = nullptr;
+	const VertexBufferLayout* layout = nullptr;
+	BlendState blend;
+	DepthState depth;
+	StencilState stencil;
+	RasterState raster;
+};
+
+/* immutable bundle of shader and fixed function state, made by a
+   PipelineCache, identical descriptions give the same object */
+class PipelineState
+{
+private:
+	PipelineStateDesc m_Desc;
+	unsigned long long m_Hash;
+	unsigned int m_ID;			/* small number, sorts draws by pipeline */
+public:
+	PipelineState(const PipelineStateDesc& desc, unsigned long long hash, unsigned int id)
+		: m_Desc(desc), m_Hash(hash), m_ID(id) {} /* constructor */
+
+	PipelineState(const PipelineState&) = delete;
+	PipelineState& operator=(const PipelineState&) = delete;
+
+	inline const PipelineStateDesc& GetDesc() const { return m_Desc; }
+	inline unsigned long long GetHash() const { return m_Hash; }
+	inline unsigned int GetID() const { return m_ID; }
+};
+
+/* hashes descriptions and hands out one PipelineState per distinct one,
+   pointers stay good for the cache's lifetime */
+class PipelineCache
+{
+private:
+	std::unordered_map<unsigned long long, std::vector<std::unique_ptr<PipelineState>>> m_States;
+	unsigned int m_Count;
+public:
+	PipelineCache() : m_Count(0) {} /* constructor */
+
+	PipelineCache(const PipelineCache&) = delete;
+	PipelineCache& operator=(const PipelineCache&) = delete;
+
+	const PipelineState* Get(const PipelineStateDesc& desc);
+
+	inline unsigned int GetCount() const { return m_Count; }
+
+	static unsigned long long Hash(const PipelineStateDesc& desc);
+	static bool Equal(const PipelineStateDesc& a, const PipelineStateDesc& b);
+};
+
+/* what GL currently has set, so switching pipelines only issues the GL
+   calls for the fields that differ
+	~ the first Apply (and the first after Invalidate) sets everything
+	~ call Invalidate after changing state with raw GL calls */
+class PipelineStateTracker
+{
+private:
+	PipelineStateDesc m_Current;
+	const PipelineState* m_Bound;
+	bool m_Valid;
+	unsigned int m_Transitions;		/* Apply calls that changed something */
+	unsigned int m_StateCalls;		/* GL calls issued */
+public:
+	PipelineStateTracker(); /* constructor */
+
+	void Apply(const PipelineState& state);
+	void Invalidate();
+
+	inline unsigned int GetTransitions() const { return m_Transitions; }
+	inline unsigned int GetStateCalls() const { return m_StateCalls; }
+	inline void ResetCounters() { m_Transitions = 0; m_StateCalls = 0; }
+};
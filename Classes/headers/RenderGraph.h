@@ -0,0 +1,152 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "RenderTarget.h"
+
+class FrameBuffer;
+class RenderGraph;
+class RenderTargetPool;
+
+/* a texture in the graph, index into the graph's resources */
+typedef unsigned int RenderGraphResource;
+#define INVALID_RESOURCE 0xFFFFFFFF
+
+/* handed to a pass's setup function to declare what it reads and writes */
+class RenderPassBuilder
+{
+private:
+	RenderGraph& m_Graph;
+	unsigned int m_Pass;
+public:
+	RenderPassBuilder(RenderGraph& graph, unsigned int pass) : m_Graph(graph), m_Pass(pass) {} /* constructor */
+
+	/* a transient target this pass writes first, the graph creates it
+	   (from a RenderTargetPool) just before the pass and releases it
+	   after its last reader */
+	RenderGraphResource Create(const std::string& name, const RenderTargetDesc& desc);
+	RenderGraphResource Read(RenderGraphResource resource);
+	RenderGraphResource Write(RenderGraphResource resource);
+	/* never culled, even if nothing reads what it writes (readbacks, queries) */
+	void SetSideEffect();
+};
+
+/* handed to a pass's execute function */
+class RenderPassContext
+{
+private:
+	const RenderGraph& m_Graph;
+	unsigned int m_Pass;
+	RenderTargetPool& m_Pool;
+public:
+	RenderPassContext(const RenderGraph& graph, unsigned int pass, RenderTargetPool& pool)
+		: m_Graph(graph), m_Pass(pass), m_Pool(pool) {} /* constructor */
+
+	/* the texture behind a resource the pass declared, nullptr for the window */
+	RenderTarget* GetTarget(RenderGraphResource resource) const;
+	/* framebuffer of the pass's first color and depth writes, nullptr when
+	   it writes the window */
+	FrameBuffer* GetFrameBuffer() const;
+	/* framebuffer with just `resource` attached, to blit from it */
+	FrameBuffer* GetFrameBuffer(RenderGraphResource resource) const;
+	/* binds that framebuffer (or the window) with its viewport */
+	void BindOutput() const;
+};
+
+struct RenderPassTiming
+{
+	const char* name;
+	double cpuMilliseconds;
+	double gpuMilliseconds;		/* from a timer query a few frames old */
+};
+
+/* the frame as passes that declare the targets they read and write
+	~ AddPass runs the setup function right away, the execute function
+	  every Execute()
+	~ Compile() orders the passes so every pass runs after the writers of
+	  what it reads (several writers of one resource run in the order they
+	  were added), culls passes whose results nobody reads and works out
+	  when every transient target is first and last used
+	~ Execute() acquires transient targets from the pool just before their
+	  first use and releases them after their last, so targets whose
+	  lifetimes don't overlap share textures
+	~ imported targets and the window count as read after the frame, the
+	  passes writing them (and what they read) are never culled
+	~ every pass is timed on the CPU and with a GL_TIME_ELAPSED query */
+class RenderGraph
+{
+private:
+	friend class RenderPassBuilder;
+	friend class RenderPassContext;
+
+	struct Resource
+	{
+		std::string name;
+		RenderTargetDesc desc;
+		RenderTarget* target;		/* imported, or acquired while executing */
+		bool imported;
+		bool backbuffer;
+		std::vector<unsigned int> writers;
+		std::vector<unsigned int> readers;
+		unsigned int refCount;
+		unsigned int firstUse, lastUse;	/* positions in m_Order */
+	};
+
+	struct Pass
+	{
+		std::string name;
+		std::function<void(const RenderPassContext&)> execute;
+		std::vector<RenderGraphResource> reads;
+		std::vector<RenderGraphResource> writes;
+		bool sideEffect;
+		bool culled;
+		unsigned int refCount;
+		unsigned int queries[3];	/* GL_TIME_ELAPSED, one per frame in flight */
+		unsigned int queryFrame;
+		double cpuMilliseconds, gpuMilliseconds;
+	};
+
+	std::vector<Resource> m_Resources;
+	std::vector<Pass> m_Passes;
+	std::vector<unsigned int> m_Order;	/* passes to execute */
+	unsigned int m_Width, m_Height;		/* of the window */
+	bool m_Compiled;
+
+	bool Writes(unsigned int pass, RenderGraphResource resource) const;
+	void Cull();
+public:
+	RenderGraph(unsigned int width, unsigned int height); /* constructor */
+	~RenderGraph(); /* destructor */
+
+	RenderGraph(const RenderGraph&) = delete;
+	RenderGraph& operator=(const RenderGraph&) = delete;
+
+	/* a transient target declared before the pass writing it is added, so
+	   passes can be added in any order (RenderPassBuilder::Create does both) */
+	RenderGraphResource CreateTexture(const std::string& name, const RenderTargetDesc& desc);
+	/* a target that lives outside the graph (history buffers, shadow maps
+	   kept across frames) */
+	RenderGraphResource Import(const std::string& name, RenderTarget* target);
+	/* the window's framebuffer */
+	RenderGraphResource GetBackbuffer();
+
+	void AddPass(const std::string& name, const std::function<void(RenderPassBuilder&)>& setup,
+		const std::function<void(const RenderPassContext&)>& execute);
+
+	/* false (and a message) when the passes depend on each other in a cycle */
+	bool Compile();
+	void Execute(RenderTargetPool& pool);
+
+	/* removes every pass and resource */
+	void Clear();
+	void SetSize(unsigned int width, unsigned int height);
+
+	inline const std::vector<unsigned int>& GetExecutionOrder() const { return m_Order; }
+	inline const std::string& GetPassName(unsigned int pass) const { return m_Passes[pass].name; }
+	inline bool IsCulled(unsigned int pass) const { return m_Passes[pass].culled; }
+	inline unsigned int GetPassCount() const { return (unsigned int)m_Passes.size(); }
+	/* executed passes, in execution order */
+	std::vector<RenderPassTiming> GetTimings() const;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+/* what a render target is made of, two targets with the same description
+   can stand in for each other */
+struct RenderTargetDesc
+{
+	unsigned int width;
+	unsigned int height;
+	unsigned int internalFormat;	/* GL_RGBA8, GL_RGBA16F, GL_DEPTH24_STENCIL8, ... */
+	unsigned int samples;			/* 1: GL_TEXTURE_2D, more: GL_TEXTURE_2D_MULTISAMPLE */
+
+	inline bool operator==(const RenderTargetDesc& other) const
+	{
+		return width == other.width && height == other.height &&
+			internalFormat == other.internalFormat && samples == other.samples;
+	}
+	inline bool operator!=(const RenderTargetDesc& other) const { return !(*this == other); }
+};
+
+/* texture a FrameBuffer renders into
+	~ immutable storage, one level, linear filtering and clamped edges so
+	  post processing passes can sample it directly
+	~ multisampled targets can't be sampled with texture(), resolve them
+	  into a single sampled target with FrameBuffer::Blit first */
+class RenderTarget
+{
+private:
+	unsigned int m_RendererID;
+	RenderTargetDesc m_Desc;
+public:
+	RenderTarget(const RenderTargetDesc& desc); /* constructor */
+	~RenderTarget(); /* destructor */
+
+	RenderTarget(const RenderTarget&) = delete;
+	RenderTarget& operator=(const RenderTarget&) = delete;
+
+	/* binds to texture unit `slot` (GL_TEXTURE0 + slot) */
+	void Bind(unsigned int slot = 0) const;
+
+	inline const RenderTargetDesc& GetDesc() const { return m_Desc; }
+	inline unsigned int GetWidth() const { return m_Desc.width; }
+	inline unsigned int GetHeight() const { return m_Desc.height; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	/* GL_TEXTURE_2D or GL_TEXTURE_2D_MULTISAMPLE */
+	unsigned int GetTarget() const;
+	/* video memory taken by the texture, every sample counted */
+	unsigned long long GetMemorySize() const;
+
+	/* true for the depth and depth/stencil formats */
+	static bool IsDepthFormat(unsigned int internalFormat);
+	static bool HasStencil(unsigned int internalFormat);
+	/* bytes of one sample of a renderable internal format, 0 if unknown */
+	static unsigned int GetBytesPerPixel(unsigned int internalFormat);
+};
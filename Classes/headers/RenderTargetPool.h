@@ -0,0 +1,74 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "RenderTarget.h"
+#include "FrameBuffer.h"
+
+struct RenderTargetPoolStats
+{
+	unsigned int targets;				/* textures the pool holds */
+	unsigned int inUse;
+	unsigned long long memory;			/* bytes of every texture the pool holds */
+	unsigned long long peakMemory;
+	unsigned long long requestedMemory;	/* bytes acquired this frame, what it would take without reuse */
+	unsigned int created;				/* this frame */
+	unsigned int reused;				/* this frame */
+};
+
+/* recycles transient render targets (post processing, blur chains...)
+	~ Acquire() hands out a free target with the same description or makes
+	  a new one, Release() gives it back as soon as the pass that read it
+	  is done: a later pass asking for the same description gets the same
+	  texture, targets whose lifetimes don't overlap share memory
+	~ EndFrame() gives back whatever is still acquired and destroys
+	  targets nobody asked for in the last maxUnusedFrames frames
+	~ framebuffers for target combinations are cached as well, so a pass
+	  doesn't create an FBO every frame
+	~ targets that must keep their contents across frames (history
+	  buffers) don't belong here */
+class RenderTargetPool
+{
+private:
+	struct PooledTarget
+	{
+		std::unique_ptr<RenderTarget> target;
+		bool inUse;
+		unsigned long long lastUsed;	/* frame */
+	};
+
+	struct CachedFrameBuffer
+	{
+		const RenderTarget* color;
+		const RenderTarget* depth;
+		std::unique_ptr<FrameBuffer> frameBuffer;
+		unsigned long long lastUsed;
+	};
+
+	std::vector<PooledTarget> m_Targets;
+	std::vector<CachedFrameBuffer> m_FrameBuffers;
+	unsigned long long m_Frame;
+	unsigned int m_MaxUnusedFrames;
+	RenderTargetPoolStats m_Stats;
+public:
+	RenderTargetPool(unsigned int maxUnusedFrames = 3); /* constructor */
+
+	RenderTargetPool(const RenderTargetPool&) = delete;
+	RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+	/* good until Release() or EndFrame() */
+	RenderTarget* Acquire(const RenderTargetDesc& desc);
+	void Release(const RenderTarget* target);
+
+	/* framebuffer with `color` on attachment 0 and `depth` (either may be
+	   nullptr), both must come from this pool */
+	FrameBuffer& GetFrameBuffer(const RenderTarget* color, const RenderTarget* depth = nullptr);
+
+	void EndFrame();
+	/* destroys every target and framebuffer, nothing may be acquired */
+	void Clear();
+
+	/* counts, the per frame ones are for the frame in progress */
+	inline const RenderTargetPoolStats& GetStats() const { return m_Stats; }
+};
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "FrameSync.h"
+#include "DeletionQueue.h"
+
+/* reference to an object in a ResourcePool
+	~ 8 bytes, copied freely (draw commands, caches, other threads)
+	~ the generation makes a handle to a destroyed object stale: Get()
+	  returns nullptr instead of whatever took over the slot */
+template<typename T>
+struct Handle
+{
+	unsigned int index = 0xFFFFFFFF;
+	unsigned int generation = 0;
+
+	inline bool IsValid() const { return index != 0xFFFFFFFF; }
+	inline bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+	inline bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+/* owns GL wrapper objects (VertexBuffer, IndexBuffer, VertexArray, Shader...)
+	~ objects are stored back to back in one array, iterating over every
+	  buffer/shader is a walk through contiguous memory
+	~ removing moves the last object into the hole, handles go through a
+	  slot table so they stay valid when objects move
+	~ Destroy() doesn't free the GL object right away: the object is parked
+	  until the GPU has finished the frame it was destroyed in (FrameSync),
+	  Collect() once a frame frees what is safe to free
+	~ while the DeletionQueue has a FrameSync the object is destroyed right
+	  away instead, its destructor hands the names to the queue and that
+	  already waits for the GPU (parking it here too would wait twice)
+	~ T must be movable, with the moved-from object owning nothing */
+template<typename T>
+class ResourcePool
+{
+private:
+	struct Slot
+	{
+		unsigned int dense;			/* index into m_Objects while alive */
+		unsigned int generation;
+	};
+
+	struct Retired
+	{
+		T object;
+		unsigned long long frame;
+	};
+
+	FrameSync& m_Sync;
+	std::vector<T> m_Objects;
+	std::vector<unsigned int> m_ObjectSlots;	/* slot of every object, for moving back */
+	std::vector<Slot> m_Slots;
+	std::vector<unsigned int> m_FreeSlots;
+	std::vector<Retired> m_Retired;
+public:
+	ResourcePool(FrameSync& sync) : m_Sync(sync) {} /* constructor */
+
+	ResourcePool(const ResourcePool&) = delete;
+	ResourcePool& operator=(const ResourcePool&) = delete;
+
+	/* constructs the object in place, arguments go to its constructor */
+	template<typename... Args>
+	Handle<T> Create(Args&&... args)
+	{
+		unsigned int slot;
+		if (!m_FreeSlots.empty())
+		{
+			slot = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+		else
+		{
+			slot = (unsigned int)m_Slots.size();
+			m_Slots.push_back({ 0, 0 });
+		}
+
+		m_Slots[slot].dense = (unsigned int)m_Objects.size();
+		m_Objects.emplace_back(std::forward<Args>(args)...);
+		m_ObjectSlots.push_back(slot);
+
+		Handle<T> handle;
+		handle.index = slot;
+		handle.generation = m_Slots[slot].generation;
+		return handle;
+	}
+
+	/* nullptr for stale or invalid handles, the pointer is good until the
+	   next Create or Destroy */
+	T* Get(Handle<T> handle)
+	{
+		if (handle.index >= m_Slots.size() || m_Slots[handle.index].generation != handle.generation)
+			return nullptr;
+		return &m_Objects[m_Slots[handle.index].dense];
+	}
+
+	const T* Get(Handle<T> handle) const
+	{
+		return const_cast<ResourcePool*>(this)->Get(handle);
+	}
+
+	inline bool IsAlive(Handle<T> handle) const { return Get(handle) != nullptr; }
+
+	void Destroy(Handle<T> handle)
+	{
+		if (!Get(handle))
+			return;
+
+		Slot& slot = m_Slots[handle.index];
+		unsigned int dense = slot.dense;
+		if (DeletionQueue::IsDeferred())
+		{
+			T destroyed(std::move(m_Objects[dense]));
+		}
+		else
+			m_Retired.push_back({ std::move(m_Objects[dense]), m_Sync.GetCurrentFrame() });
+
+		/* fill the hole with the last object */
+		unsigned int last = (unsigned int)m_Objects.size() - 1;
+		if (dense != last)
+		{
+			m_Objects[dense] = std::move(m_Objects[last]);
+			m_ObjectSlots[dense] = m_ObjectSlots[last];
+			m_Slots[m_ObjectSlots[dense]].dense = dense;
+		}
+		m_Objects.pop_back();
+		m_ObjectSlots.pop_back();
+
+		slot.generation++;
+		m_FreeSlots.push_back(handle.index);
+	}
+
+	/* frees the GL objects of everything destroyed in frames the GPU has
+	   finished, returns how many were freed */
+	unsigned int Collect()
+	{
+		unsigned long long completed = m_Sync.Poll();
+		unsigned int freed = 0;
+		for (unsigned int i = 0; i < m_Retired.size();)
+		{
+			if (m_Retired[i].frame < completed)
+			{
+				m_Retired[i] = std::move(m_Retired.back());
+				m_Retired.pop_back();
+				freed++;
+			}
+			else
+				i++;
+		}
+		return freed;
+	}
+
+	inline unsigned int GetCount() const { return (unsigned int)m_Objects.size(); }
+	inline unsigned int GetRetiredCount() const { return (unsigned int)m_Retired.size(); }
+
+	/* every live object, in no particular order */
+	inline T* begin() { return m_Objects.data(); }
+	inline T* end() { return m_Objects.data() + m_Objects.size(); }
+	inline const T* begin() const { return m_Objects.data(); }
+	inline const T* end() const { return m_Objects.data() + m_Objects.size(); }
+};
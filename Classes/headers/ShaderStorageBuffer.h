@@ -0,0 +1,35 @@
+#pragma once
+
+/* GL_SHADER_STORAGE_BUFFER, a buffer shaders read and write by index
+	~ what compute shaders work on, bound to a binding point that matches
+	  layout(std430, binding = N) in the shader
+	~ structs shared with GLSL follow std430: vec3 and vec4 both align to
+	  16 bytes, arrays of scalars are tightly packed
+	~ any GL buffer can be bound as storage (BindBase with a renderer ID),
+	  so a compute shader can fill vertex or indirect buffers directly */
+class ShaderStorageBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Size;
+public:
+	/* data may be nullptr for storage the GPU fills, size in bytes */
+	ShaderStorageBuffer(const void* data, unsigned int size); /* constructor */
+	~ShaderStorageBuffer(); /* destructor */
+
+	ShaderStorageBuffer(const ShaderStorageBuffer&) = delete;
+	ShaderStorageBuffer& operator=(const ShaderStorageBuffer&) = delete;
+
+	/* the whole buffer at binding point index */
+	void BindBase(unsigned int index) const;
+	static void BindBase(unsigned int index, unsigned int rendererID);
+
+	/* offset and size in bytes */
+	void SetSubData(const void* data, unsigned int offset, unsigned int size);
+	/* reads back from the GPU, waits for it: for checks and tools, not
+	   every frame, needs a GL_BUFFER_UPDATE_BARRIER_BIT after compute writes */
+	void GetSubData(void* data, unsigned int offset, unsigned int size) const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetSize() const { return m_Size; }
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+struct CompressedImage;
+
+/* 2D texture with immutable storage (glTexStorage2D)
+	~ the size, format and number of mip levels are fixed when the texture
+	  is created, only the contents can change
+	~ uploads expect tightly packed rows */
+class Texture
+{
+private:
+	/* ID is created as integer for every object created
+	   ~ internal renderer ID */
+	unsigned int m_RendererID;
+	unsigned int m_Width, m_Height;
+	unsigned int m_Levels;
+	unsigned int m_InternalFormat;
+public:
+	/* levels 0 allocates the full mip chain down to 1x1 */
+	Texture(unsigned int width, unsigned int height, unsigned int internalFormat, unsigned int levels = 0); /* constructor */
+
+	/* RGBA8 texture filled with `pixels` and mipmapped, pixels may be nullptr */
+	Texture(unsigned int width, unsigned int height, const void* pixels);
+
+	/* block compressed texture (BC1/BC3/BC7) with every level the image has */
+	Texture(const CompressedImage& image);
+	~Texture(); /* destructor */
+
+	/* a copy would delete the same GL texture twice, moving hands it over
+	   and leaves the moved-from texture owning nothing (ID 0) */
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+	Texture(Texture&& other) noexcept;
+	Texture& operator=(Texture&& other) noexcept;
+
+	/* synchronous uploads from client memory
+		~ format/type describe the source pixels (GL_RGBA, GL_UNSIGNED_BYTE, ...)
+		~ with a GL_PIXEL_UNPACK_BUFFER bound, pixels is an offset into it */
+	void SetData(const void* pixels, unsigned int format, unsigned int type, unsigned int level = 0);
+	void SetSubData(unsigned int x, unsigned int y, unsigned int width, unsigned int height,
+		const void* pixels, unsigned int format, unsigned int type, unsigned int level = 0);
+
+	/* upload of a whole level of a block compressed texture, size in bytes */
+	void SetCompressedData(const void* data, unsigned int size, unsigned int level = 0);
+
+	/* rebuilds levels 1..n from level 0
+		~ does nothing for compressed formats, their levels come from the file */
+	void GenerateMipmaps();
+
+	/* binds to texture unit `slot` (GL_TEXTURE0 + slot) */
+	void Bind(unsigned int slot = 0) const;
+	void Unbind() const;
+
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	inline unsigned int GetLevels() const { return m_Levels; }
+	inline unsigned int GetInternalFormat() const { return m_InternalFormat; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
+	/* bytes per pixel of client data in format/type */
+	static unsigned int GetPixelSize(unsigned int format, unsigned int type);
+	/* true for the S3TC/BPTC formats */
+	static bool IsCompressedFormat(unsigned int internalFormat);
+	/* number of levels of a full mip chain */
+	static unsigned int GetMaxLevels(unsigned int width, unsigned int height);
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+/* GL_TEXTURE_2D_ARRAY with immutable storage
+	~ every layer has the same size and format, all of them sit behind one
+	  binding, so sprites from different layers can share a draw call
+	~ in GLSL it's a sampler2DArray, sampled with vec3(u, v, layer) */
+class TextureArray
+{
+private:
+	/* ID is created as integer for every object created
+	   ~ internal renderer ID */
+	unsigned int m_RendererID;
+	unsigned int m_Width, m_Height, m_Layers;
+	unsigned int m_Levels;
+	unsigned int m_InternalFormat;
+public:
+	/* levels 0 allocates the full mip chain down to 1x1 */
+	TextureArray(unsigned int width, unsigned int height, unsigned int layers,
+		unsigned int internalFormat, unsigned int levels = 0); /* constructor */
+	~TextureArray(); /* destructor */
+
+	/* no copies, moves hand the GL texture over */
+	TextureArray(const TextureArray&) = delete;
+	TextureArray& operator=(const TextureArray&) = delete;
+	TextureArray(TextureArray&& other) noexcept;
+	TextureArray& operator=(TextureArray&& other) noexcept;
+
+	/* synchronous upload into one layer, rows tightly packed */
+	void SetSubData(unsigned int layer, unsigned int x, unsigned int y, unsigned int width, unsigned int height,
+		const void* pixels, unsigned int format, unsigned int type, unsigned int level = 0);
+
+	/* rebuilds levels 1..n of every layer from level 0 */
+	void GenerateMipmaps();
+
+	/* binds to texture unit `slot` (GL_TEXTURE0 + slot) */
+	void Bind(unsigned int slot = 0) const;
+	void Unbind() const;
+
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	inline unsigned int GetLayers() const { return m_Layers; }
+	inline unsigned int GetLevels() const { return m_Levels; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+};
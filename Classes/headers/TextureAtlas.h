@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include "TextureArray.h"
+
+/* skyline bin packer
+	~ keeps the top edge of everything placed so far as a list of
+	  horizontal segments and puts every new rectangle where its top ends
+	  up lowest (bottom-left rule)
+	~ fast and tight enough for sprites/glyphs, and it can keep adding
+	  rectangles without repacking */
+class SkylinePacker
+{
+private:
+	struct Segment
+	{
+		unsigned int x, y, width;
+	};
+
+	std::vector<Segment> m_Skyline;
+	unsigned int m_Width, m_Height;
+	unsigned long long m_UsedArea;
+public:
+	SkylinePacker(unsigned int width, unsigned int height); /* constructor */
+
+	/* finds room for a width x height rectangle, false when it doesn't fit */
+	bool Insert(unsigned int width, unsigned int height, unsigned int& x, unsigned int& y);
+	void Clear();
+
+	/* used area / total area */
+	inline float GetOccupancy() const { return (float)m_UsedArea / ((float)m_Width * m_Height); }
+private:
+	bool Fit(size_t index, unsigned int width, unsigned int height, unsigned int& y) const;
+	void AddLevel(size_t index, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+};
+
+/* where an image ended up inside the atlas */
+struct AtlasRegion
+{
+	unsigned int x, y, width, height;	/* texels, padding not included */
+	unsigned int layer;
+	float u0, v0, u1, v1;
+
+	/* maps a 0..1 texcoord of the original image into the atlas layer */
+	inline void Remap(float u, float v, float& atlasU, float& atlasV) const
+	{
+		atlasU = u0 + (u1 - u0) * u;
+		atlasV = v0 + (v1 - v0) * v;
+	}
+};
+
+/* packs many small RGBA8 images into the layers of one TextureArray
+	~ every image gets `padding` texels of its own edge pixels around it so
+	  linear filtering and the first mips don't bleed into neighbours
+	~ Add() everything, Build() once, then draw with GetRegion(id) texcoords
+	  (u, v, layer) against a sampler2DArray, see atlas.shader */
+class TextureAtlas
+{
+private:
+	struct Image
+	{
+		unsigned int width, height;
+		const unsigned char* pixels;
+	};
+
+	std::vector<Image> m_Images;
+	std::vector<AtlasRegion> m_Regions;
+	std::unique_ptr<TextureArray> m_Texture;
+	unsigned int m_Width, m_Height;
+	unsigned int m_MaxLayers;
+	unsigned int m_Padding;
+	unsigned int m_LayerCount;
+public:
+	static const unsigned int INVALID_REGION = 0xFFFFFFFF;
+
+	TextureAtlas(unsigned int width, unsigned int height, unsigned int maxLayers, unsigned int padding = 2); /* constructor */
+
+	/* registers an image and returns its region id
+		~ pixels are RGBA8 and must stay valid until Build()
+		~ INVALID_REGION for an empty (0 wide or 0 high) image */
+	unsigned int Add(unsigned int width, unsigned int height, const void* pixels);
+
+	/* packs every image, creates the texture array and uploads them
+		~ false when they don't fit in maxLayers layers */
+	bool Build();
+
+	inline const AtlasRegion& GetRegion(unsigned int id) const { return m_Regions[id]; }
+	inline unsigned int GetRegionCount() const { return (unsigned int)m_Regions.size(); }
+	inline unsigned int GetLayerCount() const { return m_LayerCount; }
+	/* nullptr until Build() has succeeded */
+	inline const TextureArray* GetTexture() const { return m_Texture.get(); }
+
+	void Bind(unsigned int slot = 0) const;
+};
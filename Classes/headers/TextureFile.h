@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+/* one mip level inside a mapped texture file */
+struct CompressedLevel
+{
+	const unsigned char* data;
+	unsigned int size;
+	unsigned int width, height;
+};
+
+/* block compressed image ready for glCompressedTexSubImage2D */
+struct CompressedImage
+{
+	unsigned int internalFormat;	/* GL_COMPRESSED_..., 0 when unsupported */
+	unsigned int width, height;
+	std::vector<CompressedLevel> levels;	/* largest first */
+};
+
+/* DDS / KTX2 container with BC1, BC3 or BC7 data
+	~ the file is memory mapped, levels point straight into the mapping so
+	  the upload doesn't go through any intermediate buffer
+	~ only 2D textures are read (no arrays, cube maps or KTX2 supercompression) */
+class TextureFile
+{
+private:
+	MappedFile m_File;
+	CompressedImage m_Image;
+	bool m_Valid;
+public:
+	TextureFile(const std::string& filepath); /* constructor */
+
+	inline bool IsValid() const { return m_Valid; }
+	inline const CompressedImage& GetImage() const { return m_Image; }
+
+	/* writes a DDS file (DX10 header for BC7), levels largest first */
+	static bool WriteDds(const std::string& filepath, unsigned int internalFormat, unsigned int width, unsigned int height,
+		const std::vector<std::vector<unsigned char>>& levels);
+private:
+	bool ReadDds(const std::string& filepath);
+	bool ReadKtx2(const std::string& filepath);
+	bool AddLevels(const std::string& filepath, const unsigned char* data, unsigned int levelCount);
+};
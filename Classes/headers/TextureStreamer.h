@@ -0,0 +1,64 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include <GL/glew.h>
+
+class Texture;
+
+/* streams pixel data into textures through a ring of pixel buffer objects
+	~ the CPU only memcpys into a PBO, the copy from the PBO into the
+	  texture is done by the driver/GPU while we keep rendering
+	~ every PBO is guarded by a fence, a PBO still being read by the GPU is
+	  skipped instead of waited on, so Update() never stalls the frame
+	~ big images are split into row bands, at most `bytesPerFrame` go out
+	  per Update() */
+class TextureStreamer
+{
+private:
+	struct StagingBuffer
+	{
+		unsigned int rendererID;
+		GLsync fence;
+	};
+
+	struct Upload
+	{
+		Texture* texture;
+		const unsigned char* pixels;
+		unsigned int format, type;
+		unsigned int level;
+		unsigned int nextRow;
+		bool generateMipmaps;
+	};
+
+	std::vector<StagingBuffer> m_Buffers;
+	unsigned int m_BufferSize;
+	unsigned int m_BytesPerFrame;
+	unsigned int m_NextBuffer;
+	std::deque<Upload> m_Queue;
+public:
+	TextureStreamer(unsigned int bufferCount, unsigned int bufferSize, unsigned int bytesPerFrame); /* constructor */
+	~TextureStreamer(); /* destructor */
+
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	/* queues an upload of a whole mip level
+		~ texture and pixels must stay alive until IsIdle() (or the upload
+		  has finished), nothing is copied here
+		~ a level whose rows don't fit in a staging buffer is uploaded
+		  directly with SetSubData instead (blocking) */
+	void Queue(Texture& texture, const void* pixels, unsigned int format, unsigned int type,
+		unsigned int level = 0, bool generateMipmaps = true);
+
+	/* pushes queued rows through free staging buffers, call once a frame
+		~ returns the number of bytes handed to the GPU */
+	unsigned int Update();
+
+	/* true when every queued upload has been submitted */
+	inline bool IsIdle() const { return m_Queue.empty(); }
+private:
+	bool AcquireBuffer(StagingBuffer& buffer);
+};
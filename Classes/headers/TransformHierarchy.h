@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector>
+
+#include "VectorMath.h"
+
+class JobSystem;
+
+typedef unsigned int TransformNode;
+#define INVALID_NODE 0xFFFFFFFF
+
+/* slots [first, end) */
+struct SlotRange
+{
+	unsigned int first, end;
+};
+
+/* parent/child transforms of a scene
+	~ every array is indexed by slot, slots are sorted by depth: all roots
+	  first, then their children, and so on, so a parent always comes
+	  before its children and every depth is one contiguous range
+	~ nodes keep their TransformNode handle, the slot can move when nodes
+	  are added (the next Update re-sorts)
+	~ local transforms are position/rotation/scale arrays or a matrix set
+	  directly, only nodes whose local transform changed, and their
+	  subtrees, get a new world matrix in Update
+	~ Update walks the depths in order, the nodes of one depth don't
+	  depend on each other so with a JobSystem a depth is split over the
+	  workers
+	~ GetWorldMatrices() is one Mat4 per slot, ready to be an instanced
+	  vertex buffer (a mat4 attribute is 4 vec4 locations), the
+	  changed ranges say what to re-upload: a moving subtree is one run
+	  of slots per depth, so it costs a few SetSubData calls */
+class TransformHierarchy
+{
+private:
+	enum Flags : unsigned char
+	{
+		TRS_DIRTY = 1,			/* local matrix has to be rebuilt */
+		LOCAL_CHANGED = 2,		/* local matrix is new */
+		WORLD_CHANGED = 4		/* world matrix changed in the last Update */
+	};
+
+	/* by slot */
+	std::vector<unsigned int> m_Parents;	/* slot, INVALID_NODE for roots */
+	std::vector<unsigned int> m_Depths;
+	std::vector<Vec3> m_Positions;
+	std::vector<Quat> m_Rotations;
+	std::vector<Vec3> m_Scales;
+	std::vector<Mat4> m_Local;
+	std::vector<Mat4> m_World;
+	std::vector<unsigned char> m_Flags;
+	std::vector<TransformNode> m_Nodes;		/* node of a slot */
+
+	std::vector<unsigned int> m_Slots;		/* slot of a node */
+	std::vector<unsigned int> m_LevelStarts;	/* first slot of every depth, plus the end */
+	bool m_Sorted;
+	std::vector<SlotRange> m_Changed;
+	unsigned int m_Updated;
+
+	void Sort();
+	void UpdateRange(unsigned int begin, unsigned int end, std::vector<SlotRange>& changed, unsigned int& updated);
+public:
+	TransformHierarchy(); /* constructor */
+
+	/* parent INVALID_NODE makes a root, the parent has to exist already */
+	TransformNode Create(TransformNode parent = INVALID_NODE);
+	void Reserve(unsigned int count);
+	void Clear();
+
+	void SetPosition(TransformNode node, const Vec3& position);
+	void SetRotation(TransformNode node, const Quat& rotation);
+	void SetScale(TransformNode node, const Vec3& scale);
+	/* replaces position/rotation/scale until one of them is set again */
+	void SetLocalMatrix(TransformNode node, const Mat4& local);
+
+	inline const Vec3& GetPosition(TransformNode node) const { return m_Positions[m_Slots[node]]; }
+	inline const Quat& GetRotation(TransformNode node) const { return m_Rotations[m_Slots[node]]; }
+	inline const Vec3& GetScale(TransformNode node) const { return m_Scales[m_Slots[node]]; }
+	inline TransformNode GetParent(TransformNode node) const { unsigned int parent = m_Parents[m_Slots[node]]; return parent == INVALID_NODE ? INVALID_NODE : m_Nodes[parent]; }
+	/* valid after Update */
+	inline const Mat4& GetWorld(TransformNode node) const { return m_World[m_Slots[node]]; }
+
+	/* new world matrices for everything that changed */
+	void Update(JobSystem* jobs = nullptr);
+
+	/* in slot order, slots can change with the Update after a Create */
+	inline const Mat4* GetWorldMatrices() const { return m_World.data(); }
+	inline unsigned int GetSlot(TransformNode node) const { return m_Slots[node]; }
+	inline TransformNode GetNode(unsigned int slot) const { return m_Nodes[slot]; }
+	inline unsigned int GetCount() const { return (unsigned int)m_Nodes.size(); }
+	inline unsigned int GetLevelCount() const { return m_LevelStarts.empty() ? 0 : (unsigned int)m_LevelStarts.size() - 1; }
+
+	/* every world matrix the last Update changed, in order, runs closer
+	   than a few slots are joined (one bigger upload beats many small
+	   ones), a single span when there are too many of them, the whole
+	   hierarchy after a re-sort */
+	inline const std::vector<SlotRange>& GetChangedRanges() const { return m_Changed; }
+	/* world matrices the last Update computed */
+	inline unsigned int GetUpdatedCount() const { return m_Updated; }
+};
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cmath>
+
+#if defined(__AVX__)
+#define MATH_AVX
+#define MATH_SSE
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATH_SSE
+#include <emmintrin.h>
+#endif
+
+/* vectors, matrices and quaternions for the CPU side of rendering
+	~ matrices are column major like GL expects, Data() goes straight to
+	  glUniformMatrix4fv with transpose GL_FALSE
+	~ Vec4, Quat and Mat4 are 16 byte aligned and SSE backed (with a
+	  scalar fallback when SSE isn't available), Vec2 and Vec3 are plain
+	  floats so they can describe vertex data
+	~ layouts match std140: Vec2 is 8 bytes aligned to 8, Vec4 16/16,
+	  Mat4 four vec4 columns, Mat3 three vec4 columns (std140 pads a
+	  mat3's columns, use Pack() for glUniformMatrix3fv), a Vec3 in a
+	  uniform block needs alignas(16) on the member */
+
+struct alignas(8) Vec2
+{
+	float x, y;
+};
+
+struct Vec3
+{
+	float x, y, z;
+};
+
+struct alignas(16) Vec4
+{
+	float x, y, z, w;
+};
+
+/* x, y, z imaginary, w real, unit length for rotations */
+struct alignas(16) Quat
+{
+	float x, y, z, w;
+
+	static Quat Identity() { return { 0.0f, 0.0f, 0.0f, 1.0f }; }
+	/* axis must be unit length, angle in radians */
+	static Quat FromAxisAngle(const Vec3& axis, float angle);
+};
+
+/* std140 mat3, three padded columns */
+struct alignas(16) Mat3
+{
+	Vec4 columns[3];
+
+	/* the 9 floats glUniformMatrix3fv takes */
+	void Pack(float* out) const;
+};
+
+struct alignas(16) Mat4
+{
+	Vec4 columns[4];
+
+	inline const float* Data() const { return &columns[0].x; }
+	inline float* Data() { return &columns[0].x; }
+
+	static Mat4 Identity();
+	static Mat4 Translation(const Vec3& t);
+	static Mat4 Scale(const Vec3& s);
+	static Mat4 Rotation(const Quat& q);
+	/* translation * rotation * scale, the usual model matrix */
+	static Mat4 TRS(const Vec3& t, const Quat& q, const Vec3& s);
+	/* GL clip space, z in -w..w, fovY in radians */
+	static Mat4 Perspective(float fovY, float aspect, float zNear, float zFar);
+	static Mat4 Orthographic(float left, float right, float bottom, float top, float zNear, float zFar);
+	static Mat4 LookAt(const Vec3& eye, const Vec3& target, const Vec3& up);
+};
+
+static_assert(sizeof(Vec2) == 8 && alignof(Vec2) == 8, "Vec2 must match std140 vec2");
+static_assert(sizeof(Vec4) == 16 && alignof(Vec4) == 16, "Vec4 must match std140 vec4");
+static_assert(sizeof(Mat3) == 48 && alignof(Mat3) == 16, "Mat3 must match std140 mat3");
+static_assert(sizeof(Mat4) == 64 && alignof(Mat4) == 16, "Mat4 must match std140 mat4");
+
+/* Vec2 */
+inline Vec2 operator+(const Vec2& a, const Vec2& b) { return { a.x + b.x, a.y + b.y }; }
+inline Vec2 operator-(const Vec2& a, const Vec2& b) { return { a.x - b.x, a.y - b.y }; }
+inline Vec2 operator*(const Vec2& a, float s) { return { a.x * s, a.y * s }; }
+inline float Dot(const Vec2& a, const Vec2& b) { return a.x * b.x + a.y * b.y; }
+
+/* Vec3 */
+inline Vec3 operator+(const Vec3& a, const Vec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+inline Vec3 operator-(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+inline Vec3 operator*(const Vec3& a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+inline Vec3 operator*(const Vec3& a, const Vec3& b) { return { a.x * b.x, a.y * b.y, a.z * b.z }; }
+inline float Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Vec3 Cross(const Vec3& a, const Vec3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+inline float Length(const Vec3& a) { return sqrtf(Dot(a, a)); }
+inline Vec3 Normalize(const Vec3& a) { return a * (1.0f / Length(a)); }
+
+/* Vec4 */
+#ifdef MATH_SSE
+inline __m128 LoadVec4(const Vec4& v) { return _mm_load_ps(&v.x); }
+inline Vec4 StoreVec4(__m128 v) { Vec4 r; _mm_store_ps(&r.x, v); return r; }
+
+inline Vec4 operator+(const Vec4& a, const Vec4& b) { return StoreVec4(_mm_add_ps(LoadVec4(a), LoadVec4(b))); }
+inline Vec4 operator-(const Vec4& a, const Vec4& b) { return StoreVec4(_mm_sub_ps(LoadVec4(a), LoadVec4(b))); }
+inline Vec4 operator*(const Vec4& a, const Vec4& b) { return StoreVec4(_mm_mul_ps(LoadVec4(a), LoadVec4(b))); }
+inline Vec4 operator*(const Vec4& a, float s) { return StoreVec4(_mm_mul_ps(LoadVec4(a), _mm_set1_ps(s))); }
+inline float Dot(const Vec4& a, const Vec4& b)
+{
+	__m128 m = _mm_mul_ps(LoadVec4(a), LoadVec4(b));
+	m = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+	m = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+	return _mm_cvtss_f32(m);
+}
+#else
+inline Vec4 operator+(const Vec4& a, const Vec4& b) { return { a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w }; }
+inline Vec4 operator-(const Vec4& a, const Vec4& b) { return { a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w }; }
+inline Vec4 operator*(const Vec4& a, const Vec4& b) { return { a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w }; }
+inline Vec4 operator*(const Vec4& a, float s) { return { a.x * s, a.y * s, a.z * s, a.w * s }; }
+inline float Dot(const Vec4& a, const Vec4& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+#endif
+
+/* Quat */
+Quat operator*(const Quat& a, const Quat& b);
+Quat Normalize(const Quat& q);
+inline Quat Conjugate(const Quat& q) { return { -q.x, -q.y, -q.z, q.w }; }
+Vec3 Rotate(const Quat& q, const Vec3& v);
+/* normalized lerp along the shorter arc, good enough for animation
+   blending and far cheaper than slerp */
+Quat Nlerp(const Quat& a, const Quat& b, float t);
+Quat Slerp(const Quat& a, const Quat& b, float t);
+
+/* Mat4 */
+inline Vec4 operator*(const Mat4& m, const Vec4& v)
+{
+#ifdef MATH_SSE
+	__m128 r = _mm_mul_ps(LoadVec4(m.columns[0]), _mm_set1_ps(v.x));
+	r = _mm_add_ps(r, _mm_mul_ps(LoadVec4(m.columns[1]), _mm_set1_ps(v.y)));
+	r = _mm_add_ps(r, _mm_mul_ps(LoadVec4(m.columns[2]), _mm_set1_ps(v.z)));
+	r = _mm_add_ps(r, _mm_mul_ps(LoadVec4(m.columns[3]), _mm_set1_ps(v.w)));
+	return StoreVec4(r);
+#else
+	return m.columns[0] * v.x + m.columns[1] * v.y + m.columns[2] * v.z + m.columns[3] * v.w;
+#endif
+}
+
+inline Mat4 operator*(const Mat4& a, const Mat4& b)
+{
+	Mat4 r;
+#ifdef MATH_SSE
+	__m128 a0 = LoadVec4(a.columns[0]), a1 = LoadVec4(a.columns[1]), a2 = LoadVec4(a.columns[2]), a3 = LoadVec4(a.columns[3]);
+	for (int j = 0; j < 4; j++)
+	{
+		__m128 column = LoadVec4(b.columns[j]);
+		__m128 c = _mm_mul_ps(a0, _mm_shuffle_ps(column, column, _MM_SHUFFLE(0, 0, 0, 0)));
+		c = _mm_add_ps(c, _mm_mul_ps(a1, _mm_shuffle_ps(column, column, _MM_SHUFFLE(1, 1, 1, 1))));
+		c = _mm_add_ps(c, _mm_mul_ps(a2, _mm_shuffle_ps(column, column, _MM_SHUFFLE(2, 2, 2, 2))));
+		c = _mm_add_ps(c, _mm_mul_ps(a3, _mm_shuffle_ps(column, column, _MM_SHUFFLE(3, 3, 3, 3))));
+		_mm_store_ps(&r.columns[j].x, c);
+	}
+#else
+	for (int j = 0; j < 4; j++)
+		r.columns[j] = a * b.columns[j];
+#endif
+	return r;
+}
+
+inline Vec3 TransformPoint(const Mat4& m, const Vec3& p)
+{
+	Vec4 r = m * Vec4{ p.x, p.y, p.z, 1.0f };
+	return { r.x, r.y, r.z };
+}
+
+inline Vec3 TransformDirection(const Mat4& m, const Vec3& d)
+{
+	Vec4 r = m * Vec4{ d.x, d.y, d.z, 0.0f };
+	return { r.x, r.y, r.z };
+}
+
+Mat4 Transpose(const Mat4& m);
+/* general inverse, the matrix must not be singular */
+Mat4 Inverse(const Mat4& m);
+/* for matrices whose last row is 0 0 0 1 (model and view matrices), cheaper */
+Mat4 InverseAffine(const Mat4& m);
+/* inverse transpose of the upper 3x3, for normals under non uniform scale */
+Mat3 NormalMatrix(const Mat4& m);
+
+/* the same math over many points or matrices at once
+	~ points are structure of arrays: one array per component, so AVX
+	  transforms 8 points per instruction, SSE 4, with a scalar tail
+	~ matrices stay Mat4 (they usually end up in a GL buffer as is), AVX
+	  computes two result columns per instruction
+	~ in and out may be the same arrays
+	~ the Scalar versions are plain loops to check and time against */
+class BatchTransform
+{
+public:
+	static void TransformPoints(const Mat4& m, const float* x, const float* y, const float* z,
+		float* outX, float* outY, float* outZ, unsigned int count);
+	static void TransformPointsScalar(const Mat4& m, const float* x, const float* y, const float* z,
+		float* outX, float* outY, float* outZ, unsigned int count);
+
+	/* out[i] = a[i] * b[i] */
+	static void Multiply(const Mat4* a, const Mat4* b, Mat4* out, unsigned int count);
+	static void MultiplyScalar(const Mat4* a, const Mat4* b, Mat4* out, unsigned int count);
+	/* out[i] = a * b[i], e.g. view projection times every model matrix */
+	static void Multiply(const Mat4& a, const Mat4* b, Mat4* out, unsigned int count);
+};
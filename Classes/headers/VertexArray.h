@@ -1,18 +1,41 @@
 #pragma once
 
+#include <vector>
+
 #include "vertexbuffer.h"
 #include "VertexBufferLayout.h"
 
+class Shader;
+
 class VertexArray
 {
 public:
 	VertexArray();
 	~VertexArray();
 
+	/* no copies, moves hand the GL vertex array over */
+	VertexArray(const VertexArray&) = delete;
+	VertexArray& operator=(const VertexArray&) = delete;
+	VertexArray(VertexArray&& other) noexcept;
+	VertexArray& operator=(VertexArray&& other) noexcept;
+
+	/* element i goes to attribute location i */
 	void addBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	/* elements go where the bindings say (Shader::MatchLayout) */
+	void addBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, const std::vector<VertexAttributeBinding>& bindings);
+	/* matches the layout to the shader's attributes by name, false (and
+	   nothing bound) when they don't fit */
+	bool addBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, const Shader& shader);
+	/* attributes that advance once per instance instead of once per vertex,
+	   starting at attribute location firstAttribute, the first instance's
+	   data starts offset bytes into the buffer (several instance streams
+	   can share one buffer) */
+	void addInstanceBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int firstAttribute, unsigned int offset = 0);
 
 	void Bind() const;
 	void Unbind() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 private:
 	unsigned int m_RendererID;
 };
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "VertexArray.h"
+
+class Shader;
+class IndexBuffer;
+
+/* validated (shader, layout) pairs and the vertex arrays built from them
+	~ Validate() matches a layout to a shader once (Shader::MatchLayout) and
+	  remembers the bindings, or that it doesn't fit
+	~ Get() hands out one vertex array per shader, layout, vertex buffer
+	  and index buffer, built the first time with the cached bindings, so
+	  meshes sharing a format don't redo the matching and setup
+	~ entries are keyed by GL names, call Remove() before a buffer is
+	  destroyed (GL may hand its name to a new buffer) */
+class VertexArrayCache
+{
+private:
+	struct LayoutEntry
+	{
+		unsigned int program;
+		unsigned long long layoutHash;
+		VertexBufferLayout layout;		/* to tell hash collisions apart */
+		bool valid;
+		std::vector<VertexAttributeBinding> bindings;
+	};
+
+	struct ArrayEntry
+	{
+		unsigned int layoutEntry;
+		std::unique_ptr<VertexArray> vertexArray;
+	};
+
+	std::vector<LayoutEntry> m_Layouts;
+	/* vertex buffer << 32 | index buffer -> one entry per layout used with them */
+	std::unordered_map<unsigned long long, std::vector<ArrayEntry>> m_Arrays;
+	unsigned int m_ArrayCount;
+	unsigned int m_Hits, m_Misses;
+
+	const LayoutEntry& FindLayout(const Shader& shader, const VertexBufferLayout& layout);
+public:
+	VertexArrayCache(); /* constructor */
+
+	VertexArrayCache(const VertexArrayCache&) = delete;
+	VertexArrayCache& operator=(const VertexArrayCache&) = delete;
+
+	/* at load time, false when the layout doesn't fit the shader (the
+	   reason is printed once) */
+	bool Validate(const Shader& shader, const VertexBufferLayout& layout);
+
+	/* nullptr when the layout doesn't fit, the index buffer (if any) is
+	   recorded in the vertex array as well */
+	const VertexArray* Get(const Shader& shader, const VertexBuffer& vb, const VertexBufferLayout& layout,
+		const IndexBuffer* ib = nullptr);
+
+	/* drops every vertex array using the buffer */
+	void Remove(const VertexBuffer& vb);
+	/* drops everything made for the shader (before it's destroyed or reloaded) */
+	void Remove(const Shader& shader);
+
+	inline unsigned int GetLayoutCount() const { return (unsigned int)m_Layouts.size(); }
+	inline unsigned int GetVertexArrayCount() const { return m_ArrayCount; }
+	inline unsigned int GetHits() const { return m_Hits; }
+	inline unsigned int GetMisses() const { return m_Misses; }
+
+	/* of the elements' types, counts and names */
+	static unsigned long long HashLayout(const VertexBufferLayout& layout);
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <string>
 #include <vector>
 #include <GL/glew.h>
 #include "renderer.h"
@@ -9,6 +10,7 @@ struct VertexBufferElement
 	unsigned int type;
 	unsigned int count;
 	unsigned char normalized;
+	std::string name;	/* shader attribute it feeds, empty: bound by position */
 
 	static unsigned int GetSizeOfType(unsigned int type)
 	{
@@ -16,13 +18,24 @@ struct VertexBufferElement
 		{
 			case GL_FLOAT:			return 4;
 			case GL_UNSIGNED_INT:	return 4;
-			case GL_UNSIGNED_BYTE:	return 4;
+			case GL_UNSIGNED_BYTE:	return 1;
 		}
 		ASSERT(false);
 		return 0;
 	}
 };
 
+/* one attribute location a layout feeds, made by Shader::MatchLayout and
+   applied by VertexArray::addBuffer */
+struct VertexAttributeBinding
+{
+	unsigned int location;
+	unsigned int element;	/* index into the layout's elements */
+	unsigned int count;		/* components fed to this location */
+	unsigned int offset;	/* bytes into the vertex */
+	bool integer;			/* int/uint attribute: glVertexAttribIPointer */
+};
+
 class VertexBufferLayout
 {
 private:
@@ -32,33 +45,43 @@ public:
 	VertexBufferLayout()
 		: m_Stride(0) {}
 
+	/* name is the `in` variable of the vertex shader the element feeds,
+	   with names the layout can be matched to a shader (Shader::MatchLayout)
+	   instead of relying on element i going to attribute location i */
 	template<typename T>
-	void Push(unsigned int count)
+	void Push(unsigned int count, const std::string& name = std::string())
 	{
 		static_assert(false);
 	}
 
 	template<>
-	void Push<float>(unsigned int count)
+	void Push<float>(unsigned int count, const std::string& name)
 	{
-		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
+		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE, name });
 		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT);
 	}
 
 	template<>
-	void Push<unsigned int>(unsigned int count)
+	void Push<unsigned int>(unsigned int count, const std::string& name)
 	{
-		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
+		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE, name });
 		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT);
 	}
 
 	template<>
-	void Push<unsigned char>(unsigned int count)
+	void Push<unsigned char>(unsigned int count, const std::string& name)
+	{
+		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE, name });
+		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
+	}
+
+	/* pushes an already described element (e.g. read back from a mesh file) */
+	void Push(const VertexBufferElement& element)
 	{
-		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
-		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_BYTE);
+		m_Elements.push_back(element);
+		m_Stride += element.count * VertexBufferElement::GetSizeOfType(element.type);
 	}
 
-	inline const std::vector<VertexBufferElement> GetElements() const { return m_Elements; }
+	inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
 	inline unsigned int GetStride() const { return m_Stride; }
 };
\ No newline at end of file
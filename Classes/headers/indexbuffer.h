@@ -11,10 +11,20 @@ public:
 	IndexBuffer(const unsigned int* data, unsigned int count); /* constructor */
 	~IndexBuffer(); /* destructor */
 
+	/* same as VertexBuffer: no copies, moves hand the GL buffer over */
+	IndexBuffer(const IndexBuffer&) = delete;
+	IndexBuffer& operator=(const IndexBuffer&) = delete;
+	IndexBuffer(IndexBuffer&& other) noexcept;
+	IndexBuffer& operator=(IndexBuffer&& other) noexcept;
+
 	/* these two function bind and unbinds vertex buffer*/
 	void Bind() const;
 	void Unbind() const;
+
+	/* overwrites count indices starting at index offset, m_Count stays the same */
+	void SetSubData(const unsigned int* data, unsigned int offset, unsigned int count);
 	
 	/* Getter to store and return count */
 	inline unsigned int GetCount() const { return m_Count; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 };
\ No newline at end of file
@@ -14,3 +14,79 @@
 
 void GLClearError();
 bool GLLogCall(const char* function, const char* file, int line);
+
+#include "FrameArena.h"
+#include "PipelineState.h"
+
+class VertexArray;
+class IndexBuffer;
+class Shader;
+class CommandList;
+class JobSystem;
+
+/* one queued glDrawElements */
+struct DrawCommand
+{
+    unsigned long long key; /* sort key: shader, then vertex array */
+    const VertexArray* va;
+    const IndexBuffer* ib;
+    const Shader* shader;
+    const PipelineState* pipeline; /* nullptr: only the shader is bound */
+
+    /* fills in the sort key, safe on any thread */
+    static DrawCommand Make(const VertexArray& va, const IndexBuffer& ib, const Shader& shader);
+    static DrawCommand Make(const VertexArray& va, const IndexBuffer& ib, const PipelineState& pipeline);
+};
+
+class Renderer
+{
+private:
+    FrameArena* m_Arena;
+    FrameVector<DrawCommand> m_Queue;
+    FrameVector<DrawCommand> m_SortScratch;
+    unsigned int m_LastFrameCount; /* to reserve the whole queue in one go */
+    /* a cache of GL state, not part of what the renderer draws, so the
+       const draw functions may update it */
+    mutable PipelineStateTracker m_Pipelines;
+public:
+    /* with an arena the queue lives in it and is given back on every Flush,
+       so Flush has to come before the arena's Reset */
+    Renderer(FrameArena* arena = nullptr); /* constructor */
+
+    void Clear() const;
+
+    /* draws right away, binding everything */
+    void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
+    void Draw(const VertexArray& va, const IndexBuffer& ib, const PipelineState& pipeline) const;
+    /* instanceCount copies of the mesh, the vertex array's instance
+       buffers (VertexArray::addInstanceBuffer) advance once per copy */
+    void DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const;
+
+    /* runs a compute shader over groupsX * groupsY * groupsZ work groups
+       (not invocations, divide by Shader::GetWorkGroupSize) */
+    void Dispatch(const Shader& shader, unsigned int groupsX, unsigned int groupsY = 1, unsigned int groupsZ = 1) const;
+    /* glMemoryBarrier, GL_*_BARRIER_BIT flags for how the next commands
+       read what the compute shader wrote */
+    void Barrier(unsigned int bits) const;
+
+    /* switches to a pipeline, only the fields that differ from the current
+       one are set, call InvalidatePipeline after raw GL state changes */
+    void SetPipelineState(const PipelineState& pipeline) const;
+    inline void InvalidatePipeline() const { m_Pipelines.Invalidate(); }
+    inline const PipelineStateTracker& GetPipelineTracker() const { return m_Pipelines; }
+
+    /* queued path: Submit every visible object during the frame, Flush once
+        ~ draws are sorted so objects sharing a shader/vertex array are
+          drawn back to back and their binds are issued only once */
+    void Submit(const VertexArray& va, const IndexBuffer& ib, const Shader& shader);
+    /* sorted by pipeline, then vertex array */
+    void Submit(const VertexArray& va, const IndexBuffer& ib, const PipelineState& pipeline);
+    /* appends lists recorded on worker threads, call it on the GL thread
+       once they're done, with jobs the lists are copied in parallel */
+    void Submit(const CommandList* lists, unsigned int count, JobSystem* jobs = nullptr);
+    /* with jobs the queue is radix sorted in parallel, GL calls still
+       only happen on this thread */
+    void Flush(JobSystem* jobs = nullptr);
+
+    inline unsigned int GetQueuedCount() const { return (unsigned int)m_Queue.size(); }
+};
@@ -2,33 +2,169 @@
 
 #include <string>
 #include <unordered_map> /* this is a hash table (further research) */
+#include <vector>
+
+#include "VertexBufferLayout.h"
 
 struct ShaderProgramSource
 {
 	std::string VertexSource;
 	std::string FragmentSource;
+	std::string ComputeSource;
+};
+
+/* an active uniform found by reflection after linking, with the last
+   value uploaded to it kept in the shader's shadow copy */
+struct ShaderUniform
+{
+	int location;
+	unsigned int type;		/* GL_FLOAT_VEC4, GL_FLOAT_MAT4, GL_SAMPLER_2D, ... */
+	int arraySize;			/* 1 for plain uniforms */
+	unsigned int offset;	/* into the shadow copy, bytes */
+	unsigned int size;		/* of the whole array, bytes */
+	unsigned int uploadedSize;	/* bytes of the shadow copy known to match GL */
+};
+
+/* an active vertex attribute (`in` variable of the vertex shader) */
+struct ShaderAttribute
+{
+	std::string name;
+	int location;
+	unsigned int type;		/* GL_FLOAT_VEC4, GL_INT_VEC2, GL_FLOAT_MAT4, ... */
+	int arraySize;
+};
+
+/* uploads and the ones skipped because the value hadn't changed */
+struct UniformStats
+{
+	unsigned long long uploads;
+	unsigned long long skipped;
 };
 
+/* shader program built from a .shader file
+	~ every uniform setter compares the value with a shadow copy of what
+	  was last uploaded and only calls glUniform* when it changed, many
+	  objects sharing a program then cost one upload per actual change
+	~ the shadow copy assumes nothing else sets this program's uniforms
+	  (call InvalidateUniforms after raw glUniform calls)
+	~ like glUniform*, the setters need the program to be bound
+	~ a file with a `#shader compute` section (and no vertex section)
+	  makes a compute program, run it with Renderer::Dispatch */
 class Shader
 {
 public:
 	Shader(const std::string& filepath);
 	~Shader();
 
+	/* no copies, moves hand the GL program (and the location cache) over */
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+	Shader(Shader&& other) noexcept;
+	Shader& operator=(Shader&& other) noexcept;
+
 	void Bind() const;
 	void Unbind() const;
 
-	/* sets uniform */
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline bool IsCompute() const { return m_WorkGroupSize[0] != 0; }
+	/* local_size_x/y/z of a compute program, 0 otherwise */
+	inline unsigned int GetWorkGroupSize(unsigned int axis) const { return m_WorkGroupSize[axis]; }
+
+	/* sets uniform
+		~ every float, int, uint and bool type (bools through the int
+		  setters) and arrays of them, doubles have no setters */
+	void SetUniform1i(const std::string& name, int value);	/* ints, bools and samplers */
+	void SetUniform2i(const std::string& name, int v0, int v1);
+	void SetUniform3i(const std::string& name, int v0, int v1, int v2);
+	void SetUniform4i(const std::string& name, int v0, int v1, int v2, int v3);
+	void SetUniform1ui(const std::string& name, unsigned int value);
+	void SetUniform2ui(const std::string& name, unsigned int v0, unsigned int v1);
+	void SetUniform3ui(const std::string& name, unsigned int v0, unsigned int v1, unsigned int v2);
+	void SetUniform4ui(const std::string& name, unsigned int v0, unsigned int v1, unsigned int v2, unsigned int v3);
+	void SetUniform1f(const std::string& name, float value);
+	void SetUniform2f(const std::string& name, float v0, float v1);
+	void SetUniform3f(const std::string& name, float v0, float v1, float v2);
 	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
+
+	/* matrices are column major, like GL wants them */
+	void SetUniformMat2f(const std::string& name, const float* matrix);
+	void SetUniformMat3f(const std::string& name, const float* matrix);
+	void SetUniformMat4f(const std::string& name, const float* matrix);
+
+	/* arrays (and sampler arrays), `count` elements from the first one,
+	   or from element n with a "name[n]" name */
+	void SetUniform1iv(const std::string& name, int count, const int* values);
+	void SetUniform2iv(const std::string& name, int count, const int* values);
+	void SetUniform3iv(const std::string& name, int count, const int* values);
+	void SetUniform4iv(const std::string& name, int count, const int* values);
+	void SetUniform1uiv(const std::string& name, int count, const unsigned int* values);
+	void SetUniform2uiv(const std::string& name, int count, const unsigned int* values);
+	void SetUniform3uiv(const std::string& name, int count, const unsigned int* values);
+	void SetUniform4uiv(const std::string& name, int count, const unsigned int* values);
+	void SetUniform1fv(const std::string& name, int count, const float* values);
+	void SetUniform2fv(const std::string& name, int count, const float* values);
+	void SetUniform3fv(const std::string& name, int count, const float* values);
+	void SetUniform4fv(const std::string& name, int count, const float* values);
+	void SetUniformMat2fv(const std::string& name, int count, const float* matrices);
+	void SetUniformMat3fv(const std::string& name, int count, const float* matrices);
+	void SetUniformMat4fv(const std::string& name, int count, const float* matrices);
+	/* non square matrices, columns x rows like GLSL's matCxR, count 1
+	   for a single one */
+	void SetUniformMat2x3fv(const std::string& name, int count, const float* matrices);
+	void SetUniformMat3x2fv(const std::string& name, int count, const float* matrices);
+	void SetUniformMat2x4fv(const std::string& name, int count, const float* matrices);
+	void SetUniformMat4x2fv(const std::string& name, int count, const float* matrices);
+	void SetUniformMat3x4fv(const std::string& name, int count, const float* matrices);
+	void SetUniformMat4x3fv(const std::string& name, int count, const float* matrices);
+
+	/* forgets the shadow copy, the next set of every uniform uploads */
+	void InvalidateUniforms();
+
+	inline const UniformStats& GetUniformStats() const { return m_UniformStats; }
+	inline const std::vector<ShaderUniform>& GetUniforms() const { return m_Uniforms; }
+	inline const std::vector<ShaderAttribute>& GetAttributes() const { return m_Attributes; }
+	inline const std::string& GetFilePath() const { return m_FilePath; }
+
+	/* works out where every element of `layout` goes for this shader
+		~ elements are matched to attributes by name, a layout without any
+		  names falls back to element i -> location i
+		~ fails (printing why) when an attribute has no element, an int
+		  attribute is fed floats or a matrix gets the wrong number of
+		  floats, warns when a vector gets more components than it has
+		  (fewer is fine, GL fills in 0, 0, 0, 1)
+		~ do it when the mesh is loaded, not when it's drawn */
+	bool MatchLayout(const VertexBufferLayout& layout, std::vector<VertexAttributeBinding>& bindings) const;
+
+	/* components per location, locations per element (matrix columns)
+	   and whether the attribute is int/uint, false for types that can't
+	   be a vertex attribute here (doubles) */
+	static bool GetAttributeShape(unsigned int type, unsigned int& components, unsigned int& columns, bool& integer);
+	/* bytes of one element of a uniform type, opaque types (samplers,
+	   images) are an int */
+	static unsigned int GetUniformTypeSize(unsigned int type);
 private:
 	std::string m_FilePath;
 	unsigned int m_RendererID;
 	std::unordered_map<std::string, int> m_UniformLocationCache;
+	std::vector<ShaderUniform> m_Uniforms;
+	std::unordered_map<std::string, unsigned int> m_UniformIndices;	/* name -> m_Uniforms */
+	std::vector<unsigned char> m_UniformData;	/* shadow copy of every value */
+	std::vector<ShaderAttribute> m_Attributes;
+	UniformStats m_UniformStats;
+	unsigned int m_WorkGroupSize[3];
 private:	
 	ShaderProgramSource ParseShader(const std::string& filepath);
 	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
+	unsigned int CreateComputeShader(const std::string& computeShader);
 	unsigned int CompileShader(unsigned int type, const std::string& source);
 
 	unsigned int GetUniformLocation(const std::string& name);
+
+	void ReflectUniforms();
+	void ReflectAttributes();
+	/* copies `size` bytes into the shadow copy, returns the location to
+	   upload to or -1 when the value hasn't changed (or doesn't exist)
+		~ "name[n]" writes into name's copy from element n on */
+	int UpdateUniform(const std::string& name, const void* data, unsigned int size);
 };
 
@@ -10,7 +10,28 @@ public:
 	VertexBuffer(const void* data, unsigned int size); /* constructor */
 	~VertexBuffer(); /* destructor */
 
+	/* a copy would delete the same GL buffer twice, moving hands it over
+	   and leaves the moved-from object owning nothing (ID 0) */
+	VertexBuffer(const VertexBuffer&) = delete;
+	VertexBuffer& operator=(const VertexBuffer&) = delete;
+	VertexBuffer(VertexBuffer&& other) noexcept;
+	VertexBuffer& operator=(VertexBuffer&& other) noexcept;
+
 	/* these two function bind and unbinds vertex buffer*/
 	void Bind() const;
 	void Unbind() const;
+
+	/* overwrites part of the buffer, offset and size in bytes */
+	void SetSubData(const void* data, unsigned int offset, unsigned int size);
+
+	/* pointer to write [offset, offset + size) directly, nullptr on failure
+		~ the old contents of the range are dropped, nothing is read back
+		~ orphan gives the whole buffer new storage, so the GPU can keep
+		  drawing last frame's data while this frame's is written
+		~ any thread may write through the pointer, Map/Unmap are GL calls */
+	void* Map(unsigned int offset, unsigned int size, bool orphan = false);
+	/* false when the contents got lost while mapped, write them again */
+	bool Unmap();
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 };
\ No newline at end of file
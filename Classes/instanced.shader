@@ -0,0 +1,26 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec2 position;
+/* per instance world matrix, straight from a TransformHierarchy, a mat4
+   attribute takes four locations (1 to 4), one per column */
+layout(location = 1) in mat4 model;
+
+uniform mat4 u_ViewProjection;
+
+void main()
+{
+   gl_Position = u_ViewProjection * model * vec4(position, 0.0, 1.0);
+}
+
+#shader fragment
+#version 330 core
+
+out vec4 color;
+
+uniform vec4 u_Color;
+
+void main()
+{
+    color = u_Color;
+}
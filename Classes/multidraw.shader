@@ -0,0 +1,28 @@
+#shader vertex
+#version 430 core
+
+layout(location = 0) in vec2 position;
+/* per draw attributes, advanced once per instance, and every draw of a
+   glMultiDrawElementsIndirect starts at its own baseInstance */
+layout(location = 1) in vec4 transform; /* xy = offset, z = scale */
+layout(location = 2) in vec4 drawColor;
+
+out vec4 v_Color;
+
+void main()
+{
+   gl_Position = vec4(position * transform.z + transform.xy, 0.0, 1.0);
+   v_Color = drawColor;
+}
+
+#shader fragment
+#version 430 core
+
+out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+    color = v_Color;
+}
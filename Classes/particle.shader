@@ -0,0 +1,31 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec2 corner;
+/* per particle, written by ParticleSystem: xyz position, w half size */
+layout(location = 1) in vec4 particle;
+layout(location = 2) in vec4 particleColor;
+
+uniform mat4 u_ViewProjection;
+
+out vec4 v_Color;
+
+void main()
+{
+   /* the quad faces the camera: corners are offset after projection */
+   vec4 center = u_ViewProjection * vec4(particle.xyz, 1.0);
+   gl_Position = center + vec4(corner * particle.w, 0.0, 0.0);
+   v_Color = particleColor;
+}
+
+#shader fragment
+#version 330 core
+
+out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+    color = v_Color;
+}
@@ -0,0 +1,43 @@
+#shader vertex
+#version 430 core
+
+layout(location = 0) in vec2 corner;
+
+/* written by particle_update.shader, one per instance */
+struct Particle
+{
+    vec4 position; /* w = life left */
+    vec4 velocity; /* w = 1 / lifetime */
+};
+
+layout(std430, binding = 0) readonly buffer Particles
+{
+    Particle particles[];
+};
+
+uniform mat4 u_ViewProjection;
+uniform float u_HalfSize;
+
+out vec4 v_Color;
+
+void main()
+{
+   Particle p = particles[gl_InstanceID];
+   /* t goes from 1 at birth to 0 at death, like ParticleSystem::Write */
+   float t = clamp(p.position.w * p.velocity.w, 0.0, 1.0);
+   vec4 center = u_ViewProjection * vec4(p.position.xyz, 1.0);
+   gl_Position = center + vec4(corner * (u_HalfSize + u_HalfSize * t), 0.0, 0.0);
+   v_Color = vec4(1.0, t, t * 64.0 / 255.0, t);
+}
+
+#shader fragment
+#version 430 core
+
+out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+    color = v_Color;
+}
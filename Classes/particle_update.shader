@@ -0,0 +1,72 @@
+#shader compute
+#version 430 core
+
+/* one invocation per particle, GpuParticleSystem::Simulate */
+layout(local_size_x = 256) in;
+
+struct Particle
+{
+    vec4 position; /* w = life left */
+    vec4 velocity; /* w = 1 / lifetime */
+};
+
+layout(std430, binding = 0) buffer Particles
+{
+    Particle particles[];
+};
+
+uniform float u_DeltaTime;
+uniform vec3 u_Gravity;
+uniform vec3 u_Origin;
+uniform vec3 u_Velocity;
+uniform float u_Spread;
+uniform vec2 u_Life; /* min, max */
+uniform float u_Bounce;
+uniform uint u_Seed;
+uniform uint u_Count;
+
+/* integer hash, a fresh random sequence per particle and frame */
+uint Hash(uint x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+float Random(inout uint state)
+{
+    state = Hash(state);
+    return float(state >> 8) * (1.0 / 16777216.0);
+}
+
+void main()
+{
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= u_Count)
+        return;
+
+    Particle p = particles[i];
+    p.velocity.xyz += u_Gravity * u_DeltaTime;
+    p.position.xyz += p.velocity.xyz * u_DeltaTime;
+    /* under the ground: back on it, and bounce if still going down */
+    if (p.position.y < 0.0)
+    {
+        p.position.y = 0.0;
+        if (p.velocity.y < 0.0)
+            p.velocity.y *= -u_Bounce;
+    }
+
+    p.position.w -= u_DeltaTime;
+    if (p.position.w <= 0.0)
+    {
+        uint state = Hash(i ^ Hash(u_Seed));
+        float life = mix(u_Life.x, u_Life.y, Random(state));
+        vec3 spread = vec3(Random(state), Random(state), Random(state)) * 2.0 - 1.0;
+        p.position = vec4(u_Origin, life);
+        p.velocity = vec4(u_Velocity + u_Spread * spread, 1.0 / life);
+    }
+    particles[i] = p;
+}
@@ -0,0 +1,736 @@
+#include "BlockCompression.h"
+
+#include <cstring>
+#include <cmath>
+#include <cstdint>
+
+#include "renderer.h"
+
+/* x64 always has SSE2, 32 bit MSVC only with /arch:SSE2 */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLOCK_COMPRESSION_SSE2
+#include <emmintrin.h>
+#endif
+
+/* ---------------------------------------------------------------------------
+   shared helpers
+   --------------------------------------------------------------------------- */
+
+static inline int Clamp(int value, int low, int high)
+{
+	return value < low ? low : (value > high ? high : value);
+}
+
+static inline int RoundToInt(float value)
+{
+	return (int)floorf(value + 0.5f);
+}
+
+static inline uint16_t Pack565(int r, int g, int b)
+{
+	r = Clamp(r, 0, 255); g = Clamp(g, 0, 255); b = Clamp(b, 0, 255);
+	return (uint16_t)(((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 | ((b * 31 + 127) / 255));
+}
+
+/* 565 back to 8 bit per channel, the way the hardware expands it */
+static inline void Unpack565(uint16_t color, int rgb[3])
+{
+	int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+	rgb[0] = (r << 3) | (r >> 2);
+	rgb[1] = (g << 2) | (g >> 4);
+	rgb[2] = (b << 3) | (b >> 2);
+}
+
+/* principal axis of a point cloud by power iteration on its covariance */
+template<int N>
+static bool PrincipalAxis(const float* points, int count, float mean[N], float axis[N])
+{
+	for (int c = 0; c < N; c++)
+		mean[c] = 0.0f;
+	for (int i = 0; i < count; i++)
+		for (int c = 0; c < N; c++)
+			mean[c] += points[i * N + c];
+	for (int c = 0; c < N; c++)
+		mean[c] /= count;
+
+	float covariance[N][N] = {};
+	for (int i = 0; i < count; i++)
+	{
+		float d[N];
+		for (int c = 0; c < N; c++)
+			d[c] = points[i * N + c] - mean[c];
+		for (int a = 0; a < N; a++)
+			for (int b = 0; b < N; b++)
+				covariance[a][b] += d[a] * d[b];
+	}
+
+	for (int c = 0; c < N; c++)
+		axis[c] = 1.0f;
+	float length = 0.0f;
+	for (int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[N] = {};
+		for (int a = 0; a < N; a++)
+			for (int b = 0; b < N; b++)
+				next[a] += covariance[a][b] * axis[b];
+
+		length = 0.0f;
+		for (int c = 0; c < N; c++)
+			length += next[c] * next[c];
+		length = sqrtf(length);
+		if (length < 1e-6f)
+			return false;
+		for (int c = 0; c < N; c++)
+			axis[c] = next[c] / length;
+	}
+	return true;
+}
+
+/* ---------------------------------------------------------------------------
+   BC1
+   --------------------------------------------------------------------------- */
+
+static void BuildPaletteBC1(uint16_t c0, uint16_t c1, int palette[4][3])
+{
+	Unpack565(c0, palette[0]);
+	Unpack565(c1, palette[1]);
+	for (int c = 0; c < 3; c++)
+	{
+		palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+	}
+}
+
+/* nearest palette entry for every pixel, returns the packed 2 bit indices */
+static uint32_t FitIndicesBC1(const unsigned char* block, const int palette[4][3], int& error)
+{
+	uint32_t indices = 0;
+	error = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		const unsigned char* pixel = block + i * 4;
+		int best = 0, bestError = INT32_MAX;
+		for (int p = 0; p < 4; p++)
+		{
+			int dr = pixel[0] - palette[p][0], dg = pixel[1] - palette[p][1], db = pixel[2] - palette[p][2];
+			int e = dr * dr + dg * dg + db * db;
+			if (e < bestError)
+			{
+				bestError = e;
+				best = p;
+			}
+		}
+		indices |= (uint32_t)best << (i * 2);
+		error += bestError;
+	}
+	return indices;
+}
+
+static inline void WriteBC1(unsigned char* out, uint16_t c0, uint16_t c1, uint32_t indices)
+{
+	out[0] = (unsigned char)(c0 & 0xFF); out[1] = (unsigned char)(c0 >> 8);
+	out[2] = (unsigned char)(c1 & 0xFF); out[3] = (unsigned char)(c1 >> 8);
+	out[4] = (unsigned char)(indices); out[5] = (unsigned char)(indices >> 8);
+	out[6] = (unsigned char)(indices >> 16); out[7] = (unsigned char)(indices >> 24);
+}
+
+/* puts the endpoints in 4 color order (c0 > c1)
+	~ returns false for a flat block, which is written with all indices 0 */
+static bool OrderEndpointsBC1(uint16_t& c0, uint16_t& c1)
+{
+	if (c0 < c1)
+	{
+		uint16_t swap = c0;
+		c0 = c1;
+		c1 = swap;
+	}
+	return c0 != c1;
+}
+
+/* 0..3 position along c1 -> c0 to BC1 index (0 = c0, 1 = c1, 2 = 2/3 c0, 3 = 1/3 c0) */
+static const uint32_t s_LinearToBC1[4] = { 1, 3, 2, 0 };
+
+#ifdef BLOCK_COMPRESSION_SSE2
+
+/* bounding box + projection, 16 pixels at once */
+static void EncodeColorFast(const unsigned char* block, unsigned char* out)
+{
+	__m128i rows[4];
+	for (int i = 0; i < 4; i++)
+		rows[i] = _mm_loadu_si128((const __m128i*)(block + i * 16));
+
+	__m128i low = _mm_min_epu8(_mm_min_epu8(rows[0], rows[1]), _mm_min_epu8(rows[2], rows[3]));
+	__m128i high = _mm_max_epu8(_mm_max_epu8(rows[0], rows[1]), _mm_max_epu8(rows[2], rows[3]));
+	low = _mm_min_epu8(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(1, 0, 3, 2)));
+	low = _mm_min_epu8(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(2, 3, 0, 1)));
+	high = _mm_max_epu8(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(1, 0, 3, 2)));
+	high = _mm_max_epu8(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(2, 3, 0, 1)));
+
+	uint32_t lowBits = (uint32_t)_mm_cvtsi128_si32(low);
+	uint32_t highBits = (uint32_t)_mm_cvtsi128_si32(high);
+	int minColor[3], maxColor[3];
+	for (int c = 0; c < 3; c++)
+	{
+		minColor[c] = (lowBits >> (c * 8)) & 0xFF;
+		maxColor[c] = (highBits >> (c * 8)) & 0xFF;
+		/* pull the box in by 1/16 of its size, the extremes are rarely hit exactly */
+		int inset = (maxColor[c] - minColor[c]) >> 4;
+		minColor[c] += inset;
+		maxColor[c] -= inset;
+	}
+
+	uint16_t c0 = Pack565(maxColor[0], maxColor[1], maxColor[2]);
+	uint16_t c1 = Pack565(minColor[0], minColor[1], minColor[2]);
+	if (!OrderEndpointsBC1(c0, c1))
+	{
+		WriteBC1(out, c0, c1, 0);
+		return;
+	}
+
+	int p0[3], p1[3];
+	Unpack565(c0, p0);
+	Unpack565(c1, p1);
+	int axis[3] = { p0[0] - p1[0], p0[1] - p1[1], p0[2] - p1[2] };
+	int lengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i base = _mm_setr_epi16((short)p1[0], (short)p1[1], (short)p1[2], 0, (short)p1[0], (short)p1[1], (short)p1[2], 0);
+	const __m128i direction = _mm_setr_epi16((short)axis[0], (short)axis[1], (short)axis[2], 0, (short)axis[0], (short)axis[1], (short)axis[2], 0);
+	const __m128 scale = _mm_set1_ps(3.0f / lengthSquared);
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	int16_t steps[16];
+	for (int i = 0; i < 4; i++)
+	{
+		/* dot(pixel - c1, c0 - c1) for 4 pixels */
+		__m128i lo = _mm_madd_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(rows[i], zero), base), direction);
+		__m128i hi = _mm_madd_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(rows[i], zero), base), direction);
+		__m128 even = _mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 odd = _mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(3, 1, 3, 1));
+		__m128i dot = _mm_add_epi32(_mm_castps_si128(even), _mm_castps_si128(odd));
+
+		__m128i step = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(dot), scale), half));
+		step = _mm_packs_epi32(step, step);
+		step = _mm_min_epi16(_mm_max_epi16(step, zero), _mm_set1_epi16(3));
+		_mm_storel_epi64((__m128i*)(steps + i * 4), step);
+	}
+
+	uint32_t indices = 0;
+	for (int i = 0; i < 16; i++)
+		indices |= s_LinearToBC1[steps[i]] << (i * 2);
+	WriteBC1(out, c0, c1, indices);
+}
+
+#else
+
+static void EncodeColorFast(const unsigned char* block, unsigned char* out)
+{
+	int minColor[3] = { 255, 255, 255 }, maxColor[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			int value = block[i * 4 + c];
+			minColor[c] = value < minColor[c] ? value : minColor[c];
+			maxColor[c] = value > maxColor[c] ? value : maxColor[c];
+		}
+	}
+	for (int c = 0; c < 3; c++)
+	{
+		int inset = (maxColor[c] - minColor[c]) >> 4;
+		minColor[c] += inset;
+		maxColor[c] -= inset;
+	}
+
+	uint16_t c0 = Pack565(maxColor[0], maxColor[1], maxColor[2]);
+	uint16_t c1 = Pack565(minColor[0], minColor[1], minColor[2]);
+	if (!OrderEndpointsBC1(c0, c1))
+	{
+		WriteBC1(out, c0, c1, 0);
+		return;
+	}
+
+	int p0[3], p1[3];
+	Unpack565(c0, p0);
+	Unpack565(c1, p1);
+	int axis[3] = { p0[0] - p1[0], p0[1] - p1[1], p0[2] - p1[2] };
+	float scale = 3.0f / (axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+
+	uint32_t indices = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		const unsigned char* pixel = block + i * 4;
+		int dot = (pixel[0] - p1[0]) * axis[0] + (pixel[1] - p1[1]) * axis[1] + (pixel[2] - p1[2]) * axis[2];
+		int step = Clamp((int)(dot * scale + 0.5f), 0, 3);
+		indices |= s_LinearToBC1[step] << (i * 2);
+	}
+	WriteBC1(out, c0, c1, indices);
+}
+
+#endif
+
+static void EncodeColorQuality(const unsigned char* block, unsigned char* out)
+{
+	float points[16 * 3];
+	for (int i = 0; i < 16; i++)
+		for (int c = 0; c < 3; c++)
+			points[i * 3 + c] = block[i * 4 + c];
+
+	float mean[3], axis[3];
+	if (!PrincipalAxis<3>(points, 16, mean, axis))
+	{
+		/* flat block */
+		uint16_t color = Pack565(RoundToInt(mean[0]), RoundToInt(mean[1]), RoundToInt(mean[2]));
+		WriteBC1(out, color, color, 0);
+		return;
+	}
+
+	float low = 1e9f, high = -1e9f;
+	for (int i = 0; i < 16; i++)
+	{
+		float t = 0.0f;
+		for (int c = 0; c < 3; c++)
+			t += (points[i * 3 + c] - mean[c]) * axis[c];
+		low = t < low ? t : low;
+		high = t > high ? t : high;
+	}
+
+	uint16_t c0 = Pack565(RoundToInt(mean[0] + axis[0] * high), RoundToInt(mean[1] + axis[1] * high), RoundToInt(mean[2] + axis[2] * high));
+	uint16_t c1 = Pack565(RoundToInt(mean[0] + axis[0] * low), RoundToInt(mean[1] + axis[1] * low), RoundToInt(mean[2] + axis[2] * low));
+	if (!OrderEndpointsBC1(c0, c1))
+	{
+		WriteBC1(out, c0, c1, 0);
+		return;
+	}
+
+	int palette[4][3];
+	int error;
+	BuildPaletteBC1(c0, c1, palette);
+	uint32_t indices = FitIndicesBC1(block, palette, error);
+
+	/* least squares endpoints for the chosen indices:
+	   minimize sum |a_i * c0 + b_i * c1 - p_i|^2 */
+	static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+	float aa = 0.0f, ab = 0.0f, bb = 0.0f, ap[3] = {}, bp[3] = {};
+	for (int i = 0; i < 16; i++)
+	{
+		float a = weights[(indices >> (i * 2)) & 3], b = 1.0f - a;
+		aa += a * a; ab += a * b; bb += b * b;
+		for (int c = 0; c < 3; c++)
+		{
+			ap[c] += a * points[i * 3 + c];
+			bp[c] += b * points[i * 3 + c];
+		}
+	}
+	float determinant = aa * bb - ab * ab;
+	if (fabsf(determinant) > 1e-6f)
+	{
+		int e0[3], e1[3];
+		for (int c = 0; c < 3; c++)
+		{
+			e0[c] = RoundToInt((ap[c] * bb - bp[c] * ab) / determinant);
+			e1[c] = RoundToInt((bp[c] * aa - ap[c] * ab) / determinant);
+		}
+		uint16_t r0 = Pack565(e0[0], e0[1], e0[2]);
+		uint16_t r1 = Pack565(e1[0], e1[1], e1[2]);
+		if (OrderEndpointsBC1(r0, r1))
+		{
+			int refinedPalette[4][3];
+			int refinedError;
+			BuildPaletteBC1(r0, r1, refinedPalette);
+			uint32_t refinedIndices = FitIndicesBC1(block, refinedPalette, refinedError);
+			if (refinedError < error)
+			{
+				c0 = r0;
+				c1 = r1;
+				indices = refinedIndices;
+			}
+		}
+	}
+
+	WriteBC1(out, c0, c1, indices);
+}
+
+void BlockCompressor::EncodeBC1(const unsigned char* block, unsigned char* out, CompressionQuality quality)
+{
+	/* always 4 color mode, alpha is dropped */
+	if (quality == CompressionQuality::FAST)
+		EncodeColorFast(block, out);
+	else
+		EncodeColorQuality(block, out);
+}
+
+/* ---------------------------------------------------------------------------
+   BC3
+   --------------------------------------------------------------------------- */
+
+/* 0..7 position along a1 -> a0 to BC4 index (0 = a0, 1 = a1, 2..7 = 6/7 a0 .. 1/7 a0) */
+static const uint64_t s_LinearToBC4[8] = { 1, 7, 6, 5, 4, 3, 2, 0 };
+
+static void EncodeAlpha(const unsigned char* block, unsigned char* out)
+{
+	int low = 255, high = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		int alpha = block[i * 4 + 3];
+		low = alpha < low ? alpha : low;
+		high = alpha > high ? alpha : high;
+	}
+
+	out[0] = (unsigned char)high;
+	out[1] = (unsigned char)low;
+	uint64_t indices = 0;
+	if (high > low)
+	{
+		/* 8 value mode (a0 > a1), values are evenly spaced so rounding the
+		   position is the nearest one */
+		int range = high - low;
+		for (int i = 0; i < 16; i++)
+		{
+			int step = ((block[i * 4 + 3] - low) * 7 + range / 2) / range;
+			indices |= s_LinearToBC4[step] << (i * 3);
+		}
+	}
+	for (int i = 0; i < 6; i++)
+		out[2 + i] = (unsigned char)(indices >> (i * 8));
+}
+
+void BlockCompressor::EncodeBC3(const unsigned char* block, unsigned char* out, CompressionQuality quality)
+{
+	EncodeAlpha(block, out);
+	EncodeBC1(block, out + 8, quality);
+}
+
+/* ---------------------------------------------------------------------------
+   BC7 (mode 6)
+   --------------------------------------------------------------------------- */
+
+static const int s_WeightsBC7[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct EndpointBC7
+{
+	int color[4];	/* 7 bits per channel */
+	int pbit;
+
+	inline int Expand(int channel) const { return (color[channel] << 1) | pbit; }
+};
+
+/* quantizes an RGBA endpoint to 7 bits + shared p-bit, picking the p-bit
+   that lands closest */
+static EndpointBC7 QuantizeBC7(const float value[4])
+{
+	EndpointBC7 best = {};
+	float bestError = 1e30f;
+	for (int pbit = 0; pbit < 2; pbit++)
+	{
+		EndpointBC7 candidate;
+		candidate.pbit = pbit;
+		float error = 0.0f;
+		for (int c = 0; c < 4; c++)
+		{
+			candidate.color[c] = Clamp(RoundToInt((value[c] - pbit) * 0.5f), 0, 127);
+			float d = candidate.Expand(c) - value[c];
+			error += d * d;
+		}
+		if (error < bestError)
+		{
+			bestError = error;
+			best = candidate;
+		}
+	}
+	return best;
+}
+
+static void BuildPaletteBC7(const EndpointBC7& e0, const EndpointBC7& e1, int palette[16][4])
+{
+	for (int i = 0; i < 16; i++)
+		for (int c = 0; c < 4; c++)
+			palette[i][c] = ((64 - s_WeightsBC7[i]) * e0.Expand(c) + s_WeightsBC7[i] * e1.Expand(c) + 32) >> 6;
+}
+
+static int FitIndicesBC7(const unsigned char* block, const int palette[16][4], int indices[16])
+{
+	int total = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		const unsigned char* pixel = block + i * 4;
+		int best = 0, bestError = INT32_MAX;
+		for (int p = 0; p < 16; p++)
+		{
+			int error = 0;
+			for (int c = 0; c < 4; c++)
+			{
+				int d = pixel[c] - palette[p][c];
+				error += d * d;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				best = p;
+			}
+		}
+		indices[i] = best;
+		total += bestError;
+	}
+	return total;
+}
+
+/* projected indices, the weights are round(64 * i / 15) so this is nearly exact */
+static int ProjectIndicesBC7(const unsigned char* block, const int palette[16][4], int indices[16])
+{
+	int axis[4], lengthSquared = 0;
+	for (int c = 0; c < 4; c++)
+	{
+		axis[c] = palette[15][c] - palette[0][c];
+		lengthSquared += axis[c] * axis[c];
+	}
+
+	int total = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		const unsigned char* pixel = block + i * 4;
+		int dot = 0;
+		for (int c = 0; c < 4; c++)
+			dot += (pixel[c] - palette[0][c]) * axis[c];
+		indices[i] = lengthSquared > 0 ? Clamp((dot * 15 + lengthSquared / 2) / lengthSquared, 0, 15) : 0;
+		for (int c = 0; c < 4; c++)
+		{
+			int d = pixel[c] - palette[indices[i]][c];
+			total += d * d;
+		}
+	}
+	return total;
+}
+
+class BitWriter
+{
+private:
+	unsigned char* m_Out;
+	unsigned int m_Position;
+public:
+	BitWriter(unsigned char* out)
+		: m_Out(out), m_Position(0)
+	{
+		memset(m_Out, 0, 16);
+	}
+
+	void Write(unsigned int value, unsigned int bits)
+	{
+		for (unsigned int i = 0; i < bits; i++, m_Position++)
+		{
+			if (value & (1u << i))
+				m_Out[m_Position >> 3] |= (unsigned char)(1u << (m_Position & 7));
+		}
+	}
+};
+
+static void WriteBC7Mode6(unsigned char* out, EndpointBC7 e0, EndpointBC7 e1, int indices[16])
+{
+	/* the first index is stored with 3 bits, its top bit has to be 0 */
+	if (indices[0] & 8)
+	{
+		EndpointBC7 swap = e0;
+		e0 = e1;
+		e1 = swap;
+		for (int i = 0; i < 16; i++)
+			indices[i] = 15 - indices[i];
+	}
+
+	BitWriter writer(out);
+	writer.Write(1 << 6, 7);	/* mode 6 */
+	for (int c = 0; c < 4; c++)
+	{
+		writer.Write(e0.color[c], 7);
+		writer.Write(e1.color[c], 7);
+	}
+	writer.Write(e0.pbit, 1);
+	writer.Write(e1.pbit, 1);
+	writer.Write(indices[0], 3);
+	for (int i = 1; i < 16; i++)
+		writer.Write(indices[i], 4);
+}
+
+void BlockCompressor::EncodeBC7(const unsigned char* block, unsigned char* out, CompressionQuality quality)
+{
+	float start[4], end[4];
+	if (quality == CompressionQuality::FAST)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			start[c] = 255.0f;
+			end[c] = 0.0f;
+		}
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				float value = block[i * 4 + c];
+				start[c] = value < start[c] ? value : start[c];
+				end[c] = value > end[c] ? value : end[c];
+			}
+		}
+	}
+	else
+	{
+		float points[16 * 4];
+		for (int i = 0; i < 64; i++)
+			points[i] = block[i];
+
+		float mean[4], axis[4];
+		if (!PrincipalAxis<4>(points, 16, mean, axis))
+		{
+			for (int c = 0; c < 4; c++)
+				start[c] = end[c] = mean[c];
+		}
+		else
+		{
+			float low = 1e9f, high = -1e9f;
+			for (int i = 0; i < 16; i++)
+			{
+				float t = 0.0f;
+				for (int c = 0; c < 4; c++)
+					t += (points[i * 4 + c] - mean[c]) * axis[c];
+				low = t < low ? t : low;
+				high = t > high ? t : high;
+			}
+			for (int c = 0; c < 4; c++)
+			{
+				start[c] = mean[c] + axis[c] * low;
+				end[c] = mean[c] + axis[c] * high;
+			}
+		}
+	}
+
+	EndpointBC7 e0 = QuantizeBC7(start), e1 = QuantizeBC7(end);
+	int palette[16][4];
+	int indices[16];
+	BuildPaletteBC7(e0, e1, palette);
+
+	if (quality == CompressionQuality::FAST)
+	{
+		ProjectIndicesBC7(block, palette, indices);
+		WriteBC7Mode6(out, e0, e1, indices);
+		return;
+	}
+
+	int error = FitIndicesBC7(block, palette, indices);
+
+	/* least squares refinement, same as BC1 with 16 weights */
+	float aa = 0.0f, ab = 0.0f, bb = 0.0f, ap[4] = {}, bp[4] = {};
+	for (int i = 0; i < 16; i++)
+	{
+		float b = s_WeightsBC7[indices[i]] / 64.0f, a = 1.0f - b;
+		aa += a * a; ab += a * b; bb += b * b;
+		for (int c = 0; c < 4; c++)
+		{
+			ap[c] += a * block[i * 4 + c];
+			bp[c] += b * block[i * 4 + c];
+		}
+	}
+	float determinant = aa * bb - ab * ab;
+	if (fabsf(determinant) > 1e-6f)
+	{
+		float refinedStart[4], refinedEnd[4];
+		for (int c = 0; c < 4; c++)
+		{
+			refinedStart[c] = (ap[c] * bb - bp[c] * ab) / determinant;
+			refinedEnd[c] = (bp[c] * aa - ap[c] * ab) / determinant;
+		}
+		EndpointBC7 r0 = QuantizeBC7(refinedStart), r1 = QuantizeBC7(refinedEnd);
+		int refinedPalette[16][4];
+		int refinedIndices[16];
+		BuildPaletteBC7(r0, r1, refinedPalette);
+		int refinedError = FitIndicesBC7(block, refinedPalette, refinedIndices);
+		if (refinedError < error)
+		{
+			e0 = r0;
+			e1 = r1;
+			memcpy(indices, refinedIndices, sizeof(indices));
+		}
+	}
+
+	WriteBC7Mode6(out, e0, e1, indices);
+}
+
+/* ---------------------------------------------------------------------------
+   images
+   --------------------------------------------------------------------------- */
+
+unsigned int BlockCompressor::GetBlockSize(BlockFormat format)
+{
+	return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+size_t BlockCompressor::GetCompressedSize(BlockFormat format, unsigned int width, unsigned int height)
+{
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+}
+
+unsigned int BlockCompressor::GetGLFormat(BlockFormat format)
+{
+	switch (format)
+	{
+		case BlockFormat::BC1:	return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		case BlockFormat::BC3:	return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case BlockFormat::BC7:	return GL_COMPRESSED_RGBA_BPTC_UNORM;
+	}
+	ASSERT(false);
+	return 0;
+}
+
+void BlockCompressor::Compress(BlockFormat format, const unsigned char* rgba, unsigned int width, unsigned int height,
+	unsigned char* out, CompressionQuality quality)
+{
+	unsigned int blockSize = GetBlockSize(format);
+	unsigned char block[64];
+
+	for (unsigned int by = 0; by < height; by += 4)
+	{
+		for (unsigned int bx = 0; bx < width; bx += 4)
+		{
+			/* gather the 4x4 block, repeating the last row/column past the edge */
+			for (unsigned int y = 0; y < 4; y++)
+			{
+				unsigned int sy = by + y < height ? by + y : height - 1;
+				for (unsigned int x = 0; x < 4; x++)
+				{
+					unsigned int sx = bx + x < width ? bx + x : width - 1;
+					memcpy(block + (y * 4 + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+				}
+			}
+
+			switch (format)
+			{
+				case BlockFormat::BC1:	EncodeBC1(block, out, quality); break;
+				case BlockFormat::BC3:	EncodeBC3(block, out, quality); break;
+				case BlockFormat::BC7:	EncodeBC7(block, out, quality); break;
+			}
+			out += blockSize;
+		}
+	}
+}
+
+void BlockCompressor::Downsample(const unsigned char* rgba, unsigned int width, unsigned int height,
+	std::vector<unsigned char>& out)
+{
+	unsigned int outWidth = width > 1 ? width / 2 : 1;
+	unsigned int outHeight = height > 1 ? height / 2 : 1;
+	out.resize((size_t)outWidth * outHeight * 4);
+
+	for (unsigned int y = 0; y < outHeight; y++)
+	{
+		unsigned int y0 = y * 2 < height ? y * 2 : height - 1;
+		unsigned int y1 = y * 2 + 1 < height ? y * 2 + 1 : height - 1;
+		for (unsigned int x = 0; x < outWidth; x++)
+		{
+			unsigned int x0 = x * 2 < width ? x * 2 : width - 1;
+			unsigned int x1 = x * 2 + 1 < width ? x * 2 + 1 : width - 1;
+			for (unsigned int c = 0; c < 4; c++)
+			{
+				unsigned int sum = rgba[((size_t)y0 * width + x0) * 4 + c] + rgba[((size_t)y0 * width + x1) * 4 + c]
+					+ rgba[((size_t)y1 * width + x0) * 4 + c] + rgba[((size_t)y1 * width + x1) * 4 + c];
+				out[((size_t)y * outWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+			}
+		}
+	}
+}
@@ -0,0 +1,257 @@
+#include "BufferAllocator.h"
+
+#include "renderer.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static inline unsigned int HighestBit(unsigned int value)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse(&index, value);
+	return (unsigned int)index;
+#else
+	return 31 - (unsigned int)__builtin_clz(value);
+#endif
+}
+
+static inline unsigned int LowestBit(unsigned int value)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return (unsigned int)index;
+#else
+	return (unsigned int)__builtin_ctz(value);
+#endif
+}
+
+/* first level: power of two range of the size, second level: which of the
+   8 equal slices of that range, sizes under 8 all go to first level 0 */
+static inline void Mapping(unsigned int size, unsigned int secondLevelBits, unsigned int& firstLevel, unsigned int& secondLevel)
+{
+	if (size < (1u << secondLevelBits))
+	{
+		firstLevel = 0;
+		secondLevel = size;
+		return;
+	}
+	unsigned int high = HighestBit(size);
+	secondLevel = (size >> (high - secondLevelBits)) & ((1u << secondLevelBits) - 1);
+	firstLevel = high - secondLevelBits + 1;
+}
+
+BufferAllocator::BufferAllocator(unsigned int capacity)
+	: m_Capacity(capacity)
+{
+	Reset();
+}
+
+void BufferAllocator::Reset()
+{
+	m_Blocks.clear();
+	m_UnusedBlocks.clear();
+	m_FirstLevelBitmap = 0;
+	for (unsigned int i = 0; i < FIRST_LEVEL_COUNT; i++)
+	{
+		m_SecondLevelBitmaps[i] = 0;
+		for (unsigned int j = 0; j < SECOND_LEVEL_COUNT; j++)
+			m_FreeLists[i][j] = NONE;
+	}
+	m_Used = 0;
+	m_AllocationCount = 0;
+	m_FreeBlockCount = 0;
+
+	if (m_Capacity == 0)
+		return;
+	unsigned int block = NewBlock();
+	m_Blocks[block] = { 0, m_Capacity, NONE, NONE, NONE, NONE, true };
+	InsertFree(block);
+}
+
+unsigned int BufferAllocator::NewBlock()
+{
+	if (!m_UnusedBlocks.empty())
+	{
+		unsigned int block = m_UnusedBlocks.back();
+		m_UnusedBlocks.pop_back();
+		return block;
+	}
+	m_Blocks.push_back(Block());
+	return (unsigned int)m_Blocks.size() - 1;
+}
+
+void BufferAllocator::InsertFree(unsigned int block)
+{
+	unsigned int firstLevel, secondLevel;
+	Mapping(m_Blocks[block].size, SECOND_LEVEL_BITS, firstLevel, secondLevel);
+
+	Block& b = m_Blocks[block];
+	unsigned int head = m_FreeLists[firstLevel][secondLevel];
+	b.free = true;
+	b.previousFree = NONE;
+	b.nextFree = head;
+	if (head != NONE)
+		m_Blocks[head].previousFree = block;
+	m_FreeLists[firstLevel][secondLevel] = block;
+
+	m_FirstLevelBitmap |= 1u << firstLevel;
+	m_SecondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+	m_FreeBlockCount++;
+}
+
+void BufferAllocator::RemoveFree(unsigned int block)
+{
+	unsigned int firstLevel, secondLevel;
+	Mapping(m_Blocks[block].size, SECOND_LEVEL_BITS, firstLevel, secondLevel);
+
+	Block& b = m_Blocks[block];
+	if (b.previousFree != NONE)
+		m_Blocks[b.previousFree].nextFree = b.nextFree;
+	else
+		m_FreeLists[firstLevel][secondLevel] = b.nextFree;
+	if (b.nextFree != NONE)
+		m_Blocks[b.nextFree].previousFree = b.previousFree;
+	b.free = false;
+
+	if (m_FreeLists[firstLevel][secondLevel] == NONE)
+	{
+		m_SecondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+		if (m_SecondLevelBitmaps[firstLevel] == 0)
+			m_FirstLevelBitmap &= ~(1u << firstLevel);
+	}
+	m_FreeBlockCount--;
+}
+
+bool BufferAllocator::Allocate(unsigned int size, BufferAllocation& allocation)
+{
+	if (size == 0)
+		size = 1;
+
+	if (size > m_Capacity)
+		return false;
+
+	/* round up to the start of the next size class, then every block in
+	   the class we land in is big enough: no list has to be searched */
+	unsigned long long rounded = size;
+	if (size >= SECOND_LEVEL_COUNT)
+		rounded += (1ull << (HighestBit(size) - SECOND_LEVEL_BITS)) - 1;
+
+	unsigned int block = NONE;
+	unsigned int firstLevel, secondLevel;
+	if (rounded <= m_Capacity)
+	{
+		Mapping((unsigned int)rounded, SECOND_LEVEL_BITS, firstLevel, secondLevel);
+
+		unsigned int secondLevelMap = m_SecondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+		if (secondLevelMap == 0)
+		{
+			unsigned int firstLevelMap = firstLevel + 1 < 32 ? m_FirstLevelBitmap & (~0u << (firstLevel + 1)) : 0;
+			if (firstLevelMap != 0)
+			{
+				firstLevel = LowestBit(firstLevelMap);
+				secondLevelMap = m_SecondLevelBitmaps[firstLevel];
+			}
+		}
+		if (secondLevelMap != 0)
+			block = m_FreeLists[firstLevel][LowestBit(secondLevelMap)];
+	}
+
+	/* no class that surely fits has a block, but the request's own class
+	   may still hold one big enough (a fresh allocator's single block is
+	   in the capacity's class): walk that one list */
+	if (block == NONE)
+	{
+		Mapping(size, SECOND_LEVEL_BITS, firstLevel, secondLevel);
+		for (unsigned int candidate = m_FreeLists[firstLevel][secondLevel]; candidate != NONE; candidate = m_Blocks[candidate].nextFree)
+		{
+			if (m_Blocks[candidate].size >= size)
+			{
+				block = candidate;
+				break;
+			}
+		}
+		if (block == NONE)
+			return false;
+	}
+	RemoveFree(block);
+
+	/* the rest of the block goes back as a free block of its own */
+	if (m_Blocks[block].size > size)
+	{
+		unsigned int rest = NewBlock();
+		Block& b = m_Blocks[block];
+		m_Blocks[rest] = { b.offset + size, b.size - size, block, b.next, NONE, NONE, true };
+		if (b.next != NONE)
+			m_Blocks[b.next].previous = rest;
+		b.next = rest;
+		b.size = size;
+		InsertFree(rest);
+	}
+
+	m_Used += size;
+	m_AllocationCount++;
+	allocation.offset = m_Blocks[block].offset;
+	allocation.size = size;
+	allocation.block = block;
+	return true;
+}
+
+void BufferAllocator::Free(const BufferAllocation& allocation)
+{
+	unsigned int block = allocation.block;
+	ASSERT(block < m_Blocks.size() && !m_Blocks[block].free && m_Blocks[block].offset == allocation.offset);
+
+	m_Used -= m_Blocks[block].size;
+	m_AllocationCount--;
+
+	unsigned int previous = m_Blocks[block].previous;
+	if (previous != NONE && m_Blocks[previous].free)
+	{
+		RemoveFree(previous);
+		m_Blocks[previous].size += m_Blocks[block].size;
+		m_Blocks[previous].next = m_Blocks[block].next;
+		if (m_Blocks[block].next != NONE)
+			m_Blocks[m_Blocks[block].next].previous = previous;
+		m_UnusedBlocks.push_back(block);
+		block = previous;
+	}
+
+	unsigned int next = m_Blocks[block].next;
+	if (next != NONE && m_Blocks[next].free)
+	{
+		RemoveFree(next);
+		m_Blocks[block].size += m_Blocks[next].size;
+		m_Blocks[block].next = m_Blocks[next].next;
+		if (m_Blocks[next].next != NONE)
+			m_Blocks[m_Blocks[next].next].previous = block;
+		m_UnusedBlocks.push_back(next);
+	}
+
+	InsertFree(block);
+}
+
+BufferAllocatorStats BufferAllocator::GetStats() const
+{
+	BufferAllocatorStats stats;
+	stats.capacity = m_Capacity;
+	stats.used = m_Used;
+	stats.allocations = m_AllocationCount;
+	stats.freeBlocks = m_FreeBlockCount;
+	stats.largestFree = 0;
+
+	/* the biggest block is somewhere in the highest non empty class */
+	if (m_FirstLevelBitmap)
+	{
+		unsigned int firstLevel = HighestBit(m_FirstLevelBitmap);
+		unsigned int secondLevel = HighestBit(m_SecondLevelBitmaps[firstLevel]);
+		for (unsigned int block = m_FreeLists[firstLevel][secondLevel]; block != NONE; block = m_Blocks[block].nextFree)
+			stats.largestFree = m_Blocks[block].size > stats.largestFree ? m_Blocks[block].size : stats.largestFree;
+	}
+
+	unsigned int free = m_Capacity - m_Used;
+	stats.fragmentation = free > 0 ? 1.0f - (float)stats.largestFree / free : 0.0f;
+	return stats;
+}
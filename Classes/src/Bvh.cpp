@@ -0,0 +1,463 @@
+#include "Bvh.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <float.h>
+#include <thread>
+
+#include "Culling.h"
+
+#define BVH_BINS 16
+#define BVH_MAX_LEAF_SIZE 8
+/* below this many objects a subtree isn't worth its own thread */
+#define BVH_PARALLEL_THRESHOLD 4096
+/* past this depth splits fall back to the median, which keeps the tree
+   (and the traversal stacks) shallow even for badly clustered scenes */
+#define BVH_MEDIAN_DEPTH 48
+#define BVH_STACK_SIZE 128
+
+static void EmptyBox(float* min, float* max)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		min[i] = FLT_MAX;
+		max[i] = -FLT_MAX;
+	}
+}
+
+static void GrowBox(float* min, float* max, const float* otherMin, const float* otherMax)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		min[i] = std::min(min[i], otherMin[i]);
+		max[i] = std::max(max[i], otherMax[i]);
+	}
+}
+
+static float HalfArea(const float* min, const float* max)
+{
+	float x = max[0] - min[0], y = max[1] - min[1], z = max[2] - min[2];
+	if (x < 0.0f || y < 0.0f || z < 0.0f)
+		return 0.0f;
+	return x * y + y * z + z * x;
+}
+
+static inline float Centroid(const Aabb& box, int axis)
+{
+	return (box.min[axis] + box.max[axis]) * 0.5f;
+}
+
+/* shared by every thread of one build, the node array is allocated up
+   front (a tree of n leaves never needs more than 2n - 1 nodes) so
+   threads only have to agree on who gets which slots */
+struct BuildContext
+{
+	const Aabb* objects;
+	unsigned int* indices;
+	BvhNode* nodes;
+	std::atomic<unsigned int> nodeCount;
+};
+
+static void Subdivide(BuildContext& context, unsigned int nodeIndex, unsigned int first, unsigned int count,
+	unsigned int depth, unsigned int spawnDepth)
+{
+	BvhNode& node = context.nodes[nodeIndex];
+	unsigned int* indices = context.indices + first;
+
+	float centroidMin[3], centroidMax[3];
+	EmptyBox(node.min, node.max);
+	EmptyBox(centroidMin, centroidMax);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const Aabb& box = context.objects[indices[i]];
+		GrowBox(node.min, node.max, box.min, box.max);
+		float centroid[3] = { Centroid(box, 0), Centroid(box, 1), Centroid(box, 2) };
+		GrowBox(centroidMin, centroidMax, centroid, centroid);
+	}
+	node.leftFirst = first;
+	node.count = count;
+
+	if (count <= 2)
+		return;
+
+	/* binned SAH, cost of a split relative to the parent is
+	   1 (traversal) + (areaLeft * countLeft + areaRight * countRight) / area */
+	int bestAxis = -1;
+	unsigned int bestBin = 0;
+	float bestCost = FLT_MAX;
+	if (depth < BVH_MEDIAN_DEPTH)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float extent = centroidMax[axis] - centroidMin[axis];
+			if (extent <= 0.0f)
+				continue;
+			float scale = BVH_BINS / extent;
+
+			float binMin[BVH_BINS][3], binMax[BVH_BINS][3];
+			unsigned int binCount[BVH_BINS] = {};
+			for (int b = 0; b < BVH_BINS; b++)
+				EmptyBox(binMin[b], binMax[b]);
+			for (unsigned int i = 0; i < count; i++)
+			{
+				const Aabb& box = context.objects[indices[i]];
+				int b = std::min(BVH_BINS - 1, (int)((Centroid(box, axis) - centroidMin[axis]) * scale));
+				binCount[b]++;
+				GrowBox(binMin[b], binMax[b], box.min, box.max);
+			}
+
+			/* sweep from both sides, split b puts bins [0, b] on the left */
+			float leftArea[BVH_BINS - 1];
+			unsigned int leftCount[BVH_BINS - 1];
+			float sweepMin[3], sweepMax[3];
+			unsigned int sweepCount = 0;
+			EmptyBox(sweepMin, sweepMax);
+			for (int b = 0; b < BVH_BINS - 1; b++)
+			{
+				sweepCount += binCount[b];
+				GrowBox(sweepMin, sweepMax, binMin[b], binMax[b]);
+				leftCount[b] = sweepCount;
+				leftArea[b] = HalfArea(sweepMin, sweepMax);
+			}
+			sweepCount = 0;
+			EmptyBox(sweepMin, sweepMax);
+			for (int b = BVH_BINS - 1; b > 0; b--)
+			{
+				sweepCount += binCount[b];
+				GrowBox(sweepMin, sweepMax, binMin[b], binMax[b]);
+				if (leftCount[b - 1] == 0 || sweepCount == 0)
+					continue;
+				float cost = leftArea[b - 1] * leftCount[b - 1] + HalfArea(sweepMin, sweepMax) * sweepCount;
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestBin = b - 1;
+				}
+			}
+		}
+
+		float area = HalfArea(node.min, node.max);
+		float leafCost = (float)count;
+		float splitCost = area > 0.0f ? 1.0f + bestCost / area : FLT_MAX;
+		if (count <= BVH_MAX_LEAF_SIZE && (bestAxis < 0 || splitCost >= leafCost))
+			return;
+	}
+
+	unsigned int leftCount;
+	if (bestAxis >= 0)
+	{
+		float extent = centroidMax[bestAxis] - centroidMin[bestAxis];
+		float scale = BVH_BINS / extent;
+		float axisMin = centroidMin[bestAxis];
+		const Aabb* objects = context.objects;
+		unsigned int* middle = std::partition(indices, indices + count, [=](unsigned int index)
+		{
+			int b = std::min(BVH_BINS - 1, (int)((Centroid(objects[index], bestAxis) - axisMin) * scale));
+			return b <= (int)bestBin;
+		});
+		leftCount = (unsigned int)(middle - indices);
+	}
+	else
+	{
+		/* every centroid in the same spot (or too deep): split the range in half
+		   along the longest axis */
+		int axis = 0;
+		for (int i = 1; i < 3; i++)
+			if (centroidMax[i] - centroidMin[i] > centroidMax[axis] - centroidMin[axis])
+				axis = i;
+		leftCount = count / 2;
+		const Aabb* objects = context.objects;
+		std::nth_element(indices, indices + leftCount, indices + count, [=](unsigned int a, unsigned int b)
+		{
+			return Centroid(objects[a], axis) < Centroid(objects[b], axis);
+		});
+	}
+
+	unsigned int left = context.nodeCount.fetch_add(2);
+	node.leftFirst = left;
+	node.count = 0;
+
+	if (spawnDepth > 0 && count >= BVH_PARALLEL_THRESHOLD)
+	{
+		std::thread worker(Subdivide, std::ref(context), left, first, leftCount, depth + 1, spawnDepth - 1);
+		Subdivide(context, left + 1, first + leftCount, count - leftCount, depth + 1, spawnDepth - 1);
+		worker.join();
+	}
+	else
+	{
+		Subdivide(context, left, first, leftCount, depth + 1, 0);
+		Subdivide(context, left + 1, first + leftCount, count - leftCount, depth + 1, 0);
+	}
+}
+
+void Bvh::Build(const Aabb* bounds, unsigned int count, unsigned int threadCount)
+{
+	m_Objects.assign(bounds, bounds + count);
+	m_Indices.resize(count);
+	for (unsigned int i = 0; i < count; i++)
+		m_Indices[i] = i;
+	m_Nodes.clear();
+	if (count == 0)
+		return;
+
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	/* every level below the root doubles the threads */
+	unsigned int spawnDepth = 0;
+	while ((1u << spawnDepth) < threadCount)
+		spawnDepth++;
+
+	m_Nodes.resize(count * 2 - 1);
+	BuildContext context;
+	context.objects = m_Objects.data();
+	context.indices = m_Indices.data();
+	context.nodes = m_Nodes.data();
+	context.nodeCount = 1;
+	Subdivide(context, 0, 0, count, 0, spawnDepth);
+	m_Nodes.resize(context.nodeCount);
+}
+
+void Bvh::Build(const BoundsStore& bounds, unsigned int threadCount)
+{
+	std::vector<Aabb> boxes(bounds.GetCount());
+	for (unsigned int i = 0; i < bounds.GetCount(); i++)
+	{
+		float center[3] = { bounds.GetCenterX()[i], bounds.GetCenterY()[i], bounds.GetCenterZ()[i] };
+		float extents[3] = { bounds.GetExtentX()[i], bounds.GetExtentY()[i], bounds.GetExtentZ()[i] };
+		for (int axis = 0; axis < 3; axis++)
+		{
+			boxes[i].min[axis] = center[axis] - extents[axis];
+			boxes[i].max[axis] = center[axis] + extents[axis];
+		}
+	}
+	Build(boxes.data(), (unsigned int)boxes.size(), threadCount);
+}
+
+void Bvh::UpdateObject(unsigned int index, const Aabb& bounds)
+{
+	m_Objects[index] = bounds;
+}
+
+void Bvh::Refit()
+{
+	/* children are always allocated after their parent, so walking the
+	   array backwards visits every child before the node that owns it */
+	for (size_t i = m_Nodes.size(); i-- > 0;)
+	{
+		BvhNode& node = m_Nodes[i];
+		EmptyBox(node.min, node.max);
+		if (node.count > 0)
+		{
+			for (unsigned int j = 0; j < node.count; j++)
+			{
+				const Aabb& box = m_Objects[m_Indices[node.leftFirst + j]];
+				GrowBox(node.min, node.max, box.min, box.max);
+			}
+		}
+		else
+		{
+			const BvhNode& left = m_Nodes[node.leftFirst];
+			const BvhNode& right = m_Nodes[node.leftFirst + 1];
+			GrowBox(node.min, node.max, left.min, left.max);
+			GrowBox(node.min, node.max, right.min, right.max);
+		}
+	}
+}
+
+/* 0 outside, 1 intersecting, 2 inside every plane in the mask
+	~ planes a box is fully inside of are cleared from the mask, so children
+	  of that box don't test them again */
+static int ClassifyBox(const float* min, const float* max, const Frustum& frustum, unsigned int& planeMask)
+{
+	float center[3], extents[3];
+	for (int i = 0; i < 3; i++)
+	{
+		center[i] = (min[i] + max[i]) * 0.5f;
+		extents[i] = (max[i] - min[i]) * 0.5f;
+	}
+
+	for (unsigned int p = 0; p < 6; p++)
+	{
+		if (!(planeMask & (1u << p)))
+			continue;
+		const Plane& plane = frustum.GetPlane(p);
+		float distance = plane.a * center[0] + plane.b * center[1] + plane.c * center[2] + plane.d;
+		float radius = fabsf(plane.a) * extents[0] + fabsf(plane.b) * extents[1] + fabsf(plane.c) * extents[2];
+		if (distance + radius < 0.0f)
+			return 0;
+		if (distance - radius >= 0.0f)
+			planeMask &= ~(1u << p);
+	}
+	return planeMask == 0 ? 2 : 1;
+}
+
+unsigned int Bvh::QueryFrustum(const Frustum& frustum, std::vector<unsigned int>& result) const
+{
+	result.clear();
+	if (m_Nodes.empty())
+		return 0;
+
+	unsigned int stack[BVH_STACK_SIZE];
+	unsigned int masks[BVH_STACK_SIZE];
+	unsigned int top = 0;
+	stack[top] = 0;
+	masks[top++] = 0x3F;
+
+	while (top > 0)
+	{
+		top--;
+		const BvhNode& node = m_Nodes[stack[top]];
+		unsigned int mask = masks[top];
+		if (mask != 0 && ClassifyBox(node.min, node.max, frustum, mask) == 0)
+			continue;
+
+		if (node.count > 0)
+		{
+			for (unsigned int i = 0; i < node.count; i++)
+			{
+				unsigned int object = m_Indices[node.leftFirst + i];
+				unsigned int objectMask = mask;
+				if (objectMask == 0 || ClassifyBox(m_Objects[object].min, m_Objects[object].max, frustum, objectMask) != 0)
+					result.push_back(object);
+			}
+			continue;
+		}
+
+		stack[top] = node.leftFirst;
+		masks[top++] = mask;
+		stack[top] = node.leftFirst + 1;
+		masks[top++] = mask;
+	}
+	return (unsigned int)result.size();
+}
+
+static inline bool Overlaps(const float* min, const float* max, const Aabb& region)
+{
+	return min[0] <= region.max[0] && max[0] >= region.min[0]
+		&& min[1] <= region.max[1] && max[1] >= region.min[1]
+		&& min[2] <= region.max[2] && max[2] >= region.min[2];
+}
+
+unsigned int Bvh::QueryRegion(const Aabb& region, std::vector<unsigned int>& result) const
+{
+	result.clear();
+	if (m_Nodes.empty())
+		return 0;
+
+	unsigned int stack[BVH_STACK_SIZE];
+	unsigned int top = 0;
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		const BvhNode& node = m_Nodes[stack[--top]];
+		if (!Overlaps(node.min, node.max, region))
+			continue;
+
+		if (node.count > 0)
+		{
+			for (unsigned int i = 0; i < node.count; i++)
+			{
+				unsigned int object = m_Indices[node.leftFirst + i];
+				if (Overlaps(m_Objects[object].min, m_Objects[object].max, region))
+					result.push_back(object);
+			}
+			continue;
+		}
+
+		stack[top++] = node.leftFirst;
+		stack[top++] = node.leftFirst + 1;
+	}
+	return (unsigned int)result.size();
+}
+
+/* slab test, distance where the ray enters the box or FLT_MAX on a miss */
+static inline float IntersectBox(const float* min, const float* max, const float* origin, const float* inverseDirection,
+	float maxDistance)
+{
+	float tMin = 0.0f, tMax = maxDistance;
+	for (int i = 0; i < 3; i++)
+	{
+		float t0 = (min[i] - origin[i]) * inverseDirection[i];
+		float t1 = (max[i] - origin[i]) * inverseDirection[i];
+		if (t0 > t1)
+			std::swap(t0, t1);
+		tMin = t0 > tMin ? t0 : tMin;
+		tMax = t1 < tMax ? t1 : tMax;
+	}
+	return tMin <= tMax ? tMin : FLT_MAX;
+}
+
+bool Bvh::Raycast(const Ray& ray, BvhHit& hit, float maxDistance) const
+{
+	if (m_Nodes.empty())
+		return false;
+
+	/* a zero component gives +-inf, which the slab test handles */
+	float inverseDirection[3];
+	for (int i = 0; i < 3; i++)
+		inverseDirection[i] = 1.0f / ray.direction[i];
+
+	bool found = false;
+	float closest = maxDistance;
+
+	/* entry distances are kept with the nodes, a node is dropped when it
+	   comes off the stack behind a hit found in the meantime */
+	unsigned int stack[BVH_STACK_SIZE];
+	float distances[BVH_STACK_SIZE];
+	unsigned int top = 0;
+	float rootDistance = IntersectBox(m_Nodes[0].min, m_Nodes[0].max, ray.origin, inverseDirection, closest);
+	if (rootDistance == FLT_MAX)
+		return false;
+	stack[top] = 0;
+	distances[top++] = rootDistance;
+
+	while (top > 0)
+	{
+		top--;
+		if (distances[top] > closest)
+			continue;
+		const BvhNode& node = m_Nodes[stack[top]];
+
+		if (node.count > 0)
+		{
+			for (unsigned int i = 0; i < node.count; i++)
+			{
+				unsigned int object = m_Indices[node.leftFirst + i];
+				float distance = IntersectBox(m_Objects[object].min, m_Objects[object].max, ray.origin, inverseDirection, closest);
+				if (distance != FLT_MAX && (!found || distance < closest))
+				{
+					closest = distance;
+					hit.object = object;
+					hit.distance = distance;
+					found = true;
+				}
+			}
+			continue;
+		}
+
+		/* nearer child on top of the stack, so the other one is usually
+		   skipped once something closer has been hit */
+		unsigned int first = node.leftFirst, second = node.leftFirst + 1;
+		float firstDistance = IntersectBox(m_Nodes[first].min, m_Nodes[first].max, ray.origin, inverseDirection, closest);
+		float secondDistance = IntersectBox(m_Nodes[second].min, m_Nodes[second].max, ray.origin, inverseDirection, closest);
+		if (secondDistance < firstDistance)
+		{
+			std::swap(first, second);
+			std::swap(firstDistance, secondDistance);
+		}
+		if (secondDistance != FLT_MAX)
+		{
+			stack[top] = second;
+			distances[top++] = secondDistance;
+		}
+		if (firstDistance != FLT_MAX)
+		{
+			stack[top] = first;
+			distances[top++] = firstDistance;
+		}
+	}
+	return found;
+}
@@ -0,0 +1,90 @@
+#include "CommandList.h"
+
+#include <algorithm>
+
+#include "JobSystem.h"
+
+#define RADIX_BUCKETS 256
+#define MAX_SORT_BLOCKS 32		/* the offsets live on the stack, 32 KB */
+#define MIN_SORT_BLOCK 4096		/* commands, smaller blocks aren't worth a job */
+
+void CommandList::Submit(const VertexArray& va, const IndexBuffer& ib, const Shader& shader)
+{
+	m_Commands.push_back(DrawCommand::Make(va, ib, shader));
+}
+
+void CommandList::Submit(const VertexArray& va, const IndexBuffer& ib, const PipelineState& pipeline)
+{
+	m_Commands.push_back(DrawCommand::Make(va, ib, pipeline));
+}
+
+DrawCommand* CommandList::Sort(DrawCommand* commands, DrawCommand* scratch, unsigned int count, JobSystem* jobs)
+{
+	if (count < 2)
+		return commands;
+
+	unsigned int blocks = 1;
+	if (jobs)
+	{
+		blocks = std::min(jobs->GetThreadCount() * 4, (count + MIN_SORT_BLOCK - 1) / MIN_SORT_BLOCK);
+		blocks = std::max(std::min(blocks, (unsigned int)MAX_SORT_BLOCKS), 1u);
+	}
+	unsigned int blockSize = (count + blocks - 1) / blocks;
+
+	/* bits that differ anywhere decide which passes are needed */
+	unsigned long long first = commands[0].key, differ = 0;
+	for (unsigned int i = 1; i < count; i++)
+		differ |= commands[i].key ^ first;
+
+	unsigned int offsets[MAX_SORT_BLOCKS * RADIX_BUCKETS];
+	DrawCommand* source = commands;
+	DrawCommand* target = scratch;
+	for (unsigned int shift = 0; shift < 64; shift += 8)
+	{
+		if (((differ >> shift) & 0xFF) == 0)
+			continue;
+
+		auto histogram = [&](unsigned int block)
+		{
+			unsigned int* counts = &offsets[block * RADIX_BUCKETS];
+			std::fill(counts, counts + RADIX_BUCKETS, 0);
+			unsigned int end = std::min(count, (block + 1) * blockSize);
+			for (unsigned int i = block * blockSize; i < end; i++)
+				counts[(source[i].key >> shift) & 0xFF]++;
+		};
+		auto scatter = [&](unsigned int block)
+		{
+			unsigned int* counts = &offsets[block * RADIX_BUCKETS];
+			unsigned int end = std::min(count, (block + 1) * blockSize);
+			for (unsigned int i = block * blockSize; i < end; i++)
+				target[counts[(source[i].key >> shift) & 0xFF]++] = source[i];
+		};
+
+		if (blocks > 1)
+			jobs->ParallelFor(blocks, 1, [&](unsigned int begin, unsigned int end) { for (unsigned int b = begin; b < end; b++) histogram(b); });
+		else
+			histogram(0);
+
+		/* bucket by bucket, block by block: block b's commands of a bucket
+		   land after the same bucket's commands of blocks before it, which
+		   keeps the sort stable */
+		unsigned int total = 0;
+		for (unsigned int bucket = 0; bucket < RADIX_BUCKETS; bucket++)
+		{
+			for (unsigned int block = 0; block < blocks; block++)
+			{
+				unsigned int n = offsets[block * RADIX_BUCKETS + bucket];
+				offsets[block * RADIX_BUCKETS + bucket] = total;
+				total += n;
+			}
+		}
+
+		if (blocks > 1)
+			jobs->ParallelFor(blocks, 1, [&](unsigned int begin, unsigned int end) { for (unsigned int b = begin; b < end; b++) scatter(b); });
+		else
+			scatter(0);
+
+		std::swap(source, target);
+	}
+	return source;
+}
@@ -0,0 +1,213 @@
+#include "Culling.h"
+
+#include <cmath>
+
+#if defined(__AVX__)
+#define CULLING_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CULLING_SSE
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static inline unsigned int CountTrailingZeros(unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (unsigned int)index;
+#else
+	return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+Frustum::Frustum(const float* m)
+{
+	/* rows of the column major matrix, clip = M * p, a point is inside when
+	   -w <= x, y, z <= w, so every plane is row3 +- row0/1/2 */
+	for (int i = 0; i < 3; i++)
+	{
+		m_Planes[i * 2 + 0] = { m[3] + m[i], m[7] + m[4 + i], m[11] + m[8 + i], m[15] + m[12 + i] };
+		m_Planes[i * 2 + 1] = { m[3] - m[i], m[7] - m[4 + i], m[11] - m[8 + i], m[15] - m[12 + i] };
+	}
+
+	/* unit normals, so plane distances are real distances */
+	for (Plane& plane : m_Planes)
+	{
+		float length = sqrtf(plane.a * plane.a + plane.b * plane.b + plane.c * plane.c);
+		if (length > 0.0f)
+		{
+			plane.a /= length;
+			plane.b /= length;
+			plane.c /= length;
+			plane.d /= length;
+		}
+	}
+}
+
+unsigned int BoundsStore::AddBox(const float center[3], const float extents[3])
+{
+	m_CenterX.push_back(0.0f); m_CenterY.push_back(0.0f); m_CenterZ.push_back(0.0f);
+	m_ExtentX.push_back(0.0f); m_ExtentY.push_back(0.0f); m_ExtentZ.push_back(0.0f);
+	m_Radius.push_back(0.0f);
+	SetBox(GetCount() - 1, center, extents);
+	return GetCount() - 1;
+}
+
+unsigned int BoundsStore::AddSphere(const float center[3], float radius)
+{
+	float extents[3] = { radius, radius, radius };
+	unsigned int index = AddBox(center, extents);
+	m_Radius[index] = radius;
+	return index;
+}
+
+void BoundsStore::SetBox(unsigned int index, const float center[3], const float extents[3])
+{
+	m_CenterX[index] = center[0]; m_CenterY[index] = center[1]; m_CenterZ[index] = center[2];
+	m_ExtentX[index] = extents[0]; m_ExtentY[index] = extents[1]; m_ExtentZ[index] = extents[2];
+	m_Radius[index] = sqrtf(extents[0] * extents[0] + extents[1] * extents[1] + extents[2] * extents[2]);
+}
+
+void BoundsStore::SetSphere(unsigned int index, const float center[3], float radius)
+{
+	float extents[3] = { radius, radius, radius };
+	SetBox(index, center, extents);
+	m_Radius[index] = radius;
+}
+
+void BoundsStore::Clear()
+{
+	m_CenterX.clear(); m_CenterY.clear(); m_CenterZ.clear();
+	m_ExtentX.clear(); m_ExtentY.clear(); m_ExtentZ.clear();
+	m_Radius.clear();
+}
+
+/* distance of the center to the plane must not be below -(projected size) */
+static inline bool IsVisible(const BoundsStore& bounds, const Frustum& frustum, unsigned int i)
+{
+	for (unsigned int p = 0; p < 6; p++)
+	{
+		const Plane& plane = frustum.GetPlane(p);
+		float distance = plane.a * bounds.GetCenterX()[i] + plane.b * bounds.GetCenterY()[i] + plane.c * bounds.GetCenterZ()[i] + plane.d;
+		float box = fabsf(plane.a) * bounds.GetExtentX()[i] + fabsf(plane.b) * bounds.GetExtentY()[i] + fabsf(plane.c) * bounds.GetExtentZ()[i];
+		float radius = box < bounds.GetRadius()[i] ? box : bounds.GetRadius()[i];
+		if (distance + radius < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+unsigned int FrustumCuller::CullScalar(const BoundsStore& bounds, const Frustum& frustum, std::vector<unsigned int>& visible)
+{
+	visible.clear();
+	for (unsigned int i = 0; i < bounds.GetCount(); i++)
+	{
+		if (IsVisible(bounds, frustum, i))
+			visible.push_back(i);
+	}
+	return (unsigned int)visible.size();
+}
+
+unsigned int FrustumCuller::Cull(const BoundsStore& bounds, const Frustum& frustum, std::vector<unsigned int>& visible)
+{
+	unsigned int count = bounds.GetCount();
+	/* worst case everything is visible, written through a raw pointer */
+	visible.resize(count);
+	unsigned int* out = visible.data();
+	unsigned int i = 0;
+
+	const float* cx = bounds.GetCenterX();
+	const float* cy = bounds.GetCenterY();
+	const float* cz = bounds.GetCenterZ();
+	const float* ex = bounds.GetExtentX();
+	const float* ey = bounds.GetExtentY();
+	const float* ez = bounds.GetExtentZ();
+	const float* radius = bounds.GetRadius();
+
+#if defined(CULLING_AVX)
+	__m256 a[6], b[6], c[6], d[6], absA[6], absB[6], absC[6];
+	for (int p = 0; p < 6; p++)
+	{
+		const Plane& plane = frustum.GetPlane(p);
+		a[p] = _mm256_set1_ps(plane.a); absA[p] = _mm256_set1_ps(fabsf(plane.a));
+		b[p] = _mm256_set1_ps(plane.b); absB[p] = _mm256_set1_ps(fabsf(plane.b));
+		c[p] = _mm256_set1_ps(plane.c); absC[p] = _mm256_set1_ps(fabsf(plane.c));
+		d[p] = _mm256_set1_ps(plane.d);
+	}
+	const __m256 zero = _mm256_setzero_ps();
+
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 x = _mm256_loadu_ps(cx + i), y = _mm256_loadu_ps(cy + i), z = _mm256_loadu_ps(cz + i);
+		__m256 sx = _mm256_loadu_ps(ex + i), sy = _mm256_loadu_ps(ey + i), sz = _mm256_loadu_ps(ez + i);
+		__m256 r = _mm256_loadu_ps(radius + i);
+
+		int mask = 0xFF;
+		for (int p = 0; p < 6 && mask; p++)
+		{
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a[p], x), _mm256_mul_ps(b[p], y)),
+				_mm256_add_ps(_mm256_mul_ps(c[p], z), d[p]));
+			__m256 box = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(absA[p], sx), _mm256_mul_ps(absB[p], sy)), _mm256_mul_ps(absC[p], sz));
+			__m256 inside = _mm256_cmp_ps(_mm256_add_ps(distance, _mm256_min_ps(box, r)), zero, _CMP_GE_OQ);
+			/* mostly off-screen scenes leave the loop after a plane or two */
+			mask &= _mm256_movemask_ps(inside);
+		}
+
+		while (mask)
+		{
+			*out++ = i + CountTrailingZeros((unsigned int)mask);
+			mask &= mask - 1;
+		}
+	}
+#elif defined(CULLING_SSE)
+	__m128 a[6], b[6], c[6], d[6], absA[6], absB[6], absC[6];
+	for (int p = 0; p < 6; p++)
+	{
+		const Plane& plane = frustum.GetPlane(p);
+		a[p] = _mm_set1_ps(plane.a); absA[p] = _mm_set1_ps(fabsf(plane.a));
+		b[p] = _mm_set1_ps(plane.b); absB[p] = _mm_set1_ps(fabsf(plane.b));
+		c[p] = _mm_set1_ps(plane.c); absC[p] = _mm_set1_ps(fabsf(plane.c));
+		d[p] = _mm_set1_ps(plane.d);
+	}
+	const __m128 zero = _mm_setzero_ps();
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(cx + i), y = _mm_loadu_ps(cy + i), z = _mm_loadu_ps(cz + i);
+		__m128 sx = _mm_loadu_ps(ex + i), sy = _mm_loadu_ps(ey + i), sz = _mm_loadu_ps(ez + i);
+		__m128 r = _mm_loadu_ps(radius + i);
+
+		int mask = 0xF;
+		for (int p = 0; p < 6 && mask; p++)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[p], x), _mm_mul_ps(b[p], y)),
+				_mm_add_ps(_mm_mul_ps(c[p], z), d[p]));
+			__m128 box = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absA[p], sx), _mm_mul_ps(absB[p], sy)), _mm_mul_ps(absC[p], sz));
+			__m128 inside = _mm_cmpge_ps(_mm_add_ps(distance, _mm_min_ps(box, r)), zero);
+			mask &= _mm_movemask_ps(inside);
+		}
+
+		while (mask)
+		{
+			*out++ = i + CountTrailingZeros((unsigned int)mask);
+			mask &= mask - 1;
+		}
+	}
+#endif
+
+	/* tail (or everything without SIMD) */
+	for (; i < count; i++)
+	{
+		if (IsVisible(bounds, frustum, i))
+			*out++ = i;
+	}
+
+	unsigned int visibleCount = (unsigned int)(out - visible.data());
+	visible.resize(visibleCount);
+	return visibleCount;
+}
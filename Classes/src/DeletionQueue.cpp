@@ -0,0 +1,155 @@
+#include "DeletionQueue.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "renderer.h"
+#include "FrameSync.h"
+
+struct QueuedObject
+{
+	GLObjectType type;
+	unsigned int rendererID;
+	unsigned long long frame;	/* frame being recorded when Collect took it over */
+};
+
+static std::atomic<FrameSync*> s_Sync(nullptr);
+
+/* handed over by Delete(), any thread */
+static std::mutex s_IncomingMutex;
+static std::vector<QueuedObject> s_Incoming;
+
+/* waiting for their frame's fence, render thread only */
+static std::vector<QueuedObject> s_Pending;
+static std::vector<unsigned int> s_Names[(int)GLObjectType::QUERY + 1];
+
+static void DeleteNow(GLObjectType type, unsigned int count, const unsigned int* names)
+{
+	switch (type)
+	{
+	case GLObjectType::BUFFER:
+		GLCall(glDeleteBuffers(count, names));
+		break;
+	case GLObjectType::VERTEX_ARRAY:
+		GLCall(glDeleteVertexArrays(count, names));
+		break;
+	case GLObjectType::TEXTURE:
+		GLCall(glDeleteTextures(count, names));
+		break;
+	case GLObjectType::FRAMEBUFFER:
+		GLCall(glDeleteFramebuffers(count, names));
+		break;
+	case GLObjectType::QUERY:
+		GLCall(glDeleteQueries(count, names));
+		break;
+	case GLObjectType::PROGRAM:
+		/* programs have no batched delete */
+		for (unsigned int i = 0; i < count; i++)
+		{
+			GLCall(glDeleteProgram(names[i]));
+		}
+		break;
+	}
+}
+
+/* deletes every pending object from before frame completed */
+static unsigned int DeleteCompleted(unsigned long long completed)
+{
+	unsigned int deleted = 0;
+	for (unsigned int i = 0; i < s_Pending.size();)
+	{
+		if (s_Pending[i].frame < completed)
+		{
+			s_Names[(int)s_Pending[i].type].push_back(s_Pending[i].rendererID);
+			s_Pending[i] = s_Pending.back();
+			s_Pending.pop_back();
+			deleted++;
+		}
+		else
+			i++;
+	}
+
+	for (int type = 0; type <= (int)GLObjectType::QUERY; type++)
+	{
+		if (s_Names[type].empty())
+			continue;
+		DeleteNow((GLObjectType)type, (unsigned int)s_Names[type].size(), s_Names[type].data());
+		s_Names[type].clear();
+	}
+	return deleted;
+}
+
+/* moves everything Delete() collected into s_Pending */
+static void TakeIncoming(unsigned long long frame)
+{
+	std::lock_guard<std::mutex> lock(s_IncomingMutex);
+	for (QueuedObject& object : s_Incoming)
+	{
+		object.frame = frame;
+		s_Pending.push_back(object);
+	}
+	s_Incoming.clear();
+}
+
+void DeletionQueue::SetFrameSync(FrameSync* sync)
+{
+	s_Sync = sync;
+}
+
+void DeletionQueue::Delete(GLObjectType type, unsigned int rendererID)
+{
+	if (rendererID == 0)
+		return;
+
+	if (!s_Sync)
+	{
+		DeleteNow(type, 1, &rendererID);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(s_IncomingMutex);
+	s_Incoming.push_back({ type, rendererID, 0 });
+}
+
+unsigned int DeletionQueue::Collect()
+{
+	FrameSync* sync = s_Sync;
+	if (!sync)
+		return Flush();
+
+	/* the frame being recorded is the latest one that can still use them,
+	   a frame later than the real last use is safe, only slower */
+	TakeIncoming(sync->GetCurrentFrame());
+	if (s_Pending.empty())
+		return 0;
+	return DeleteCompleted(sync->Poll());
+}
+
+unsigned int DeletionQueue::Flush()
+{
+	TakeIncoming(0);
+	if (s_Pending.empty())
+		return 0;
+
+	if (FrameSync* sync = s_Sync)
+	{
+		sync->WaitIdle();
+	}
+	else
+	{
+		GLCall(glFinish());
+	}
+	return DeleteCompleted(~0ull);
+}
+
+bool DeletionQueue::IsDeferred()
+{
+	return s_Sync != nullptr;
+}
+
+unsigned int DeletionQueue::GetPendingCount()
+{
+	std::lock_guard<std::mutex> lock(s_IncomingMutex);
+	return (unsigned int)(s_Incoming.size() + s_Pending.size());
+}
@@ -0,0 +1,101 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <mutex>
+
+/* every thread's arena, so ResetAll can reach them */
+static std::mutex s_ArenasMutex;
+static std::vector<FrameArena*> s_Arenas;
+
+FrameArena::FrameArena(size_t chunkSize)
+	: m_Offset(0), m_Used(0), m_Peak(0), m_ChunkSize(chunkSize), m_ChunkAllocations(0)
+{
+}
+
+FrameArena::~FrameArena()
+{
+	for (Chunk& chunk : m_Chunks)
+		::operator delete(chunk.data);
+}
+
+void FrameArena::AddChunk(size_t minimumSize)
+{
+	Chunk chunk;
+	chunk.size = std::max(m_ChunkSize, minimumSize);
+	chunk.data = (unsigned char*)::operator new(chunk.size);
+	m_Chunks.push_back(chunk);
+	m_Offset = 0;
+	m_ChunkAllocations++;
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	if (!m_Chunks.empty())
+	{
+		const Chunk& chunk = m_Chunks.back();
+		/* alignment is a power of two */
+		size_t aligned = ((size_t)chunk.data + m_Offset + alignment - 1) & ~(alignment - 1);
+		size_t offset = aligned - (size_t)chunk.data;
+		if (offset + size <= chunk.size)
+		{
+			m_Used += offset - m_Offset + size;
+			m_Offset = offset + size;
+			return chunk.data + offset;
+		}
+	}
+
+	/* a fresh chunk is aligned for max_align_t, bigger alignments get room to move */
+	AddChunk(size + alignment);
+	return Allocate(size, alignment);
+}
+
+void FrameArena::Reset()
+{
+	m_Peak = std::max(m_Peak, m_Used);
+
+	if (m_Chunks.size() > 1)
+	{
+		/* one chunk that fits the whole of the biggest frame so far */
+		size_t total = 0;
+		for (Chunk& chunk : m_Chunks)
+		{
+			total += chunk.size;
+			::operator delete(chunk.data);
+		}
+		m_Chunks.clear();
+		AddChunk(std::max(total, m_Peak));
+	}
+
+	m_Offset = 0;
+	m_Used = 0;
+}
+
+FrameArena& FrameArena::ForThread()
+{
+	struct Registration
+	{
+		FrameArena arena;
+
+		Registration()
+		{
+			std::lock_guard<std::mutex> lock(s_ArenasMutex);
+			s_Arenas.push_back(&arena);
+		}
+
+		~Registration()
+		{
+			std::lock_guard<std::mutex> lock(s_ArenasMutex);
+			s_Arenas.erase(std::find(s_Arenas.begin(), s_Arenas.end(), &arena));
+		}
+	};
+
+	thread_local Registration registration;
+	return registration.arena;
+}
+
+void FrameArena::ResetAll()
+{
+	std::lock_guard<std::mutex> lock(s_ArenasMutex);
+	for (FrameArena* arena : s_Arenas)
+		arena->Reset();
+}
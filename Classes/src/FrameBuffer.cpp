@@ -0,0 +1,120 @@
+#include "FrameBuffer.h"
+
+#include <iostream>
+
+#include "renderer.h"
+#include "DeletionQueue.h"
+#include "RenderTarget.h"
+
+FrameBuffer::FrameBuffer()
+	: m_RendererID(0), m_DepthAttachment(nullptr), m_Width(0), m_Height(0)
+{
+	for (unsigned int i = 0; i < MAX_COLOR_ATTACHMENTS; i++)
+		m_ColorAttachments[i] = nullptr;
+
+	GLCall(glGenFramebuffers(1, &m_RendererID));
+}
+
+FrameBuffer::~FrameBuffer()
+{
+	DeletionQueue::Delete(GLObjectType::FRAMEBUFFER, m_RendererID);
+}
+
+void FrameBuffer::AttachColor(const RenderTarget* target, unsigned int index)
+{
+	ASSERT(index < MAX_COLOR_ATTACHMENTS);
+	ASSERT(!target || !RenderTarget::IsDepthFormat(target->GetDesc().internalFormat));
+
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + index,
+		target ? target->GetTarget() : GL_TEXTURE_2D, target ? target->GetRendererID() : 0, 0));
+	m_ColorAttachments[index] = target;
+	if (target)
+	{
+		m_Width = target->GetWidth();
+		m_Height = target->GetHeight();
+	}
+	UpdateDrawBuffers();
+}
+
+void FrameBuffer::AttachDepth(const RenderTarget* target)
+{
+	ASSERT(!target || RenderTarget::IsDepthFormat(target->GetDesc().internalFormat));
+
+	/* detaching from GL_DEPTH_STENCIL_ATTACHMENT clears both points, the
+	   previous target may have had stencil */
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0));
+	m_DepthAttachment = target;
+	if (!target)
+		return;
+
+	GLenum attachment = RenderTarget::HasStencil(target->GetDesc().internalFormat) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+	GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, target->GetTarget(), target->GetRendererID(), 0));
+	m_Width = target->GetWidth();
+	m_Height = target->GetHeight();
+}
+
+void FrameBuffer::UpdateDrawBuffers()
+{
+	/* GL_NONE for the gaps so attachment i stays output location i */
+	GLenum buffers[MAX_COLOR_ATTACHMENTS];
+	int count = 0;
+	for (unsigned int i = 0; i < MAX_COLOR_ATTACHMENTS; i++)
+	{
+		buffers[i] = m_ColorAttachments[i] ? GL_COLOR_ATTACHMENT0 + i : GL_NONE;
+		if (m_ColorAttachments[i])
+			count = i + 1;
+	}
+
+	if (count == 0)
+	{
+		/* depth only (shadow maps) */
+		GLCall(glDrawBuffer(GL_NONE));
+		GLCall(glReadBuffer(GL_NONE));
+		return;
+	}
+	GLCall(glDrawBuffers(count, buffers));
+	GLCall(glReadBuffer(GL_COLOR_ATTACHMENT0));
+}
+
+bool FrameBuffer::IsComplete() const
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCall(GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Framebuffer " << m_RendererID << " is not complete (status " << status << ")" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void FrameBuffer::Bind() const
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCall(glViewport(0, 0, m_Width, m_Height));
+}
+
+void FrameBuffer::Unbind() const
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void FrameBuffer::Blit(const FrameBuffer* target, unsigned int targetWidth, unsigned int targetHeight, unsigned int mask) const
+{
+	bool scaled = targetWidth != m_Width || targetHeight != m_Height;
+	ASSERT(!(mask & GL_DEPTH_BUFFER_BIT) || !scaled);
+
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID));
+	GLCall(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target ? target->GetRendererID() : 0));
+	GLCall(glBlitFramebuffer(0, 0, m_Width, m_Height, 0, 0, targetWidth, targetHeight, mask,
+		scaled && mask == GL_COLOR_BUFFER_BIT ? GL_LINEAR : GL_NEAREST));
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void FrameBuffer::BindDefault(unsigned int width, unsigned int height)
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+	GLCall(glViewport(0, 0, width, height));
+}
@@ -0,0 +1,46 @@
+#include "FrameSync.h"
+
+#include "renderer.h"
+
+FrameSync::FrameSync()
+	: m_Frame(0), m_Completed(0)
+{
+}
+
+FrameSync::~FrameSync()
+{
+	for (FrameFence& fence : m_Fences)
+	{
+		GLCall(glDeleteSync(fence.fence));
+	}
+}
+
+void FrameSync::EndFrame()
+{
+	GLCall(GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	m_Fences.push_back({ m_Frame, fence });
+	m_Frame++;
+}
+
+unsigned long long FrameSync::Poll()
+{
+	/* fences signal in order, stop at the first one that hasn't */
+	while (!m_Fences.empty())
+	{
+		GLCall(GLenum status = glClientWaitSync(m_Fences.front().fence, 0, 0));
+		if (status == GL_TIMEOUT_EXPIRED)
+			break;
+		GLCall(glDeleteSync(m_Fences.front().fence));
+		m_Completed = m_Fences.front().frame + 1;
+		m_Fences.pop_front();
+	}
+	return m_Completed;
+}
+
+void FrameSync::WaitIdle()
+{
+	GLCall(glFinish());
+	Poll();
+	/* commands recorded after the last EndFrame are done as well */
+	m_Completed = m_Frame;
+}
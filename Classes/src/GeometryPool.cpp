@@ -0,0 +1,174 @@
+#include "GeometryPool.h"
+
+#include <iostream>
+#include <algorithm>
+
+#include "renderer.h"
+#include "DeletionQueue.h"
+
+GeometryPool::GeometryPool(const VertexBufferLayout& layout, unsigned int vertexCapacity, unsigned int indexCapacity)
+	: m_Layout(layout), m_VertexBuffer(nullptr, vertexCapacity * layout.GetStride()), m_IndexBuffer(nullptr, indexCapacity),
+	m_VertexAllocator(vertexCapacity), m_IndexAllocator(indexCapacity)
+{
+	m_VertexArray.addBuffer(m_VertexBuffer, m_Layout);
+	m_IndexBuffer.Bind();
+	m_VertexArray.Unbind();
+}
+
+unsigned int GeometryPool::Add(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+	Entry entry;
+	bool compacted = false;
+	while (true)
+	{
+		if (m_VertexAllocator.Allocate(vertexCount, entry.vertices))
+		{
+			if (m_IndexAllocator.Allocate(indexCount, entry.indices))
+				break;
+			m_VertexAllocator.Free(entry.vertices);
+		}
+
+		BufferAllocatorStats vertexStats = m_VertexAllocator.GetStats(), indexStats = m_IndexAllocator.GetStats();
+		bool fits = vertexStats.capacity - vertexStats.used >= vertexCount && indexStats.capacity - indexStats.used >= indexCount;
+		if (compacted || !fits)
+		{
+			std::cout << "GeometryPool is full (" << vertexStats.used << "/" << vertexStats.capacity << " vertices, "
+				<< indexStats.used << "/" << indexStats.capacity << " indices)" << std::endl;
+			return INVALID_MESH;
+		}
+		/* enough space in total, just not in one piece */
+		Compact();
+		compacted = true;
+	}
+
+	unsigned int stride = m_Layout.GetStride();
+	m_VertexBuffer.SetSubData(vertices, entry.vertices.offset * stride, vertexCount * stride);
+	/* bind our own vertex array first, IndexBuffer::SetSubData rebinds the element buffer */
+	m_VertexArray.Bind();
+	m_IndexBuffer.SetSubData(indices, entry.indices.offset, indexCount);
+	m_VertexArray.Unbind();
+
+	entry.range.firstIndex = entry.indices.offset;
+	entry.range.indexCount = indexCount;
+	entry.range.baseVertex = entry.vertices.offset;
+	entry.range.vertexCount = vertexCount;
+	entry.alive = true;
+
+	unsigned int mesh;
+	if (!m_FreeHandles.empty())
+	{
+		mesh = m_FreeHandles.back();
+		m_FreeHandles.pop_back();
+		m_Meshes[mesh] = entry;
+	}
+	else
+	{
+		mesh = (unsigned int)m_Meshes.size();
+		m_Meshes.push_back(entry);
+	}
+	return mesh;
+}
+
+void GeometryPool::Remove(unsigned int mesh)
+{
+	Entry& entry = m_Meshes[mesh];
+	ASSERT(entry.alive);
+
+	m_VertexAllocator.Free(entry.vertices);
+	m_IndexAllocator.Free(entry.indices);
+	entry.alive = false;
+	m_FreeHandles.push_back(mesh);
+}
+
+/* copies ranges of one buffer packed into a scratch buffer and then back to
+   its start (glCopyBufferSubData can't copy between overlapping ranges of
+   the same buffer), ranges are (offset, size) pairs in bytes */
+static void PackBuffer(unsigned int buffer, const std::vector<std::pair<unsigned int, unsigned int>>& ranges)
+{
+	unsigned int total = 0;
+	for (const auto& range : ranges)
+		total += range.second;
+	if (total == 0)
+		return;
+
+	unsigned int scratch;
+	GLCall(glGenBuffers(1, &scratch));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, scratch));
+	GLCall(glBufferData(GL_COPY_WRITE_BUFFER, total, nullptr, GL_STREAM_COPY));
+	GLCall(glBindBuffer(GL_COPY_READ_BUFFER, buffer));
+
+	unsigned int packed = 0;
+	for (const auto& range : ranges)
+	{
+		GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, range.first, packed, range.second));
+		packed += range.second;
+	}
+
+	GLCall(glBindBuffer(GL_COPY_READ_BUFFER, scratch));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+	GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, total));
+
+	GLCall(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+	/* the copies above may still be in flight */
+	DeletionQueue::Delete(GLObjectType::BUFFER, scratch);
+}
+
+void GeometryPool::Compact()
+{
+	/* live meshes in vertex buffer order, then the same for indices, so
+	   allocating them again front to back lands every one at its packed spot */
+	std::vector<unsigned int> byVertex, byIndex;
+	for (unsigned int mesh = 0; mesh < m_Meshes.size(); mesh++)
+	{
+		if (m_Meshes[mesh].alive)
+		{
+			byVertex.push_back(mesh);
+			byIndex.push_back(mesh);
+		}
+	}
+	std::sort(byVertex.begin(), byVertex.end(), [&](unsigned int a, unsigned int b)
+	{
+		return m_Meshes[a].vertices.offset < m_Meshes[b].vertices.offset;
+	});
+	std::sort(byIndex.begin(), byIndex.end(), [&](unsigned int a, unsigned int b)
+	{
+		return m_Meshes[a].indices.offset < m_Meshes[b].indices.offset;
+	});
+
+	unsigned int stride = m_Layout.GetStride();
+	std::vector<std::pair<unsigned int, unsigned int>> ranges;
+	for (unsigned int mesh : byVertex)
+		ranges.push_back({ m_Meshes[mesh].vertices.offset * stride, m_Meshes[mesh].vertices.size * stride });
+	PackBuffer(m_VertexBuffer.GetRendererID(), ranges);
+	ranges.clear();
+	for (unsigned int mesh : byIndex)
+		ranges.push_back({ m_Meshes[mesh].indices.offset * (unsigned int)sizeof(unsigned int),
+			m_Meshes[mesh].indices.size * (unsigned int)sizeof(unsigned int) });
+	PackBuffer(m_IndexBuffer.GetRendererID(), ranges);
+
+	m_VertexAllocator.Reset();
+	m_IndexAllocator.Reset();
+	for (unsigned int mesh : byVertex)
+	{
+		Entry& entry = m_Meshes[mesh];
+		m_VertexAllocator.Allocate(entry.vertices.size, entry.vertices);
+		entry.range.baseVertex = entry.vertices.offset;
+	}
+	for (unsigned int mesh : byIndex)
+	{
+		Entry& entry = m_Meshes[mesh];
+		m_IndexAllocator.Allocate(entry.indices.size, entry.indices);
+		entry.range.firstIndex = entry.indices.offset;
+	}
+}
+
+void GeometryPool::Bind() const
+{
+	m_VertexArray.Bind();
+}
+
+void GeometryPool::Unbind() const
+{
+	m_VertexArray.Unbind();
+}
@@ -0,0 +1,166 @@
+#include "GpuCuller.h"
+
+#include "renderer.h"
+#include "shader.h"
+#include "Culling.h"
+#include "GeometryPool.h"
+
+#define INSTANCE_SIZE (2 * sizeof(Vec4))	/* transform, color */
+
+const unsigned int GpuCuller::INVALID_OBJECT;
+
+GpuCuller::GpuCuller(GeometryPool& pool, unsigned int maxObjects, unsigned int maxMeshes)
+	: m_Pool(pool), m_MaxObjects(maxObjects), m_MaxMeshes(maxMeshes), m_Dirty(false),
+	m_ObjectBuffer(nullptr, maxObjects * sizeof(GpuCullObject)),
+	m_InstanceBuffer(nullptr, maxObjects * INSTANCE_SIZE), m_IndirectBuffer(maxMeshes)
+{
+	m_Objects.reserve(maxObjects);
+	m_Commands.reserve(maxMeshes);
+
+	VertexBufferLayout instanceLayout;
+	instanceLayout.Push<float>(4);
+	instanceLayout.Push<float>(4);
+	unsigned int firstAttribute = (unsigned int)pool.GetLayout().GetElements().size();
+	m_Pool.GetVertexArray().addInstanceBuffer(m_InstanceBuffer, instanceLayout, firstAttribute);
+	m_Pool.GetVertexArray().Unbind();
+}
+
+/* the command drawing a pool mesh, made on first use, INVALID_OBJECT when there's no room */
+unsigned int GpuCuller::GetCommand(unsigned int mesh)
+{
+	if (mesh >= m_MeshCommands.size())
+		m_MeshCommands.resize(mesh + 1, INVALID_OBJECT);
+	if (m_MeshCommands[mesh] == INVALID_OBJECT)
+	{
+		if (m_MeshHandles.size() >= m_MaxMeshes)
+			return INVALID_OBJECT;
+		m_MeshCommands[mesh] = (unsigned int)m_MeshHandles.size();
+		m_MeshHandles.push_back(mesh);
+		m_MeshObjects.push_back(0);
+		m_Commands.push_back(DrawElementsIndirectCommand());
+	}
+	return m_MeshCommands[mesh];
+}
+
+unsigned int GpuCuller::Add(const GpuCullObject& object)
+{
+	if (m_Objects.size() >= m_MaxObjects)
+		return INVALID_OBJECT;
+	unsigned int command = GetCommand(object.mesh);
+	if (command == INVALID_OBJECT)
+		return INVALID_OBJECT;
+
+	m_Objects.push_back(object);
+	m_Objects.back().mesh = command;
+	m_MeshObjects[command]++;
+	m_Dirty = true;
+	return (unsigned int)m_Objects.size() - 1;
+}
+
+void GpuCuller::Set(unsigned int index, const GpuCullObject& object)
+{
+	unsigned int command = GetCommand(object.mesh);
+	ASSERT(command != INVALID_OBJECT);
+
+	m_MeshObjects[m_Objects[index].mesh]--;
+	m_Objects[index] = object;
+	m_Objects[index].mesh = command;
+	m_MeshObjects[command]++;
+	m_Dirty = true;
+}
+
+void GpuCuller::Clear()
+{
+	m_Objects.clear();
+	m_MeshHandles.clear();
+	m_MeshCommands.clear();
+	m_MeshObjects.clear();
+	m_Commands.clear();
+	m_Dirty = false;
+}
+
+/* every mesh gets a run of the instance buffer as long as its object
+   count, the runs follow each other in command order */
+void GpuCuller::Upload()
+{
+	unsigned int first = 0;
+	for (unsigned int i = 0; i < m_Commands.size(); i++)
+	{
+		m_Commands[i].baseInstance = first;
+		first += m_MeshObjects[i];
+	}
+	if (!m_Objects.empty())
+		m_ObjectBuffer.SetSubData(m_Objects.data(), 0, (unsigned int)(m_Objects.size() * sizeof(GpuCullObject)));
+	m_Dirty = false;
+}
+
+void GpuCuller::Cull(const Renderer& renderer, Shader& cull, const Frustum& frustum)
+{
+	if (m_Objects.empty())
+		return;
+	if (m_Dirty)
+		Upload();
+
+	/* ranges are read again every time, Compact may have moved them */
+	for (unsigned int i = 0; i < m_Commands.size(); i++)
+	{
+		const MeshRange& range = m_Pool.GetRange(m_MeshHandles[i]);
+		DrawElementsIndirectCommand& command = m_Commands[i];
+		command.count = range.indexCount;
+		command.instanceCount = 0;
+		command.firstIndex = range.firstIndex;
+		command.baseVertex = (int)range.baseVertex;
+	}
+	m_IndirectBuffer.SetData(m_Commands.data(), (unsigned int)m_Commands.size());
+
+	float planes[6 * 4];
+	for (unsigned int p = 0; p < 6; p++)
+	{
+		const Plane& plane = frustum.GetPlane(p);
+		planes[p * 4 + 0] = plane.a;
+		planes[p * 4 + 1] = plane.b;
+		planes[p * 4 + 2] = plane.c;
+		planes[p * 4 + 3] = plane.d;
+	}
+	cull.Bind();
+	cull.SetUniform4fv("u_Planes", 6, planes);
+	cull.SetUniform1ui("u_ObjectCount", (unsigned int)m_Objects.size());
+
+	m_ObjectBuffer.BindBase(OBJECT_BINDING);
+	ShaderStorageBuffer::BindBase(COMMAND_BINDING, m_IndirectBuffer.GetRendererID());
+	ShaderStorageBuffer::BindBase(INSTANCE_BINDING, m_InstanceBuffer.GetRendererID());
+	unsigned int groupSize = cull.GetWorkGroupSize(0);
+	renderer.Dispatch(cull, ((unsigned int)m_Objects.size() + groupSize - 1) / groupSize);
+	/* the draw reads the commands as indirect arguments and the
+	   instances as vertex attributes */
+	renderer.Barrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+}
+
+unsigned int GpuCuller::Draw(const Shader& shader)
+{
+	unsigned int count = (unsigned int)m_Commands.size();
+	if (count == 0)
+		return 0;
+
+	shader.Bind();
+	m_Pool.Bind();
+	m_IndirectBuffer.Bind();
+	/* indirect offset 0, commands tightly packed (stride 0) */
+	GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, count, 0));
+	return count;
+}
+
+unsigned int GpuCuller::GetVisibleCount() const
+{
+	std::vector<DrawElementsIndirectCommand> commands(m_Commands.size());
+	if (commands.empty())
+		return 0;
+
+	GLCall(glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT));
+	m_IndirectBuffer.Bind();
+	GLCall(glGetBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data()));
+	unsigned int visible = 0;
+	for (const DrawElementsIndirectCommand& command : commands)
+		visible += command.instanceCount;
+	return visible;
+}
@@ -0,0 +1,76 @@
+#include "GpuParticleSystem.h"
+
+#include "renderer.h"
+#include "shader.h"
+#include "VertexArray.h"
+#include "indexbuffer.h"
+
+/* xorshift32, 0..1, the same sequence ParticleSystem starts from */
+static inline float Random(unsigned int& seed)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return (seed >> 8) * (1.0f / 16777216.0f);
+}
+
+GpuParticleSystem::GpuParticleSystem(unsigned int count, const ParticleSettings& settings)
+	: m_Settings(settings), m_Count(count), m_Frame(0),
+	m_Particles(nullptr, count * sizeof(GpuParticle))
+{
+	/* spawned on the CPU once, uploaded in one go */
+	std::vector<GpuParticle> particles(count);
+	const ParticleSettings& s = m_Settings;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int seed = 2463534242u ^ (i * 2654435761u);
+		if (seed == 0)
+			seed = 1;
+		float life = s.minLife + (s.maxLife - s.minLife) * Random(seed);
+		GpuParticle& p = particles[i];
+		p.velocity.x = s.velocity.x + s.spread * (Random(seed) * 2.0f - 1.0f);
+		p.velocity.y = s.velocity.y + s.spread * (Random(seed) * 2.0f - 1.0f);
+		p.velocity.z = s.velocity.z + s.spread * (Random(seed) * 2.0f - 1.0f);
+		p.velocity.w = 1.0f / life;
+		/* start somewhere in their lives, or they'd all die at once */
+		p.position = { s.origin.x, s.origin.y, s.origin.z, life * Random(seed) };
+	}
+	m_Particles.SetSubData(particles.data(), 0, count * sizeof(GpuParticle));
+}
+
+void GpuParticleSystem::Simulate(const Renderer& renderer, Shader& update, float dt)
+{
+	const ParticleSettings& s = m_Settings;
+	update.Bind();
+	update.SetUniform1f("u_DeltaTime", dt);
+	update.SetUniform3f("u_Gravity", s.gravity.x, s.gravity.y, s.gravity.z);
+	update.SetUniform3f("u_Origin", s.origin.x, s.origin.y, s.origin.z);
+	update.SetUniform3f("u_Velocity", s.velocity.x, s.velocity.y, s.velocity.z);
+	update.SetUniform1f("u_Spread", s.spread);
+	update.SetUniform2f("u_Life", s.minLife, s.maxLife);
+	update.SetUniform1f("u_Bounce", s.bounce);
+	update.SetUniform1ui("u_Seed", m_Frame++);
+	update.SetUniform1ui("u_Count", m_Count);
+
+	m_Particles.BindBase(PARTICLE_BINDING);
+	unsigned int groupSize = update.GetWorkGroupSize(0);
+	renderer.Dispatch(update, (m_Count + groupSize - 1) / groupSize);
+	/* both the draw's vertex shader and the next dispatch read the
+	   particles as storage */
+	renderer.Barrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GpuParticleSystem::Draw(const Renderer& renderer, const VertexArray& quad, const IndexBuffer& ib, Shader& shader) const
+{
+	shader.Bind();
+	shader.SetUniform1f("u_HalfSize", m_Settings.size * 0.5f);
+	m_Particles.BindBase(PARTICLE_BINDING);
+	renderer.DrawInstanced(quad, ib, shader, m_Count);
+}
+
+void GpuParticleSystem::Read(std::vector<GpuParticle>& particles) const
+{
+	particles.resize(m_Count);
+	GLCall(glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT));
+	m_Particles.GetSubData(particles.data(), 0, m_Count * sizeof(GpuParticle));
+}
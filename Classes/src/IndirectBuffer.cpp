@@ -0,0 +1,36 @@
+#include "IndirectBuffer.h"
+
+#include "renderer.h"
+#include "DeletionQueue.h"
+
+IndirectBuffer::IndirectBuffer(unsigned int maxCommands)
+	: m_MaxCommands(maxCommands)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID));
+	GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, maxCommands * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW));
+}
+
+IndirectBuffer::~IndirectBuffer()
+{
+	DeletionQueue::Delete(GLObjectType::BUFFER, m_RendererID);
+}
+
+void IndirectBuffer::SetData(const DrawElementsIndirectCommand* commands, unsigned int count)
+{
+	ASSERT(count <= m_MaxCommands);
+
+	GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID));
+	GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, m_MaxCommands * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW));
+	GLCall(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, count * sizeof(DrawElementsIndirectCommand), commands));
+}
+
+void IndirectBuffer::Bind() const
+{
+	GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID));
+}
+
+void IndirectBuffer::Unbind() const
+{
+	GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+}
@@ -0,0 +1,256 @@
+#include "JobSystem.h"
+
+#include "renderer.h"
+
+static thread_local JobSystem* s_System = nullptr;
+static thread_local unsigned int s_WorkerIndex = 0xFFFFFFFF;
+
+JobDeque::JobDeque()
+	: m_Top(0), m_Bottom(0)
+{
+	for (unsigned int i = 0; i < JOB_DEQUE_SIZE; i++)
+		m_Jobs[i].store(nullptr, std::memory_order_relaxed);
+}
+
+bool JobDeque::Push(Job* job)
+{
+	long long bottom = m_Bottom.load(std::memory_order_relaxed);
+	long long top = m_Top.load(std::memory_order_acquire);
+	if (bottom - top >= JOB_DEQUE_SIZE)
+		return false;
+
+	/* release: a thief that sees the new bottom sees the job's data */
+	m_Jobs[bottom & (JOB_DEQUE_SIZE - 1)].store(job, std::memory_order_relaxed);
+	m_Bottom.store(bottom + 1, std::memory_order_release);
+	return true;
+}
+
+Job* JobDeque::Pop()
+{
+	long long bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+	m_Bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long top = m_Top.load(std::memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		/* empty */
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = m_Jobs[bottom & (JOB_DEQUE_SIZE - 1)].load(std::memory_order_relaxed);
+	if (top == bottom)
+	{
+		/* the last job, a thief may be after it too */
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			job = nullptr;
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+Job* JobDeque::Steal()
+{
+	long long top = m_Top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long bottom = m_Bottom.load(std::memory_order_acquire);
+	if (top >= bottom)
+		return nullptr;
+
+	Job* job = m_Jobs[top & (JOB_DEQUE_SIZE - 1)].load(std::memory_order_relaxed);
+	if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return nullptr;
+	return job;
+}
+
+JobSystem::JobSystem(unsigned int threadCount)
+	: m_Available(0), m_Sleeping(0), m_Running(true)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::thread::hardware_concurrency();
+		threadCount = threadCount > 0 ? threadCount : 1;
+	}
+
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		std::unique_ptr<Worker> worker = std::make_unique<Worker>();
+		worker->pool = std::make_unique<Job[]>(JOB_POOL_SIZE);
+		for (unsigned int j = 0; j < JOB_POOL_SIZE; j++)
+			worker->pool[j].running.store(false, std::memory_order_relaxed);
+		worker->next = 0;
+		worker->random = 2463534242u + i * 7919u;
+		worker->executed = 0;
+		worker->stolen = 0;
+		m_Workers.push_back(std::move(worker));
+	}
+
+	/* the creating thread is worker 0, until we're gone */
+	m_PreviousSystem = s_System;
+	m_PreviousWorkerIndex = s_WorkerIndex;
+	s_System = this;
+	s_WorkerIndex = 0;
+	for (unsigned int i = 1; i < threadCount; i++)
+		m_Threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_Running = false;
+	}
+	m_WakeUp.notify_all();
+	for (std::thread& thread : m_Threads)
+		thread.join();
+
+	/* systems on one thread die in the reverse order they were made */
+	ASSERT(s_System == this);
+	s_System = m_PreviousSystem;
+	s_WorkerIndex = m_PreviousWorkerIndex;
+}
+
+unsigned int JobSystem::GetWorkerIndex()
+{
+	return s_WorkerIndex;
+}
+
+JobSystem* JobSystem::GetCurrent()
+{
+	return s_System;
+}
+
+Job* JobSystem::AllocateJob()
+{
+	ASSERT(s_System == this);
+
+	/* jobs don't finish in the order they were made (an old job can sit
+	   in the deque while its siblings' children come and go), so busy
+	   slots are skipped */
+	Worker& worker = *m_Workers[s_WorkerIndex];
+	for (unsigned int i = 0; i < JOB_POOL_SIZE; i++)
+	{
+		Job* job = &worker.pool[worker.next++ & (JOB_POOL_SIZE - 1)];
+		if (!job->running.load(std::memory_order_acquire))
+		{
+			job->running.store(true, std::memory_order_relaxed);
+			return job;
+		}
+	}
+
+	/* more than JOB_POOL_SIZE jobs of this thread are still in flight */
+	ASSERT(false);
+	return nullptr;
+}
+
+void JobSystem::Submit(Job* job)
+{
+	if (!m_Workers[s_WorkerIndex]->deque.Push(job))
+	{
+		/* deque full: no one would get to it sooner than we do */
+		Execute(job);
+		return;
+	}
+
+	m_Available.fetch_add(1, std::memory_order_seq_cst);
+	if (m_Sleeping.load(std::memory_order_seq_cst) > 0)
+	{
+		/* taking the lock orders us after a worker that is between
+		   checking m_Available and going to sleep */
+		{
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+		}
+		m_WakeUp.notify_one();
+	}
+}
+
+Job* JobSystem::FindJob(unsigned int index)
+{
+	Worker& worker = *m_Workers[index];
+	Job* job = worker.deque.Pop();
+	if (job)
+	{
+		m_Available.fetch_sub(1, std::memory_order_relaxed);
+		return job;
+	}
+
+	/* try every other worker once, starting at a random one */
+	unsigned int count = (unsigned int)m_Workers.size();
+	if (count < 2)
+		return nullptr;
+	worker.random ^= worker.random << 13;
+	worker.random ^= worker.random >> 17;
+	worker.random ^= worker.random << 5;
+	unsigned int start = worker.random % count;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int victim = (start + i) % count;
+		if (victim == index)
+			continue;
+		job = m_Workers[victim]->deque.Steal();
+		if (job)
+		{
+			m_Available.fetch_sub(1, std::memory_order_relaxed);
+			worker.stolen.fetch_add(1, std::memory_order_relaxed);
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+void JobSystem::Execute(Job* job)
+{
+	JobCounter* counter = job->counter;
+	job->function(*job);
+	m_Workers[s_WorkerIndex]->executed.fetch_add(1, std::memory_order_relaxed);
+	/* the slot can be handed out again before the counter drops, the
+	   job's data is already destroyed */
+	job->running.store(false, std::memory_order_release);
+	if (counter)
+		counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	ASSERT(s_System == this);
+
+	while (counter.pending.load(std::memory_order_acquire) > 0)
+	{
+		if (Job* job = FindJob(s_WorkerIndex))
+			Execute(job);
+		else
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::WorkerLoop(unsigned int index)
+{
+	s_System = this;
+	s_WorkerIndex = index;
+
+	unsigned int idle = 0;
+	while (m_Running.load(std::memory_order_relaxed))
+	{
+		if (Job* job = FindJob(index))
+		{
+			Execute(job);
+			idle = 0;
+			continue;
+		}
+
+		/* spin a little before sleeping, new jobs often come right away */
+		if (++idle < 64)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_Sleeping.fetch_add(1, std::memory_order_seq_cst);
+		while (m_Available.load(std::memory_order_seq_cst) <= 0 && m_Running)
+			m_WakeUp.wait(lock);
+		m_Sleeping.fetch_sub(1, std::memory_order_seq_cst);
+		idle = 0;
+	}
+}
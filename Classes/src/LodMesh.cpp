@@ -0,0 +1,45 @@
+#include "LodMesh.h"
+
+#include "renderer.h"
+#include "MeshLoader.h"
+#include "MeshSimplifier.h"
+
+LodMesh::LodMesh(const MeshData& data, unsigned int maxLevels, float reduction)
+	: m_VertexBuffer(data.vertices.data(), (unsigned int)(data.vertices.size() * sizeof(float)))
+{
+	unsigned int stride = data.layout.GetStride();
+	unsigned int vertexCount = (unsigned int)(data.vertices.size() * sizeof(float) / stride);
+
+	std::vector<LodLevel> levels;
+	MeshSimplifier::BuildLodChain(data.vertices.data(), vertexCount, stride, data.indices.data(),
+		(unsigned int)data.indices.size(), levels, maxLevels, reduction);
+
+	m_VertexArray.addBuffer(m_VertexBuffer, data.layout);
+	for (const LodLevel& level : levels)
+	{
+		m_Levels.emplace_back(new IndexBuffer(level.indices.data(), (unsigned int)level.indices.size()));
+		m_Errors.push_back(level.error);
+		m_TriangleCounts.push_back((unsigned int)level.indices.size() / 3);
+	}
+	/* full detail is what a plain Bind() of the vertex array draws */
+	m_Levels[0]->Bind();
+	m_VertexArray.Unbind();
+}
+
+unsigned int LodMesh::SelectLod(float distance, float pixelsPerUnit, unsigned int currentLevel,
+	float pixelError, float hysteresis) const
+{
+	return LodSelector::Select(m_Errors.data(), (unsigned int)m_Errors.size(), distance, pixelsPerUnit,
+		currentLevel, pixelError, hysteresis);
+}
+
+void LodMesh::Bind(unsigned int level) const
+{
+	m_VertexArray.Bind();
+	m_Levels[level]->Bind();
+}
+
+void LodMesh::Unbind() const
+{
+	m_VertexArray.Unbind();
+}
@@ -0,0 +1,110 @@
+#include "MappedFile.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& filepath)
+	: m_Data(nullptr), m_Size(0), m_FileHandle(nullptr), m_MappingHandle(nullptr)
+{
+	/* FILE_FLAG_SEQUENTIAL_SCAN lets the cache manager read ahead aggressively */
+	HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		std::cout << "Failed to open '" << filepath << "'" << std::endl;
+		return;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+	{
+		std::cout << "Failed to map '" << filepath << "'" << std::endl;
+		CloseHandle(file);
+		return;
+	}
+
+	m_Data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!m_Data)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return;
+	}
+
+	m_Size = (std::size_t)size.QuadPart;
+	m_FileHandle = file;
+	m_MappingHandle = mapping;
+}
+
+MappedFile::~MappedFile()
+{
+	if (m_Data)
+		UnmapViewOfFile(m_Data);
+	if (m_MappingHandle)
+		CloseHandle(m_MappingHandle);
+	if (m_FileHandle)
+		CloseHandle(m_FileHandle);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filepath)
+	: m_Data(nullptr), m_Size(0)
+{
+	int fd = open(filepath.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		std::cout << "Failed to open '" << filepath << "'" << std::endl;
+		return;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		close(fd);
+		return;
+	}
+
+	void* data = mmap(nullptr, (std::size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	/* the mapping keeps its own reference to the file */
+	close(fd);
+	if (data == MAP_FAILED)
+	{
+		std::cout << "Failed to map '" << filepath << "'" << std::endl;
+		return;
+	}
+
+	/* the whole file is about to be streamed to the GPU, start reading it now */
+	madvise(data, (std::size_t)st.st_size, MADV_SEQUENTIAL);
+	madvise(data, (std::size_t)st.st_size, MADV_WILLNEED);
+
+	m_Data = (const unsigned char*)data;
+	m_Size = (std::size_t)st.st_size;
+}
+
+MappedFile::~MappedFile()
+{
+	if (m_Data)
+		munmap((void*)m_Data, m_Size);
+}
+
+#endif
@@ -0,0 +1,37 @@
+#include "Mesh.h"
+
+#include "renderer.h"
+#include "MeshFile.h"
+#include "MeshLoader.h"
+
+Mesh::Mesh(const void* vertices, unsigned int size, const unsigned int* indices, unsigned int count,
+	const VertexBufferLayout& layout)
+	: m_VertexBuffer(vertices, size), m_IndexBuffer(indices, count)
+{
+	m_VertexArray.addBuffer(m_VertexBuffer, layout);
+	/* the element array binding is part of the vertex array state */
+	m_IndexBuffer.Bind();
+	m_VertexArray.Unbind();
+}
+
+/* MeshFile rejects vertex blobs over 4 GB, the size fits */
+Mesh::Mesh(const MeshFile& file)
+	: Mesh(file.GetVertexData(), (unsigned int)file.GetVertexSize(), file.GetIndexData(), file.GetIndexCount(), file.GetLayout())
+{
+}
+
+Mesh::Mesh(const MeshData& data)
+	: Mesh(data.vertices.data(), (unsigned int)(data.vertices.size() * sizeof(float)),
+		data.indices.data(), (unsigned int)data.indices.size(), data.layout)
+{
+}
+
+void Mesh::Bind() const
+{
+	m_VertexArray.Bind();
+}
+
+void Mesh::Unbind() const
+{
+	m_VertexArray.Unbind();
+}
@@ -0,0 +1,134 @@
+#include "MeshFile.h"
+
+#include <iostream>
+#include <fstream>
+#include <cfloat>
+#include <cstring>
+
+#include "renderer.h"
+
+static uint64_t AlignUp(uint64_t value)
+{
+	return (value + MESH_FILE_ALIGNMENT - 1) & ~(uint64_t)(MESH_FILE_ALIGNMENT - 1);
+}
+
+MeshFile::MeshFile(const std::string& filepath)
+	: m_File(filepath), m_Header(nullptr)
+{
+	if (!m_File.IsOpen())
+		return;
+
+	if (m_File.GetSize() < sizeof(MeshFileHeader))
+	{
+		std::cout << "'" << filepath << "' is too small to be a mesh file" << std::endl;
+		return;
+	}
+
+	const MeshFileHeader* header = (const MeshFileHeader*)m_File.GetData();
+	if (header->magic != MESH_FILE_MAGIC || header->version != MESH_FILE_VERSION)
+	{
+		std::cout << "'" << filepath << "' is not a version " << MESH_FILE_VERSION << " mesh file" << std::endl;
+		return;
+	}
+
+	/* blobs must lie inside the mapping, otherwise the upload reads past
+	   the end, compared without adding so huge values can't wrap around */
+	uint64_t fileSize = m_File.GetSize();
+	uint64_t indexSize = (uint64_t)header->indexCount * sizeof(unsigned int);
+	bool valid = header->elementCount <= MESH_FILE_MAX_ELEMENTS
+		&& header->vertexOffset <= fileSize && header->vertexSize <= fileSize - header->vertexOffset
+		&& header->indexOffset <= fileSize && indexSize <= fileSize - header->indexOffset
+		&& header->vertexSize <= 0xFFFFFFFF;	/* VertexBuffer sizes are 32 bit */
+
+	/* only types VertexBufferElement knows, anything else would assert */
+	for (unsigned int i = 0; valid && i < header->elementCount; i++)
+	{
+		const MeshFileElement& element = header->elements[i];
+		valid = (element.type == GL_FLOAT || element.type == GL_UNSIGNED_INT || element.type == GL_UNSIGNED_BYTE)
+			&& element.count >= 1 && element.count <= 16;
+	}
+	if (!valid)
+	{
+		std::cout << "'" << filepath << "' is truncated or corrupt" << std::endl;
+		return;
+	}
+
+	for (unsigned int i = 0; i < header->elementCount; i++)
+	{
+		const MeshFileElement& element = header->elements[i];
+		m_Layout.Push({ element.type, element.count, (unsigned char)element.normalized, std::string() });
+	}
+
+	if (m_Layout.GetStride() != header->stride)
+	{
+		std::cout << "'" << filepath << "' has a layout that doesn't match its stride" << std::endl;
+		return;
+	}
+
+	m_Header = header;
+}
+
+bool MeshFile::Write(const std::string& filepath, const void* vertices, unsigned int size,
+	const unsigned int* indices, unsigned int count, const VertexBufferLayout& layout)
+{
+	const auto& elements = layout.GetElements();
+	ASSERT(elements.size() <= MESH_FILE_MAX_ELEMENTS);
+
+	MeshFileHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = MESH_FILE_MAGIC;
+	header.version = MESH_FILE_VERSION;
+	header.stride = layout.GetStride();
+	header.elementCount = (uint32_t)elements.size();
+	for (unsigned int i = 0; i < elements.size(); i++)
+		header.elements[i] = { elements[i].type, elements[i].count, elements[i].normalized };
+
+	header.vertexOffset = AlignUp(sizeof(MeshFileHeader));
+	header.vertexSize = size;
+	header.indexOffset = AlignUp(header.vertexOffset + size);
+	header.indexCount = count;
+
+	/* bounds from the position attribute (first element, 2 or 3 floats) */
+	for (int axis = 0; axis < 3; axis++)
+	{
+		header.boundsMin[axis] = 0.0f;
+		header.boundsMax[axis] = 0.0f;
+	}
+	if (!elements.empty() && elements[0].type == GL_FLOAT && header.stride > 0)
+	{
+		unsigned int components = elements[0].count < 3 ? elements[0].count : 3;
+		unsigned int vertexCount = size / header.stride;
+		for (unsigned int axis = 0; axis < components; axis++)
+		{
+			header.boundsMin[axis] = FLT_MAX;
+			header.boundsMax[axis] = -FLT_MAX;
+		}
+		const unsigned char* vertex = (const unsigned char*)vertices;
+		for (unsigned int v = 0; v < vertexCount; v++, vertex += header.stride)
+		{
+			float position[3];
+			memcpy(position, vertex, components * sizeof(float));
+			for (unsigned int axis = 0; axis < components; axis++)
+			{
+				if (position[axis] < header.boundsMin[axis]) header.boundsMin[axis] = position[axis];
+				if (position[axis] > header.boundsMax[axis]) header.boundsMax[axis] = position[axis];
+			}
+		}
+	}
+
+	std::ofstream stream(filepath, std::ios::binary);
+	if (!stream)
+	{
+		std::cout << "Failed to create '" << filepath << "'" << std::endl;
+		return false;
+	}
+
+	static const char padding[MESH_FILE_ALIGNMENT] = {};
+	stream.write((const char*)&header, sizeof(header));
+	stream.write(padding, header.vertexOffset - sizeof(header));
+	stream.write((const char*)vertices, size);
+	stream.write(padding, header.indexOffset - (header.vertexOffset + size));
+	stream.write((const char*)indices, (std::streamsize)count * sizeof(unsigned int));
+
+	return (bool)stream;
+}
@@ -0,0 +1,1067 @@
+#include "MeshLoader.h"
+
+#include <iostream>
+#include <atomic>
+#include <functional>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+#include "renderer.h"
+#include "MappedFile.h"
+#include "JobSystem.h"
+
+/* ---------------------------------------------------------------------------
+   shared helpers
+   --------------------------------------------------------------------------- */
+
+/* runs task(0) .. task(count - 1) on the job system's workers
+	~ one job per task, idle workers steal, so uneven chunks balance
+	  themselves
+	~ the workers live as long as the JobSystem, a load no longer starts
+	  threads for every step */
+static void ParallelFor(unsigned int count, JobSystem& jobs, const std::function<void(unsigned int)>& task)
+{
+	jobs.ParallelFor(count, 1, [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; i++)
+			task(i);
+	});
+}
+
+struct TextRange
+{
+	const char* begin;
+	const char* end;
+};
+
+/* splits [begin, end) into roughly `count` ranges that all end on a line break */
+static std::vector<TextRange> SplitLines(const char* begin, const char* end, unsigned int count)
+{
+	std::vector<TextRange> ranges;
+	size_t step = (size_t)(end - begin) / count + 1;
+	const char* start = begin;
+	while (start < end)
+	{
+		const char* stop = (size_t)(end - start) > step ? start + step : end;
+		if (stop < end)
+		{
+			const char* newline = (const char*)memchr(stop, '\n', end - stop);
+			stop = newline ? newline + 1 : end;
+		}
+		ranges.push_back({ start, stop });
+		start = stop;
+	}
+	return ranges;
+}
+
+static inline const char* SkipSpaces(const char* p, const char* end)
+{
+	while (p < end && (*p == ' ' || *p == '\t'))
+		p++;
+	return p;
+}
+
+static inline const char* FindLineEnd(const char* p, const char* end)
+{
+	const char* newline = (const char*)memchr(p, '\n', end - p);
+	return newline ? newline : end;
+}
+
+/* from_chars doesn't skip whitespace or accept a leading '+' */
+static inline const char* ParseFloat(const char* p, const char* end, float& value)
+{
+	p = SkipSpaces(p, end);
+	if (p < end && *p == '+')
+		p++;
+	auto result = std::from_chars(p, end, value);
+	if (result.ec != std::errc())
+	{
+		value = 0.0f;
+		return p;
+	}
+	return result.ptr;
+}
+
+static inline const char* ParseInt(const char* p, const char* end, long long& value)
+{
+	p = SkipSpaces(p, end);
+	if (p < end && *p == '+')
+		p++;
+	auto result = std::from_chars(p, end, value);
+	if (result.ec != std::errc())
+	{
+		value = 0;
+		return p;
+	}
+	return result.ptr;
+}
+
+/* fan triangulation of one polygon into a triangle list */
+template<typename T>
+static void Triangulate(const std::vector<T>& polygon, std::vector<T>& triangles)
+{
+	for (size_t i = 2; i < polygon.size(); i++)
+	{
+		triangles.push_back(polygon[0]);
+		triangles.push_back(polygon[i - 1]);
+		triangles.push_back(polygon[i]);
+	}
+}
+
+bool MeshLoader::Load(const std::string& filepath, MeshData& mesh, unsigned int threadCount)
+{
+	/* a thread that already runs jobs keeps using its own system, a second
+	   one would only fight it for the cores */
+	if (JobSystem* current = JobSystem::GetCurrent())
+		return Load(filepath, mesh, *current);
+
+	JobSystem jobs(threadCount);
+	return Load(filepath, mesh, jobs);
+}
+
+bool MeshLoader::Load(const std::string& filepath, MeshData& mesh, JobSystem& jobs)
+{
+	size_t dot = filepath.find_last_of('.');
+	std::string extension = dot == std::string::npos ? "" : filepath.substr(dot + 1);
+	for (char& c : extension)
+		c = (char)tolower((unsigned char)c);
+
+	if (extension == "obj")
+		return LoadObj(filepath, mesh, jobs);
+	if (extension == "ply")
+		return LoadPly(filepath, mesh, jobs);
+
+	std::cout << "Unknown mesh format '" << filepath << "'" << std::endl;
+	return false;
+}
+
+/* ---------------------------------------------------------------------------
+   OBJ
+   --------------------------------------------------------------------------- */
+
+#define OBJ_MISSING INT_MIN
+
+/* relative bits: the index was negative in the file and is stored relative to
+   the start of its chunk until the chunk bases are known */
+#define OBJ_RELATIVE_POSITION 1
+#define OBJ_RELATIVE_TEXCOORD 2
+#define OBJ_RELATIVE_NORMAL 4
+
+struct ObjCorner
+{
+	int position, texcoord, normal;
+	int relative;
+
+	bool operator==(const ObjCorner& other) const
+	{
+		return position == other.position && texcoord == other.texcoord && normal == other.normal;
+	}
+};
+
+struct ObjChunk
+{
+	std::vector<float> positions, texcoords, normals;
+	std::vector<ObjCorner> corners; /* already triangulated */
+};
+
+/* turns an index as written in the file (1 based, negative = from the end) into
+   a 0 based index, chunk relative when negative */
+static inline int ResolveObjIndex(long long value, size_t localCount, int relativeBit, int& relative)
+{
+	if (value > 0)
+		return (int)(value - 1);
+	if (value < 0)
+	{
+		relative |= relativeBit;
+		return (int)((long long)localCount + value);
+	}
+	return OBJ_MISSING;
+}
+
+static void ParseObjChunk(const TextRange& range, ObjChunk& chunk)
+{
+	std::vector<ObjCorner> polygon;
+	const char* p = range.begin;
+	const char* end = range.end;
+	while (p < end)
+	{
+		p = SkipSpaces(p, end);
+		const char* lineEnd = FindLineEnd(p, end);
+
+		if (lineEnd - p >= 2 && p[0] == 'v')
+		{
+			float value;
+			if (p[1] == ' ' || p[1] == '\t')
+			{
+				const char* q = p + 2;
+				for (int i = 0; i < 3; i++) { q = ParseFloat(q, lineEnd, value); chunk.positions.push_back(value); }
+			}
+			else if (p[1] == 't')
+			{
+				const char* q = p + 2;
+				for (int i = 0; i < 2; i++) { q = ParseFloat(q, lineEnd, value); chunk.texcoords.push_back(value); }
+			}
+			else if (p[1] == 'n')
+			{
+				const char* q = p + 2;
+				for (int i = 0; i < 3; i++) { q = ParseFloat(q, lineEnd, value); chunk.normals.push_back(value); }
+			}
+		}
+		else if (lineEnd - p >= 2 && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+		{
+			polygon.clear();
+			const char* q = p + 2;
+			while (true)
+			{
+				q = SkipSpaces(q, lineEnd);
+				if (q >= lineEnd || *q == '\r' || *q == '#')
+					break;
+
+				ObjCorner corner = { OBJ_MISSING, OBJ_MISSING, OBJ_MISSING, 0 };
+				long long value;
+				q = ParseInt(q, lineEnd, value);
+				corner.position = ResolveObjIndex(value, chunk.positions.size() / 3, OBJ_RELATIVE_POSITION, corner.relative);
+				if (q < lineEnd && *q == '/')
+				{
+					q++;
+					if (q < lineEnd && *q != '/')
+					{
+						q = ParseInt(q, lineEnd, value);
+						corner.texcoord = ResolveObjIndex(value, chunk.texcoords.size() / 2, OBJ_RELATIVE_TEXCOORD, corner.relative);
+					}
+					if (q < lineEnd && *q == '/')
+					{
+						q = ParseInt(q + 1, lineEnd, value);
+						corner.normal = ResolveObjIndex(value, chunk.normals.size() / 3, OBJ_RELATIVE_NORMAL, corner.relative);
+					}
+				}
+				/* skip whatever is left of a malformed corner */
+				while (q < lineEnd && *q != ' ' && *q != '\t' && *q != '\r')
+					q++;
+				polygon.push_back(corner);
+			}
+			Triangulate(polygon, chunk.corners);
+		}
+
+		p = lineEnd + 1;
+	}
+}
+
+static inline uint32_t HashCorner(const ObjCorner& corner)
+{
+	uint32_t hash = (uint32_t)corner.position * 0x9E3779B1u;
+	hash ^= (uint32_t)corner.texcoord * 0x85EBCA77u + (hash << 6) + (hash >> 2);
+	hash ^= (uint32_t)corner.normal * 0xC2B2AE3Du + (hash << 6) + (hash >> 2);
+	return hash;
+}
+
+/* open addressing table mapping a corner to its vertex id inside one partition */
+class CornerTable
+{
+private:
+	std::vector<ObjCorner> m_Keys;		/* in id order, used to build the vertices */
+	std::vector<uint32_t> m_Slots;		/* id + 1, 0 = empty */
+	uint32_t m_Mask;
+public:
+	CornerTable()
+		: m_Slots(1024, 0), m_Mask(1023) {}
+
+	uint32_t Insert(const ObjCorner& corner, uint32_t hash)
+	{
+		/* keep the load factor under one half */
+		if (m_Keys.size() * 2 >= m_Slots.size())
+			Grow();
+
+		/* the low bits chose the partition, probe with the high ones */
+		for (uint32_t slot = (hash >> 8) & m_Mask;; slot = (slot + 1) & m_Mask)
+		{
+			uint32_t id = m_Slots[slot];
+			if (id == 0)
+			{
+				m_Keys.push_back(corner);
+				m_Slots[slot] = (uint32_t)m_Keys.size();
+				return (uint32_t)m_Keys.size() - 1;
+			}
+			if (m_Keys[id - 1] == corner)
+				return id - 1;
+		}
+	}
+
+	inline const std::vector<ObjCorner>& GetKeys() const { return m_Keys; }
+private:
+	void Grow()
+	{
+		m_Slots.assign(m_Slots.size() * 2, 0);
+		m_Mask = (uint32_t)m_Slots.size() - 1;
+		for (uint32_t id = 0; id < m_Keys.size(); id++)
+		{
+			uint32_t slot = (HashCorner(m_Keys[id]) >> 8) & m_Mask;
+			while (m_Slots[slot] != 0)
+				slot = (slot + 1) & m_Mask;
+			m_Slots[slot] = id + 1;
+		}
+	}
+};
+
+bool MeshLoader::LoadObj(const std::string& filepath, MeshData& mesh, unsigned int threadCount)
+{
+	if (JobSystem* current = JobSystem::GetCurrent())
+		return LoadObj(filepath, mesh, *current);
+
+	JobSystem jobs(threadCount);
+	return LoadObj(filepath, mesh, jobs);
+}
+
+bool MeshLoader::LoadObj(const std::string& filepath, MeshData& mesh, JobSystem& jobs)
+{
+	MappedFile file(filepath);
+	if (!file.IsOpen())
+		return false;
+
+	unsigned int threadCount = jobs.GetThreadCount();
+	const char* text = (const char*)file.GetData();
+
+	/* 1. parse newline aligned chunks in parallel
+		~ more chunks than threads so a slow chunk doesn't hold everyone up */
+	std::vector<TextRange> ranges = SplitLines(text, text + file.GetSize(), threadCount * 4);
+	std::vector<ObjChunk> chunks(ranges.size());
+	ParallelFor((unsigned int)ranges.size(), jobs, [&](unsigned int i)
+	{
+		ParseObjChunk(ranges[i], chunks[i]);
+	});
+
+	/* 2. every chunk only knew its own attribute counts, make them global */
+	std::vector<size_t> positionBase(chunks.size()), texcoordBase(chunks.size()), normalBase(chunks.size()), cornerBase(chunks.size());
+	size_t positionCount = 0, texcoordCount = 0, normalCount = 0, cornerCount = 0;
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		positionBase[i] = positionCount;	positionCount += chunks[i].positions.size() / 3;
+		texcoordBase[i] = texcoordCount;	texcoordCount += chunks[i].texcoords.size() / 2;
+		normalBase[i] = normalCount;		normalCount += chunks[i].normals.size() / 3;
+		cornerBase[i] = cornerCount;		cornerCount += chunks[i].corners.size();
+	}
+
+	if (cornerCount == 0)
+	{
+		std::cout << "'" << filepath << "' has no faces" << std::endl;
+		return false;
+	}
+
+	std::vector<float> positions(positionCount * 3), texcoords(texcoordCount * 2), normals(normalCount * 3);
+	std::vector<ObjCorner> corners(cornerCount);
+	std::atomic<bool> valid(true);
+	ParallelFor((unsigned int)chunks.size(), jobs, [&](unsigned int i)
+	{
+		ObjChunk& chunk = chunks[i];
+		std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + positionBase[i] * 3);
+		std::copy(chunk.texcoords.begin(), chunk.texcoords.end(), texcoords.begin() + texcoordBase[i] * 2);
+		std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + normalBase[i] * 3);
+
+		ObjCorner* out = corners.data() + cornerBase[i];
+		for (ObjCorner corner : chunk.corners)
+		{
+			if (corner.relative & OBJ_RELATIVE_POSITION) corner.position += (int)positionBase[i];
+			if (corner.relative & OBJ_RELATIVE_TEXCOORD) corner.texcoord += (int)texcoordBase[i];
+			if (corner.relative & OBJ_RELATIVE_NORMAL) corner.normal += (int)normalBase[i];
+			corner.relative = 0;
+
+			if (corner.position < 0 || (size_t)corner.position >= positionCount)
+				valid = false;
+			/* a broken texcoord/normal reference only loses that attribute */
+			if (corner.texcoord != OBJ_MISSING && (corner.texcoord < 0 || (size_t)corner.texcoord >= texcoordCount))
+				corner.texcoord = OBJ_MISSING;
+			if (corner.normal != OBJ_MISSING && (corner.normal < 0 || (size_t)corner.normal >= normalCount))
+				corner.normal = OBJ_MISSING;
+			*out++ = corner;
+		}
+
+		/* chunk memory isn't needed anymore */
+		chunk = ObjChunk();
+	});
+
+	if (!valid)
+	{
+		std::cout << "'" << filepath << "' references a missing position" << std::endl;
+		return false;
+	}
+
+	/* 3. deduplicate corners into vertices
+		~ corners are split into one partition per thread by hash, every
+		  partition owns its own table, so there is no locking
+		~ a counting pass buckets the corner indices by partition first,
+		  every partition then reads only its own corners
+		~ a vertex id is (partition base + id inside the partition) */
+	unsigned int partitionCount = threadCount;
+	unsigned int batchCount = (unsigned int)chunks.size();
+	size_t batchSize = (cornerCount + batchCount - 1) / batchCount;
+
+	/* counts[batch * partitionCount + partition] */
+	std::vector<uint32_t> hashes(cornerCount);
+	std::vector<size_t> counts((size_t)batchCount * partitionCount, 0);
+	ParallelFor(batchCount, jobs, [&](unsigned int batch)
+	{
+		size_t* count = &counts[(size_t)batch * partitionCount];
+		size_t first = batch * batchSize;
+		size_t last = std::min(first + batchSize, cornerCount);
+		for (size_t i = first; i < last; i++)
+		{
+			hashes[i] = HashCorner(corners[i]);
+			count[hashes[i] % partitionCount]++;
+		}
+	});
+
+	/* partition major prefix sum: a partition's corners end up contiguous
+	   and in file order, so vertex ids don't depend on scheduling */
+	std::vector<size_t> partitionFirst(partitionCount + 1);
+	size_t bucketed = 0;
+	for (unsigned int partition = 0; partition < partitionCount; partition++)
+	{
+		partitionFirst[partition] = bucketed;
+		for (unsigned int batch = 0; batch < batchCount; batch++)
+		{
+			size_t& count = counts[(size_t)batch * partitionCount + partition];
+			size_t first = bucketed;
+			bucketed += count;
+			count = first;
+		}
+	}
+	partitionFirst[partitionCount] = bucketed;
+
+	std::vector<uint32_t> order(cornerCount);
+	ParallelFor(batchCount, jobs, [&](unsigned int batch)
+	{
+		size_t* next = &counts[(size_t)batch * partitionCount];
+		size_t first = batch * batchSize;
+		size_t last = std::min(first + batchSize, cornerCount);
+		for (size_t i = first; i < last; i++)
+			order[next[hashes[i] % partitionCount]++] = (uint32_t)i;
+	});
+
+	std::vector<uint32_t> ids(cornerCount);
+	std::vector<CornerTable> tables(partitionCount);
+	ParallelFor(partitionCount, jobs, [&](unsigned int partition)
+	{
+		CornerTable& table = tables[partition];
+		for (size_t k = partitionFirst[partition]; k < partitionFirst[partition + 1]; k++)
+		{
+			uint32_t i = order[k];
+			ids[i] = table.Insert(corners[i], hashes[i]);
+		}
+	});
+
+	std::vector<uint32_t> partitionBase(partitionCount);
+	size_t vertexCount = 0;
+	for (unsigned int partition = 0; partition < partitionCount; partition++)
+	{
+		partitionBase[partition] = (uint32_t)vertexCount;
+		vertexCount += tables[partition].GetKeys().size();
+	}
+
+	/* 4. build the index and vertex buffers */
+	bool hasTexcoords = texcoordCount > 0;
+	bool hasNormals = normalCount > 0;
+	unsigned int stride = 3 + (hasTexcoords ? 2 : 0) + (hasNormals ? 3 : 0);
+
+	mesh.indices.resize(cornerCount);
+	ParallelFor(batchCount, jobs, [&](unsigned int batch)
+	{
+		size_t first = batch * batchSize;
+		size_t last = std::min(first + batchSize, cornerCount);
+		for (size_t i = first; i < last; i++)
+			mesh.indices[i] = partitionBase[hashes[i] % partitionCount] + ids[i];
+	});
+
+	mesh.vertices.resize(vertexCount * stride);
+	ParallelFor(partitionCount, jobs, [&](unsigned int partition)
+	{
+		const std::vector<ObjCorner>& keys = tables[partition].GetKeys();
+		float* out = mesh.vertices.data() + (size_t)partitionBase[partition] * stride;
+		for (const ObjCorner& corner : keys)
+		{
+			memcpy(out, &positions[(size_t)corner.position * 3], 3 * sizeof(float));
+			out += 3;
+			if (hasTexcoords)
+			{
+				if (corner.texcoord != OBJ_MISSING)
+					memcpy(out, &texcoords[(size_t)corner.texcoord * 2], 2 * sizeof(float));
+				else
+					out[0] = out[1] = 0.0f;
+				out += 2;
+			}
+			if (hasNormals)
+			{
+				if (corner.normal != OBJ_MISSING)
+					memcpy(out, &normals[(size_t)corner.normal * 3], 3 * sizeof(float));
+				else
+					out[0] = out[1] = out[2] = 0.0f;
+				out += 3;
+			}
+		}
+	});
+
+	mesh.layout = VertexBufferLayout();
+	mesh.layout.Push<float>(3, "position");
+	if (hasTexcoords)
+		mesh.layout.Push<float>(2, "texCoord");
+	if (hasNormals)
+		mesh.layout.Push<float>(3, "normal");
+
+	return true;
+}
+
+/* ---------------------------------------------------------------------------
+   PLY
+   --------------------------------------------------------------------------- */
+
+enum class PlyType
+{
+	NONE, INT8, UINT8, INT16, UINT16, INT32, UINT32, FLOAT32, FLOAT64
+};
+
+struct PlyProperty
+{
+	std::string name;
+	PlyType type;
+	PlyType countType;	/* NONE unless this is a list */
+	int slot;			/* float offset inside the output vertex, -1 = ignored */
+	float scale;		/* 1/255 for 8 bit colors */
+};
+
+struct PlyElement
+{
+	std::string name;
+	size_t count;
+	std::vector<PlyProperty> properties;
+};
+
+static PlyType GetPlyType(const std::string& name)
+{
+	if (name == "char" || name == "int8")		return PlyType::INT8;
+	if (name == "uchar" || name == "uint8")		return PlyType::UINT8;
+	if (name == "short" || name == "int16")		return PlyType::INT16;
+	if (name == "ushort" || name == "uint16")	return PlyType::UINT16;
+	if (name == "int" || name == "int32")		return PlyType::INT32;
+	if (name == "uint" || name == "uint32")		return PlyType::UINT32;
+	if (name == "float" || name == "float32")	return PlyType::FLOAT32;
+	if (name == "double" || name == "float64")	return PlyType::FLOAT64;
+	return PlyType::NONE;
+}
+
+static size_t GetPlyTypeSize(PlyType type)
+{
+	switch (type)
+	{
+		case PlyType::INT8: case PlyType::UINT8:	return 1;
+		case PlyType::INT16: case PlyType::UINT16:	return 2;
+		case PlyType::INT32: case PlyType::UINT32:	return 4;
+		case PlyType::FLOAT32:						return 4;
+		case PlyType::FLOAT64:						return 8;
+		default:									return 0;
+	}
+}
+
+/* reads one binary value, swapping bytes for big endian files */
+static double ReadPlyValue(const unsigned char* p, PlyType type, bool swap)
+{
+	unsigned char bytes[8];
+	size_t size = GetPlyTypeSize(type);
+	for (size_t i = 0; i < size; i++)
+		bytes[i] = swap ? p[size - 1 - i] : p[i];
+
+	switch (type)
+	{
+		case PlyType::INT8:		{ int8_t v;   memcpy(&v, bytes, 1); return v; }
+		case PlyType::UINT8:	{ uint8_t v;  memcpy(&v, bytes, 1); return v; }
+		case PlyType::INT16:	{ int16_t v;  memcpy(&v, bytes, 2); return v; }
+		case PlyType::UINT16:	{ uint16_t v; memcpy(&v, bytes, 2); return v; }
+		case PlyType::INT32:	{ int32_t v;  memcpy(&v, bytes, 4); return v; }
+		case PlyType::UINT32:	{ uint32_t v; memcpy(&v, bytes, 4); return v; }
+		case PlyType::FLOAT32:	{ float v;    memcpy(&v, bytes, 4); return v; }
+		case PlyType::FLOAT64:	{ double v;   memcpy(&v, bytes, 8); return v; }
+		default:				return 0.0;
+	}
+}
+
+/* size of one record of an element in a binary file, 0 when it contains lists */
+static size_t GetPlyRecordSize(const PlyElement& element)
+{
+	size_t size = 0;
+	for (const PlyProperty& property : element.properties)
+	{
+		if (property.countType != PlyType::NONE)
+			return 0;
+		size += GetPlyTypeSize(property.type);
+	}
+	return size;
+}
+
+/* walks over one binary record that may contain lists */
+static const unsigned char* SkipPlyRecord(const unsigned char* p, const unsigned char* end, const PlyElement& element, bool swap)
+{
+	for (const PlyProperty& property : element.properties)
+	{
+		/* compared against what's left, a huge count can't wrap p around */
+		size_t size = GetPlyTypeSize(property.countType != PlyType::NONE ? property.countType : property.type);
+		if (size > (size_t)(end - p))
+			return nullptr;
+		if (property.countType != PlyType::NONE)
+		{
+			size_t count = (size_t)ReadPlyValue(p, property.countType, swap);
+			p += size;
+			if (count > (size_t)(end - p) / GetPlyTypeSize(property.type))
+				return nullptr;
+			p += count * GetPlyTypeSize(property.type);
+		}
+		else
+			p += size;
+	}
+	return p;
+}
+
+/* returns the end of the text lines [p, ...) holding `count` records */
+static const char* SkipLines(const char* p, const char* end, size_t count)
+{
+	for (size_t i = 0; i < count && p < end; i++)
+		p = FindLineEnd(p, end) + 1;
+	return p < end ? p : end;
+}
+
+bool MeshLoader::LoadPly(const std::string& filepath, MeshData& mesh, unsigned int threadCount)
+{
+	if (JobSystem* current = JobSystem::GetCurrent())
+		return LoadPly(filepath, mesh, *current);
+
+	JobSystem jobs(threadCount);
+	return LoadPly(filepath, mesh, jobs);
+}
+
+bool MeshLoader::LoadPly(const std::string& filepath, MeshData& mesh, JobSystem& jobs)
+{
+	MappedFile file(filepath);
+	if (!file.IsOpen())
+		return false;
+
+	unsigned int threadCount = jobs.GetThreadCount();
+	const char* text = (const char*)file.GetData();
+	const char* end = text + file.GetSize();
+
+	/* header, always text */
+	if (file.GetSize() < 4 || memcmp(text, "ply", 3) != 0)
+	{
+		std::cout << "'" << filepath << "' is not a PLY file" << std::endl;
+		return false;
+	}
+
+	enum class PlyFormat { ASCII, BINARY_LITTLE_ENDIAN, BINARY_BIG_ENDIAN };
+	PlyFormat format = PlyFormat::ASCII;
+	std::vector<PlyElement> elements;
+	const char* body = nullptr;
+
+	const char* p = FindLineEnd(text, end) + 1;
+	while (p < end)
+	{
+		const char* lineEnd = FindLineEnd(p, end);
+		std::string line(p, lineEnd);
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		p = lineEnd + 1;
+
+		std::vector<std::string> words;
+		for (size_t start = 0; start < line.size();)
+		{
+			size_t stop = line.find(' ', start);
+			if (stop == std::string::npos)
+				stop = line.size();
+			if (stop > start)
+				words.push_back(line.substr(start, stop - start));
+			start = stop + 1;
+		}
+		if (words.empty())
+			continue;
+
+		if (words[0] == "end_header")
+		{
+			body = p;
+			break;
+		}
+		else if (words[0] == "format" && words.size() >= 2)
+		{
+			if (words[1] == "binary_little_endian")
+				format = PlyFormat::BINARY_LITTLE_ENDIAN;
+			else if (words[1] == "binary_big_endian")
+				format = PlyFormat::BINARY_BIG_ENDIAN;
+		}
+		else if (words[0] == "element" && words.size() >= 3)
+		{
+			unsigned long long count = 0;
+			const char* first = words[2].data();
+			const char* last = first + words[2].size();
+			std::from_chars_result result = std::from_chars(first, last, count);
+			if (result.ec != std::errc() || result.ptr != last)
+			{
+				std::cout << "'" << filepath << "' has a bad element count '" << words[2] << "'" << std::endl;
+				return false;
+			}
+			elements.push_back({ words[1], (size_t)count, {} });
+		}
+		else if (words[0] == "property" && !elements.empty())
+		{
+			if (words.size() >= 5 && words[1] == "list")
+				elements.back().properties.push_back({ words[4], GetPlyType(words[3]), GetPlyType(words[2]), -1, 1.0f });
+			else if (words.size() >= 3)
+				elements.back().properties.push_back({ words[2], GetPlyType(words[1]), PlyType::NONE, -1, 1.0f });
+		}
+	}
+
+	if (!body)
+	{
+		std::cout << "'" << filepath << "' has no end_header" << std::endl;
+		return false;
+	}
+
+	PlyElement* vertexElement = nullptr;
+	PlyElement* faceElement = nullptr;
+	for (PlyElement& element : elements)
+	{
+		for (const PlyProperty& property : element.properties)
+		{
+			if (property.type == PlyType::NONE || (property.countType == PlyType::NONE && GetPlyTypeSize(property.type) == 0))
+			{
+				std::cout << "'" << filepath << "' has a property of unknown type" << std::endl;
+				return false;
+			}
+		}
+		if (element.name == "vertex")
+			vertexElement = &element;
+		else if (element.name == "face")
+			faceElement = &element;
+	}
+
+	if (!vertexElement || !faceElement)
+	{
+		std::cout << "'" << filepath << "' needs vertex and face elements" << std::endl;
+		return false;
+	}
+
+	/* map vertex properties onto position [texcoord] [normal] [color] */
+	bool hasTexcoords = false, hasNormals = false, hasColors = false;
+	for (const PlyProperty& property : vertexElement->properties)
+	{
+		const std::string& name = property.name;
+		if (name == "u" || name == "s" || name == "texture_u" || name == "v" || name == "t" || name == "texture_v")
+			hasTexcoords = true;
+		else if (name == "nx" || name == "ny" || name == "nz")
+			hasNormals = true;
+		else if (name == "red" || name == "green" || name == "blue" || name == "alpha")
+			hasColors = true;
+	}
+
+	int texcoordSlot = 3;
+	int normalSlot = texcoordSlot + (hasTexcoords ? 2 : 0);
+	int colorSlot = normalSlot + (hasNormals ? 3 : 0);
+	unsigned int stride = colorSlot + (hasColors ? 4 : 0);
+	bool hasAlpha = false;
+
+	for (PlyProperty& property : vertexElement->properties)
+	{
+		const std::string& name = property.name;
+		if (property.countType != PlyType::NONE)
+			continue;
+		if (name == "x") property.slot = 0;
+		else if (name == "y") property.slot = 1;
+		else if (name == "z") property.slot = 2;
+		else if (name == "u" || name == "s" || name == "texture_u") property.slot = texcoordSlot;
+		else if (name == "v" || name == "t" || name == "texture_v") property.slot = texcoordSlot + 1;
+		else if (name == "nx") property.slot = normalSlot;
+		else if (name == "ny") property.slot = normalSlot + 1;
+		else if (name == "nz") property.slot = normalSlot + 2;
+		else if (name == "red") property.slot = colorSlot;
+		else if (name == "green") property.slot = colorSlot + 1;
+		else if (name == "blue") property.slot = colorSlot + 2;
+		else if (name == "alpha") { property.slot = colorSlot + 3; hasAlpha = true; }
+
+		if (property.slot >= colorSlot && hasColors && (property.type == PlyType::UINT8 || property.type == PlyType::INT8))
+			property.scale = 1.0f / 255.0f;
+	}
+
+	const PlyProperty* indexProperty = nullptr;
+	for (const PlyProperty& property : faceElement->properties)
+	{
+		if (property.countType != PlyType::NONE && (property.name == "vertex_indices" || property.name == "vertex_index"))
+			indexProperty = &property;
+	}
+	if (!indexProperty)
+	{
+		std::cout << "'" << filepath << "' has faces without vertex_indices" << std::endl;
+		return false;
+	}
+
+	/* every record takes at least a few bytes (ASCII: a digit and a
+	   separator per value), counts the body can't hold are corrupt and
+	   must not size the arrays below */
+	size_t bodySize = (size_t)(end - body);
+	for (const PlyElement& element : elements)
+	{
+		size_t minimumSize = 0;
+		for (const PlyProperty& property : element.properties)
+		{
+			if (format == PlyFormat::ASCII)
+				minimumSize += 2;
+			else
+				minimumSize += GetPlyTypeSize(property.countType != PlyType::NONE ? property.countType : property.type);
+		}
+		if (minimumSize == 0)
+			minimumSize = 1;
+		if (element.count > bodySize / minimumSize)
+		{
+			std::cout << "'" << filepath << "' is truncated or has a bad '" << element.name << "' count" << std::endl;
+			return false;
+		}
+		bodySize -= element.count * minimumSize;
+	}
+
+	size_t vertexCount = vertexElement->count;
+	mesh.vertices.assign(vertexCount * stride, 0.0f);
+	if (hasColors && !hasAlpha)
+	{
+		for (size_t v = 0; v < vertexCount; v++)
+			mesh.vertices[v * stride + colorSlot + 3] = 1.0f;
+	}
+	mesh.indices.clear();
+
+	if (format == PlyFormat::ASCII)
+	{
+		const char* q = body;
+		for (PlyElement& element : elements)
+		{
+			const char* sectionEnd = SkipLines(q, end, element.count);
+
+			if (&element == vertexElement)
+			{
+				/* vertex lines are independent, parse chunks in parallel into
+				   their own buffers and copy them into place afterwards */
+				std::vector<TextRange> ranges = SplitLines(q, sectionEnd, threadCount * 4);
+				std::vector<std::vector<float>> chunks(ranges.size());
+				ParallelFor((unsigned int)ranges.size(), jobs, [&](unsigned int i)
+				{
+					std::vector<float>& out = chunks[i];
+					std::vector<float> vertex(stride);
+					for (const char* r = ranges[i].begin; r < ranges[i].end;)
+					{
+						const char* lineEnd = FindLineEnd(r, ranges[i].end);
+						const char* s = SkipSpaces(r, lineEnd);
+						if (s < lineEnd && *s != '\r')
+						{
+							vertex.assign(stride, 0.0f);
+							if (hasColors && !hasAlpha)
+								vertex[colorSlot + 3] = 1.0f;
+							for (const PlyProperty& property : element.properties)
+							{
+								float value;
+								if (property.countType != PlyType::NONE)
+								{
+									long long count;
+									s = ParseInt(s, lineEnd, count);
+									for (long long k = 0; k < count && s < lineEnd; k++)
+										s = ParseFloat(s, lineEnd, value);
+									continue;
+								}
+								s = ParseFloat(s, lineEnd, value);
+								if (property.slot >= 0)
+									vertex[property.slot] = value * property.scale;
+							}
+							out.insert(out.end(), vertex.begin(), vertex.end());
+						}
+						r = lineEnd + 1;
+					}
+				});
+
+				size_t offset = 0;
+				for (const std::vector<float>& chunk : chunks)
+				{
+					size_t count = std::min(chunk.size(), mesh.vertices.size() - offset);
+					memcpy(mesh.vertices.data() + offset, chunk.data(), count * sizeof(float));
+					offset += count;
+				}
+			}
+			else if (&element == faceElement)
+			{
+				std::vector<TextRange> ranges = SplitLines(q, sectionEnd, threadCount * 4);
+				std::vector<std::vector<unsigned int>> chunks(ranges.size());
+				ParallelFor((unsigned int)ranges.size(), jobs, [&](unsigned int i)
+				{
+					std::vector<unsigned int> polygon;
+					for (const char* r = ranges[i].begin; r < ranges[i].end;)
+					{
+						const char* lineEnd = FindLineEnd(r, ranges[i].end);
+						const char* s = r;
+						for (const PlyProperty& property : element.properties)
+						{
+							long long value;
+							if (property.countType == PlyType::NONE)
+							{
+								float ignored;
+								s = ParseFloat(s, lineEnd, ignored);
+								continue;
+							}
+							long long count;
+							s = ParseInt(s, lineEnd, count);
+							if (&property == indexProperty)
+								polygon.clear();
+							for (long long k = 0; k < count && s < lineEnd; k++)
+							{
+								s = ParseInt(s, lineEnd, value);
+								if (&property == indexProperty)
+									polygon.push_back((unsigned int)value);
+							}
+							if (&property == indexProperty)
+								Triangulate(polygon, chunks[i]);
+						}
+						r = lineEnd + 1;
+					}
+				});
+
+				size_t total = 0;
+				for (const std::vector<unsigned int>& chunk : chunks)
+					total += chunk.size();
+				mesh.indices.reserve(total);
+				for (const std::vector<unsigned int>& chunk : chunks)
+					mesh.indices.insert(mesh.indices.end(), chunk.begin(), chunk.end());
+			}
+
+			q = sectionEnd;
+		}
+	}
+	else
+	{
+		bool swap = format == PlyFormat::BINARY_BIG_ENDIAN;
+		const unsigned char* q = (const unsigned char*)body;
+		const unsigned char* bytesEnd = (const unsigned char*)end;
+		for (PlyElement& element : elements)
+		{
+			size_t recordSize = GetPlyRecordSize(element);
+
+			if (&element == vertexElement && recordSize > 0)
+			{
+				if (element.count > (size_t)(bytesEnd - q) / recordSize)
+				{
+					std::cout << "'" << filepath << "' is truncated" << std::endl;
+					return false;
+				}
+
+				/* fixed size records, every batch converts its own range in place */
+				const unsigned char* records = q;
+				unsigned int batchCount = threadCount * 4;
+				size_t batchSize = (element.count + batchCount - 1) / batchCount;
+				ParallelFor(batchCount, jobs, [&](unsigned int batch)
+				{
+					size_t first = batch * batchSize;
+					size_t last = std::min(first + batchSize, element.count);
+					for (size_t v = first; v < last; v++)
+					{
+						const unsigned char* record = records + v * recordSize;
+						float* out = mesh.vertices.data() + v * stride;
+						for (const PlyProperty& property : element.properties)
+						{
+							if (property.slot >= 0)
+								out[property.slot] = (float)ReadPlyValue(record, property.type, swap) * property.scale;
+							record += GetPlyTypeSize(property.type);
+						}
+					}
+				});
+				q += recordSize * element.count;
+			}
+			else if (&element == faceElement)
+			{
+				/* variable length lists, has to be walked in order, running
+				   out of bytes anywhere fails the whole load (q = nullptr) */
+				std::vector<unsigned int> polygon;
+				for (size_t f = 0; f < element.count && q; f++)
+				{
+					for (const PlyProperty& property : element.properties)
+					{
+						size_t valueSize = GetPlyTypeSize(property.type);
+						if (property.countType == PlyType::NONE)
+						{
+							if (valueSize > (size_t)(bytesEnd - q))
+							{
+								q = nullptr;
+								break;
+							}
+							q += valueSize;
+							continue;
+						}
+						size_t countSize = GetPlyTypeSize(property.countType);
+						if (countSize > (size_t)(bytesEnd - q))
+						{
+							q = nullptr;
+							break;
+						}
+						size_t count = (size_t)ReadPlyValue(q, property.countType, swap);
+						q += countSize;
+						if (count > (size_t)(bytesEnd - q) / valueSize)
+						{
+							q = nullptr;
+							break;
+						}
+						if (&property == indexProperty)
+						{
+							polygon.clear();
+							for (size_t k = 0; k < count; k++)
+								polygon.push_back((unsigned int)ReadPlyValue(q + k * valueSize, property.type, swap));
+							Triangulate(polygon, mesh.indices);
+						}
+						q += count * valueSize;
+					}
+				}
+			}
+			else
+			{
+				/* elements we don't use (or a vertex element with lists, which
+				   isn't worth supporting) */
+				if (recordSize > 0)
+					q += recordSize * element.count;
+				else
+				{
+					for (size_t r = 0; r < element.count && q; r++)
+						q = SkipPlyRecord(q, bytesEnd, element, swap);
+				}
+				if (&element == vertexElement)
+				{
+					std::cout << "'" << filepath << "' has list properties on its vertices" << std::endl;
+					return false;
+				}
+			}
+
+			if (!q || q > bytesEnd)
+			{
+				std::cout << "'" << filepath << "' is truncated" << std::endl;
+				return false;
+			}
+		}
+	}
+
+	/* PLY is already indexed, there is nothing to deduplicate, only check */
+	for (unsigned int index : mesh.indices)
+	{
+		if (index >= vertexCount)
+		{
+			std::cout << "'" << filepath << "' references a missing vertex" << std::endl;
+			return false;
+		}
+	}
+
+	mesh.layout = VertexBufferLayout();
+	mesh.layout.Push<float>(3, "position");
+	if (hasTexcoords)
+		mesh.layout.Push<float>(2, "texCoord");
+	if (hasNormals)
+		mesh.layout.Push<float>(3, "normal");
+	if (hasColors)
+		mesh.layout.Push<float>(4, "color");
+
+	return true;
+}
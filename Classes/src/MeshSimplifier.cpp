@@ -0,0 +1,333 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <float.h>
+#include <unordered_map>
+
+/* symmetric 4x4 matrix of a sum of planes, weighted by triangle area,
+   error(p) = area weighted mean of the squared distances of p to the planes */
+struct Quadric
+{
+	double a00, a01, a02, a11, a12, a22;
+	double b0, b1, b2;
+	double c;
+	double weight;
+
+	void AddPlane(double x, double y, double z, double d, double weight)
+	{
+		a00 += weight * x * x; a01 += weight * x * y; a02 += weight * x * z;
+		a11 += weight * y * y; a12 += weight * y * z; a22 += weight * z * z;
+		b0 += weight * x * d; b1 += weight * y * d; b2 += weight * z * d;
+		c += weight * d * d;
+		this->weight += weight;
+	}
+
+	void Add(const Quadric& other)
+	{
+		a00 += other.a00; a01 += other.a01; a02 += other.a02;
+		a11 += other.a11; a12 += other.a12; a22 += other.a22;
+		b0 += other.b0; b1 += other.b1; b2 += other.b2;
+		c += other.c;
+		weight += other.weight;
+	}
+
+	double Evaluate(const float* p) const
+	{
+		double x = p[0], y = p[1], z = p[2];
+		double result = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z
+			+ a11 * y * y + 2.0 * a12 * y * z + a22 * z * z
+			+ 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+		return result > 0.0 && weight > 0.0 ? result / weight : 0.0;
+	}
+};
+
+struct Collapse
+{
+	unsigned int from, to;
+	double cost;
+};
+
+static inline const float* Position(const float* vertices, unsigned int stride, unsigned int index)
+{
+	return (const float*)((const char*)vertices + (size_t)index * stride);
+}
+
+static inline unsigned long long EdgeKey(unsigned int a, unsigned int b)
+{
+	return a < b ? ((unsigned long long)a << 32 | b) : ((unsigned long long)b << 32 | a);
+}
+
+static void Normal(const float* a, const float* b, const float* c, float* out)
+{
+	float e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+	float e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+	out[0] = e0[1] * e1[2] - e0[2] * e1[1];
+	out[1] = e0[2] * e1[0] - e0[0] * e1[2];
+	out[2] = e0[0] * e1[1] - e0[1] * e1[0];
+}
+
+float MeshSimplifier::Simplify(const float* vertices, unsigned int vertexCount, unsigned int stride,
+	const unsigned int* indices, unsigned int indexCount, unsigned int targetIndexCount, float maxError,
+	std::vector<unsigned int>& result)
+{
+	result.assign(indices, indices + indexCount - indexCount % 3);
+	if (result.size() <= targetIndexCount)
+		return 0.0f;
+
+	/* vertices sharing a position: the first one stands for all of them */
+	std::vector<unsigned int> canonical(vertexCount);
+	std::vector<unsigned char> seam(vertexCount, 0);
+	{
+		struct PositionHash
+		{
+			size_t operator()(const std::pair<unsigned long long, unsigned int>& key) const
+			{
+				return (size_t)(key.first * 0x9E3779B97F4A7C15ull ^ key.second * 0xC2B2AE3D27D4EB4Full);
+			}
+		};
+		std::unordered_map<std::pair<unsigned long long, unsigned int>, unsigned int, PositionHash> positions;
+		positions.reserve(vertexCount);
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			unsigned int bits[3];
+			memcpy(bits, Position(vertices, stride, i), sizeof(bits));
+			std::pair<unsigned long long, unsigned int> key((unsigned long long)bits[0] << 32 | bits[1], bits[2]);
+			auto inserted = positions.emplace(key, i);
+			canonical[i] = inserted.first->second;
+			if (!inserted.second)
+			{
+				seam[i] = 1;
+				seam[canonical[i]] = 1;
+			}
+		}
+	}
+
+	/* an edge with only one triangle is an open border, both ends stay */
+	std::vector<unsigned char> locked(seam);
+	{
+		std::unordered_map<unsigned long long, unsigned int> edgeUse;
+		edgeUse.reserve(result.size());
+		for (size_t i = 0; i < result.size(); i += 3)
+			for (int e = 0; e < 3; e++)
+				edgeUse[EdgeKey(canonical[result[i + e]], canonical[result[i + (e + 1) % 3]])]++;
+		for (const auto& edge : edgeUse)
+		{
+			if (edge.second == 1)
+			{
+				unsigned int a = (unsigned int)(edge.first >> 32), b = (unsigned int)edge.first;
+				for (unsigned int v : { a, b })
+					locked[v] = 1;
+			}
+		}
+		/* locks were set on the canonical vertex, spread them to the copies */
+		for (unsigned int i = 0; i < vertexCount; i++)
+			locked[i] |= locked[canonical[i]];
+	}
+
+	std::vector<Quadric> quadrics(vertexCount, Quadric());
+	for (size_t i = 0; i < result.size(); i += 3)
+	{
+		const float* p0 = Position(vertices, stride, result[i]);
+		const float* p1 = Position(vertices, stride, result[i + 1]);
+		const float* p2 = Position(vertices, stride, result[i + 2]);
+		float n[3];
+		Normal(p0, p1, p2, n);
+		double length = sqrt((double)n[0] * n[0] + (double)n[1] * n[1] + (double)n[2] * n[2]);
+		if (length == 0.0)
+			continue;
+		double x = n[0] / length, y = n[1] / length, z = n[2] / length;
+		double d = -(x * p0[0] + y * p0[1] + z * p0[2]);
+		for (int corner = 0; corner < 3; corner++)
+			quadrics[result[i + corner]].AddPlane(x, y, z, d, length * 0.5);
+	}
+
+	double maxCost = (double)maxError * maxError;
+	double worstCost = 0.0;
+	std::vector<unsigned int> remap(vertexCount);
+	std::vector<unsigned char> touched(vertexCount);
+	std::vector<unsigned int> adjacencyOffset(vertexCount + 1), adjacency;
+	std::vector<unsigned long long> edges;
+	std::vector<Collapse> collapses;
+
+	/* each pass collapses as many edges as it can without two collapses
+	   touching the same triangles, then rebuilds everything */
+	while (result.size() > targetIndexCount)
+	{
+		/* vertex -> triangles */
+		std::fill(adjacencyOffset.begin(), adjacencyOffset.end(), 0);
+		for (unsigned int index : result)
+			adjacencyOffset[index + 1]++;
+		for (unsigned int i = 0; i < vertexCount; i++)
+			adjacencyOffset[i + 1] += adjacencyOffset[i];
+		adjacency.resize(result.size());
+		{
+			std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+			for (size_t i = 0; i < result.size(); i++)
+				adjacency[fill[result[i]]++] = (unsigned int)(i / 3);
+		}
+
+		edges.clear();
+		for (size_t i = 0; i < result.size(); i += 3)
+			for (int e = 0; e < 3; e++)
+				edges.push_back(EdgeKey(result[i + e], result[i + (e + 1) % 3]));
+		std::sort(edges.begin(), edges.end());
+		edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+		collapses.clear();
+		for (unsigned long long edge : edges)
+		{
+			unsigned int a = (unsigned int)(edge >> 32), b = (unsigned int)edge;
+			Quadric q = quadrics[a];
+			q.Add(quadrics[b]);
+			/* removing a vertex moves it onto the other end, which has to be
+			   free of seams so its attributes fit every triangle it lands in */
+			double costAB = !locked[a] && !seam[b] ? q.Evaluate(Position(vertices, stride, b)) : DBL_MAX;
+			double costBA = !locked[b] && !seam[a] ? q.Evaluate(Position(vertices, stride, a)) : DBL_MAX;
+			if (costAB == DBL_MAX && costBA == DBL_MAX)
+				continue;
+			if (costAB <= costBA)
+				collapses.push_back({ a, b, costAB });
+			else
+				collapses.push_back({ b, a, costBA });
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+		for (unsigned int i = 0; i < vertexCount; i++)
+			remap[i] = i;
+		std::fill(touched.begin(), touched.end(), 0);
+
+		size_t triangleCount = result.size() / 3, targetTriangles = targetIndexCount / 3;
+		unsigned int collapsed = 0;
+		for (const Collapse& collapse : collapses)
+		{
+			if (triangleCount <= targetTriangles || collapse.cost > maxCost)
+				break;
+			unsigned int from = collapse.from, to = collapse.to;
+			if (touched[from] || touched[to])
+				continue;
+
+			/* the triangles that keep existing must not turn over */
+			bool flips = false;
+			unsigned int removed = 0;
+			const float* target = Position(vertices, stride, to);
+			for (unsigned int j = adjacencyOffset[from]; j < adjacencyOffset[from + 1] && !flips; j++)
+			{
+				const unsigned int* triangle = &result[adjacency[j] * 3];
+				if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+				{
+					removed++;
+					continue;
+				}
+				const float* before[3], *after[3];
+				for (int corner = 0; corner < 3; corner++)
+				{
+					before[corner] = Position(vertices, stride, triangle[corner]);
+					after[corner] = triangle[corner] == from ? target : before[corner];
+				}
+				float n0[3], n1[3];
+				Normal(before[0], before[1], before[2], n0);
+				Normal(after[0], after[1], after[2], n1);
+				float dot = n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2];
+				float length0 = n0[0] * n0[0] + n0[1] * n0[1] + n0[2] * n0[2];
+				float length1 = n1[0] * n1[0] + n1[1] * n1[1] + n1[2] * n1[2];
+				/* turned over, or almost at a right angle to where it was */
+				if (dot <= 0.25f * sqrtf(length0 * length1))
+					flips = true;
+			}
+			if (flips)
+				continue;
+
+			remap[from] = to;
+			quadrics[to].Add(quadrics[from]);
+			worstCost = std::max(worstCost, collapse.cost);
+			triangleCount -= removed;
+			collapsed++;
+
+			/* everything around the collapse is off limits until the next pass */
+			for (unsigned int j = adjacencyOffset[from]; j < adjacencyOffset[from + 1]; j++)
+			{
+				const unsigned int* triangle = &result[adjacency[j] * 3];
+				touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+			}
+		}
+
+		if (collapsed == 0)
+			break;
+
+		size_t write = 0;
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			unsigned int a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+			if (a == b || b == c || c == a)
+				continue;
+			result[write++] = a;
+			result[write++] = b;
+			result[write++] = c;
+		}
+		result.resize(write);
+	}
+
+	return (float)sqrt(worstCost);
+}
+
+void MeshSimplifier::BuildLodChain(const float* vertices, unsigned int vertexCount, unsigned int stride,
+	const unsigned int* indices, unsigned int indexCount, std::vector<LodLevel>& levels,
+	unsigned int maxLevels, float reduction)
+{
+	levels.clear();
+	levels.push_back({ std::vector<unsigned int>(indices, indices + indexCount), 0.0f });
+
+	while (levels.size() < maxLevels)
+	{
+		const LodLevel& previous = levels.back();
+		unsigned int target = (unsigned int)(previous.indices.size() / 3 * reduction) * 3;
+		if (target < 3)
+			break;
+
+		/* always from the full mesh, simplifying a simplification piles up error */
+		LodLevel level;
+		level.error = Simplify(vertices, vertexCount, stride, indices, indexCount, target, FLT_MAX, level.indices);
+		/* less than 10% fewer triangles: the mesh is as simple as it gets */
+		if (level.indices.size() * 10 > previous.indices.size() * 9)
+			break;
+		/* selection expects errors that only grow */
+		level.error = std::max(level.error, previous.error);
+		levels.push_back(std::move(level));
+	}
+}
+
+unsigned int LodSelector::Select(const float* errors, unsigned int levelCount, float distance, float pixelsPerUnit,
+	unsigned int currentLevel, float pixelError, float hysteresis)
+{
+	if (levelCount == 0)
+		return 0;
+	currentLevel = std::min(currentLevel, levelCount - 1);
+	float scale = pixelsPerUnit / std::max(distance, 1e-6f);
+
+	unsigned int desired = 0;
+	for (unsigned int i = 1; i < levelCount; i++)
+		if (errors[i] * scale <= pixelError)
+			desired = i;
+
+	if (desired > currentLevel)
+	{
+		/* coarsest level that is comfortably under the limit */
+		unsigned int level = currentLevel;
+		for (unsigned int i = currentLevel + 1; i <= desired; i++)
+			if (errors[i] * scale <= pixelError * (1.0f - hysteresis))
+				level = i;
+		return level;
+	}
+	if (desired < currentLevel && errors[currentLevel] * scale > pixelError * (1.0f + hysteresis))
+		return desired;
+	return currentLevel;
+}
+
+float LodSelector::GetPixelsPerUnit(const float* projection, float viewportHeight)
+{
+	/* projection[5] is cot(fovY / 2), one unit at distance 1 covers half of
+	   that many viewport heights */
+	return projection[5] * viewportHeight * 0.5f;
+}
@@ -0,0 +1,59 @@
+#include "MultiDrawBatch.h"
+
+#include <cstring>
+
+#include "renderer.h"
+#include "GeometryPool.h"
+#include "shader.h"
+
+MultiDrawBatch::MultiDrawBatch(GeometryPool& pool, const VertexBufferLayout& instanceLayout, unsigned int maxDraws)
+	: m_Pool(pool), m_InstanceLayout(instanceLayout), m_MaxDraws(maxDraws),
+	m_InstanceBuffer(nullptr, maxDraws * instanceLayout.GetStride()), m_IndirectBuffer(maxDraws)
+{
+	m_Commands.reserve(maxDraws);
+	m_InstanceData.reserve(maxDraws * instanceLayout.GetStride());
+
+	unsigned int firstAttribute = (unsigned int)pool.GetLayout().GetElements().size();
+	m_Pool.GetVertexArray().addInstanceBuffer(m_InstanceBuffer, m_InstanceLayout, firstAttribute);
+	m_Pool.GetVertexArray().Unbind();
+}
+
+bool MultiDrawBatch::Add(const MeshRange& mesh, const void* instanceData)
+{
+	if (m_Commands.size() >= m_MaxDraws)
+		return false;
+
+	DrawElementsIndirectCommand command;
+	command.count = mesh.indexCount;
+	command.instanceCount = 1;
+	command.firstIndex = mesh.firstIndex;
+	command.baseVertex = (int)mesh.baseVertex;
+	command.baseInstance = (unsigned int)m_Commands.size();
+	m_Commands.push_back(command);
+
+	unsigned int stride = m_InstanceLayout.GetStride();
+	size_t offset = m_InstanceData.size();
+	m_InstanceData.resize(offset + stride);
+	memcpy(&m_InstanceData[offset], instanceData, stride);
+	return true;
+}
+
+unsigned int MultiDrawBatch::Flush(const Shader& shader)
+{
+	unsigned int count = (unsigned int)m_Commands.size();
+	if (count == 0)
+		return 0;
+
+	m_InstanceBuffer.SetSubData(m_InstanceData.data(), 0, (unsigned int)m_InstanceData.size());
+	m_IndirectBuffer.SetData(m_Commands.data(), count);
+
+	shader.Bind();
+	m_Pool.Bind();
+	m_IndirectBuffer.Bind();
+	/* indirect offset 0, commands tightly packed (stride 0) */
+	GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, count, 0));
+
+	m_Commands.clear();
+	m_InstanceData.clear();
+	return count;
+}
@@ -0,0 +1,339 @@
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "Bvh.h"
+#include "Culling.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_SSE2
+#include <emmintrin.h>
+#endif
+
+/* anything with w below this is treated as crossing the near plane */
+#define OCCLUSION_MIN_W 1e-4f
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Milliseconds(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/* x, y in pixels, z in [0, 1], returns false behind the camera */
+static bool ToScreen(const float* m, const float* p, unsigned int width, unsigned int height, float* out)
+{
+	float x = m[0] * p[0] + m[4] * p[1] + m[8] * p[2] + m[12];
+	float y = m[1] * p[0] + m[5] * p[1] + m[9] * p[2] + m[13];
+	float z = m[2] * p[0] + m[6] * p[1] + m[10] * p[2] + m[14];
+	float w = m[3] * p[0] + m[7] * p[1] + m[11] * p[2] + m[15];
+	if (w < OCCLUSION_MIN_W)
+		return false;
+	out[0] = (x / w * 0.5f + 0.5f) * width;
+	out[1] = (y / w * 0.5f + 0.5f) * height;
+	out[2] = z / w * 0.5f + 0.5f;
+	return true;
+}
+
+OcclusionCuller::OcclusionCuller(unsigned int width, unsigned int height)
+	: m_Width((std::max(width, 4u) + 3) & ~3u), m_Height(std::max(height, 1u))
+{
+	unsigned int levelWidth = m_Width, levelHeight = m_Height;
+	while (true)
+	{
+		m_Levels.emplace_back(levelWidth * levelHeight, 1.0f);
+		m_LevelWidth.push_back(levelWidth);
+		m_LevelHeight.push_back(levelHeight);
+		if (levelWidth == 1 && levelHeight == 1)
+			break;
+		levelWidth = (levelWidth + 1) / 2;
+		levelHeight = (levelHeight + 1) / 2;
+	}
+	for (int i = 0; i < 16; i++)
+		m_ViewProjection[i] = i % 5 == 0 ? 1.0f : 0.0f;
+}
+
+void OcclusionCuller::BeginFrame(const float* viewProjection)
+{
+	for (int i = 0; i < 16; i++)
+		m_ViewProjection[i] = viewProjection[i];
+	std::fill(m_Levels[0].begin(), m_Levels[0].end(), 1.0f);
+	m_Stats = OcclusionStats();
+}
+
+void OcclusionCuller::AddOccluder(const float* positions, unsigned int vertexCount, const unsigned int* indices,
+	unsigned int indexCount)
+{
+	Clock::time_point start = Clock::now();
+
+	/* 4 floats per vertex, the last one flags vertices behind the camera */
+	m_Transformed.resize(vertexCount * 4);
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		float* out = &m_Transformed[i * 4];
+		out[3] = ToScreen(m_ViewProjection, positions + i * 3, m_Width, m_Height, out) ? 1.0f : 0.0f;
+	}
+
+	for (unsigned int i = 0; i + 2 < indexCount; i += 3)
+	{
+		const float* v0 = &m_Transformed[indices[i] * 4];
+		const float* v1 = &m_Transformed[indices[i + 1] * 4];
+		const float* v2 = &m_Transformed[indices[i + 2] * 4];
+		/* no clipping, an occluder that is missing a triangle only culls less */
+		if (v0[3] == 0.0f || v1[3] == 0.0f || v2[3] == 0.0f)
+			continue;
+		RasterizeTriangle(v0, v1, v2);
+	}
+
+	m_Stats.rasterizeMs += Milliseconds(start);
+}
+
+void OcclusionCuller::AddOccluder(const Aabb& box)
+{
+	float positions[8 * 3];
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		positions[i * 3 + 0] = (i & 1) ? box.max[0] : box.min[0];
+		positions[i * 3 + 1] = (i & 2) ? box.max[1] : box.min[1];
+		positions[i * 3 + 2] = (i & 4) ? box.max[2] : box.min[2];
+	}
+	static const unsigned int indices[36] = {
+		0, 2, 1, 1, 2, 3,	/* -z */
+		4, 5, 6, 5, 7, 6,	/* +z */
+		0, 1, 4, 1, 5, 4,	/* -y */
+		2, 6, 3, 3, 6, 7,	/* +y */
+		0, 4, 2, 2, 4, 6,	/* -x */
+		1, 3, 5, 3, 7, 5	/* +x */
+	};
+	AddOccluder(positions, 8, indices, 36);
+}
+
+void OcclusionCuller::RasterizeTriangle(const float* v0, const float* v1, const float* v2)
+{
+	/* counter clockwise on screen, so inside means every edge function >= 0 */
+	float area = (v1[0] - v0[0]) * (v2[1] - v0[1]) - (v1[1] - v0[1]) * (v2[0] - v0[0]);
+	if (area == 0.0f)
+		return;
+	if (area < 0.0f)
+	{
+		std::swap(v1, v2);
+		area = -area;
+	}
+
+	int minX = std::max(0, (int)floorf(std::min(v0[0], std::min(v1[0], v2[0]))));
+	int maxX = std::min((int)m_Width - 1, (int)ceilf(std::max(v0[0], std::max(v1[0], v2[0]))));
+	int minY = std::max(0, (int)floorf(std::min(v0[1], std::min(v1[1], v2[1]))));
+	int maxY = std::min((int)m_Height - 1, (int)ceilf(std::max(v0[1], std::max(v1[1], v2[1]))));
+	if (minX > maxX || minY > maxY)
+		return;
+
+	m_Stats.occluderTriangles++;
+
+	/* edge i goes from vertex i to vertex i + 1: E(p) = A * x + B * y + C,
+	   C is pulled in by half a pixel in both directions so E(center) >= 0
+	   only when the whole pixel is inside */
+	const float* v[3] = { v0, v1, v2 };
+	float A[3], B[3], C[3];
+	for (int i = 0; i < 3; i++)
+	{
+		const float* a = v[i];
+		const float* b = v[(i + 1) % 3];
+		A[i] = a[1] - b[1];
+		B[i] = b[0] - a[0];
+		C[i] = a[0] * b[1] - a[1] * b[0];
+		C[i] -= 0.5f * (fabsf(A[i]) + fabsf(B[i]));
+	}
+
+	/* depth plane, plus the most it can grow within half a pixel, so every
+	   written pixel holds the farthest depth the triangle has inside it */
+	float dzdx = ((v1[2] - v0[2]) * (v2[1] - v0[1]) - (v1[1] - v0[1]) * (v2[2] - v0[2])) / area;
+	float dzdy = ((v1[0] - v0[0]) * (v2[2] - v0[2]) - (v1[2] - v0[2]) * (v2[0] - v0[0])) / area;
+	float dzc = v0[2] - dzdx * v0[0] - dzdy * v0[1] + 0.5f * (fabsf(dzdx) + fabsf(dzdy));
+	float maxZ = std::max(v0[2], std::max(v1[2], v2[2]));
+
+	float* depth = m_Levels[0].data();
+	int startX = minX & ~3;
+
+#ifdef OCCLUSION_SSE2
+	const __m128 offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 zMax = _mm_set1_ps(maxZ);
+	for (int y = minY; y <= maxY; y++)
+	{
+		float py = y + 0.5f;
+		__m128 x = _mm_add_ps(_mm_set1_ps((float)startX), offsets);
+		float* row = depth + y * m_Width;
+		for (int px = startX; px <= maxX; px += 4)
+		{
+			__m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A[0]), x), _mm_set1_ps(B[0] * py + C[0]));
+			__m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A[1]), x), _mm_set1_ps(B[1] * py + C[1]));
+			__m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A[2]), x), _mm_set1_ps(B[2] * py + C[2]));
+			__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+			if (_mm_movemask_ps(inside))
+			{
+				__m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(dzdx), x), _mm_set1_ps(dzdy * py + dzc));
+				z = _mm_min_ps(z, zMax);
+				__m128 old = _mm_loadu_ps(row + px);
+				__m128 nearer = _mm_min_ps(old, z);
+				_mm_storeu_ps(row + px, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+			}
+			x = _mm_add_ps(x, _mm_set1_ps(4.0f));
+		}
+	}
+#else
+	for (int y = minY; y <= maxY; y++)
+	{
+		float py = y + 0.5f;
+		float* row = depth + y * m_Width;
+		for (int px = startX; px <= maxX; px++)
+		{
+			float x = px + 0.5f;
+			if (A[0] * x + B[0] * py + C[0] < 0.0f || A[1] * x + B[1] * py + C[1] < 0.0f || A[2] * x + B[2] * py + C[2] < 0.0f)
+				continue;
+			float z = std::min(dzdx * x + dzdy * py + dzc, maxZ);
+			row[px] = std::min(row[px], z);
+		}
+	}
+#endif
+}
+
+void OcclusionCuller::BuildPyramid()
+{
+	Clock::time_point start = Clock::now();
+
+	for (size_t level = 1; level < m_Levels.size(); level++)
+	{
+		const float* source = m_Levels[level - 1].data();
+		unsigned int sourceWidth = m_LevelWidth[level - 1], sourceHeight = m_LevelHeight[level - 1];
+		float* destination = m_Levels[level].data();
+		unsigned int width = m_LevelWidth[level], height = m_LevelHeight[level];
+
+		for (unsigned int y = 0; y < height; y++)
+		{
+			/* odd sizes: the last texel only has itself to reduce */
+			const float* row0 = source + (y * 2) * sourceWidth;
+			const float* row1 = source + std::min(y * 2 + 1, sourceHeight - 1) * sourceWidth;
+			for (unsigned int x = 0; x < width; x++)
+			{
+				unsigned int x0 = x * 2, x1 = std::min(x * 2 + 1, sourceWidth - 1);
+				destination[y * width + x] = std::max(std::max(row0[x0], row0[x1]), std::max(row1[x0], row1[x1]));
+			}
+		}
+	}
+
+	m_Stats.pyramidMs += Milliseconds(start);
+}
+
+bool OcclusionCuller::IsVisible(const Aabb& box)
+{
+	m_Stats.testedObjects++;
+
+	float minX, minY, minZ, maxX, maxY;
+#ifdef OCCLUSION_SSE2
+	/* all 8 corners at once, lanes are corners 0-3 (min z) and 4-7 (max z),
+	   corner i takes max x when bit 0 is set and max y when bit 1 is */
+	const float* m = m_ViewProjection;
+	__m128 clip[2][4];
+	for (int c = 0; c < 4; c++)
+	{
+		__m128 x = _mm_set_ps(m[c] * box.max[0], m[c] * box.min[0], m[c] * box.max[0], m[c] * box.min[0]);
+		__m128 y = _mm_set_ps(m[4 + c] * box.max[1], m[4 + c] * box.max[1], m[4 + c] * box.min[1], m[4 + c] * box.min[1]);
+		__m128 xy = _mm_add_ps(_mm_add_ps(x, y), _mm_set1_ps(m[12 + c]));
+		clip[0][c] = _mm_add_ps(xy, _mm_set1_ps(m[8 + c] * box.min[2]));
+		clip[1][c] = _mm_add_ps(xy, _mm_set1_ps(m[8 + c] * box.max[2]));
+	}
+
+	/* a box reaching behind the camera can't be tested, keep it */
+	__m128 minW = _mm_set1_ps(OCCLUSION_MIN_W);
+	if (_mm_movemask_ps(_mm_or_ps(_mm_cmplt_ps(clip[0][3], minW), _mm_cmplt_ps(clip[1][3], minW))))
+		return true;
+
+	__m128 half = _mm_set1_ps(0.5f);
+	__m128 screen[2][3];
+	for (int h = 0; h < 2; h++)
+	{
+		__m128 inverseW = _mm_div_ps(_mm_set1_ps(1.0f), clip[h][3]);
+		screen[h][0] = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(clip[h][0], inverseW), half), half), _mm_set1_ps((float)m_Width));
+		screen[h][1] = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(clip[h][1], inverseW), half), half), _mm_set1_ps((float)m_Height));
+		screen[h][2] = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(clip[h][2], inverseW), half), half);
+	}
+
+	float lanes[4];
+	__m128 reduced = _mm_min_ps(screen[0][0], screen[1][0]);
+	_mm_storeu_ps(lanes, reduced);
+	minX = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+	reduced = _mm_max_ps(screen[0][0], screen[1][0]);
+	_mm_storeu_ps(lanes, reduced);
+	maxX = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+	reduced = _mm_min_ps(screen[0][1], screen[1][1]);
+	_mm_storeu_ps(lanes, reduced);
+	minY = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+	reduced = _mm_max_ps(screen[0][1], screen[1][1]);
+	_mm_storeu_ps(lanes, reduced);
+	maxY = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+	reduced = _mm_min_ps(screen[0][2], screen[1][2]);
+	_mm_storeu_ps(lanes, reduced);
+	minZ = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+#else
+	minX = minY = minZ = 3.402823466e+38f;
+	maxX = maxY = -3.402823466e+38f;
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		float corner[3] = { (i & 1) ? box.max[0] : box.min[0], (i & 2) ? box.max[1] : box.min[1], (i & 4) ? box.max[2] : box.min[2] };
+		float screen[3];
+		/* a box reaching behind the camera can't be tested, keep it */
+		if (!ToScreen(m_ViewProjection, corner, m_Width, m_Height, screen))
+			return true;
+		minX = std::min(minX, screen[0]); maxX = std::max(maxX, screen[0]);
+		minY = std::min(minY, screen[1]); maxY = std::max(maxY, screen[1]);
+		minZ = std::min(minZ, screen[2]);
+	}
+#endif
+
+	if (maxX < 0.0f || maxY < 0.0f || minX >= (float)m_Width || minY >= (float)m_Height || minZ <= 0.0f)
+		return true;
+
+	int x0 = std::max(0, (int)floorf(minX)), x1 = std::min((int)m_Width - 1, (int)floorf(maxX));
+	int y0 = std::max(0, (int)floorf(minY)), y1 = std::min((int)m_Height - 1, (int)floorf(maxY));
+
+	/* coarsest level first that still has the rectangle within 2x2 texels */
+	unsigned int level = 0;
+	while (level + 1 < m_Levels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+		level++;
+
+	const float* depth = m_Levels[level].data();
+	unsigned int width = m_LevelWidth[level];
+	for (int y = y0 >> level; y <= (y1 >> level); y++)
+		for (int x = x0 >> level; x <= (x1 >> level); x++)
+			if (minZ <= depth[y * width + x])
+				return true;
+
+	m_Stats.occludedObjects++;
+	return false;
+}
+
+unsigned int OcclusionCuller::Cull(const BoundsStore& bounds, const unsigned int* candidates, unsigned int count,
+	std::vector<unsigned int>& visible)
+{
+	Clock::time_point start = Clock::now();
+
+	visible.clear();
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int index = candidates[i];
+		Aabb box;
+		box.min[0] = bounds.GetCenterX()[index] - bounds.GetExtentX()[index];
+		box.min[1] = bounds.GetCenterY()[index] - bounds.GetExtentY()[index];
+		box.min[2] = bounds.GetCenterZ()[index] - bounds.GetExtentZ()[index];
+		box.max[0] = bounds.GetCenterX()[index] + bounds.GetExtentX()[index];
+		box.max[1] = bounds.GetCenterY()[index] + bounds.GetExtentY()[index];
+		box.max[2] = bounds.GetCenterZ()[index] + bounds.GetExtentZ()[index];
+		if (IsVisible(box))
+			visible.push_back(index);
+	}
+
+	m_Stats.testMs += Milliseconds(start);
+	return (unsigned int)visible.size();
+}
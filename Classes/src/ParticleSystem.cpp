@@ -0,0 +1,246 @@
+#include "ParticleSystem.h"
+
+#include "JobSystem.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#define PARTICLE_GRAIN 16384	/* particles per job */
+
+static inline unsigned int CountTrailingZeros(unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (unsigned int)index;
+#else
+	return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+/* xorshift32, 0..1 */
+static inline float Random(unsigned int& seed)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return (seed >> 8) * (1.0f / 16777216.0f);
+}
+
+ParticleSystem::ParticleSystem(unsigned int count, const ParticleSettings& settings)
+	: m_Settings(settings), m_Count(count),
+	m_PositionX(count), m_PositionY(count), m_PositionZ(count),
+	m_VelocityX(count), m_VelocityY(count), m_VelocityZ(count),
+	m_Life(count), m_InverseLifetime(count), m_Seeds(count)
+{
+	for (unsigned int i = 0; i < count; i++)
+	{
+		m_Seeds[i] = 2463534242u ^ (i * 2654435761u);
+		if (m_Seeds[i] == 0)
+			m_Seeds[i] = 1;
+		Spawn(i);
+		/* start somewhere in their lives, or they'd all die at once */
+		m_Life[i] *= Random(m_Seeds[i]);
+	}
+}
+
+void ParticleSystem::Spawn(unsigned int i)
+{
+	unsigned int& seed = m_Seeds[i];
+	const ParticleSettings& s = m_Settings;
+	float life = s.minLife + (s.maxLife - s.minLife) * Random(seed);
+	m_Life[i] = life;
+	m_InverseLifetime[i] = 1.0f / life;
+	m_PositionX[i] = s.origin.x;
+	m_PositionY[i] = s.origin.y;
+	m_PositionZ[i] = s.origin.z;
+	m_VelocityX[i] = s.velocity.x + s.spread * (Random(seed) * 2.0f - 1.0f);
+	m_VelocityY[i] = s.velocity.y + s.spread * (Random(seed) * 2.0f - 1.0f);
+	m_VelocityZ[i] = s.velocity.z + s.spread * (Random(seed) * 2.0f - 1.0f);
+}
+
+void ParticleSystem::SimulateRangeScalar(float dt, unsigned int begin, unsigned int end)
+{
+	const ParticleSettings& s = m_Settings;
+	for (unsigned int i = begin; i < end; i++)
+	{
+		m_VelocityX[i] += s.gravity.x * dt;
+		m_VelocityY[i] += s.gravity.y * dt;
+		m_VelocityZ[i] += s.gravity.z * dt;
+		m_PositionX[i] += m_VelocityX[i] * dt;
+		m_PositionY[i] += m_VelocityY[i] * dt;
+		m_PositionZ[i] += m_VelocityZ[i] * dt;
+		if (m_PositionY[i] < 0.0f)
+		{
+			m_PositionY[i] = 0.0f;
+			if (m_VelocityY[i] < 0.0f)
+				m_VelocityY[i] *= -s.bounce;
+		}
+		m_Life[i] -= dt;
+		if (m_Life[i] <= 0.0f)
+			Spawn(i);
+	}
+}
+
+void ParticleSystem::SimulateRange(float dt, unsigned int begin, unsigned int end)
+{
+	const ParticleSettings& s = m_Settings;
+	float* px = m_PositionX.data(); float* py = m_PositionY.data(); float* pz = m_PositionZ.data();
+	float* vx = m_VelocityX.data(); float* vy = m_VelocityY.data(); float* vz = m_VelocityZ.data();
+	float* life = m_Life.data();
+	unsigned int i = begin;
+
+#if defined(MATH_AVX)
+	const __m256 gx = _mm256_set1_ps(s.gravity.x * dt), gy = _mm256_set1_ps(s.gravity.y * dt), gz = _mm256_set1_ps(s.gravity.z * dt);
+	const __m256 step = _mm256_set1_ps(dt), zero = _mm256_setzero_ps(), bounce = _mm256_set1_ps(-s.bounce);
+	for (; i + 8 <= end; i += 8)
+	{
+		__m256 x = _mm256_loadu_ps(vx + i), y = _mm256_loadu_ps(vy + i), z = _mm256_loadu_ps(vz + i);
+		x = _mm256_add_ps(x, gx);
+		y = _mm256_add_ps(y, gy);
+		z = _mm256_add_ps(z, gz);
+		__m256 positionY = _mm256_add_ps(_mm256_loadu_ps(py + i), _mm256_mul_ps(y, step));
+		_mm256_storeu_ps(px + i, _mm256_add_ps(_mm256_loadu_ps(px + i), _mm256_mul_ps(x, step)));
+		_mm256_storeu_ps(pz + i, _mm256_add_ps(_mm256_loadu_ps(pz + i), _mm256_mul_ps(z, step)));
+
+		/* under the ground: back on it, and bounce if still going down */
+		__m256 below = _mm256_cmp_ps(positionY, zero, _CMP_LT_OQ);
+		__m256 falling = _mm256_and_ps(below, _mm256_cmp_ps(y, zero, _CMP_LT_OQ));
+		positionY = _mm256_blendv_ps(positionY, zero, below);
+		y = _mm256_blendv_ps(y, _mm256_mul_ps(y, bounce), falling);
+		_mm256_storeu_ps(py + i, positionY);
+		_mm256_storeu_ps(vx + i, x);
+		_mm256_storeu_ps(vy + i, y);
+		_mm256_storeu_ps(vz + i, z);
+
+		__m256 remaining = _mm256_sub_ps(_mm256_loadu_ps(life + i), step);
+		_mm256_storeu_ps(life + i, remaining);
+		/* few particles die in one frame, they respawn one by one */
+		int dead = _mm256_movemask_ps(_mm256_cmp_ps(remaining, zero, _CMP_LE_OQ));
+		while (dead)
+		{
+			Spawn(i + CountTrailingZeros((unsigned int)dead));
+			dead &= dead - 1;
+		}
+	}
+#elif defined(MATH_SSE)
+	const __m128 gx = _mm_set1_ps(s.gravity.x * dt), gy = _mm_set1_ps(s.gravity.y * dt), gz = _mm_set1_ps(s.gravity.z * dt);
+	const __m128 step = _mm_set1_ps(dt), zero = _mm_setzero_ps(), bounce = _mm_set1_ps(-s.bounce);
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(vx + i), y = _mm_loadu_ps(vy + i), z = _mm_loadu_ps(vz + i);
+		x = _mm_add_ps(x, gx);
+		y = _mm_add_ps(y, gy);
+		z = _mm_add_ps(z, gz);
+		__m128 positionY = _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(y, step));
+		_mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(x, step)));
+		_mm_storeu_ps(pz + i, _mm_add_ps(_mm_loadu_ps(pz + i), _mm_mul_ps(z, step)));
+
+		/* SSE2 has no blend, select with and/andnot/or */
+		__m128 below = _mm_cmplt_ps(positionY, zero);
+		__m128 falling = _mm_and_ps(below, _mm_cmplt_ps(y, zero));
+		positionY = _mm_andnot_ps(below, positionY);
+		y = _mm_or_ps(_mm_and_ps(falling, _mm_mul_ps(y, bounce)), _mm_andnot_ps(falling, y));
+		_mm_storeu_ps(py + i, positionY);
+		_mm_storeu_ps(vx + i, x);
+		_mm_storeu_ps(vy + i, y);
+		_mm_storeu_ps(vz + i, z);
+
+		__m128 remaining = _mm_sub_ps(_mm_loadu_ps(life + i), step);
+		_mm_storeu_ps(life + i, remaining);
+		int dead = _mm_movemask_ps(_mm_cmple_ps(remaining, zero));
+		while (dead)
+		{
+			Spawn(i + CountTrailingZeros((unsigned int)dead));
+			dead &= dead - 1;
+		}
+	}
+#endif
+
+	SimulateRangeScalar(dt, i, end);
+}
+
+void ParticleSystem::WriteRange(const ParticleInstances& out, unsigned int begin, unsigned int end) const
+{
+	const float* px = m_PositionX.data(); const float* py = m_PositionY.data(); const float* pz = m_PositionZ.data();
+	const float* life = m_Life.data(); const float* inverseLifetime = m_InverseLifetime.data();
+	float halfSize = m_Settings.size * 0.5f;
+	unsigned int i = begin;
+
+#ifdef MATH_SSE
+	/* 4 at a time even with AVX, the transpose and the stores limit this,
+	   not the arithmetic */
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), half = _mm_set1_ps(halfSize);
+	const __m128 red = _mm_set1_ps(255.0f), blue = _mm_set1_ps(64.0f);
+	for (; i + 4 <= end; i += 4)
+	{
+		/* t goes from 1 at birth to 0 at death */
+		__m128 t = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(life + i), _mm_loadu_ps(inverseLifetime + i)), zero), one);
+		__m128 x = _mm_loadu_ps(px + i), y = _mm_loadu_ps(py + i), z = _mm_loadu_ps(pz + i);
+		__m128 size = _mm_add_ps(half, _mm_mul_ps(half, t));
+		_MM_TRANSPOSE4_PS(x, y, z, size);
+		float* positions = out.positions + (size_t)i * 4;
+		_mm_storeu_ps(positions, x);
+		_mm_storeu_ps(positions + 4, y);
+		_mm_storeu_ps(positions + 8, z);
+		_mm_storeu_ps(positions + 12, size);
+
+		__m128i g = _mm_cvtps_epi32(_mm_mul_ps(red, t));
+		__m128i b = _mm_cvtps_epi32(_mm_mul_ps(blue, t));
+		__m128i color = _mm_or_si128(_mm_set1_epi32(255), _mm_slli_epi32(g, 8));
+		color = _mm_or_si128(color, _mm_slli_epi32(b, 16));
+		color = _mm_or_si128(color, _mm_slli_epi32(g, 24));
+		_mm_storeu_si128((__m128i*)(out.colors + i), color);
+	}
+#endif
+
+	for (; i < end; i++)
+	{
+		float t = life[i] * inverseLifetime[i];
+		t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+		float* position = out.positions + (size_t)i * 4;
+		position[0] = px[i];
+		position[1] = py[i];
+		position[2] = pz[i];
+		position[3] = halfSize + halfSize * t;
+		unsigned int g = (unsigned int)(255.0f * t + 0.5f), b = (unsigned int)(64.0f * t + 0.5f);
+		/* red, green, blue, alpha as bytes in memory order */
+		out.colors[i] = 255u | g << 8 | b << 16 | g << 24;
+	}
+}
+
+void ParticleSystem::Simulate(float dt, JobSystem* jobs)
+{
+	if (jobs)
+		jobs->ParallelFor(m_Count, PARTICLE_GRAIN, [this, dt](unsigned int begin, unsigned int end) { SimulateRange(dt, begin, end); });
+	else
+		SimulateRange(dt, 0, m_Count);
+}
+
+void ParticleSystem::SimulateScalar(float dt)
+{
+	SimulateRangeScalar(dt, 0, m_Count);
+}
+
+void ParticleSystem::Write(const ParticleInstances& out, JobSystem* jobs) const
+{
+	if (jobs)
+		jobs->ParallelFor(m_Count, PARTICLE_GRAIN, [this, &out](unsigned int begin, unsigned int end) { WriteRange(out, begin, end); });
+	else
+		WriteRange(out, 0, m_Count);
+}
+
+void ParticleSystem::Update(float dt, const ParticleInstances& out, JobSystem* jobs)
+{
+	auto update = [this, dt, &out](unsigned int begin, unsigned int end)
+	{
+		SimulateRange(dt, begin, end);
+		WriteRange(out, begin, end);
+	};
+
+	if (jobs)
+		jobs->ParallelFor(m_Count, PARTICLE_GRAIN, update);
+	else
+		update(0, m_Count);
+}
@@ -0,0 +1,292 @@
+#include "PipelineState.h"
+
+#include "renderer.h"
+#include "shader.h"
+#include "VertexBufferLayout.h"
+
+/* FNV-1a, fed field by field so padding never ends up in the hash */
+static void HashValue(unsigned long long& hash, unsigned long long value)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		hash ^= (value >> (i * 8)) & 0xFF;
+		hash *= 1099511628211ull;
+	}
+}
+
+static void HashFloat(unsigned long long& hash, float value)
+{
+	union { float f; unsigned int u; } bits;
+	bits.f = value;
+	HashValue(hash, bits.u);
+}
+
+unsigned long long PipelineCache::Hash(const PipelineStateDesc& desc)
+{
+	unsigned long long hash = 14695981039346656037ull;
+	HashValue(hash, (unsigned long long)desc.shader);
+	if (desc.layout)
+	{
+		for (const VertexBufferElement& element : desc.layout->GetElements())
+			HashValue(hash, (unsigned long long)element.type << 32 | element.count << 8 | element.normalized);
+		HashValue(hash, desc.layout->GetStride());
+	}
+
+	const BlendState& blend = desc.blend;
+	HashValue(hash, blend.enabled | blend.writeRed << 1 | blend.writeGreen << 2 | blend.writeBlue << 3 | blend.writeAlpha << 4);
+	HashValue(hash, (unsigned long long)blend.srcColor << 32 | blend.dstColor);
+	HashValue(hash, (unsigned long long)blend.srcAlpha << 32 | blend.dstAlpha);
+	HashValue(hash, (unsigned long long)blend.colorOp << 32 | blend.alphaOp);
+
+	HashValue(hash, (unsigned long long)desc.depth.func << 2 | desc.depth.test << 1 | desc.depth.write);
+
+	const StencilState& stencil = desc.stencil;
+	HashValue(hash, (unsigned long long)stencil.func << 1 | stencil.enabled);
+	HashValue(hash, (unsigned long long)(unsigned int)stencil.reference << 32 | stencil.readMask << 16 | stencil.writeMask);
+	HashValue(hash, (unsigned long long)stencil.stencilFail << 40 | (unsigned long long)stencil.depthFail << 20 | stencil.pass);
+
+	const RasterState& raster = desc.raster;
+	HashValue(hash, (unsigned long long)raster.cullFace << 32 | raster.frontFace << 2 | raster.cull << 1 | raster.scissor);
+	HashValue(hash, raster.polygonMode);
+	HashFloat(hash, raster.depthBiasFactor);
+	HashFloat(hash, raster.depthBiasUnits);
+	return hash;
+}
+
+static bool EqualLayouts(const VertexBufferLayout* a, const VertexBufferLayout* b)
+{
+	if (a == b)
+		return true;
+	if (!a || !b || a->GetStride() != b->GetStride() || a->GetElements().size() != b->GetElements().size())
+		return false;
+	for (unsigned int i = 0; i < a->GetElements().size(); i++)
+	{
+		const VertexBufferElement& x = a->GetElements()[i];
+		const VertexBufferElement& y = b->GetElements()[i];
+		if (x.type != y.type || x.count != y.count || x.normalized != y.normalized)
+			return false;
+	}
+	return true;
+}
+
+bool PipelineCache::Equal(const PipelineStateDesc& a, const PipelineStateDesc& b)
+{
+	const BlendState& x = a.blend;
+	const BlendState& y = b.blend;
+	const StencilState& s = a.stencil;
+	const StencilState& t = b.stencil;
+	const RasterState& r = a.raster;
+	const RasterState& q = b.raster;
+	return a.shader == b.shader && EqualLayouts(a.layout, b.layout) &&
+		x.enabled == y.enabled && x.srcColor == y.srcColor && x.dstColor == y.dstColor && x.colorOp == y.colorOp &&
+		x.srcAlpha == y.srcAlpha && x.dstAlpha == y.dstAlpha && x.alphaOp == y.alphaOp &&
+		x.writeRed == y.writeRed && x.writeGreen == y.writeGreen && x.writeBlue == y.writeBlue && x.writeAlpha == y.writeAlpha &&
+		a.depth.test == b.depth.test && a.depth.write == b.depth.write && a.depth.func == b.depth.func &&
+		s.enabled == t.enabled && s.func == t.func && s.reference == t.reference && s.readMask == t.readMask &&
+		s.writeMask == t.writeMask && s.stencilFail == t.stencilFail && s.depthFail == t.depthFail && s.pass == t.pass &&
+		r.cull == q.cull && r.cullFace == q.cullFace && r.frontFace == q.frontFace && r.polygonMode == q.polygonMode &&
+		r.scissor == q.scissor && r.depthBiasFactor == q.depthBiasFactor && r.depthBiasUnits == q.depthBiasUnits;
+}
+
+const PipelineState* PipelineCache::Get(const PipelineStateDesc& desc)
+{
+	unsigned long long hash = Hash(desc);
+	std::vector<std::unique_ptr<PipelineState>>& bucket = m_States[hash];
+	for (const std::unique_ptr<PipelineState>& state : bucket)
+		if (Equal(state->GetDesc(), desc))
+			return state.get();
+
+	bucket.push_back(std::make_unique<PipelineState>(desc, hash, m_Count++));
+	return bucket.back().get();
+}
+
+PipelineStateTracker::PipelineStateTracker()
+	: m_Bound(nullptr), m_Valid(false), m_Transitions(0), m_StateCalls(0)
+{
+}
+
+void PipelineStateTracker::Invalidate()
+{
+	m_Valid = false;
+	m_Bound = nullptr;
+}
+
+static void SetEnabled(GLenum capability, bool enabled)
+{
+	if (enabled)
+	{
+		GLCall(glEnable(capability));
+	}
+	else
+	{
+		GLCall(glDisable(capability));
+	}
+}
+
+void PipelineStateTracker::Apply(const PipelineState& state)
+{
+	if (&state == m_Bound)
+		return;
+
+	const PipelineStateDesc& next = state.GetDesc();
+	PipelineStateDesc& current = m_Current;
+	bool all = !m_Valid;
+	unsigned int calls = m_StateCalls;
+
+	if (all || next.shader != current.shader)
+	{
+		if (next.shader)
+			next.shader->Bind();
+		else
+		{
+			GLCall(glUseProgram(0));
+		}
+		m_StateCalls++;
+	}
+	current.shader = next.shader;
+	current.layout = next.layout;
+
+	/* blend: the functions only matter (and are only set) while enabled,
+	   except on a full sync, GL may hold anything after raw calls and
+	   m_Current has to match it afterwards */
+	const BlendState& blend = next.blend;
+	if (all || blend.enabled != current.blend.enabled)
+	{
+		SetEnabled(GL_BLEND, blend.enabled);
+		m_StateCalls++;
+	}
+	if (all || blend.enabled)
+	{
+		if (all || blend.srcColor != current.blend.srcColor || blend.dstColor != current.blend.dstColor ||
+			blend.srcAlpha != current.blend.srcAlpha || blend.dstAlpha != current.blend.dstAlpha)
+		{
+			GLCall(glBlendFuncSeparate(blend.srcColor, blend.dstColor, blend.srcAlpha, blend.dstAlpha));
+			m_StateCalls++;
+		}
+		if (all || blend.colorOp != current.blend.colorOp || blend.alphaOp != current.blend.alphaOp)
+		{
+			GLCall(glBlendEquationSeparate(blend.colorOp, blend.alphaOp));
+			m_StateCalls++;
+		}
+		current.blend.srcColor = blend.srcColor;
+		current.blend.dstColor = blend.dstColor;
+		current.blend.srcAlpha = blend.srcAlpha;
+		current.blend.dstAlpha = blend.dstAlpha;
+		current.blend.colorOp = blend.colorOp;
+		current.blend.alphaOp = blend.alphaOp;
+	}
+	current.blend.enabled = blend.enabled;
+	/* the color mask also applies to glClear, always kept up to date */
+	if (all || blend.writeRed != current.blend.writeRed || blend.writeGreen != current.blend.writeGreen ||
+		blend.writeBlue != current.blend.writeBlue || blend.writeAlpha != current.blend.writeAlpha)
+	{
+		GLCall(glColorMask(blend.writeRed, blend.writeGreen, blend.writeBlue, blend.writeAlpha));
+		m_StateCalls++;
+		current.blend.writeRed = blend.writeRed;
+		current.blend.writeGreen = blend.writeGreen;
+		current.blend.writeBlue = blend.writeBlue;
+		current.blend.writeAlpha = blend.writeAlpha;
+	}
+
+	const DepthState& depth = next.depth;
+	if (all || depth.test != current.depth.test)
+	{
+		SetEnabled(GL_DEPTH_TEST, depth.test);
+		m_StateCalls++;
+		current.depth.test = depth.test;
+	}
+	if (all || (depth.test && depth.func != current.depth.func))
+	{
+		GLCall(glDepthFunc(depth.func));
+		m_StateCalls++;
+		current.depth.func = depth.func;
+	}
+	if (all || depth.write != current.depth.write)
+	{
+		GLCall(glDepthMask(depth.write));
+		m_StateCalls++;
+		current.depth.write = depth.write;
+	}
+
+	const StencilState& stencil = next.stencil;
+	if (all || stencil.enabled != current.stencil.enabled)
+	{
+		SetEnabled(GL_STENCIL_TEST, stencil.enabled);
+		m_StateCalls++;
+		current.stencil.enabled = stencil.enabled;
+	}
+	if (all || stencil.enabled)
+	{
+		if (all || stencil.func != current.stencil.func || stencil.reference != current.stencil.reference ||
+			stencil.readMask != current.stencil.readMask)
+		{
+			GLCall(glStencilFunc(stencil.func, stencil.reference, stencil.readMask));
+			m_StateCalls++;
+		}
+		if (all || stencil.stencilFail != current.stencil.stencilFail || stencil.depthFail != current.stencil.depthFail ||
+			stencil.pass != current.stencil.pass)
+		{
+			GLCall(glStencilOp(stencil.stencilFail, stencil.depthFail, stencil.pass));
+			m_StateCalls++;
+		}
+		unsigned int writeMask = current.stencil.writeMask;
+		current.stencil = stencil;
+		current.stencil.writeMask = writeMask;
+	}
+	if (all || stencil.writeMask != current.stencil.writeMask)
+	{
+		GLCall(glStencilMask(stencil.writeMask));
+		m_StateCalls++;
+		current.stencil.writeMask = stencil.writeMask;
+	}
+
+	const RasterState& raster = next.raster;
+	if (all || raster.cull != current.raster.cull)
+	{
+		SetEnabled(GL_CULL_FACE, raster.cull);
+		m_StateCalls++;
+		current.raster.cull = raster.cull;
+	}
+	if (all || (raster.cull && raster.cullFace != current.raster.cullFace))
+	{
+		GLCall(glCullFace(raster.cullFace));
+		m_StateCalls++;
+		current.raster.cullFace = raster.cullFace;
+	}
+	if (all || raster.frontFace != current.raster.frontFace)
+	{
+		GLCall(glFrontFace(raster.frontFace));
+		m_StateCalls++;
+		current.raster.frontFace = raster.frontFace;
+	}
+	if (all || raster.polygonMode != current.raster.polygonMode)
+	{
+		GLCall(glPolygonMode(GL_FRONT_AND_BACK, raster.polygonMode));
+		m_StateCalls++;
+		current.raster.polygonMode = raster.polygonMode;
+	}
+	if (all || raster.scissor != current.raster.scissor)
+	{
+		SetEnabled(GL_SCISSOR_TEST, raster.scissor);
+		m_StateCalls++;
+		current.raster.scissor = raster.scissor;
+	}
+	bool bias = raster.depthBiasFactor != 0.0f || raster.depthBiasUnits != 0.0f;
+	bool currentBias = current.raster.depthBiasFactor != 0.0f || current.raster.depthBiasUnits != 0.0f;
+	if (all || bias != currentBias)
+	{
+		SetEnabled(GL_POLYGON_OFFSET_FILL, bias);
+		m_StateCalls++;
+	}
+	if (all || (bias && (raster.depthBiasFactor != current.raster.depthBiasFactor || raster.depthBiasUnits != current.raster.depthBiasUnits)))
+	{
+		GLCall(glPolygonOffset(raster.depthBiasFactor, raster.depthBiasUnits));
+		m_StateCalls++;
+	}
+	current.raster.depthBiasFactor = raster.depthBiasFactor;
+	current.raster.depthBiasUnits = raster.depthBiasUnits;
+
+	m_Transitions += m_StateCalls != calls;
+	m_Bound = &state;
+	m_Valid = true;
+}
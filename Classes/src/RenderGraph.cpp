@@ -0,0 +1,391 @@
+#include "RenderGraph.h"
+
+#include <iostream>
+#include <chrono>
+
+#include "renderer.h"
+#include "DeletionQueue.h"
+#include "FrameBuffer.h"
+#include "RenderTargetPool.h"
+
+RenderGraphResource RenderPassBuilder::Create(const std::string& name, const RenderTargetDesc& desc)
+{
+	return Write(m_Graph.CreateTexture(name, desc));
+}
+
+RenderGraphResource RenderPassBuilder::Read(RenderGraphResource resource)
+{
+	ASSERT(resource < m_Graph.m_Resources.size());
+
+	std::vector<RenderGraphResource>& reads = m_Graph.m_Passes[m_Pass].reads;
+	for (RenderGraphResource read : reads)
+		if (read == resource)
+			return resource;
+	reads.push_back(resource);
+	m_Graph.m_Resources[resource].readers.push_back(m_Pass);
+	m_Graph.m_Compiled = false;
+	return resource;
+}
+
+RenderGraphResource RenderPassBuilder::Write(RenderGraphResource resource)
+{
+	ASSERT(resource < m_Graph.m_Resources.size());
+
+	std::vector<RenderGraphResource>& writes = m_Graph.m_Passes[m_Pass].writes;
+	for (RenderGraphResource write : writes)
+		if (write == resource)
+			return resource;
+	writes.push_back(resource);
+	m_Graph.m_Resources[resource].writers.push_back(m_Pass);
+	m_Graph.m_Compiled = false;
+	return resource;
+}
+
+void RenderPassBuilder::SetSideEffect()
+{
+	m_Graph.m_Passes[m_Pass].sideEffect = true;
+}
+
+RenderTarget* RenderPassContext::GetTarget(RenderGraphResource resource) const
+{
+	return m_Graph.m_Resources[resource].target;
+}
+
+FrameBuffer* RenderPassContext::GetFrameBuffer() const
+{
+	const RenderTarget* color = nullptr;
+	const RenderTarget* depth = nullptr;
+	for (RenderGraphResource write : m_Graph.m_Passes[m_Pass].writes)
+	{
+		const RenderGraph::Resource& resource = m_Graph.m_Resources[write];
+		if (resource.backbuffer)
+			return nullptr;
+		if (RenderTarget::IsDepthFormat(resource.desc.internalFormat))
+			depth = depth ? depth : resource.target;
+		else
+			color = color ? color : resource.target;
+	}
+	return &m_Pool.GetFrameBuffer(color, depth);
+}
+
+FrameBuffer* RenderPassContext::GetFrameBuffer(RenderGraphResource resource) const
+{
+	const RenderGraph::Resource& source = m_Graph.m_Resources[resource];
+	if (source.backbuffer)
+		return nullptr;
+	if (RenderTarget::IsDepthFormat(source.desc.internalFormat))
+		return &m_Pool.GetFrameBuffer(nullptr, source.target);
+	return &m_Pool.GetFrameBuffer(source.target, nullptr);
+}
+
+void RenderPassContext::BindOutput() const
+{
+	if (FrameBuffer* frameBuffer = GetFrameBuffer())
+		frameBuffer->Bind();
+	else
+		FrameBuffer::BindDefault(m_Graph.m_Width, m_Graph.m_Height);
+}
+
+RenderGraph::RenderGraph(unsigned int width, unsigned int height)
+	: m_Width(width), m_Height(height), m_Compiled(false)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+	Clear();
+}
+
+RenderGraphResource RenderGraph::CreateTexture(const std::string& name, const RenderTargetDesc& desc)
+{
+	Resource resource = {};
+	resource.name = name;
+	resource.desc = desc;
+	m_Resources.push_back(resource);
+	m_Compiled = false;
+	return (RenderGraphResource)m_Resources.size() - 1;
+}
+
+RenderGraphResource RenderGraph::Import(const std::string& name, RenderTarget* target)
+{
+	Resource resource = {};
+	resource.name = name;
+	resource.desc = target->GetDesc();
+	resource.target = target;
+	resource.imported = true;
+	m_Resources.push_back(resource);
+	m_Compiled = false;
+	return (RenderGraphResource)m_Resources.size() - 1;
+}
+
+RenderGraphResource RenderGraph::GetBackbuffer()
+{
+	for (unsigned int i = 0; i < m_Resources.size(); i++)
+		if (m_Resources[i].backbuffer)
+			return i;
+
+	Resource resource = {};
+	resource.name = "backbuffer";
+	resource.desc = { m_Width, m_Height, GL_RGBA8, 1 };
+	resource.imported = true;
+	resource.backbuffer = true;
+	m_Resources.push_back(resource);
+	m_Compiled = false;
+	return (RenderGraphResource)m_Resources.size() - 1;
+}
+
+void RenderGraph::AddPass(const std::string& name, const std::function<void(RenderPassBuilder&)>& setup,
+	const std::function<void(const RenderPassContext&)>& execute)
+{
+	Pass pass = {};
+	pass.name = name;
+	pass.execute = execute;
+	m_Passes.push_back(pass);
+	m_Compiled = false;
+
+	RenderPassBuilder builder(*this, (unsigned int)m_Passes.size() - 1);
+	setup(builder);
+}
+
+bool RenderGraph::Compile()
+{
+	unsigned int passCount = (unsigned int)m_Passes.size();
+
+	for (const Resource& resource : m_Resources)
+	{
+		if (!resource.imported && resource.writers.empty() && !resource.readers.empty())
+		{
+			std::cout << "[RenderGraph] " << resource.name << " is read but no pass writes it" << std::endl;
+			return false;
+		}
+	}
+
+	/* edges: the writers of a resource run in the order they were added,
+	   a reader runs after every writer (a pass that reads and writes a
+	   resource, after the writers added before it) */
+	std::vector<std::vector<unsigned int>> next(passCount);
+	std::vector<unsigned int> incoming(passCount, 0);
+	auto addEdge = [&](unsigned int from, unsigned int to)
+	{
+		next[from].push_back(to);
+		incoming[to]++;
+	};
+	for (RenderGraphResource index = 0; index < m_Resources.size(); index++)
+	{
+		const Resource& resource = m_Resources[index];
+		for (unsigned int i = 1; i < resource.writers.size(); i++)
+			addEdge(resource.writers[i - 1], resource.writers[i]);
+
+		for (unsigned int reader : resource.readers)
+		{
+			bool modifies = Writes(reader, index);
+			for (unsigned int writer : resource.writers)
+				if (writer != reader && (!modifies || writer < reader))
+					addEdge(writer, reader);
+		}
+	}
+
+	/* Kahn's algorithm, among the passes that are ready the one added
+	   first goes first, so independent passes keep the order of AddPass */
+	m_Order.clear();
+	std::vector<bool> done(passCount, false);
+	for (unsigned int step = 0; step < passCount; step++)
+	{
+		unsigned int ready = passCount;
+		for (unsigned int pass = 0; pass < passCount; pass++)
+		{
+			if (!done[pass] && incoming[pass] == 0)
+			{
+				ready = pass;
+				break;
+			}
+		}
+		if (ready == passCount)
+		{
+			std::cout << "[RenderGraph] passes depend on each other in a cycle:";
+			for (unsigned int pass = 0; pass < passCount; pass++)
+				if (!done[pass])
+					std::cout << " " << m_Passes[pass].name;
+			std::cout << std::endl;
+			m_Order.clear();
+			return false;
+		}
+
+		done[ready] = true;
+		m_Order.push_back(ready);
+		for (unsigned int to : next[ready])
+			incoming[to]--;
+	}
+
+	Cull();
+
+	/* drop culled passes and find every transient target's lifetime */
+	unsigned int kept = 0;
+	for (unsigned int pass : m_Order)
+		if (!m_Passes[pass].culled)
+			m_Order[kept++] = pass;
+	m_Order.resize(kept);
+
+	for (Resource& resource : m_Resources)
+	{
+		resource.firstUse = 0xFFFFFFFF;
+		resource.lastUse = 0;
+	}
+	for (unsigned int position = 0; position < m_Order.size(); position++)
+	{
+		const Pass& pass = m_Passes[m_Order[position]];
+		for (const std::vector<RenderGraphResource>* list : { &pass.reads, &pass.writes })
+		{
+			for (RenderGraphResource index : *list)
+			{
+				Resource& resource = m_Resources[index];
+				resource.firstUse = position < resource.firstUse ? position : resource.firstUse;
+				resource.lastUse = position > resource.lastUse ? position : resource.lastUse;
+			}
+		}
+	}
+
+	m_Compiled = true;
+	return true;
+}
+
+bool RenderGraph::Writes(unsigned int pass, RenderGraphResource resource) const
+{
+	for (RenderGraphResource write : m_Passes[pass].writes)
+		if (write == resource)
+			return true;
+	return false;
+}
+
+void RenderGraph::Cull()
+{
+	/* reference counting from the outputs: a pass is needed while one of
+	   the resources it writes is, a resource while someone reads it */
+	for (Pass& pass : m_Passes)
+	{
+		pass.refCount = (unsigned int)pass.writes.size();
+		pass.culled = false;
+	}
+
+	std::vector<RenderGraphResource> unused;
+	for (unsigned int index = 0; index < m_Resources.size(); index++)
+	{
+		Resource& resource = m_Resources[index];
+		resource.refCount = resource.imported ? 1 : 0;
+		/* reading what it writes itself doesn't keep a pass alive */
+		for (unsigned int reader : resource.readers)
+			resource.refCount += Writes(reader, index) ? 0 : 1;
+		if (resource.refCount == 0)
+			unused.push_back(index);
+	}
+
+	while (!unused.empty())
+	{
+		Resource& resource = m_Resources[unused.back()];
+		unused.pop_back();
+		for (unsigned int writer : resource.writers)
+		{
+			Pass& pass = m_Passes[writer];
+			if (--pass.refCount > 0 || pass.sideEffect || pass.culled)
+				continue;
+
+			pass.culled = true;
+			for (RenderGraphResource read : pass.reads)
+				if (!Writes(writer, read) && --m_Resources[read].refCount == 0)
+					unused.push_back(read);
+		}
+	}
+}
+
+void RenderGraph::Execute(RenderTargetPool& pool)
+{
+	if (!m_Compiled && !Compile())
+		return;
+
+	for (unsigned int position = 0; position < m_Order.size(); position++)
+	{
+		Pass& pass = m_Passes[m_Order[position]];
+
+		/* transient targets come from the pool right before their first use */
+		for (RenderGraphResource index : pass.writes)
+		{
+			Resource& resource = m_Resources[index];
+			if (!resource.imported && resource.firstUse == position)
+				resource.target = pool.Acquire(resource.desc);
+		}
+
+		/* the query three frames back is the one we're about to reuse */
+		if (pass.queries[0] == 0)
+		{
+			GLCall(glGenQueries(3, pass.queries));
+		}
+		unsigned int query = pass.queries[pass.queryFrame % 3];
+		if (pass.queryFrame >= 3)
+		{
+			GLint available = 0;
+			GLCall(glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available));
+			if (available)
+			{
+				GLuint64 nanoseconds = 0;
+				GLCall(glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds));
+				pass.gpuMilliseconds = nanoseconds / 1000000.0;
+			}
+		}
+
+		auto start = std::chrono::high_resolution_clock::now();
+		GLCall(glBeginQuery(GL_TIME_ELAPSED, query));
+		pass.execute(RenderPassContext(*this, m_Order[position], pool));
+		GLCall(glEndQuery(GL_TIME_ELAPSED));
+		pass.cpuMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		pass.queryFrame++;
+
+		/* and go back after their last */
+		for (const std::vector<RenderGraphResource>* list : { &pass.reads, &pass.writes })
+		{
+			for (RenderGraphResource index : *list)
+			{
+				Resource& resource = m_Resources[index];
+				if (!resource.imported && resource.target && resource.lastUse == position)
+				{
+					pool.Release(resource.target);
+					resource.target = nullptr;
+				}
+			}
+		}
+	}
+}
+
+void RenderGraph::Clear()
+{
+	for (Pass& pass : m_Passes)
+	{
+		for (unsigned int query : pass.queries)
+			DeletionQueue::Delete(GLObjectType::QUERY, query);
+	}
+	m_Passes.clear();
+	m_Resources.clear();
+	m_Order.clear();
+	m_Compiled = false;
+}
+
+void RenderGraph::SetSize(unsigned int width, unsigned int height)
+{
+	m_Width = width;
+	m_Height = height;
+	for (Resource& resource : m_Resources)
+	{
+		if (resource.backbuffer)
+		{
+			resource.desc.width = width;
+			resource.desc.height = height;
+		}
+	}
+}
+
+std::vector<RenderPassTiming> RenderGraph::GetTimings() const
+{
+	std::vector<RenderPassTiming> timings;
+	for (unsigned int pass : m_Order)
+		timings.push_back({ m_Passes[pass].name.c_str(), m_Passes[pass].cpuMilliseconds, m_Passes[pass].gpuMilliseconds });
+	return timings;
+}
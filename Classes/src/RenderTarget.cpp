@@ -0,0 +1,96 @@
+#include "RenderTarget.h"
+
+#include "renderer.h"
+#include "DeletionQueue.h"
+
+RenderTarget::RenderTarget(const RenderTargetDesc& desc)
+	: m_RendererID(0), m_Desc(desc)
+{
+	ASSERT(desc.width > 0 && desc.height > 0 && desc.samples > 0);
+
+	GLCall(glGenTextures(1, &m_RendererID));
+	if (m_Desc.samples > 1)
+	{
+		GLCall(glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, m_RendererID));
+		GLCall(glTexStorage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, m_Desc.samples, m_Desc.internalFormat,
+			m_Desc.width, m_Desc.height, GL_TRUE));
+		return;
+	}
+
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLCall(glTexStorage2D(GL_TEXTURE_2D, 1, m_Desc.internalFormat, m_Desc.width, m_Desc.height));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+}
+
+RenderTarget::~RenderTarget()
+{
+	DeletionQueue::Delete(GLObjectType::TEXTURE, m_RendererID);
+}
+
+void RenderTarget::Bind(unsigned int slot) const
+{
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(GetTarget(), m_RendererID));
+}
+
+unsigned int RenderTarget::GetTarget() const
+{
+	return m_Desc.samples > 1 ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
+}
+
+unsigned long long RenderTarget::GetMemorySize() const
+{
+	return (unsigned long long)m_Desc.width * m_Desc.height * m_Desc.samples * GetBytesPerPixel(m_Desc.internalFormat);
+}
+
+bool RenderTarget::IsDepthFormat(unsigned int internalFormat)
+{
+	switch (internalFormat)
+	{
+	case GL_DEPTH_COMPONENT16:
+	case GL_DEPTH_COMPONENT24:
+	case GL_DEPTH_COMPONENT32F:
+	case GL_DEPTH24_STENCIL8:
+	case GL_DEPTH32F_STENCIL8:
+		return true;
+	}
+	return false;
+}
+
+bool RenderTarget::HasStencil(unsigned int internalFormat)
+{
+	return internalFormat == GL_DEPTH24_STENCIL8 || internalFormat == GL_DEPTH32F_STENCIL8;
+}
+
+unsigned int RenderTarget::GetBytesPerPixel(unsigned int internalFormat)
+{
+	switch (internalFormat)
+	{
+	case GL_R8:
+		return 1;
+	case GL_RG8:
+	case GL_R16F:
+	case GL_DEPTH_COMPONENT16:
+		return 2;
+	case GL_RGBA8:
+	case GL_SRGB8_ALPHA8:
+	case GL_RGB10_A2:
+	case GL_R11F_G11F_B10F:
+	case GL_RG16F:
+	case GL_R32F:
+	case GL_DEPTH_COMPONENT24:	/* stored padded to 32 bits */
+	case GL_DEPTH_COMPONENT32F:
+	case GL_DEPTH24_STENCIL8:
+		return 4;
+	case GL_RGBA16F:
+	case GL_RG32F:
+	case GL_DEPTH32F_STENCIL8:
+		return 8;
+	case GL_RGBA32F:
+		return 16;
+	}
+	return 0;
+}
@@ -0,0 +1,123 @@
+#include "RenderTargetPool.h"
+
+#include "renderer.h"
+
+RenderTargetPool::RenderTargetPool(unsigned int maxUnusedFrames)
+	: m_Frame(0), m_MaxUnusedFrames(maxUnusedFrames), m_Stats()
+{
+}
+
+RenderTarget* RenderTargetPool::Acquire(const RenderTargetDesc& desc)
+{
+	RenderTarget* target = nullptr;
+	for (PooledTarget& pooled : m_Targets)
+	{
+		if (!pooled.inUse && pooled.target->GetDesc() == desc)
+		{
+			pooled.inUse = true;
+			pooled.lastUsed = m_Frame;
+			target = pooled.target.get();
+			m_Stats.reused++;
+			break;
+		}
+	}
+
+	if (!target)
+	{
+		m_Targets.push_back({ std::make_unique<RenderTarget>(desc), true, m_Frame });
+		target = m_Targets.back().target.get();
+		m_Stats.targets++;
+		m_Stats.created++;
+		m_Stats.memory += target->GetMemorySize();
+		if (m_Stats.memory > m_Stats.peakMemory)
+			m_Stats.peakMemory = m_Stats.memory;
+	}
+
+	m_Stats.inUse++;
+	m_Stats.requestedMemory += target->GetMemorySize();
+	return target;
+}
+
+void RenderTargetPool::Release(const RenderTarget* target)
+{
+	for (PooledTarget& pooled : m_Targets)
+	{
+		if (pooled.target.get() == target)
+		{
+			ASSERT(pooled.inUse);
+			pooled.inUse = false;
+			m_Stats.inUse--;
+			return;
+		}
+	}
+	ASSERT(false); /* not from this pool */
+}
+
+FrameBuffer& RenderTargetPool::GetFrameBuffer(const RenderTarget* color, const RenderTarget* depth)
+{
+	for (CachedFrameBuffer& cached : m_FrameBuffers)
+	{
+		if (cached.color == color && cached.depth == depth)
+		{
+			cached.lastUsed = m_Frame;
+			return *cached.frameBuffer;
+		}
+	}
+
+	std::unique_ptr<FrameBuffer> frameBuffer = std::make_unique<FrameBuffer>();
+	if (color)
+		frameBuffer->AttachColor(color);
+	if (depth)
+		frameBuffer->AttachDepth(depth);
+	ASSERT(frameBuffer->IsComplete());
+	frameBuffer->Unbind();
+
+	m_FrameBuffers.push_back({ color, depth, std::move(frameBuffer), m_Frame });
+	return *m_FrameBuffers.back().frameBuffer;
+}
+
+void RenderTargetPool::EndFrame()
+{
+	/* framebuffers first, they point at the targets */
+	for (unsigned int i = 0; i < m_FrameBuffers.size();)
+	{
+		if (m_Frame - m_FrameBuffers[i].lastUsed >= m_MaxUnusedFrames)
+		{
+			m_FrameBuffers[i] = std::move(m_FrameBuffers.back());
+			m_FrameBuffers.pop_back();
+		}
+		else
+			i++;
+	}
+
+	for (unsigned int i = 0; i < m_Targets.size();)
+	{
+		PooledTarget& pooled = m_Targets[i];
+		pooled.inUse = false;
+		if (m_Frame - pooled.lastUsed >= m_MaxUnusedFrames)
+		{
+			m_Stats.targets--;
+			m_Stats.memory -= pooled.target->GetMemorySize();
+			pooled = std::move(m_Targets.back());
+			m_Targets.pop_back();
+		}
+		else
+			i++;
+	}
+
+	m_Frame++;
+	m_Stats.inUse = 0;
+	m_Stats.requestedMemory = 0;
+	m_Stats.created = 0;
+	m_Stats.reused = 0;
+}
+
+void RenderTargetPool::Clear()
+{
+	ASSERT(m_Stats.inUse == 0);
+
+	m_FrameBuffers.clear();
+	m_Targets.clear();
+	m_Stats.targets = 0;
+	m_Stats.memory = 0;
+}
@@ -0,0 +1,41 @@
+#include "ShaderStorageBuffer.h"
+
+#include "renderer.h"
+#include "DeletionQueue.h"
+
+ShaderStorageBuffer::ShaderStorageBuffer(const void* data, unsigned int size)
+	: m_Size(size)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID));
+	GLCall(glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, GL_DYNAMIC_COPY));
+}
+
+ShaderStorageBuffer::~ShaderStorageBuffer()
+{
+	DeletionQueue::Delete(GLObjectType::BUFFER, m_RendererID);
+}
+
+void ShaderStorageBuffer::BindBase(unsigned int index) const
+{
+	BindBase(index, m_RendererID);
+}
+
+void ShaderStorageBuffer::BindBase(unsigned int index, unsigned int rendererID)
+{
+	GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, rendererID));
+}
+
+void ShaderStorageBuffer::SetSubData(const void* data, unsigned int offset, unsigned int size)
+{
+	ASSERT(offset + size <= m_Size);
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID));
+	GLCall(glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data));
+}
+
+void ShaderStorageBuffer::GetSubData(void* data, unsigned int offset, unsigned int size) const
+{
+	ASSERT(offset + size <= m_Size);
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID));
+	GLCall(glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data));
+}
@@ -0,0 +1,166 @@
+#include "Texture.h"
+
+#include "renderer.h"
+#include "DeletionQueue.h"
+#include "TextureFile.h"
+
+Texture::Texture(unsigned int width, unsigned int height, unsigned int internalFormat, unsigned int levels)
+	: m_RendererID(0), m_Width(width), m_Height(height),
+	  m_Levels(levels ? levels : GetMaxLevels(width, height)), m_InternalFormat(internalFormat)
+{
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLCall(glTexStorage2D(GL_TEXTURE_2D, m_Levels, m_InternalFormat, m_Width, m_Height));
+
+	/* trilinear when there are mips to filter between */
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_Levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+}
+
+Texture::Texture(unsigned int width, unsigned int height, const void* pixels)
+	: Texture(width, height, GL_RGBA8)
+{
+	if (pixels)
+	{
+		SetData(pixels, GL_RGBA, GL_UNSIGNED_BYTE);
+		GenerateMipmaps();
+	}
+}
+
+Texture::Texture(const CompressedImage& image)
+	: Texture(image.width, image.height, image.internalFormat, (unsigned int)image.levels.size())
+{
+	for (unsigned int level = 0; level < image.levels.size(); level++)
+		SetCompressedData(image.levels[level].data, image.levels[level].size, level);
+}
+
+Texture::~Texture()
+{
+	DeletionQueue::Delete(GLObjectType::TEXTURE, m_RendererID);
+}
+
+Texture::Texture(Texture&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_Width(other.m_Width), m_Height(other.m_Height),
+	  m_Levels(other.m_Levels), m_InternalFormat(other.m_InternalFormat)
+{
+	other.m_RendererID = 0;
+}
+
+Texture& Texture::operator=(Texture&& other) noexcept
+{
+	if (this != &other)
+	{
+		DeletionQueue::Delete(GLObjectType::TEXTURE, m_RendererID);
+		m_RendererID = other.m_RendererID;
+		m_Width = other.m_Width;
+		m_Height = other.m_Height;
+		m_Levels = other.m_Levels;
+		m_InternalFormat = other.m_InternalFormat;
+		other.m_RendererID = 0;
+	}
+	return *this;
+}
+
+void Texture::SetData(const void* pixels, unsigned int format, unsigned int type, unsigned int level)
+{
+	unsigned int width = m_Width >> level ? m_Width >> level : 1;
+	unsigned int height = m_Height >> level ? m_Height >> level : 1;
+	SetSubData(0, 0, width, height, pixels, format, type, level);
+}
+
+void Texture::SetSubData(unsigned int x, unsigned int y, unsigned int width, unsigned int height,
+	const void* pixels, unsigned int format, unsigned int type, unsigned int level)
+{
+	ASSERT(level < m_Levels);
+
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	/* rows are tightly packed (the default expects 4 byte aligned rows),
+	   put the caller's alignment back afterwards */
+	GLint alignment;
+	GLCall(glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+	GLCall(glTexSubImage2D(GL_TEXTURE_2D, level, x, y, width, height, format, type, pixels));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, alignment));
+}
+
+void Texture::SetCompressedData(const void* data, unsigned int size, unsigned int level)
+{
+	ASSERT(level < m_Levels && IsCompressedFormat(m_InternalFormat));
+
+	unsigned int width = m_Width >> level ? m_Width >> level : 1;
+	unsigned int height = m_Height >> level ? m_Height >> level : 1;
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLCall(glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, m_InternalFormat, size, data));
+}
+
+void Texture::GenerateMipmaps()
+{
+	if (m_Levels < 2 || IsCompressedFormat(m_InternalFormat))
+		return;
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+}
+
+void Texture::Bind(unsigned int slot) const
+{
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+}
+
+void Texture::Unbind() const
+{
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+unsigned int Texture::GetPixelSize(unsigned int format, unsigned int type)
+{
+	unsigned int channels = 0;
+	switch (format)
+	{
+		case GL_RED:	channels = 1; break;
+		case GL_RG:		channels = 2; break;
+		case GL_RGB:	case GL_BGR:	channels = 3; break;
+		case GL_RGBA:	case GL_BGRA:	channels = 4; break;
+	}
+
+	switch (type)
+	{
+		case GL_UNSIGNED_BYTE:	return channels;
+		case GL_UNSIGNED_SHORT:
+		case GL_HALF_FLOAT:		return channels * 2;
+		case GL_FLOAT:			return channels * 4;
+	}
+	ASSERT(false);
+	return 0;
+}
+
+bool Texture::IsCompressedFormat(unsigned int internalFormat)
+{
+	switch (internalFormat)
+	{
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+			return true;
+	}
+	return false;
+}
+
+unsigned int Texture::GetMaxLevels(unsigned int width, unsigned int height)
+{
+	unsigned int size = width > height ? width : height;
+	unsigned int levels = 1;
+	while (size > 1)
+	{
+		size >>= 1;
+		levels++;
+	}
+	return levels;
+}
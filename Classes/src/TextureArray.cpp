@@ -0,0 +1,81 @@
+#include "TextureArray.h"
+
+#include "renderer.h"
+#include "DeletionQueue.h"
+#include "Texture.h"
+
+TextureArray::TextureArray(unsigned int width, unsigned int height, unsigned int layers,
+	unsigned int internalFormat, unsigned int levels)
+	: m_RendererID(0), m_Width(width), m_Height(height), m_Layers(layers),
+	  m_Levels(levels ? levels : Texture::GetMaxLevels(width, height)), m_InternalFormat(internalFormat)
+{
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID));
+	GLCall(glTexStorage3D(GL_TEXTURE_2D_ARRAY, m_Levels, m_InternalFormat, m_Width, m_Height, m_Layers));
+
+	GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, m_Levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+}
+
+TextureArray::~TextureArray()
+{
+	DeletionQueue::Delete(GLObjectType::TEXTURE, m_RendererID);
+}
+
+TextureArray::TextureArray(TextureArray&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_Width(other.m_Width), m_Height(other.m_Height), m_Layers(other.m_Layers),
+	  m_Levels(other.m_Levels), m_InternalFormat(other.m_InternalFormat)
+{
+	other.m_RendererID = 0;
+}
+
+TextureArray& TextureArray::operator=(TextureArray&& other) noexcept
+{
+	if (this != &other)
+	{
+		DeletionQueue::Delete(GLObjectType::TEXTURE, m_RendererID);
+		m_RendererID = other.m_RendererID;
+		m_Width = other.m_Width;
+		m_Height = other.m_Height;
+		m_Layers = other.m_Layers;
+		m_Levels = other.m_Levels;
+		m_InternalFormat = other.m_InternalFormat;
+		other.m_RendererID = 0;
+	}
+	return *this;
+}
+
+void TextureArray::SetSubData(unsigned int layer, unsigned int x, unsigned int y, unsigned int width, unsigned int height,
+	const void* pixels, unsigned int format, unsigned int type, unsigned int level)
+{
+	ASSERT(layer < m_Layers && level < m_Levels);
+
+	GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID));
+	/* same as Texture::SetSubData: tight rows, caller's alignment restored */
+	GLint alignment;
+	GLCall(glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+	GLCall(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, x, y, layer, width, height, 1, format, type, pixels));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, alignment));
+}
+
+void TextureArray::GenerateMipmaps()
+{
+	if (m_Levels < 2)
+		return;
+	GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID));
+	GLCall(glGenerateMipmap(GL_TEXTURE_2D_ARRAY));
+}
+
+void TextureArray::Bind(unsigned int slot) const
+{
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID));
+}
+
+void TextureArray::Unbind() const
+{
+	GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
+}
@@ -0,0 +1,228 @@
+#include "TextureAtlas.h"
+
+#include <iostream>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include "renderer.h"
+
+SkylinePacker::SkylinePacker(unsigned int width, unsigned int height)
+	: m_Width(width), m_Height(height), m_UsedArea(0)
+{
+	Clear();
+}
+
+void SkylinePacker::Clear()
+{
+	m_Skyline.clear();
+	m_Skyline.push_back({ 0, 0, m_Width });
+	m_UsedArea = 0;
+}
+
+bool SkylinePacker::Fit(size_t index, unsigned int width, unsigned int height, unsigned int& y) const
+{
+	unsigned int x = m_Skyline[index].x;
+	if (x + width > m_Width)
+		return false;
+
+	/* the rectangle rests on the highest segment it spans */
+	y = 0;
+	unsigned int covered = 0;
+	for (size_t i = index; covered < width; i++)
+	{
+		if (i >= m_Skyline.size())
+			return false;
+		y = m_Skyline[i].y > y ? m_Skyline[i].y : y;
+		if (y + height > m_Height)
+			return false;
+		covered += m_Skyline[i].width;
+	}
+	return true;
+}
+
+bool SkylinePacker::Insert(unsigned int width, unsigned int height, unsigned int& x, unsigned int& y)
+{
+	size_t bestIndex = SIZE_MAX;
+	unsigned int bestTop = UINT_MAX, bestWidth = UINT_MAX;
+
+	for (size_t i = 0; i < m_Skyline.size(); i++)
+	{
+		unsigned int top;
+		if (!Fit(i, width, height, top))
+			continue;
+
+		/* lowest top edge first, narrowest segment breaks ties */
+		if (top + height < bestTop || (top + height == bestTop && m_Skyline[i].width < bestWidth))
+		{
+			bestIndex = i;
+			bestTop = top + height;
+			bestWidth = m_Skyline[i].width;
+			x = m_Skyline[i].x;
+			y = top;
+		}
+	}
+
+	if (bestIndex == SIZE_MAX)
+		return false;
+
+	AddLevel(bestIndex, x, y, width, height);
+	m_UsedArea += (unsigned long long)width * height;
+	return true;
+}
+
+void SkylinePacker::AddLevel(size_t index, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+	m_Skyline.insert(m_Skyline.begin() + index, { x, y + height, width });
+
+	/* cut away the part of the following segments now under the new one */
+	for (size_t i = index + 1; i < m_Skyline.size(); i++)
+	{
+		const Segment& previous = m_Skyline[i - 1];
+		Segment& segment = m_Skyline[i];
+		unsigned int previousEnd = previous.x + previous.width;
+		if (segment.x >= previousEnd)
+			break;
+
+		unsigned int shrink = previousEnd - segment.x;
+		if (segment.width <= shrink)
+		{
+			m_Skyline.erase(m_Skyline.begin() + i);
+			i--;
+			continue;
+		}
+		segment.x += shrink;
+		segment.width -= shrink;
+		break;
+	}
+
+	/* neighbours at the same height become one segment */
+	for (size_t i = 0; i + 1 < m_Skyline.size();)
+	{
+		if (m_Skyline[i].y == m_Skyline[i + 1].y)
+		{
+			m_Skyline[i].width += m_Skyline[i + 1].width;
+			m_Skyline.erase(m_Skyline.begin() + i + 1);
+		}
+		else
+			i++;
+	}
+}
+
+const unsigned int TextureAtlas::INVALID_REGION;
+
+TextureAtlas::TextureAtlas(unsigned int width, unsigned int height, unsigned int maxLayers, unsigned int padding)
+	: m_Width(width), m_Height(height), m_MaxLayers(maxLayers), m_Padding(padding), m_LayerCount(0)
+{
+}
+
+unsigned int TextureAtlas::Add(unsigned int width, unsigned int height, const void* pixels)
+{
+	ASSERT(!m_Texture);
+	if (width == 0 || height == 0)
+	{
+		std::cout << "Texture atlas can't hold an empty image (" << width << "x" << height << ")" << std::endl;
+		return INVALID_REGION;
+	}
+
+	m_Images.push_back({ width, height, (const unsigned char*)pixels });
+	m_Regions.push_back({ 0, 0, width, height, 0, 0.0f, 0.0f, 0.0f, 0.0f });
+	return (unsigned int)m_Images.size() - 1;
+}
+
+bool TextureAtlas::Build()
+{
+	ASSERT(!m_Texture);
+
+	/* tall images first packs noticeably tighter */
+	std::vector<unsigned int> order(m_Images.size());
+	for (unsigned int i = 0; i < order.size(); i++)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b)
+	{
+		if (m_Images[a].height != m_Images[b].height)
+			return m_Images[a].height > m_Images[b].height;
+		return m_Images[a].width > m_Images[b].width;
+	});
+
+	std::vector<SkylinePacker> layers;
+	for (unsigned int id : order)
+	{
+		const Image& image = m_Images[id];
+		unsigned int width = image.width + 2 * m_Padding;
+		unsigned int height = image.height + 2 * m_Padding;
+
+		/* every open layer first, a new layer only when none has room */
+		unsigned int x = 0, y = 0, layer = 0;
+		bool placed = false;
+		for (; layer < layers.size() && !placed; layer++)
+			placed = layers[layer].Insert(width, height, x, y);
+		if (placed)
+			layer--;
+		else
+		{
+			if (layers.size() >= m_MaxLayers)
+			{
+				std::cout << "Texture atlas is full (" << m_MaxLayers << " layers of " << m_Width << "x" << m_Height << ")" << std::endl;
+				return false;
+			}
+			layers.emplace_back(m_Width, m_Height);
+			layer = (unsigned int)layers.size() - 1;
+			if (!layers[layer].Insert(width, height, x, y))
+			{
+				std::cout << "Image " << image.width << "x" << image.height << " is too big for the texture atlas" << std::endl;
+				return false;
+			}
+		}
+
+		AtlasRegion& region = m_Regions[id];
+		region.x = x + m_Padding;
+		region.y = y + m_Padding;
+		region.layer = layer;
+		region.u0 = (float)region.x / m_Width;
+		region.v0 = (float)region.y / m_Height;
+		region.u1 = (float)(region.x + region.width) / m_Width;
+		region.v1 = (float)(region.y + region.height) / m_Height;
+	}
+
+	m_LayerCount = layers.empty() ? 1 : (unsigned int)layers.size();
+	m_Texture = std::make_unique<TextureArray>(m_Width, m_Height, m_LayerCount, GL_RGBA8);
+
+	/* upload every image with its edge pixels repeated into the padding */
+	std::vector<unsigned char> padded;
+	for (unsigned int id = 0; id < m_Images.size(); id++)
+	{
+		const Image& image = m_Images[id];
+		const AtlasRegion& region = m_Regions[id];
+		unsigned int width = image.width + 2 * m_Padding;
+		unsigned int height = image.height + 2 * m_Padding;
+		padded.resize((size_t)width * height * 4);
+
+		for (unsigned int row = 0; row < height; row++)
+		{
+			unsigned int sourceRow = row < m_Padding ? 0 : std::min(row - m_Padding, image.height - 1);
+			const unsigned char* source = image.pixels + (size_t)sourceRow * image.width * 4;
+			unsigned char* destination = padded.data() + (size_t)row * width * 4;
+			for (unsigned int column = 0; column < m_Padding; column++)
+			{
+				memcpy(destination + column * 4, source, 4);
+				memcpy(destination + (m_Padding + image.width + column) * 4, source + (image.width - 1) * 4, 4);
+			}
+			memcpy(destination + m_Padding * 4, source, (size_t)image.width * 4);
+		}
+
+		m_Texture->SetSubData(region.layer, region.x - m_Padding, region.y - m_Padding, width, height,
+			padded.data(), GL_RGBA, GL_UNSIGNED_BYTE);
+	}
+	m_Texture->GenerateMipmaps();
+
+	/* the pixels were only borrowed until now */
+	m_Images.clear();
+	return true;
+}
+
+void TextureAtlas::Bind(unsigned int slot) const
+{
+	ASSERT(m_Texture);
+	m_Texture->Bind(slot);
+}
@@ -0,0 +1,319 @@
+#include "TextureFile.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+
+#include "renderer.h"
+
+#define DDS_MAGIC 0x20534444 /* "DDS " */
+#define DDS_FOURCC(a, b, c, d) ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+#define DDPF_FOURCC 0x4
+#define DDSD_CAPS 0x1
+#define DDSD_HEIGHT 0x2
+#define DDSD_WIDTH 0x4
+#define DDSD_PIXELFORMAT 0x1000
+#define DDSD_MIPMAPCOUNT 0x20000
+#define DDSD_LINEARSIZE 0x80000
+#define DDSCAPS_COMPLEX 0x8
+#define DDSCAPS_TEXTURE 0x1000
+#define DDSCAPS_MIPMAP 0x400000
+
+/* DXGI_FORMAT values used in the DX10 header */
+#define DXGI_FORMAT_BC1_UNORM 71
+#define DXGI_FORMAT_BC1_UNORM_SRGB 72
+#define DXGI_FORMAT_BC3_UNORM 77
+#define DXGI_FORMAT_BC3_UNORM_SRGB 78
+#define DXGI_FORMAT_BC7_UNORM 98
+#define DXGI_FORMAT_BC7_UNORM_SRGB 99
+#define DDS_DIMENSION_TEXTURE2D 3
+
+/* VkFormat values used by KTX2 */
+#define VK_FORMAT_BC1_RGB_UNORM_BLOCK 131
+#define VK_FORMAT_BC1_RGB_SRGB_BLOCK 132
+#define VK_FORMAT_BC1_RGBA_UNORM_BLOCK 133
+#define VK_FORMAT_BC1_RGBA_SRGB_BLOCK 134
+#define VK_FORMAT_BC3_UNORM_BLOCK 137
+#define VK_FORMAT_BC3_SRGB_BLOCK 138
+#define VK_FORMAT_BC7_UNORM_BLOCK 145
+#define VK_FORMAT_BC7_SRGB_BLOCK 146
+
+struct DdsPixelFormat
+{
+	uint32_t size, flags, fourCC, rgbBitCount;
+	uint32_t rBitMask, gBitMask, bBitMask, aBitMask;
+};
+
+struct DdsHeader
+{
+	uint32_t size, flags, height, width, pitchOrLinearSize, depth, mipMapCount;
+	uint32_t reserved1[11];
+	DdsPixelFormat pixelFormat;
+	uint32_t caps, caps2, caps3, caps4, reserved2;
+};
+
+struct DdsHeaderDX10
+{
+	uint32_t dxgiFormat, resourceDimension, miscFlag, arraySize, miscFlags2;
+};
+
+struct Ktx2Header
+{
+	unsigned char identifier[12];
+	uint32_t vkFormat, typeSize, pixelWidth, pixelHeight, pixelDepth;
+	uint32_t layerCount, faceCount, levelCount, supercompressionScheme;
+	uint32_t dfdByteOffset, dfdByteLength, kvdByteOffset, kvdByteLength;
+	uint64_t sgdByteOffset, sgdByteLength;
+};
+
+struct Ktx2Level
+{
+	uint64_t byteOffset, byteLength, uncompressedByteLength;
+};
+
+static unsigned int GetBlockBytes(unsigned int internalFormat)
+{
+	switch (internalFormat)
+	{
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+			return 8;
+		default:
+			return 16;
+	}
+}
+
+/* bytes of one level, 64 bit so huge header dimensions can't wrap */
+static uint64_t GetLevelSize(unsigned int internalFormat, unsigned int width, unsigned int height)
+{
+	return (uint64_t)((width + 3ull) / 4) * ((height + 3ull) / 4) * GetBlockBytes(internalFormat);
+}
+
+/* levels in a full mip chain down to 1x1 */
+static unsigned int GetMipChainLength(unsigned int width, unsigned int height)
+{
+	unsigned int levels = 1;
+	for (unsigned int size = width > height ? width : height; size > 1; size /= 2)
+		levels++;
+	return levels;
+}
+
+TextureFile::TextureFile(const std::string& filepath)
+	: m_File(filepath), m_Image({ 0, 0, 0, {} }), m_Valid(false)
+{
+	if (!m_File.IsOpen())
+		return;
+
+	static const unsigned char ktx2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+	if (m_File.GetSize() >= 4 && *(const uint32_t*)m_File.GetData() == DDS_MAGIC)
+		m_Valid = ReadDds(filepath);
+	else if (m_File.GetSize() >= sizeof(Ktx2Header) && memcmp(m_File.GetData(), ktx2Identifier, 12) == 0)
+		m_Valid = ReadKtx2(filepath);
+	else
+		std::cout << "'" << filepath << "' is neither a DDS nor a KTX2 file" << std::endl;
+}
+
+/* lays out `levelCount` tightly packed levels starting at data (DDS order) */
+bool TextureFile::AddLevels(const std::string& filepath, const unsigned char* data, unsigned int levelCount)
+{
+	const unsigned char* end = m_File.GetData() + m_File.GetSize();
+	unsigned int width = m_Image.width, height = m_Image.height;
+	for (unsigned int level = 0; level < levelCount; level++)
+	{
+		/* compared against what's left, data + size could point past the mapping */
+		uint64_t size = GetLevelSize(m_Image.internalFormat, width, height);
+		if (size > (uint64_t)(end - data) || size > 0xFFFFFFFF)
+		{
+			std::cout << "'" << filepath << "' is truncated" << std::endl;
+			return false;
+		}
+		m_Image.levels.push_back({ data, (unsigned int)size, width, height });
+		data += size;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+	return true;
+}
+
+bool TextureFile::ReadDds(const std::string& filepath)
+{
+	const unsigned char* data = m_File.GetData() + 4;
+	if (m_File.GetSize() < 4 + sizeof(DdsHeader))
+	{
+		std::cout << "'" << filepath << "' is truncated" << std::endl;
+		return false;
+	}
+
+	DdsHeader header;
+	memcpy(&header, data, sizeof(header));
+	data += sizeof(header);
+
+	m_Image.width = header.width;
+	m_Image.height = header.height;
+
+	if (!(header.pixelFormat.flags & DDPF_FOURCC))
+	{
+		std::cout << "'" << filepath << "' is not block compressed" << std::endl;
+		return false;
+	}
+
+	switch (header.pixelFormat.fourCC)
+	{
+		case DDS_FOURCC('D', 'X', 'T', '1'):	m_Image.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;
+		case DDS_FOURCC('D', 'X', 'T', '5'):	m_Image.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+		case DDS_FOURCC('D', 'X', '1', '0'):
+		{
+			if (m_File.GetSize() < 4 + sizeof(DdsHeader) + sizeof(DdsHeaderDX10))
+				return false;
+			DdsHeaderDX10 dx10;
+			memcpy(&dx10, data, sizeof(dx10));
+			data += sizeof(dx10);
+			if (dx10.resourceDimension != DDS_DIMENSION_TEXTURE2D || dx10.arraySize > 1)
+			{
+				std::cout << "'" << filepath << "' is not a single 2D texture" << std::endl;
+				return false;
+			}
+			switch (dx10.dxgiFormat)
+			{
+				case DXGI_FORMAT_BC1_UNORM:			m_Image.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;
+				case DXGI_FORMAT_BC1_UNORM_SRGB:	m_Image.internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; break;
+				case DXGI_FORMAT_BC3_UNORM:			m_Image.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+				case DXGI_FORMAT_BC3_UNORM_SRGB:	m_Image.internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; break;
+				case DXGI_FORMAT_BC7_UNORM:			m_Image.internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM; break;
+				case DXGI_FORMAT_BC7_UNORM_SRGB:	m_Image.internalFormat = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; break;
+			}
+			break;
+		}
+	}
+
+	if (m_Image.internalFormat == 0)
+	{
+		std::cout << "'" << filepath << "' uses an unsupported compression format" << std::endl;
+		return false;
+	}
+
+	unsigned int levelCount = (header.flags & DDSD_MIPMAPCOUNT) && header.mipMapCount > 0 ? header.mipMapCount : 1;
+	if (m_Image.width == 0 || m_Image.height == 0 || levelCount > GetMipChainLength(m_Image.width, m_Image.height))
+	{
+		std::cout << "'" << filepath << "' has an invalid size (" << m_Image.width << "x" << m_Image.height
+			<< ", " << levelCount << " levels)" << std::endl;
+		return false;
+	}
+	return AddLevels(filepath, data, levelCount);
+}
+
+bool TextureFile::ReadKtx2(const std::string& filepath)
+{
+	Ktx2Header header;
+	memcpy(&header, m_File.GetData(), sizeof(header));
+
+	if (header.supercompressionScheme != 0 || header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1)
+	{
+		std::cout << "'" << filepath << "' is supercompressed or not a single 2D texture" << std::endl;
+		return false;
+	}
+
+	switch (header.vkFormat)
+	{
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:		m_Image.internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT; break;
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:		m_Image.internalFormat = GL_COMPRESSED_SRGB_S3TC_DXT1_EXT; break;
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:	m_Image.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:		m_Image.internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; break;
+		case VK_FORMAT_BC3_UNORM_BLOCK:			m_Image.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+		case VK_FORMAT_BC3_SRGB_BLOCK:			m_Image.internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; break;
+		case VK_FORMAT_BC7_UNORM_BLOCK:			m_Image.internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM; break;
+		case VK_FORMAT_BC7_SRGB_BLOCK:			m_Image.internalFormat = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; break;
+		default:
+			std::cout << "'" << filepath << "' uses an unsupported format (VkFormat " << header.vkFormat << ")" << std::endl;
+			return false;
+	}
+
+	m_Image.width = header.pixelWidth;
+	m_Image.height = header.pixelHeight ? header.pixelHeight : 1;
+
+	/* the level index follows the header, level 0 (the largest) first */
+	unsigned int levelCount = header.levelCount ? header.levelCount : 1;
+	if (m_Image.width == 0 || levelCount > GetMipChainLength(m_Image.width, m_Image.height))
+	{
+		std::cout << "'" << filepath << "' has an invalid size (" << m_Image.width << "x" << m_Image.height
+			<< ", " << levelCount << " levels)" << std::endl;
+		return false;
+	}
+	if (sizeof(Ktx2Header) + levelCount * sizeof(Ktx2Level) > m_File.GetSize())
+	{
+		std::cout << "'" << filepath << "' is truncated" << std::endl;
+		return false;
+	}
+
+	unsigned int width = m_Image.width, height = m_Image.height;
+	for (unsigned int level = 0; level < levelCount; level++)
+	{
+		Ktx2Level index;
+		memcpy(&index, m_File.GetData() + sizeof(Ktx2Header) + level * sizeof(Ktx2Level), sizeof(index));
+		if (index.byteOffset > m_File.GetSize() || index.byteLength > m_File.GetSize() - index.byteOffset)
+		{
+			std::cout << "'" << filepath << "' is truncated" << std::endl;
+			return false;
+		}
+		if (index.byteLength != GetLevelSize(m_Image.internalFormat, width, height) || index.byteLength > 0xFFFFFFFF)
+		{
+			std::cout << "'" << filepath << "' level " << level << " has the wrong size (" << index.byteLength << " bytes)" << std::endl;
+			return false;
+		}
+		m_Image.levels.push_back({ m_File.GetData() + index.byteOffset, (unsigned int)index.byteLength, width, height });
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+	return true;
+}
+
+bool TextureFile::WriteDds(const std::string& filepath, unsigned int internalFormat, unsigned int width, unsigned int height,
+	const std::vector<std::vector<unsigned char>>& levels)
+{
+	DdsHeader header;
+	memset(&header, 0, sizeof(header));
+	header.size = sizeof(DdsHeader);
+	header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+	header.width = width;
+	header.height = height;
+	header.pitchOrLinearSize = levels.empty() ? 0 : (uint32_t)levels[0].size();
+	header.mipMapCount = (uint32_t)levels.size();
+	header.pixelFormat.size = sizeof(DdsPixelFormat);
+	header.pixelFormat.flags = DDPF_FOURCC;
+	header.caps = DDSCAPS_TEXTURE | (levels.size() > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+	DdsHeaderDX10 dx10 = { 0, DDS_DIMENSION_TEXTURE2D, 0, 1, 0 };
+	switch (internalFormat)
+	{
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:	header.pixelFormat.fourCC = DDS_FOURCC('D', 'X', 'T', '1'); break;
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:	header.pixelFormat.fourCC = DDS_FOURCC('D', 'X', 'T', '5'); break;
+		case GL_COMPRESSED_RGBA_BPTC_UNORM:
+			/* BC7 has no FourCC of its own */
+			header.pixelFormat.fourCC = DDS_FOURCC('D', 'X', '1', '0');
+			dx10.dxgiFormat = DXGI_FORMAT_BC7_UNORM;
+			break;
+		default:
+			ASSERT(false);
+			return false;
+	}
+
+	std::ofstream stream(filepath, std::ios::binary);
+	if (!stream)
+	{
+		std::cout << "Failed to create '" << filepath << "'" << std::endl;
+		return false;
+	}
+
+	uint32_t magic = DDS_MAGIC;
+	stream.write((const char*)&magic, sizeof(magic));
+	stream.write((const char*)&header, sizeof(header));
+	if (dx10.dxgiFormat)
+		stream.write((const char*)&dx10, sizeof(dx10));
+	for (const std::vector<unsigned char>& level : levels)
+		stream.write((const char*)level.data(), level.size());
+
+	return (bool)stream;
+}
@@ -0,0 +1,129 @@
+#include "TextureStreamer.h"
+
+#include <cstring>
+
+#include "renderer.h"
+#include "DeletionQueue.h"
+#include "Texture.h"
+
+TextureStreamer::TextureStreamer(unsigned int bufferCount, unsigned int bufferSize, unsigned int bytesPerFrame)
+	: m_Buffers(bufferCount), m_BufferSize(bufferSize), m_BytesPerFrame(bytesPerFrame), m_NextBuffer(0)
+{
+	ASSERT(bufferCount > 0 && bufferSize > 0);
+
+	for (StagingBuffer& buffer : m_Buffers)
+	{
+		buffer.fence = nullptr;
+		GLCall(glGenBuffers(1, &buffer.rendererID));
+		GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.rendererID));
+		GLCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, m_BufferSize, nullptr, GL_STREAM_DRAW));
+	}
+	GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	for (StagingBuffer& buffer : m_Buffers)
+	{
+		if (buffer.fence)
+		{
+			GLCall(glDeleteSync(buffer.fence));
+		}
+		DeletionQueue::Delete(GLObjectType::BUFFER, buffer.rendererID);
+	}
+}
+
+void TextureStreamer::Queue(Texture& texture, const void* pixels, unsigned int format, unsigned int type,
+	unsigned int level, bool generateMipmaps)
+{
+	unsigned int width = texture.GetWidth() >> level ? texture.GetWidth() >> level : 1;
+	unsigned int height = texture.GetHeight() >> level ? texture.GetHeight() >> level : 1;
+	if ((size_t)width * Texture::GetPixelSize(format, type) > m_BufferSize)
+	{
+		/* not even one row fits in a staging buffer, upload it directly */
+		texture.SetSubData(0, 0, width, height, pixels, format, type, level);
+		if (generateMipmaps && level == 0)
+			texture.GenerateMipmaps();
+		return;
+	}
+
+	m_Queue.push_back({ &texture, (const unsigned char*)pixels, format, type, level, 0, generateMipmaps });
+}
+
+bool TextureStreamer::AcquireBuffer(StagingBuffer& buffer)
+{
+	if (!buffer.fence)
+		return true;
+
+	/* timeout 0: only asks, never blocks */
+	GLCall(GLenum status = glClientWaitSync(buffer.fence, 0, 0));
+	if (status == GL_TIMEOUT_EXPIRED)
+		return false;
+
+	GLCall(glDeleteSync(buffer.fence));
+	buffer.fence = nullptr;
+	return true;
+}
+
+unsigned int TextureStreamer::Update()
+{
+	unsigned int sent = 0;
+	unsigned int tried = 0;
+
+	while (!m_Queue.empty() && sent < m_BytesPerFrame && tried < m_Buffers.size())
+	{
+		StagingBuffer& buffer = m_Buffers[m_NextBuffer];
+		if (!AcquireBuffer(buffer))
+		{
+			/* the oldest buffer is still in flight, so are the newer ones */
+			break;
+		}
+
+		Upload& upload = m_Queue.front();
+		Texture& texture = *upload.texture;
+		unsigned int width = texture.GetWidth() >> upload.level ? texture.GetWidth() >> upload.level : 1;
+		unsigned int height = texture.GetHeight() >> upload.level ? texture.GetHeight() >> upload.level : 1;
+		unsigned int rowSize = width * Texture::GetPixelSize(upload.format, upload.type);
+
+		/* as many rows as fit in the buffer and what's left of this frame's budget,
+		   always at least one so a tiny budget can't stall the queue */
+		unsigned int budget = m_BytesPerFrame - sent < m_BufferSize ? m_BytesPerFrame - sent : m_BufferSize;
+		unsigned int rows = budget / rowSize;
+		if (rows == 0)
+			rows = 1;
+		if (rows > height - upload.nextRow)
+			rows = height - upload.nextRow;
+		unsigned int size = rows * rowSize;
+		ASSERT(size <= m_BufferSize);
+
+		GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.rendererID));
+		/* the fence says the GPU is done with this buffer, no need for the driver to sync again */
+		GLCall(void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+		if (mapped)
+		{
+			memcpy(mapped, upload.pixels + (size_t)upload.nextRow * rowSize, size);
+			GLCall(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+
+			/* pixels == offset into the bound unpack buffer */
+			texture.SetSubData(0, upload.nextRow, width, rows, nullptr, upload.format, upload.type, upload.level);
+			GLCall(buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+
+			upload.nextRow += rows;
+			sent += size;
+		}
+		GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+		m_NextBuffer = (m_NextBuffer + 1) % m_Buffers.size();
+		tried++;
+
+		if (upload.nextRow >= height)
+		{
+			if (upload.generateMipmaps && upload.level == 0)
+				texture.GenerateMipmaps();
+			m_Queue.pop_front();
+		}
+	}
+
+	return sent;
+}
@@ -0,0 +1,256 @@
+#include "TransformHierarchy.h"
+
+#include <algorithm>
+#include <mutex>
+#include <type_traits>
+
+#include "renderer.h"
+#include "JobSystem.h"
+
+#define PARALLEL_LEVEL_SIZE 4096	/* smaller depths aren't worth splitting */
+#define UPDATE_GRAIN 1024
+#define RANGE_GAP 16				/* unchanged slots a changed range may span */
+#define MAX_CHANGED_RANGES 256		/* past this, one upload of the whole span is cheaper */
+
+TransformHierarchy::TransformHierarchy()
+	: m_Sorted(true), m_Updated(0)
+{
+}
+
+TransformNode TransformHierarchy::Create(TransformNode parent)
+{
+	unsigned int parentSlot = INVALID_NODE;
+	unsigned int depth = 0;
+	if (parent != INVALID_NODE)
+	{
+		ASSERT(parent < m_Slots.size());
+		parentSlot = m_Slots[parent];
+		depth = m_Depths[parentSlot] + 1;
+	}
+
+	/* appended, still sorted as long as it isn't shallower than the last */
+	unsigned int slot = (unsigned int)m_Nodes.size();
+	if (slot > 0 && depth < m_Depths[slot - 1])
+		m_Sorted = false;
+
+	TransformNode node = (TransformNode)m_Slots.size();
+	m_Slots.push_back(slot);
+	m_Nodes.push_back(node);
+	m_Parents.push_back(parentSlot);
+	m_Depths.push_back(depth);
+	m_Positions.push_back({ 0.0f, 0.0f, 0.0f });
+	m_Rotations.push_back(Quat::Identity());
+	m_Scales.push_back({ 1.0f, 1.0f, 1.0f });
+	m_Local.push_back(Mat4::Identity());
+	m_World.push_back(Mat4::Identity());
+	m_Flags.push_back(LOCAL_CHANGED);
+
+	if (m_Sorted)
+	{
+		/* a new depth, or the end of the last one moves */
+		if (m_LevelStarts.empty())
+			m_LevelStarts.push_back(0);
+		if (depth + 1 >= m_LevelStarts.size())
+			m_LevelStarts.push_back(slot + 1);
+		else
+			m_LevelStarts.back() = slot + 1;
+	}
+	return node;
+}
+
+void TransformHierarchy::Reserve(unsigned int count)
+{
+	m_Parents.reserve(count);
+	m_Depths.reserve(count);
+	m_Positions.reserve(count);
+	m_Rotations.reserve(count);
+	m_Scales.reserve(count);
+	m_Local.reserve(count);
+	m_World.reserve(count);
+	m_Flags.reserve(count);
+	m_Nodes.reserve(count);
+	m_Slots.reserve(count);
+}
+
+void TransformHierarchy::Clear()
+{
+	m_Parents.clear();
+	m_Depths.clear();
+	m_Positions.clear();
+	m_Rotations.clear();
+	m_Scales.clear();
+	m_Local.clear();
+	m_World.clear();
+	m_Flags.clear();
+	m_Nodes.clear();
+	m_Slots.clear();
+	m_LevelStarts.clear();
+	m_Sorted = true;
+	m_Changed.clear();
+	m_Updated = 0;
+}
+
+void TransformHierarchy::SetPosition(TransformNode node, const Vec3& position)
+{
+	unsigned int slot = m_Slots[node];
+	m_Positions[slot] = position;
+	m_Flags[slot] |= TRS_DIRTY;
+}
+
+void TransformHierarchy::SetRotation(TransformNode node, const Quat& rotation)
+{
+	unsigned int slot = m_Slots[node];
+	m_Rotations[slot] = rotation;
+	m_Flags[slot] |= TRS_DIRTY;
+}
+
+void TransformHierarchy::SetScale(TransformNode node, const Vec3& scale)
+{
+	unsigned int slot = m_Slots[node];
+	m_Scales[slot] = scale;
+	m_Flags[slot] |= TRS_DIRTY;
+}
+
+void TransformHierarchy::SetLocalMatrix(TransformNode node, const Mat4& local)
+{
+	unsigned int slot = m_Slots[node];
+	m_Local[slot] = local;
+	m_Flags[slot] = (m_Flags[slot] & ~TRS_DIRTY) | LOCAL_CHANGED;
+}
+
+void TransformHierarchy::Sort()
+{
+	/* counting sort by depth, stable, so the order within a depth stays */
+	unsigned int count = (unsigned int)m_Nodes.size();
+	unsigned int levels = 0;
+	for (unsigned int depth : m_Depths)
+		levels = std::max(levels, depth + 1);
+
+	m_LevelStarts.assign(levels + 1, 0);
+	for (unsigned int depth : m_Depths)
+		m_LevelStarts[depth + 1]++;
+	for (unsigned int i = 0; i < levels; i++)
+		m_LevelStarts[i + 1] += m_LevelStarts[i];
+
+	std::vector<unsigned int> newSlots(count);
+	std::vector<unsigned int> next(m_LevelStarts.begin(), m_LevelStarts.end() - 1);
+	for (unsigned int slot = 0; slot < count; slot++)
+		newSlots[slot] = next[m_Depths[slot]]++;
+
+	auto permute = [&](auto& array)
+	{
+		typename std::remove_reference<decltype(array)>::type sorted(array.size());
+		for (unsigned int slot = 0; slot < count; slot++)
+			sorted[newSlots[slot]] = array[slot];
+		array.swap(sorted);
+	};
+	for (unsigned int& parent : m_Parents)
+	{
+		if (parent != INVALID_NODE)
+			parent = newSlots[parent];
+	}
+	permute(m_Parents);
+	permute(m_Depths);
+	permute(m_Positions);
+	permute(m_Rotations);
+	permute(m_Scales);
+	permute(m_Local);
+	permute(m_World);
+	permute(m_Flags);
+	permute(m_Nodes);
+	for (unsigned int slot = 0; slot < count; slot++)
+		m_Slots[m_Nodes[slot]] = slot;
+
+	m_Sorted = true;
+}
+
+/* adds slot to the last range, or starts a new one */
+static void AddChanged(std::vector<SlotRange>& changed, unsigned int slot)
+{
+	if (!changed.empty() && slot <= changed.back().end + RANGE_GAP)
+		changed.back().end = slot + 1;
+	else
+		changed.push_back({ slot, slot + 1 });
+}
+
+void TransformHierarchy::UpdateRange(unsigned int begin, unsigned int end, std::vector<SlotRange>& changed, unsigned int& updated)
+{
+	for (unsigned int slot = begin; slot < end; slot++)
+	{
+		unsigned char flags = m_Flags[slot];
+		unsigned int parent = m_Parents[slot];
+		/* the parent is one depth up, it was done before this depth began */
+		bool parentChanged = parent != INVALID_NODE && (m_Flags[parent] & WORLD_CHANGED);
+
+		if (!(flags & (TRS_DIRTY | LOCAL_CHANGED)) && !parentChanged)
+		{
+			m_Flags[slot] = 0;
+			continue;
+		}
+
+		if (flags & TRS_DIRTY)
+			m_Local[slot] = Mat4::TRS(m_Positions[slot], m_Rotations[slot], m_Scales[slot]);
+		m_World[slot] = parent == INVALID_NODE ? m_Local[slot] : m_World[parent] * m_Local[slot];
+		m_Flags[slot] = WORLD_CHANGED;
+
+		AddChanged(changed, slot);
+		updated++;
+	}
+}
+
+void TransformHierarchy::Update(JobSystem* jobs)
+{
+	bool resorted = !m_Sorted;
+	if (resorted)
+		Sort();
+
+	m_Changed.clear();
+	m_Updated = 0;
+	bool parallel = false;
+	std::mutex merge;
+	for (unsigned int level = 0; level + 1 < m_LevelStarts.size(); level++)
+	{
+		unsigned int begin = m_LevelStarts[level], end = m_LevelStarts[level + 1];
+		if (!jobs || end - begin < PARALLEL_LEVEL_SIZE)
+		{
+			UpdateRange(begin, end, m_Changed, m_Updated);
+			continue;
+		}
+
+		/* every piece collects its own ranges, they are put in order below */
+		parallel = true;
+		jobs->ParallelFor(end - begin, UPDATE_GRAIN, [&](unsigned int first, unsigned int last)
+		{
+			std::vector<SlotRange> changed;
+			unsigned int updated = 0;
+			UpdateRange(begin + first, begin + last, changed, updated);
+			if (updated == 0)
+				return;
+			std::lock_guard<std::mutex> lock(merge);
+			m_Changed.insert(m_Changed.end(), changed.begin(), changed.end());
+			m_Updated += updated;
+		});
+	}
+
+	if (parallel && m_Changed.size() > 1)
+	{
+		std::sort(m_Changed.begin(), m_Changed.end(), [](const SlotRange& a, const SlotRange& b) { return a.first < b.first; });
+		unsigned int merged = 0;
+		for (unsigned int i = 1; i < m_Changed.size(); i++)
+		{
+			if (m_Changed[i].first <= m_Changed[merged].end + RANGE_GAP)
+				m_Changed[merged].end = std::max(m_Changed[merged].end, m_Changed[i].end);
+			else
+				m_Changed[++merged] = m_Changed[i];
+		}
+		m_Changed.resize(merged + 1);
+	}
+
+	if (m_Changed.size() > MAX_CHANGED_RANGES)
+		m_Changed.assign(1, { m_Changed.front().first, m_Changed.back().end });
+	if (resorted)
+	{
+		/* every slot may have moved, the whole buffer is stale */
+		m_Changed.assign(1, { 0, (unsigned int)m_Nodes.size() });
+	}
+}
@@ -0,0 +1,379 @@
+#include "VectorMath.h"
+
+Quat Quat::FromAxisAngle(const Vec3& axis, float angle)
+{
+	float s = sinf(angle * 0.5f);
+	return { axis.x * s, axis.y * s, axis.z * s, cosf(angle * 0.5f) };
+}
+
+void Mat3::Pack(float* out) const
+{
+	for (int c = 0; c < 3; c++)
+	{
+		out[c * 3 + 0] = columns[c].x;
+		out[c * 3 + 1] = columns[c].y;
+		out[c * 3 + 2] = columns[c].z;
+	}
+}
+
+Mat4 Mat4::Identity()
+{
+	return { { { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } } };
+}
+
+Mat4 Mat4::Translation(const Vec3& t)
+{
+	Mat4 m = Identity();
+	m.columns[3] = { t.x, t.y, t.z, 1.0f };
+	return m;
+}
+
+Mat4 Mat4::Scale(const Vec3& s)
+{
+	return { { { s.x, 0.0f, 0.0f, 0.0f }, { 0.0f, s.y, 0.0f, 0.0f }, { 0.0f, 0.0f, s.z, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } } };
+}
+
+Mat4 Mat4::Rotation(const Quat& q)
+{
+	return TRS({ 0.0f, 0.0f, 0.0f }, q, { 1.0f, 1.0f, 1.0f });
+}
+
+Mat4 Mat4::TRS(const Vec3& t, const Quat& q, const Vec3& s)
+{
+	float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+	float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+	float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+	/* rotation columns, each scaled by its axis' scale */
+	Mat4 m;
+	m.columns[0] = { (1.0f - 2.0f * (yy + zz)) * s.x, 2.0f * (xy + wz) * s.x, 2.0f * (xz - wy) * s.x, 0.0f };
+	m.columns[1] = { 2.0f * (xy - wz) * s.y, (1.0f - 2.0f * (xx + zz)) * s.y, 2.0f * (yz + wx) * s.y, 0.0f };
+	m.columns[2] = { 2.0f * (xz + wy) * s.z, 2.0f * (yz - wx) * s.z, (1.0f - 2.0f * (xx + yy)) * s.z, 0.0f };
+	m.columns[3] = { t.x, t.y, t.z, 1.0f };
+	return m;
+}
+
+Mat4 Mat4::Perspective(float fovY, float aspect, float zNear, float zFar)
+{
+	float f = 1.0f / tanf(fovY * 0.5f);
+	Mat4 m = {};
+	m.columns[0].x = f / aspect;
+	m.columns[1].y = f;
+	m.columns[2].z = (zFar + zNear) / (zNear - zFar);
+	m.columns[2].w = -1.0f;
+	m.columns[3].z = 2.0f * zFar * zNear / (zNear - zFar);
+	return m;
+}
+
+Mat4 Mat4::Orthographic(float left, float right, float bottom, float top, float zNear, float zFar)
+{
+	Mat4 m = Identity();
+	m.columns[0].x = 2.0f / (right - left);
+	m.columns[1].y = 2.0f / (top - bottom);
+	m.columns[2].z = -2.0f / (zFar - zNear);
+	m.columns[3] = { -(right + left) / (right - left), -(top + bottom) / (top - bottom), -(zFar + zNear) / (zFar - zNear), 1.0f };
+	return m;
+}
+
+Mat4 Mat4::LookAt(const Vec3& eye, const Vec3& target, const Vec3& up)
+{
+	/* camera looks down its -z */
+	Vec3 f = Normalize(target - eye);
+	Vec3 s = Normalize(Cross(f, up));
+	Vec3 u = Cross(s, f);
+
+	Mat4 m;
+	m.columns[0] = { s.x, u.x, -f.x, 0.0f };
+	m.columns[1] = { s.y, u.y, -f.y, 0.0f };
+	m.columns[2] = { s.z, u.z, -f.z, 0.0f };
+	m.columns[3] = { -Dot(s, eye), -Dot(u, eye), Dot(f, eye), 1.0f };
+	return m;
+}
+
+Quat operator*(const Quat& a, const Quat& b)
+{
+	return {
+		a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+		a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+		a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+		a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+	};
+}
+
+Quat Normalize(const Quat& q)
+{
+	float scale = 1.0f / sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+	return { q.x * scale, q.y * scale, q.z * scale, q.w * scale };
+}
+
+Vec3 Rotate(const Quat& q, const Vec3& v)
+{
+	/* v + w * t + q.xyz x t with t = 2 * (q.xyz x v), cheaper than q v q* */
+	Vec3 axis = { q.x, q.y, q.z };
+	Vec3 t = Cross(axis, v) * 2.0f;
+	return v + t * q.w + Cross(axis, t);
+}
+
+Quat Nlerp(const Quat& a, const Quat& b, float t)
+{
+	/* q and -q are the same rotation, take the one closer to a */
+	float dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+	float sign = dot < 0.0f ? -1.0f : 1.0f;
+	float s = 1.0f - t, u = t * sign;
+	return Normalize(Quat{ a.x * s + b.x * u, a.y * s + b.y * u, a.z * s + b.z * u, a.w * s + b.w * u });
+}
+
+Quat Slerp(const Quat& a, const Quat& b, float t)
+{
+	float dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+	float sign = dot < 0.0f ? -1.0f : 1.0f;
+	dot *= sign;
+	/* nearly the same rotation, the sine below would divide by ~0 */
+	if (dot > 0.9995f)
+		return Nlerp(a, b, t);
+
+	float angle = acosf(dot);
+	float s = sinf((1.0f - t) * angle) / sinf(angle);
+	float u = sinf(t * angle) / sinf(angle) * sign;
+	return { a.x * s + b.x * u, a.y * s + b.y * u, a.z * s + b.z * u, a.w * s + b.w * u };
+}
+
+Mat4 Transpose(const Mat4& m)
+{
+#ifdef MATH_SSE
+	__m128 c0 = LoadVec4(m.columns[0]), c1 = LoadVec4(m.columns[1]), c2 = LoadVec4(m.columns[2]), c3 = LoadVec4(m.columns[3]);
+	_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+	return { { StoreVec4(c0), StoreVec4(c1), StoreVec4(c2), StoreVec4(c3) } };
+#else
+	const float* a = m.Data();
+	Mat4 r;
+	float* out = r.Data();
+	for (int c = 0; c < 4; c++)
+	{
+		for (int row = 0; row < 4; row++)
+			out[c * 4 + row] = a[row * 4 + c];
+	}
+	return r;
+#endif
+}
+
+Mat4 Inverse(const Mat4& matrix)
+{
+	/* cofactors over 2x2 sub determinants of the lower and upper halves */
+	const float* m = matrix.Data();
+	float s0 = m[0] * m[5] - m[4] * m[1];
+	float s1 = m[0] * m[9] - m[8] * m[1];
+	float s2 = m[0] * m[13] - m[12] * m[1];
+	float s3 = m[4] * m[9] - m[8] * m[5];
+	float s4 = m[4] * m[13] - m[12] * m[5];
+	float s5 = m[8] * m[13] - m[12] * m[9];
+	float c5 = m[10] * m[15] - m[14] * m[11];
+	float c4 = m[6] * m[15] - m[14] * m[7];
+	float c3 = m[6] * m[11] - m[10] * m[7];
+	float c2 = m[2] * m[15] - m[14] * m[3];
+	float c1 = m[2] * m[11] - m[10] * m[3];
+	float c0 = m[2] * m[7] - m[6] * m[3];
+	float inverseDeterminant = 1.0f / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+	Mat4 r;
+	float* o = r.Data();
+	o[0] = (m[5] * c5 - m[9] * c4 + m[13] * c3) * inverseDeterminant;
+	o[4] = (-m[4] * c5 + m[8] * c4 - m[12] * c3) * inverseDeterminant;
+	o[8] = (m[7] * s5 - m[11] * s4 + m[15] * s3) * inverseDeterminant;
+	o[12] = (-m[6] * s5 + m[10] * s4 - m[14] * s3) * inverseDeterminant;
+	o[1] = (-m[1] * c5 + m[9] * c2 - m[13] * c1) * inverseDeterminant;
+	o[5] = (m[0] * c5 - m[8] * c2 + m[12] * c1) * inverseDeterminant;
+	o[9] = (-m[3] * s5 + m[11] * s2 - m[15] * s1) * inverseDeterminant;
+	o[13] = (m[2] * s5 - m[10] * s2 + m[14] * s1) * inverseDeterminant;
+	o[2] = (m[1] * c4 - m[5] * c2 + m[13] * c0) * inverseDeterminant;
+	o[6] = (-m[0] * c4 + m[4] * c2 - m[12] * c0) * inverseDeterminant;
+	o[10] = (m[3] * s4 - m[7] * s2 + m[15] * s0) * inverseDeterminant;
+	o[14] = (-m[2] * s4 + m[6] * s2 - m[14] * s0) * inverseDeterminant;
+	o[3] = (-m[1] * c3 + m[5] * c1 - m[9] * c0) * inverseDeterminant;
+	o[7] = (m[0] * c3 - m[4] * c1 + m[8] * c0) * inverseDeterminant;
+	o[11] = (-m[3] * s3 + m[7] * s1 - m[11] * s0) * inverseDeterminant;
+	o[15] = (m[2] * s3 - m[6] * s1 + m[10] * s0) * inverseDeterminant;
+	return r;
+}
+
+/* inverse of the upper 3x3 as columns, via the cross products of its columns */
+static void Inverse3x3(const Mat4& m, Vec3 out[3])
+{
+	Vec3 a = { m.columns[0].x, m.columns[0].y, m.columns[0].z };
+	Vec3 b = { m.columns[1].x, m.columns[1].y, m.columns[1].z };
+	Vec3 c = { m.columns[2].x, m.columns[2].y, m.columns[2].z };
+	Vec3 r0 = Cross(b, c), r1 = Cross(c, a), r2 = Cross(a, b);
+	float inverseDeterminant = 1.0f / Dot(a, r0);
+	r0 = r0 * inverseDeterminant;
+	r1 = r1 * inverseDeterminant;
+	r2 = r2 * inverseDeterminant;
+
+	/* r0, r1, r2 are the rows of the inverse */
+	out[0] = { r0.x, r1.x, r2.x };
+	out[1] = { r0.y, r1.y, r2.y };
+	out[2] = { r0.z, r1.z, r2.z };
+}
+
+Mat4 InverseAffine(const Mat4& m)
+{
+	Vec3 columns[3];
+	Inverse3x3(m, columns);
+	Vec3 t = { m.columns[3].x, m.columns[3].y, m.columns[3].z };
+
+	Mat4 r;
+	for (int c = 0; c < 3; c++)
+		r.columns[c] = { columns[c].x, columns[c].y, columns[c].z, 0.0f };
+	Vec3 inverseT = (columns[0] * t.x + columns[1] * t.y + columns[2] * t.z) * -1.0f;
+	r.columns[3] = { inverseT.x, inverseT.y, inverseT.z, 1.0f };
+	return r;
+}
+
+Mat3 NormalMatrix(const Mat4& m)
+{
+	Vec3 columns[3];
+	Inverse3x3(m, columns);
+
+	/* transposed: the columns of the result are the rows of the inverse */
+	Mat3 r;
+	r.columns[0] = { columns[0].x, columns[1].x, columns[2].x, 0.0f };
+	r.columns[1] = { columns[0].y, columns[1].y, columns[2].y, 0.0f };
+	r.columns[2] = { columns[0].z, columns[1].z, columns[2].z, 0.0f };
+	return r;
+}
+
+void BatchTransform::TransformPointsScalar(const Mat4& matrix, const float* x, const float* y, const float* z,
+	float* outX, float* outY, float* outZ, unsigned int count)
+{
+	const float* m = matrix.Data();
+	for (unsigned int i = 0; i < count; i++)
+	{
+		float px = x[i], py = y[i], pz = z[i];
+		outX[i] = m[0] * px + m[4] * py + m[8] * pz + m[12];
+		outY[i] = m[1] * px + m[5] * py + m[9] * pz + m[13];
+		outZ[i] = m[2] * px + m[6] * py + m[10] * pz + m[14];
+	}
+}
+
+void BatchTransform::TransformPoints(const Mat4& matrix, const float* x, const float* y, const float* z,
+	float* outX, float* outY, float* outZ, unsigned int count)
+{
+	const float* m = matrix.Data();
+	unsigned int i = 0;
+
+#if defined(MATH_AVX)
+	__m256 e[12];
+	for (int c = 0; c < 4; c++)
+	{
+		for (int r = 0; r < 3; r++)
+			e[c * 3 + r] = _mm256_set1_ps(m[c * 4 + r]);
+	}
+
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i), pz = _mm256_loadu_ps(z + i);
+		__m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e[0], px), _mm256_mul_ps(e[3], py)), _mm256_add_ps(_mm256_mul_ps(e[6], pz), e[9]));
+		__m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e[1], px), _mm256_mul_ps(e[4], py)), _mm256_add_ps(_mm256_mul_ps(e[7], pz), e[10]));
+		__m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e[2], px), _mm256_mul_ps(e[5], py)), _mm256_add_ps(_mm256_mul_ps(e[8], pz), e[11]));
+		_mm256_storeu_ps(outX + i, rx);
+		_mm256_storeu_ps(outY + i, ry);
+		_mm256_storeu_ps(outZ + i, rz);
+	}
+#elif defined(MATH_SSE)
+	__m128 e[12];
+	for (int c = 0; c < 4; c++)
+	{
+		for (int r = 0; r < 3; r++)
+			e[c * 3 + r] = _mm_set1_ps(m[c * 4 + r]);
+	}
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i), pz = _mm_loadu_ps(z + i);
+		__m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e[0], px), _mm_mul_ps(e[3], py)), _mm_add_ps(_mm_mul_ps(e[6], pz), e[9]));
+		__m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e[1], px), _mm_mul_ps(e[4], py)), _mm_add_ps(_mm_mul_ps(e[7], pz), e[10]));
+		__m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e[2], px), _mm_mul_ps(e[5], py)), _mm_add_ps(_mm_mul_ps(e[8], pz), e[11]));
+		_mm_storeu_ps(outX + i, rx);
+		_mm_storeu_ps(outY + i, ry);
+		_mm_storeu_ps(outZ + i, rz);
+	}
+#endif
+
+	/* what's left over after the SIMD loop */
+	TransformPointsScalar(matrix, x + i, y + i, z + i, outX + i, outY + i, outZ + i, count - i);
+}
+
+void BatchTransform::MultiplyScalar(const Mat4* a, const Mat4* b, Mat4* out, unsigned int count)
+{
+	for (unsigned int n = 0; n < count; n++)
+	{
+		const float* l = a[n].Data();
+		const float* r = b[n].Data();
+		float result[16];
+		for (int c = 0; c < 4; c++)
+		{
+			for (int row = 0; row < 4; row++)
+				result[c * 4 + row] = l[row] * r[c * 4] + l[4 + row] * r[c * 4 + 1] + l[8 + row] * r[c * 4 + 2] + l[12 + row] * r[c * 4 + 3];
+		}
+		/* out may be a or b */
+		for (int i = 0; i < 16; i++)
+			out[n].Data()[i] = result[i];
+	}
+}
+
+#ifdef MATH_AVX
+/* two result columns per instruction: the low lane works on column j,
+   the high lane on column j + 1
+	~ unaligned loads, a Mat4 is only 16 byte aligned */
+static inline void MultiplyAVX(__m256 a0, __m256 a1, __m256 a2, __m256 a3, const Mat4& b, Mat4& out)
+{
+	__m256 b01 = _mm256_loadu_ps(&b.columns[0].x);
+	__m256 b23 = _mm256_loadu_ps(&b.columns[2].x);
+
+	__m256 r01 = _mm256_mul_ps(a0, _mm256_permute_ps(b01, 0x00));
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(a1, _mm256_permute_ps(b01, 0x55)));
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(a2, _mm256_permute_ps(b01, 0xAA)));
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(a3, _mm256_permute_ps(b01, 0xFF)));
+
+	__m256 r23 = _mm256_mul_ps(a0, _mm256_permute_ps(b23, 0x00));
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(a1, _mm256_permute_ps(b23, 0x55)));
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(a2, _mm256_permute_ps(b23, 0xAA)));
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(a3, _mm256_permute_ps(b23, 0xFF)));
+
+	_mm256_storeu_ps(&out.columns[0].x, r01);
+	_mm256_storeu_ps(&out.columns[2].x, r23);
+}
+#endif
+
+void BatchTransform::Multiply(const Mat4* a, const Mat4* b, Mat4* out, unsigned int count)
+{
+#ifdef MATH_AVX
+	for (unsigned int n = 0; n < count; n++)
+	{
+		/* every column of a in both lanes */
+		__m256 a0 = _mm256_broadcast_ps((const __m128*)&a[n].columns[0].x);
+		__m256 a1 = _mm256_broadcast_ps((const __m128*)&a[n].columns[1].x);
+		__m256 a2 = _mm256_broadcast_ps((const __m128*)&a[n].columns[2].x);
+		__m256 a3 = _mm256_broadcast_ps((const __m128*)&a[n].columns[3].x);
+		MultiplyAVX(a0, a1, a2, a3, b[n], out[n]);
+	}
+#else
+	for (unsigned int n = 0; n < count; n++)
+		out[n] = a[n] * b[n];
+#endif
+}
+
+void BatchTransform::Multiply(const Mat4& a, const Mat4* b, Mat4* out, unsigned int count)
+{
+#ifdef MATH_AVX
+	/* a is loaded once for the whole batch */
+	__m256 a0 = _mm256_broadcast_ps((const __m128*)&a.columns[0].x);
+	__m256 a1 = _mm256_broadcast_ps((const __m128*)&a.columns[1].x);
+	__m256 a2 = _mm256_broadcast_ps((const __m128*)&a.columns[2].x);
+	__m256 a3 = _mm256_broadcast_ps((const __m128*)&a.columns[3].x);
+	for (unsigned int n = 0; n < count; n++)
+		MultiplyAVX(a0, a1, a2, a3, b[n], out[n]);
+#else
+	for (unsigned int n = 0; n < count; n++)
+		out[n] = a * b[n];
+#endif
+}
@@ -1,6 +1,8 @@
 #include "VertexArray.h"
 
 #include "renderer.h"
+#include "DeletionQueue.h"
+#include "shader.h"
 
 VertexArray::VertexArray()
 {
@@ -9,7 +11,24 @@ VertexArray::VertexArray()
 
 VertexArray::~VertexArray()
 {
-	GLCall(glDeleteVertexArrays(1, &m_RendererID));
+	DeletionQueue::Delete(GLObjectType::VERTEX_ARRAY, m_RendererID);
+}
+
+VertexArray::VertexArray(VertexArray&& other) noexcept
+	: m_RendererID(other.m_RendererID)
+{
+	other.m_RendererID = 0;
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
+{
+	if (this != &other)
+	{
+		DeletionQueue::Delete(GLObjectType::VERTEX_ARRAY, m_RendererID);
+		m_RendererID = other.m_RendererID;
+		other.m_RendererID = 0;
+	}
+	return *this;
 }
 
 void VertexArray::addBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
@@ -23,7 +42,55 @@ void VertexArray::addBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 		const auto& element = elements[i];
 		GLCall(glEnableVertexAttribArray(i));
 		GLCall(glVertexAttribPointer(i, element.count, element.type, 
-			element.normalized, layout.GetStride(), (const void*)offset));
+			element.normalized, layout.GetStride(), (const void*)(size_t)offset));
+		offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+	}
+}
+
+void VertexArray::addBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, const std::vector<VertexAttributeBinding>& bindings)
+{
+	Bind();
+	vb.Bind();
+	const auto& elements = layout.GetElements();
+	for (const VertexAttributeBinding& binding : bindings)
+	{
+		const auto& element = elements[binding.element];
+		GLCall(glEnableVertexAttribArray(binding.location));
+		if (binding.integer)
+		{
+			GLCall(glVertexAttribIPointer(binding.location, binding.count, element.type,
+				layout.GetStride(), (const void*)(size_t)binding.offset));
+		}
+		else
+		{
+			GLCall(glVertexAttribPointer(binding.location, binding.count, element.type,
+				element.normalized, layout.GetStride(), (const void*)(size_t)binding.offset));
+		}
+	}
+}
+
+bool VertexArray::addBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, const Shader& shader)
+{
+	std::vector<VertexAttributeBinding> bindings;
+	if (!shader.MatchLayout(layout, bindings))
+		return false;
+	addBuffer(vb, layout, bindings);
+	return true;
+}
+
+void VertexArray::addInstanceBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int firstAttribute, unsigned int offset)
+{
+	Bind();
+	vb.Bind();
+	const auto& elements = layout.GetElements();
+	for (unsigned i = 0; i < elements.size(); i++)
+	{
+		const auto& element = elements[i];
+		GLCall(glEnableVertexAttribArray(firstAttribute + i));
+		GLCall(glVertexAttribPointer(firstAttribute + i, element.count, element.type,
+			element.normalized, layout.GetStride(), (const void*)(size_t)offset));
+		/* 1: next value every instance */
+		GLCall(glVertexAttribDivisor(firstAttribute + i, 1));
 		offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
 	}
 }
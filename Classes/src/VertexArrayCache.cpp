@@ -0,0 +1,149 @@
+#include "VertexArrayCache.h"
+
+#include "renderer.h"
+#include "shader.h"
+#include "indexbuffer.h"
+
+static bool EqualLayouts(const VertexBufferLayout& a, const VertexBufferLayout& b)
+{
+	if (a.GetStride() != b.GetStride() || a.GetElements().size() != b.GetElements().size())
+		return false;
+	for (unsigned int i = 0; i < a.GetElements().size(); i++)
+	{
+		const VertexBufferElement& x = a.GetElements()[i];
+		const VertexBufferElement& y = b.GetElements()[i];
+		if (x.type != y.type || x.count != y.count || x.normalized != y.normalized || x.name != y.name)
+			return false;
+	}
+	return true;
+}
+
+VertexArrayCache::VertexArrayCache()
+	: m_ArrayCount(0), m_Hits(0), m_Misses(0)
+{
+}
+
+unsigned long long VertexArrayCache::HashLayout(const VertexBufferLayout& layout)
+{
+	/* FNV-1a */
+	unsigned long long hash = 14695981039346656037ull;
+	auto add = [&hash](unsigned long long value)
+	{
+		hash ^= value;
+		hash *= 1099511628211ull;
+	};
+	add(layout.GetStride());
+	for (const VertexBufferElement& element : layout.GetElements())
+	{
+		add((unsigned long long)element.type << 32 | element.count << 8 | element.normalized);
+		for (char c : element.name)
+			add((unsigned char)c);
+	}
+	return hash;
+}
+
+const VertexArrayCache::LayoutEntry& VertexArrayCache::FindLayout(const Shader& shader, const VertexBufferLayout& layout)
+{
+	unsigned long long hash = HashLayout(layout);
+	for (const LayoutEntry& entry : m_Layouts)
+		if (entry.program == shader.GetRendererID() && entry.layoutHash == hash && EqualLayouts(entry.layout, layout))
+			return entry;
+
+	LayoutEntry entry;
+	entry.program = shader.GetRendererID();
+	entry.layoutHash = hash;
+	entry.layout = layout;
+	entry.valid = shader.MatchLayout(layout, entry.bindings);
+	m_Layouts.push_back(entry);
+	return m_Layouts.back();
+}
+
+bool VertexArrayCache::Validate(const Shader& shader, const VertexBufferLayout& layout)
+{
+	return FindLayout(shader, layout).valid;
+}
+
+const VertexArray* VertexArrayCache::Get(const Shader& shader, const VertexBuffer& vb, const VertexBufferLayout& layout,
+	const IndexBuffer* ib)
+{
+	const LayoutEntry& entry = FindLayout(shader, layout);
+	if (!entry.valid)
+		return nullptr;
+
+	unsigned int layoutEntry = (unsigned int)(&entry - m_Layouts.data());
+	unsigned long long key = (unsigned long long)vb.GetRendererID() << 32 | (ib ? ib->GetRendererID() : 0);
+	std::vector<ArrayEntry>& arrays = m_Arrays[key];
+	for (const ArrayEntry& array : arrays)
+	{
+		if (array.layoutEntry == layoutEntry)
+		{
+			m_Hits++;
+			return array.vertexArray.get();
+		}
+	}
+
+	m_Misses++;
+	std::unique_ptr<VertexArray> vertexArray = std::make_unique<VertexArray>();
+	vertexArray->addBuffer(vb, layout, entry.bindings);
+	if (ib)
+		ib->Bind();	/* the element buffer binding is part of the vertex array */
+	vertexArray->Unbind();
+
+	arrays.push_back({ layoutEntry, std::move(vertexArray) });
+	m_ArrayCount++;
+	return arrays.back().vertexArray.get();
+}
+
+void VertexArrayCache::Remove(const VertexBuffer& vb)
+{
+	for (auto it = m_Arrays.begin(); it != m_Arrays.end();)
+	{
+		if (it->first >> 32 == vb.GetRendererID())
+		{
+			m_ArrayCount -= (unsigned int)it->second.size();
+			it = m_Arrays.erase(it);
+		}
+		else
+			++it;
+	}
+}
+
+void VertexArrayCache::Remove(const Shader& shader)
+{
+	/* layout entries are referenced by index, remap the arrays that survive */
+	std::vector<unsigned int> remap(m_Layouts.size());
+	unsigned int kept = 0;
+	for (unsigned int i = 0; i < m_Layouts.size(); i++)
+	{
+		if (m_Layouts[i].program == shader.GetRendererID())
+		{
+			remap[i] = 0xFFFFFFFF;
+			continue;
+		}
+		remap[i] = kept;
+		if (kept != i)
+			m_Layouts[kept] = std::move(m_Layouts[i]);
+		kept++;
+	}
+	m_Layouts.resize(kept);
+
+	for (auto& bucket : m_Arrays)
+	{
+		std::vector<ArrayEntry>& arrays = bucket.second;
+		for (unsigned int i = 0; i < arrays.size();)
+		{
+			unsigned int layoutEntry = remap[arrays[i].layoutEntry];
+			if (layoutEntry == 0xFFFFFFFF)
+			{
+				arrays[i] = std::move(arrays.back());
+				arrays.pop_back();
+				m_ArrayCount--;
+			}
+			else
+			{
+				arrays[i].layoutEntry = layoutEntry;
+				i++;
+			}
+		}
+	}
+}
@@ -0,0 +1,93 @@
+/* BufferAllocator benchmark
+	~ random churn of allocations and frees (sizes from 64 to 64k units,
+	  log distributed, like meshes of very different sizes) on a 64M unit
+	  buffer kept around 70% full
+	~ prints the cost per operation and how fragmented the free space gets,
+	  and checks that no two live ranges ever overlap
+	~ CPU only, no window needed */
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+#include "BufferAllocator.h"
+
+#define CAPACITY (64u * 1024 * 1024)
+#define OPERATIONS 2000000
+#define TARGET_LOAD 0.7
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static bool CheckOverlaps(std::vector<BufferAllocation> live)
+{
+	std::sort(live.begin(), live.end(), [](const BufferAllocation& a, const BufferAllocation& b) { return a.offset < b.offset; });
+	for (size_t i = 1; i < live.size(); i++)
+		if (live[i - 1].offset + live[i - 1].size > live[i].offset)
+			return false;
+	return live.empty() || live.back().offset + live.back().size <= CAPACITY;
+}
+
+int main(void)
+{
+	BufferAllocator allocator(CAPACITY);
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> logSize(log2f(64.0f), log2f(65536.0f));
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	std::vector<BufferAllocation> live;
+	unsigned long long allocations = 0, frees = 0, failures = 0;
+	bool valid = true;
+
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < OPERATIONS; i++)
+	{
+		double load = (double)allocator.GetStats().used / CAPACITY;
+		/* above the target load frees win, below it allocations do */
+		bool allocate = live.empty() || unit(random) < (load < TARGET_LOAD ? 0.6f : 0.4f);
+		if (allocate)
+		{
+			BufferAllocation allocation;
+			if (allocator.Allocate((unsigned int)exp2f(logSize(random)), allocation))
+			{
+				live.push_back(allocation);
+				allocations++;
+			}
+			else
+				failures++;
+		}
+		else
+		{
+			size_t index = random() % live.size();
+			allocator.Free(live[index]);
+			live[index] = live.back();
+			live.pop_back();
+			frees++;
+		}
+
+		if (i % (OPERATIONS / 8) == 0)
+		{
+			valid = valid && CheckOverlaps(live);
+			BufferAllocatorStats stats = allocator.GetStats();
+			std::cout << "after " << i << " operations: " << stats.allocations << " live, "
+				<< 100.0 * stats.used / stats.capacity << "% used, " << stats.freeBlocks << " free blocks, largest free "
+				<< stats.largestFree << ", fragmentation " << stats.fragmentation << std::endl;
+		}
+	}
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	valid = valid && CheckOverlaps(live);
+
+	std::cout << allocations << " allocations, " << frees << " frees, " << failures << " failed, "
+		<< seconds * 1e9 / OPERATIONS << " ns per operation (stats and checks included)" << std::endl;
+
+	/* everything freed must merge back into one block */
+	for (const BufferAllocation& allocation : live)
+		allocator.Free(allocation);
+	BufferAllocatorStats stats = allocator.GetStats();
+	valid = valid && stats.used == 0 && stats.freeBlocks == 1 && stats.largestFree == CAPACITY;
+
+	std::cout << (valid ? "no overlaps, everything merged back" : "ALLOCATOR STATE IS BROKEN!") << std::endl;
+	return valid ? 0 : 1;
+}
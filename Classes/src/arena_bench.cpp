@@ -0,0 +1,202 @@
+/* frame arena benchmark
+	~ counts heap allocations (operator new calls) per frame for a typical
+	  frame: frustum culling, building per object uniform payloads and a
+	  staging array of debug lines, queueing draws in the Renderer and
+	  flushing them
+		1. per frame std::vectors on the heap, Renderer without arena
+		2. FrameVectors in the thread's FrameArena, Renderer with the arena
+	~ the camera turns, so the visible count changes every frame */
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <cmath>
+
+#include "renderer.h"
+#include "shader.h"
+#include "Mesh.h"
+#include "Culling.h"
+#include "FrameArena.h"
+
+#define OBJECT_COUNT 5000
+#define MESH_COUNT 16
+#define FRAMES 120
+#define WARMUP_FRAMES 10
+
+static std::atomic<unsigned long long> s_Allocations(0);
+
+void* operator new(size_t size)
+{
+	s_Allocations++;
+	if (void* pointer = malloc(size ? size : 1))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+	free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+	free(pointer);
+}
+
+struct Payload
+{
+	float color[4];
+	unsigned int object;
+};
+
+/* column major projection * rotation about y, camera at the origin */
+static void ViewProjection(float angle, float* out)
+{
+	float f = 1.0f / tanf(0.5f), aspect = 4.0f / 3.0f, zNear = 0.1f, zFar = 200.0f;
+	float c = cosf(angle), s = sinf(angle);
+	float a = f / aspect, b = (zFar + zNear) / (zNear - zFar), d = 2.0f * zFar * zNear / (zNear - zFar);
+	float matrix[16] = {
+		a * c, 0.0f, -b * s, s,
+		0.0f, f, 0.0f, 0.0f,
+		a * s, 0.0f, b * c, -c,
+		0.0f, 0.0f, d, 0.0f
+	};
+	for (int i = 0; i < 16; i++)
+		out[i] = matrix[i];
+}
+
+int main(void)
+{
+	GLFWwindow* window;
+
+	/* Initialize the library */
+	if (!glfwInit())
+		return -1;
+
+	window = glfwCreateWindow(640, 480, "Frame arena benchmark", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+
+	if (glewInit() != GLEW_OK)
+		std::cout << "Error!" << std::endl;
+
+	{
+		float positions[] = {
+			-0.01f, -0.01f,
+			 0.01f, -0.01f,
+			 0.01f,  0.01f,
+			-0.01f,  0.01f,
+		};
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		std::vector<std::unique_ptr<Mesh>> meshes;
+		for (int i = 0; i < MESH_COUNT; i++)
+			meshes.push_back(std::make_unique<Mesh>(positions, (unsigned int)sizeof(positions), indices, 6, layout));
+
+		Shader shader("res/shading/basic.shader");
+		shader.Bind();
+		shader.SetUniform4f("u_Color", 0.2f, 0.3f, 0.8f, 1.0f);
+
+		std::mt19937 random(9);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+		BoundsStore bounds;
+		for (int i = 0; i < OBJECT_COUNT; i++)
+		{
+			float center[3] = { position(random), position(random) * 0.2f, position(random) };
+			bounds.AddSphere(center, 1.0f);
+		}
+
+		Renderer heapRenderer;
+		FrameArena& arena = FrameArena::ForThread();
+		Renderer arenaRenderer(&arena);
+		std::vector<unsigned int> visible;
+
+		for (int path = 0; path < 2; path++)
+		{
+			unsigned long long allocations = 0, worst = 0, draws = 0;
+			double milliseconds = 0.0;
+			for (int frame = 0; frame < FRAMES; frame++)
+			{
+				unsigned long long before = s_Allocations;
+				auto start = std::chrono::high_resolution_clock::now();
+
+				float viewProjection[16];
+				ViewProjection(frame * 0.05f, viewProjection);
+				Frustum frustum(viewProjection);
+
+				GLCall(glClear(GL_COLOR_BUFFER_BIT));
+				if (path == 0)
+				{
+					std::vector<unsigned int> frameVisible;
+					FrustumCuller::Cull(bounds, frustum, frameVisible);
+
+					std::vector<Payload> payloads;
+					std::vector<float> debugLines;
+					for (unsigned int object : frameVisible)
+					{
+						payloads.push_back({ { 1.0f, 0.5f, 0.2f, 1.0f }, object });
+						debugLines.insert(debugLines.end(), { bounds.GetCenterX()[object], bounds.GetCenterY()[object], 0.0f, 1.0f });
+						const Mesh& mesh = *meshes[object % MESH_COUNT];
+						heapRenderer.Submit(mesh.GetVertexArray(), mesh.GetIndexBuffer(), shader);
+					}
+					draws += heapRenderer.GetQueuedCount();
+					heapRenderer.Flush();
+				}
+				else
+				{
+					/* the culler keeps its output vector from frame to frame */
+					FrustumCuller::Cull(bounds, frustum, visible);
+
+					FrameVector<Payload> payloads(&arena);
+					FrameVector<float> debugLines(&arena);
+					payloads.reserve(visible.size());
+					debugLines.reserve(visible.size() * 4);
+					for (unsigned int object : visible)
+					{
+						payloads.push_back({ { 1.0f, 0.5f, 0.2f, 1.0f }, object });
+						debugLines.insert(debugLines.end(), { bounds.GetCenterX()[object], bounds.GetCenterY()[object], 0.0f, 1.0f });
+						const Mesh& mesh = *meshes[object % MESH_COUNT];
+						arenaRenderer.Submit(mesh.GetVertexArray(), mesh.GetIndexBuffer(), shader);
+					}
+					draws += arenaRenderer.GetQueuedCount();
+					arenaRenderer.Flush();
+				}
+				glfwSwapBuffers(window);
+				glfwPollEvents();
+				/* end of frame: nothing uses this frame's arena memory any more */
+				FrameArena::ResetAll();
+
+				milliseconds += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+				if (frame >= WARMUP_FRAMES)
+				{
+					unsigned long long count = s_Allocations - before;
+					allocations += count;
+					worst = count > worst ? count : worst;
+				}
+			}
+
+			unsigned int measured = FRAMES - WARMUP_FRAMES;
+			std::cout << (path == 0 ? "heap vectors" : "frame arena") << ": " << draws / FRAMES << " draws per frame, "
+				<< (double)allocations / measured << " heap allocations per frame (worst " << worst << "), "
+				<< milliseconds / FRAMES << " ms per frame" << std::endl;
+		}
+		std::cout << "arena peak " << arena.GetPeak() / 1024 << " KB, " << arena.GetChunkAllocations() << " chunk allocations in total" << std::endl;
+	}
+
+	glfwTerminate();
+	return 0;
+}
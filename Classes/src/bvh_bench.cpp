@@ -0,0 +1,218 @@
+/* BVH benchmark on a synthetic million object scene
+	~ build time with one thread and with every hardware thread
+	~ refit time after moving every object a little
+	~ frustum, region and ray queries per second, frustum queries are
+	  compared against brute force FrustumCuller over the same boxes
+	~ every query type is checked against a brute force answer
+	~ CPU only, no window needed */
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <thread>
+#include <cmath>
+#include <float.h>
+
+#include "Bvh.h"
+#include "Culling.h"
+
+#define OBJECT_COUNT 1000000
+#define WORLD_SIZE 2000.0f
+#define FRUSTUM_QUERIES 50
+#define REGION_QUERIES 20000
+#define RAY_QUERIES 100000
+#define CHECKED_RAYS 50
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Seconds(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/* projection * translation(-eye), camera looking down -z */
+static void ViewProjection(const float eye[3], float* out)
+{
+	float f = 1.0f / tanf(60.0f * 3.14159265f / 360.0f), aspect = 16.0f / 9.0f;
+	float zNear = 0.1f, zFar = 500.0f;
+	for (int i = 0; i < 16; i++)
+		out[i] = 0.0f;
+	out[0] = f / aspect;
+	out[5] = f;
+	out[10] = (zFar + zNear) / (zNear - zFar);
+	out[11] = -1.0f;
+	out[14] = 2.0f * zFar * zNear / (zNear - zFar);
+	out[12] = -out[0] * eye[0];
+	out[13] = -out[5] * eye[1];
+	out[14] += -out[10] * eye[2];
+	out[15] = eye[2];
+}
+
+int main(void)
+{
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> position(-WORLD_SIZE * 0.5f, WORLD_SIZE * 0.5f);
+	std::uniform_real_distribution<float> size(0.5f, 4.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	BoundsStore store;
+	for (unsigned int i = 0; i < OBJECT_COUNT; i++)
+	{
+		float center[3] = { position(random), position(random), position(random) };
+		float extents[3] = { size(random), size(random), size(random) };
+		store.AddBox(center, extents);
+	}
+	std::vector<Aabb> boxes(OBJECT_COUNT);
+	for (unsigned int i = 0; i < OBJECT_COUNT; i++)
+	{
+		const float* c[3] = { store.GetCenterX(), store.GetCenterY(), store.GetCenterZ() };
+		const float* e[3] = { store.GetExtentX(), store.GetExtentY(), store.GetExtentZ() };
+		for (int axis = 0; axis < 3; axis++)
+		{
+			boxes[i].min[axis] = c[axis][i] - e[axis][i];
+			boxes[i].max[axis] = c[axis][i] + e[axis][i];
+		}
+	}
+
+	/* build */
+	Bvh bvh;
+	Clock::time_point start = Clock::now();
+	bvh.Build(boxes.data(), OBJECT_COUNT, 1);
+	double singleBuild = Seconds(start);
+	unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+	start = Clock::now();
+	bvh.Build(store, threads);
+	double parallelBuild = Seconds(start);
+	std::cout << OBJECT_COUNT << " objects, " << bvh.GetNodeCount() << " nodes" << std::endl;
+	std::cout << "build: " << singleBuild * 1000.0 << " ms (1 thread), " << parallelBuild * 1000.0 << " ms ("
+		<< threads << " threads)" << std::endl;
+
+	/* refit after a small move of everything */
+	for (unsigned int i = 0; i < OBJECT_COUNT; i++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float offset = unit(random);
+			boxes[i].min[axis] += offset;
+			boxes[i].max[axis] += offset;
+		}
+		bvh.UpdateObject(i, boxes[i]);
+	}
+	start = Clock::now();
+	bvh.Refit();
+	std::cout << "refit: " << Seconds(start) * 1000.0 << " ms" << std::endl;
+	/* brute force culling has to see the moved boxes too */
+	for (unsigned int i = 0; i < OBJECT_COUNT; i++)
+	{
+		float center[3], extents[3];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			center[axis] = (boxes[i].min[axis] + boxes[i].max[axis]) * 0.5f;
+			extents[axis] = (boxes[i].max[axis] - boxes[i].min[axis]) * 0.5f;
+		}
+		store.SetBox(i, center, extents);
+	}
+
+	bool correct = true;
+
+	/* frustum queries */
+	std::vector<unsigned int> bvhResult, bruteResult;
+	double bvhSeconds = 0.0, bruteSeconds = 0.0;
+	unsigned long long visibleTotal = 0;
+	for (int q = 0; q < FRUSTUM_QUERIES; q++)
+	{
+		float eye[3] = { position(random), position(random), position(random) };
+		float viewProjection[16];
+		ViewProjection(eye, viewProjection);
+		Frustum frustum(viewProjection);
+
+		start = Clock::now();
+		bvh.QueryFrustum(frustum, bvhResult);
+		bvhSeconds += Seconds(start);
+		start = Clock::now();
+		FrustumCuller::Cull(store, frustum, bruteResult);
+		bruteSeconds += Seconds(start);
+
+		visibleTotal += bvhResult.size();
+		std::sort(bvhResult.begin(), bvhResult.end());
+		if (bvhResult != bruteResult)
+			correct = false;
+	}
+	std::cout << "frustum: " << FRUSTUM_QUERIES / bvhSeconds << " queries/s (brute force SIMD "
+		<< FRUSTUM_QUERIES / bruteSeconds << " queries/s), " << visibleTotal / FRUSTUM_QUERIES << " visible on average" << std::endl;
+
+	/* region queries */
+	std::vector<Aabb> regions(REGION_QUERIES);
+	for (Aabb& region : regions)
+	{
+		float center[3] = { position(random), position(random), position(random) };
+		for (int axis = 0; axis < 3; axis++)
+		{
+			region.min[axis] = center[axis] - 20.0f;
+			region.max[axis] = center[axis] + 20.0f;
+		}
+	}
+	unsigned long long regionTotal = 0;
+	start = Clock::now();
+	for (const Aabb& region : regions)
+		regionTotal += bvh.QueryRegion(region, bvhResult);
+	double regionSeconds = Seconds(start);
+	std::cout << "region: " << REGION_QUERIES / regionSeconds << " queries/s, "
+		<< (double)regionTotal / REGION_QUERIES << " objects on average" << std::endl;
+
+	bvh.QueryRegion(regions[0], bvhResult);
+	std::sort(bvhResult.begin(), bvhResult.end());
+	bruteResult.clear();
+	for (unsigned int i = 0; i < OBJECT_COUNT; i++)
+	{
+		bool overlaps = true;
+		for (int axis = 0; axis < 3; axis++)
+			overlaps = overlaps && boxes[i].min[axis] <= regions[0].max[axis] && boxes[i].max[axis] >= regions[0].min[axis];
+		if (overlaps)
+			bruteResult.push_back(i);
+	}
+	if (bvhResult != bruteResult)
+		correct = false;
+
+	/* picking rays from random points in random directions */
+	std::vector<Ray> rays(RAY_QUERIES);
+	for (Ray& ray : rays)
+	{
+		ray.origin[0] = position(random); ray.origin[1] = position(random); ray.origin[2] = position(random);
+		ray.direction[0] = unit(random); ray.direction[1] = unit(random); ray.direction[2] = unit(random);
+	}
+	unsigned int hits = 0;
+	BvhHit hit;
+	start = Clock::now();
+	for (const Ray& ray : rays)
+		hits += bvh.Raycast(ray, hit) ? 1 : 0;
+	double raySeconds = Seconds(start);
+	std::cout << "raycast: " << RAY_QUERIES / raySeconds << " rays/s, " << hits << " hits" << std::endl;
+
+	for (int r = 0; r < CHECKED_RAYS; r++)
+	{
+		const Ray& ray = rays[r];
+		float closest = FLT_MAX;
+		for (unsigned int i = 0; i < OBJECT_COUNT; i++)
+		{
+			float tMin = 0.0f, tMax = FLT_MAX;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				float t0 = (boxes[i].min[axis] - ray.origin[axis]) * (1.0f / ray.direction[axis]);
+				float t1 = (boxes[i].max[axis] - ray.origin[axis]) * (1.0f / ray.direction[axis]);
+				tMin = std::max(tMin, std::min(t0, t1));
+				tMax = std::min(tMax, std::max(t0, t1));
+			}
+			if (tMin <= tMax && tMin < closest)
+				closest = tMin;
+		}
+		bool found = bvh.Raycast(ray, hit);
+		if (found != (closest != FLT_MAX) || (found && fabsf(hit.distance - closest) > 1e-4f * closest))
+			correct = false;
+	}
+
+	std::cout << (correct ? "results match brute force" : "MISMATCH against brute force!") << std::endl;
+	return correct ? 0 : 1;
+}
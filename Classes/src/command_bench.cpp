@@ -0,0 +1,216 @@
+/* parallel command recording benchmark
+	~ every frame each object is tested against the frustum and, when
+	  visible, queued for drawing
+		1. one thread Submits straight into the Renderer
+		2. the objects are split over a JobSystem's workers, each one
+		   records into its own CommandList, the lists are merged into the
+		   Renderer and Flush radix sorts them in parallel
+	  path 2 runs with 1 to N threads (N = hardware threads, at least 4)
+	~ prints record time, merge + sort + draw time and the draw count,
+	  then sorts 1M commands with std::sort, the serial radix sort and
+	  the parallel radix sort and checks that all three agree */
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <algorithm>
+#include <thread>
+#include <cmath>
+
+#include "renderer.h"
+#include "shader.h"
+#include "Mesh.h"
+#include "Culling.h"
+#include "JobSystem.h"
+#include "CommandList.h"
+
+#define OBJECT_COUNT 50000
+#define MESH_COUNT 64
+#define FRAMES 30
+#define SORT_COUNT (1024 * 1024)
+
+static double Now()
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* column major projection * rotation about y, camera at the origin */
+static void ViewProjection(float angle, float* out)
+{
+	float f = 1.0f / tanf(0.5f), aspect = 4.0f / 3.0f, zNear = 0.1f, zFar = 200.0f;
+	float c = cosf(angle), s = sinf(angle);
+	float a = f / aspect, b = (zFar + zNear) / (zNear - zFar), d = 2.0f * zFar * zNear / (zNear - zFar);
+	float matrix[16] = {
+		a * c, 0.0f, -b * s, s,
+		0.0f, f, 0.0f, 0.0f,
+		a * s, 0.0f, b * c, -c,
+		0.0f, 0.0f, d, 0.0f
+	};
+	for (int i = 0; i < 16; i++)
+		out[i] = matrix[i];
+}
+
+static bool IsVisible(const BoundsStore& bounds, const Frustum& frustum, unsigned int object)
+{
+	for (unsigned int p = 0; p < 6; p++)
+	{
+		const Plane& plane = frustum.GetPlane(p);
+		float distance = plane.a * bounds.GetCenterX()[object] + plane.b * bounds.GetCenterY()[object] + plane.c * bounds.GetCenterZ()[object] + plane.d;
+		if (distance < -bounds.GetRadius()[object])
+			return false;
+	}
+	return true;
+}
+
+int main(void)
+{
+	GLFWwindow* window;
+
+	/* Initialize the library */
+	if (!glfwInit())
+		return -1;
+
+	window = glfwCreateWindow(640, 480, "Command list benchmark", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+
+	if (glewInit() != GLEW_OK)
+		std::cout << "Error!" << std::endl;
+
+	{
+		float positions[] = {
+			-0.01f, -0.01f,
+			 0.01f, -0.01f,
+			 0.01f,  0.01f,
+			-0.01f,  0.01f,
+		};
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		std::vector<std::unique_ptr<Mesh>> meshes;
+		for (int i = 0; i < MESH_COUNT; i++)
+			meshes.push_back(std::make_unique<Mesh>(positions, (unsigned int)sizeof(positions), indices, 6, layout));
+
+		Shader shader("res/shading/basic.shader");
+		shader.Bind();
+		shader.SetUniform4f("u_Color", 0.2f, 0.3f, 0.8f, 1.0f);
+
+		std::mt19937 random(9);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+		BoundsStore bounds;
+		for (int i = 0; i < OBJECT_COUNT; i++)
+		{
+			float center[3] = { position(random), position(random) * 0.2f, position(random) };
+			bounds.AddSphere(center, 1.0f);
+		}
+
+		unsigned int hardware = std::thread::hardware_concurrency();
+		unsigned int maxThreads = std::max(hardware, 4u);
+		std::cout << hardware << " hardware threads" << std::endl;
+
+		Renderer renderer;
+		for (unsigned int threads = 0; threads <= maxThreads; threads++)
+		{
+			/* threads == 0 is the serial path */
+			std::unique_ptr<JobSystem> jobs = threads ? std::make_unique<JobSystem>(threads) : nullptr;
+			std::vector<CommandList> lists(threads);
+
+			double record = 0.0, flush = 0.0;
+			unsigned long long draws = 0;
+			for (int frame = 0; frame < FRAMES; frame++)
+			{
+				float viewProjection[16];
+				ViewProjection(frame * 0.05f, viewProjection);
+				Frustum frustum(viewProjection);
+				GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+				double start = Now();
+				if (threads == 0)
+				{
+					for (unsigned int object = 0; object < OBJECT_COUNT; object++)
+					{
+						if (!IsVisible(bounds, frustum, object))
+							continue;
+						const Mesh& mesh = *meshes[object % MESH_COUNT];
+						renderer.Submit(mesh.GetVertexArray(), mesh.GetIndexBuffer(), shader);
+					}
+				}
+				else
+				{
+					for (CommandList& list : lists)
+						list.Clear();
+					jobs->ParallelFor(OBJECT_COUNT, 1024, [&](unsigned int begin, unsigned int end)
+					{
+						CommandList& list = lists[JobSystem::GetWorkerIndex()];
+						for (unsigned int object = begin; object < end; object++)
+						{
+							if (!IsVisible(bounds, frustum, object))
+								continue;
+							const Mesh& mesh = *meshes[object % MESH_COUNT];
+							list.Submit(mesh.GetVertexArray(), mesh.GetIndexBuffer(), shader);
+						}
+					});
+				}
+				double recorded = Now();
+				record += recorded - start;
+
+				if (threads)
+					renderer.Submit(lists.data(), threads, jobs.get());
+				draws += renderer.GetQueuedCount();
+				renderer.Flush(jobs.get());
+				glFinish();
+				flush += Now() - recorded;
+
+				glfwSwapBuffers(window);
+				glfwPollEvents();
+			}
+
+			if (threads == 0)
+				std::cout << "serial";
+			else
+				std::cout << threads << " threads";
+			std::cout << ": " << draws / FRAMES << " draws, record " << record / FRAMES << " ms, merge + sort + draw "
+				<< flush / FRAMES << " ms per frame" << std::endl;
+		}
+
+		/* the sort alone, keys like a real frame: a few shaders, many vertex arrays */
+		std::vector<DrawCommand> commands(SORT_COUNT), scratch(SORT_COUNT);
+		for (unsigned int i = 0; i < SORT_COUNT; i++)
+			commands[i] = { (unsigned long long)(random() % 8 + 1) << 32 | (random() % 4096 + 1), nullptr, nullptr, nullptr, nullptr };
+
+		std::vector<DrawCommand> reference = commands;
+		double start = Now();
+		std::stable_sort(reference.begin(), reference.end(), [](const DrawCommand& a, const DrawCommand& b) { return a.key < b.key; });
+		std::cout << "sort " << SORT_COUNT << " commands: std::stable_sort " << Now() - start << " ms";
+
+		for (unsigned int threads = 0; threads <= maxThreads; threads++)
+		{
+			std::unique_ptr<JobSystem> jobs = threads ? std::make_unique<JobSystem>(threads) : nullptr;
+			std::vector<DrawCommand> input = commands;
+			start = Now();
+			const DrawCommand* sorted = CommandList::Sort(input.data(), scratch.data(), SORT_COUNT, jobs.get());
+			double milliseconds = Now() - start;
+
+			/* stable, so the order of equal keys matches too */
+			bool correct = true;
+			for (unsigned int i = 0; i < SORT_COUNT && correct; i++)
+				correct = sorted[i].key == reference[i].key;
+			std::cout << ", radix " << threads << " threads " << milliseconds << " ms" << (correct ? "" : " WRONG");
+		}
+		std::cout << std::endl;
+	}
+
+	glfwTerminate();
+	return 0;
+}
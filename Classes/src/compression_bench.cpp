@@ -0,0 +1,120 @@
+/* block compression benchmark
+	~ encode speed of BC1/BC3/BC7 in fast (SIMD) and quality mode
+	~ upload bandwidth of the same image as RGBA8 and compressed, measured
+	  up to glFinish so the driver can't hide the copy */
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+
+#include "renderer.h"
+#include "Texture.h"
+#include "BlockCompression.h"
+
+#define IMAGE_SIZE 2048
+#define UPLOAD_REPEATS 16
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Seconds(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main(void)
+{
+	GLFWwindow* window;
+
+	/* Initialize the library */
+	if (!glfwInit())
+		return -1;
+
+	window = glfwCreateWindow(640, 480, "Block compression benchmark", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+
+	if (glewInit() != GLEW_OK)
+		std::cout << "Error!" << std::endl;
+
+	std::cout << glGetString(GL_VERSION) << std::endl;
+
+	{
+		/* smooth gradients plus some noise, roughly what photos look like to the encoder */
+		std::vector<unsigned char> image((size_t)IMAGE_SIZE * IMAGE_SIZE * 4);
+		unsigned int seed = 1;
+		for (unsigned int y = 0; y < IMAGE_SIZE; y++)
+		{
+			for (unsigned int x = 0; x < IMAGE_SIZE; x++)
+			{
+				seed = seed * 1664525 + 1013904223;
+				int noise = (int)(seed >> 28) - 8;
+				unsigned char* pixel = &image[((size_t)y * IMAGE_SIZE + x) * 4];
+				pixel[0] = (unsigned char)(128 + 100 * sin(x * 0.01) + noise);
+				pixel[1] = (unsigned char)(y * 255 / IMAGE_SIZE);
+				pixel[2] = (unsigned char)(128 + 100 * cos((x + y) * 0.005));
+				pixel[3] = (unsigned char)(x * 255 / IMAGE_SIZE);
+			}
+		}
+
+		const char* names[3] = { "BC1", "BC3", "BC7" };
+		const BlockFormat formats[3] = { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC7 };
+		std::vector<std::vector<unsigned char>> compressed(3);
+		double megapixels = (double)IMAGE_SIZE * IMAGE_SIZE / 1e6;
+
+		std::cout << "encode (" << IMAGE_SIZE << "x" << IMAGE_SIZE << ")" << std::endl;
+		for (int f = 0; f < 3; f++)
+		{
+			compressed[f].resize(BlockCompressor::GetCompressedSize(formats[f], IMAGE_SIZE, IMAGE_SIZE));
+
+			auto start = Clock::now();
+			BlockCompressor::Compress(formats[f], image.data(), IMAGE_SIZE, IMAGE_SIZE, compressed[f].data(), CompressionQuality::QUALITY);
+			double quality = Seconds(start);
+
+			start = Clock::now();
+			BlockCompressor::Compress(formats[f], image.data(), IMAGE_SIZE, IMAGE_SIZE, compressed[f].data(), CompressionQuality::FAST);
+			double fast = Seconds(start);
+
+			std::cout << "  " << names[f] << ": fast " << megapixels / fast << " Mpixels/s, quality "
+				<< megapixels / quality << " Mpixels/s" << std::endl;
+		}
+
+		/* upload level 0 over and over, glFinish makes sure it really happened */
+		std::cout << "upload (" << UPLOAD_REPEATS << "x)" << std::endl;
+		{
+			Texture texture(IMAGE_SIZE, IMAGE_SIZE, GL_RGBA8, 1);
+			GLCall(glFinish());
+			auto start = Clock::now();
+			for (int i = 0; i < UPLOAD_REPEATS; i++)
+				texture.SetData(image.data(), GL_RGBA, GL_UNSIGNED_BYTE);
+			GLCall(glFinish());
+			double seconds = Seconds(start);
+			std::cout << "  RGBA8: " << image.size() / 1024 << " KB, " << image.size() * UPLOAD_REPEATS / seconds / (1024.0 * 1024.0)
+				<< " MB/s, " << UPLOAD_REPEATS * megapixels / seconds << " Mpixels/s" << std::endl;
+		}
+		for (int f = 0; f < 3; f++)
+		{
+			Texture texture(IMAGE_SIZE, IMAGE_SIZE, BlockCompressor::GetGLFormat(formats[f]), 1);
+			GLCall(glFinish());
+			auto start = Clock::now();
+			for (int i = 0; i < UPLOAD_REPEATS; i++)
+				texture.SetCompressedData(compressed[f].data(), (unsigned int)compressed[f].size());
+			GLCall(glFinish());
+			double seconds = Seconds(start);
+			std::cout << "  " << names[f] << ": " << compressed[f].size() / 1024 << " KB, "
+				<< compressed[f].size() * UPLOAD_REPEATS / seconds / (1024.0 * 1024.0) << " MB/s, "
+				<< UPLOAD_REPEATS * megapixels / seconds << " Mpixels/s" << std::endl;
+		}
+	}
+
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,131 @@
+/* frustum culling benchmark
+	~ scatters OBJECT_COUNT boxes and spheres through a big cube and culls
+	  them against a camera in the middle of it
+	~ times the scalar reference against the SIMD path and checks that both
+	  return exactly the same objects
+	~ CPU only, no window needed */
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+
+#include "Culling.h"
+
+#define OBJECT_COUNT 100000
+#define WORLD_SIZE 1000.0f
+#define REPEATS 200
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Seconds(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/* column major out = a * b */
+static void Multiply(const float* a, const float* b, float* out)
+{
+	for (int column = 0; column < 4; column++)
+		for (int row = 0; row < 4; row++)
+		{
+			float sum = 0.0f;
+			for (int k = 0; k < 4; k++)
+				sum += a[k * 4 + row] * b[column * 4 + k];
+			out[column * 4 + row] = sum;
+		}
+}
+
+static void Perspective(float fovY, float aspect, float zNear, float zFar, float* out)
+{
+	float f = 1.0f / tanf(fovY * 0.5f);
+	for (int i = 0; i < 16; i++)
+		out[i] = 0.0f;
+	out[0] = f / aspect;
+	out[5] = f;
+	out[10] = (zFar + zNear) / (zNear - zFar);
+	out[11] = -1.0f;
+	out[14] = 2.0f * zFar * zNear / (zNear - zFar);
+}
+
+/* camera at eye looking along the (normalized) direction, y up */
+static void LookAlong(const float eye[3], const float direction[3], float* out)
+{
+	const float* f = direction;
+	float s[3] = { f[1] * 0.0f - f[2] * 1.0f, f[2] * 0.0f - f[0] * 0.0f, f[0] * 1.0f - f[1] * 0.0f };
+	float length = sqrtf(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+	s[0] /= length; s[1] /= length; s[2] /= length;
+	float u[3] = { s[1] * f[2] - s[2] * f[1], s[2] * f[0] - s[0] * f[2], s[0] * f[1] - s[1] * f[0] };
+
+	float view[16] = {
+		s[0], u[0], -f[0], 0.0f,
+		s[1], u[1], -f[1], 0.0f,
+		s[2], u[2], -f[2], 0.0f,
+		-(s[0] * eye[0] + s[1] * eye[1] + s[2] * eye[2]),
+		-(u[0] * eye[0] + u[1] * eye[1] + u[2] * eye[2]),
+		(f[0] * eye[0] + f[1] * eye[1] + f[2] * eye[2]), 1.0f
+	};
+	for (int i = 0; i < 16; i++)
+		out[i] = view[i];
+}
+
+int main(void)
+{
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(-WORLD_SIZE * 0.5f, WORLD_SIZE * 0.5f);
+	std::uniform_real_distribution<float> size(0.5f, 5.0f);
+
+	BoundsStore bounds;
+	for (unsigned int i = 0; i < OBJECT_COUNT; i++)
+	{
+		float center[3] = { position(random), position(random), position(random) };
+		if (i % 4 == 0)
+			bounds.AddSphere(center, size(random));
+		else
+		{
+			float extents[3] = { size(random), size(random), size(random) };
+			bounds.AddBox(center, extents);
+		}
+	}
+
+	float projection[16], view[16], viewProjection[16];
+	float eye[3] = { 0.0f, 0.0f, 0.0f };
+	float direction[3] = { 0.0f, 0.0f, -1.0f };
+	Perspective(60.0f * 3.14159265f / 180.0f, 16.0f / 9.0f, 0.1f, 400.0f, projection);
+	LookAlong(eye, direction, view);
+	Multiply(projection, view, viewProjection);
+	Frustum frustum(viewProjection);
+
+	std::vector<unsigned int> scalarVisible, simdVisible;
+
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < REPEATS; i++)
+		FrustumCuller::CullScalar(bounds, frustum, scalarVisible);
+	double scalarSeconds = Seconds(start) / REPEATS;
+
+	start = Clock::now();
+	for (int i = 0; i < REPEATS; i++)
+		FrustumCuller::Cull(bounds, frustum, simdVisible);
+	double simdSeconds = Seconds(start) / REPEATS;
+
+#if defined(__AVX__)
+	const char* path = "AVX";
+#elif defined(__SSE2__) || defined(_M_X64)
+	const char* path = "SSE";
+#else
+	const char* path = "scalar fallback";
+#endif
+
+	std::cout << OBJECT_COUNT << " objects, " << simdVisible.size() << " visible" << std::endl;
+	std::cout << "scalar: " << scalarSeconds * 1e6 << " us" << std::endl;
+	std::cout << path << ": " << simdSeconds * 1e6 << " us (" << scalarSeconds / simdSeconds << "x)" << std::endl;
+
+	if (scalarVisible != simdVisible)
+	{
+		std::cout << "MISMATCH between scalar and SIMD results!" << std::endl;
+		return 1;
+	}
+	std::cout << "results match" << std::endl;
+	return 0;
+}
@@ -0,0 +1,142 @@
+/* deletion queue benchmark
+	~ streams content out: every frame STREAM_COUNT vertex buffers that were
+	  drawn with are destroyed and new ones are created
+		1. destructors delete right away (no FrameSync set)
+		2. destructors hand their names to the DeletionQueue, deleted once
+		   the frame's fence has signalled
+		3. like 2, but the buffers are released by a worker thread
+	~ prints the average and worst frame time and how many names wait */
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "renderer.h"
+#include "vertexbuffer.h"
+#include "VertexArray.h"
+#include "indexbuffer.h"
+#include "shader.h"
+#include "FrameSync.h"
+#include "DeletionQueue.h"
+
+#define OBJECT_COUNT 2000
+#define STREAM_COUNT 200
+#define FRAMES 120
+
+struct StreamedObject
+{
+	std::unique_ptr<VertexBuffer> vb;
+	std::unique_ptr<VertexArray> va;
+};
+
+static StreamedObject MakeObject(const float* positions, unsigned int size, const VertexBufferLayout& layout)
+{
+	StreamedObject object;
+	object.vb = std::make_unique<VertexBuffer>(positions, size);
+	object.va = std::make_unique<VertexArray>();
+	object.va->addBuffer(*object.vb, layout);
+	return object;
+}
+
+int main(void)
+{
+	GLFWwindow* window;
+
+	/* Initialize the library */
+	if (!glfwInit())
+		return -1;
+
+	window = glfwCreateWindow(640, 480, "Deletion queue benchmark", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+
+	if (glewInit() != GLEW_OK)
+		std::cout << "Error!" << std::endl;
+
+	{
+		float positions[] = {
+			-0.01f, -0.01f,
+			 0.01f, -0.01f,
+			 0.01f,  0.01f,
+			-0.01f,  0.01f,
+		};
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		IndexBuffer ib(indices, 6);
+
+		Shader shader("res/shading/basic.shader");
+		shader.Bind();
+		shader.SetUniform4f("u_Color", 0.2f, 0.3f, 0.8f, 1.0f);
+
+		Renderer renderer;
+		FrameSync sync;
+		const char* names[] = { "immediate delete", "deletion queue", "deletion queue, worker thread" };
+
+		for (int path = 0; path < 3; path++)
+		{
+			DeletionQueue::SetFrameSync(path == 0 ? nullptr : &sync);
+
+			std::vector<StreamedObject> objects;
+			for (int i = 0; i < OBJECT_COUNT; i++)
+				objects.push_back(MakeObject(positions, (unsigned int)sizeof(positions), layout));
+
+			double total = 0.0, worst = 0.0;
+			unsigned int waiting = 0, deleted = 0;
+			for (int frame = 0; frame < FRAMES; frame++)
+			{
+				auto start = std::chrono::high_resolution_clock::now();
+
+				renderer.Clear();
+				for (const StreamedObject& object : objects)
+					renderer.Draw(*object.va, ib, shader);
+
+				/* stream out the oldest objects, which were just drawn with */
+				std::vector<StreamedObject> released;
+				for (int i = 0; i < STREAM_COUNT; i++)
+				{
+					unsigned int index = (frame * STREAM_COUNT + i) % OBJECT_COUNT;
+					released.push_back(std::move(objects[index]));
+					objects[index] = MakeObject(positions, (unsigned int)sizeof(positions), layout);
+				}
+				if (path == 2)
+				{
+					std::thread worker([&released]() { released.clear(); });
+					worker.join();
+				}
+				else
+					released.clear();
+
+				glfwSwapBuffers(window);
+				glfwPollEvents();
+				sync.EndFrame();
+				deleted += DeletionQueue::Collect();
+				waiting += DeletionQueue::GetPendingCount();
+
+				double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+				total += milliseconds;
+				worst = milliseconds > worst ? milliseconds : worst;
+			}
+
+			objects.clear();
+			deleted += DeletionQueue::Flush();
+			std::cout << names[path] << ": " << total / FRAMES << " ms per frame (worst " << worst << " ms), "
+				<< (double)waiting / FRAMES << " names waiting per frame, " << deleted << " deleted by the queue" << std::endl;
+		}
+		DeletionQueue::SetFrameSync(nullptr);
+	}
+
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,302 @@
+/* compute shader benchmark
+	~ particles: PARTICLE_COUNT particles of the ParticleSystem fountain
+		1. CPU: SIMD Simulate, Write into the mapped VertexBuffer, draw
+		2. GPU: GpuParticleSystem, one dispatch, the draw reads the
+		   storage buffer, nothing crosses the bus
+	  checks that one GPU step matches one CPU step for every particle
+	  that didn't respawn, and that after many steps every particle is
+	  above the ground with a life inside the settings' range
+	~ culling: OBJECT_COUNT spheres using MESH_COUNT meshes of a
+	  GeometryPool, seen through an orthographic window that slides over
+	  them
+		1. CPU: FrustumCuller::Cull, a MultiDrawBatch of what's visible
+		2. GPU: GpuCuller, cull.shader writes the indirect commands
+	  checks that both keep the same number of objects every frame
+	~ prints the frame times up to glFinish */
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+
+#include "renderer.h"
+#include "vertexbuffer.h"
+#include "VertexArray.h"
+#include "indexbuffer.h"
+#include "shader.h"
+#include "VectorMath.h"
+#include "ParticleSystem.h"
+#include "GpuParticleSystem.h"
+#include "Culling.h"
+#include "GeometryPool.h"
+#include "MultiDrawBatch.h"
+#include "GpuCuller.h"
+
+#define PARTICLE_COUNT (1024 * 1024)
+#define OBJECT_COUNT 100000
+#define MESH_COUNT 64
+#define FRAMES 20
+#define DT (1.0f / 60.0f)
+
+static double Now()
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* star with points points, the meshes the culling draws */
+static unsigned int AddStar(GeometryPool& pool, unsigned int points, float inner)
+{
+	std::vector<float> vertices = { 0.0f, 0.0f };
+	std::vector<unsigned int> indices;
+	for (unsigned int p = 0; p < points * 2; p++)
+	{
+		float angle = 3.14159265f * p / points;
+		float radius = p % 2 ? inner : 1.0f;
+		vertices.push_back(cosf(angle) * radius);
+		vertices.push_back(sinf(angle) * radius);
+		unsigned int next = (p + 1) % (points * 2);
+		indices.insert(indices.end(), { 0, p + 1, next + 1 });
+	}
+	return pool.Add(vertices.data(), (unsigned int)vertices.size() / 2, indices.data(), (unsigned int)indices.size());
+}
+
+int main(void)
+{
+	GLFWwindow* window;
+
+	/* Initialize the library */
+	if (!glfwInit())
+		return -1;
+
+	/* compute shaders and storage buffers are GL 4.3 */
+	window = glfwCreateWindow(640, 480, "Compute shader benchmark", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+
+	if (glewInit() != GLEW_OK)
+		std::cout << "Error!" << std::endl;
+
+	std::cout << glGetString(GL_VERSION) << ", " << glGetString(GL_RENDERER) << std::endl;
+
+	{
+		Renderer renderer;
+		float corners[] = {
+			-1.0f, -1.0f,
+			 1.0f, -1.0f,
+			 1.0f,  1.0f,
+			-1.0f,  1.0f,
+		};
+		unsigned int quadIndices[] = { 0, 1, 2, 2, 3, 0 };
+		VertexBuffer quadBuffer(corners, sizeof(corners));
+		VertexBufferLayout quadLayout;
+		quadLayout.Push<float>(2, "corner");
+
+		Shader cpuShader("res/shading/particle.shader");
+		Shader gpuShader("res/shading/particle_gpu.shader");
+		Shader update("res/shading/particle_update.shader");
+		std::cout << "particles (" << PARTICLE_COUNT << ", compute groups of " << update.GetWorkGroupSize(0) << "):" << std::endl;
+
+		Mat4 viewProjection = Mat4::Perspective(1.0f, 4.0f / 3.0f, 0.1f, 100.0f) * Mat4::LookAt({ 0.0f, 3.0f, 10.0f }, { 0.0f, 1.5f, 0.0f }, { 0.0f, 1.0f, 0.0f });
+		cpuShader.Bind();
+		cpuShader.SetUniformMat4f("u_ViewProjection", viewProjection.Data());
+		gpuShader.Bind();
+		gpuShader.SetUniformMat4f("u_ViewProjection", viewProjection.Data());
+		GLCall(glEnable(GL_BLEND));
+		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE));
+
+		ParticleSystem cpu(PARTICLE_COUNT);
+		GpuParticleSystem gpu(PARTICLE_COUNT);
+
+		/* one step each from the same start, a particle that didn't die
+		   must be where the CPU put it */
+		{
+			std::vector<float> before(cpu.GetLife(), cpu.GetLife() + PARTICLE_COUNT);
+			cpu.Simulate(DT);
+			gpu.Simulate(renderer, update, DT);
+			std::vector<GpuParticle> particles;
+			gpu.Read(particles);
+			float error = 0.0f;
+			unsigned int compared = 0;
+			for (unsigned int i = 0; i < PARTICLE_COUNT; i++)
+			{
+				if (before[i] - DT <= 0.0f)
+					continue;	/* respawned, differently on each side */
+				error = fmaxf(error, fabsf(cpu.GetPositionX()[i] - particles[i].position.x));
+				error = fmaxf(error, fabsf(cpu.GetPositionY()[i] - particles[i].position.y));
+				error = fmaxf(error, fabsf(cpu.GetPositionZ()[i] - particles[i].position.z));
+				error = fmaxf(error, fabsf(cpu.GetLife()[i] - particles[i].position.w));
+				compared++;
+			}
+			std::cout << "  one step, " << compared << " particles compared, largest difference GPU vs CPU: " << error
+				<< (error < 1e-4f ? " (ok)" : " (MISMATCH)") << std::endl;
+		}
+
+		/* CPU: what particle_bench's frames do, on this thread */
+		{
+			VertexArray va;
+			va.addBuffer(quadBuffer, quadLayout);
+			IndexBuffer ib(quadIndices, 6);
+			unsigned int positionsSize = PARTICLE_COUNT * 4 * sizeof(float);
+			unsigned int bufferSize = positionsSize + PARTICLE_COUNT * sizeof(unsigned int);
+			VertexBuffer instances(nullptr, bufferSize);
+			VertexBufferLayout positionLayout, colorLayout;
+			positionLayout.Push<float>(4);
+			colorLayout.Push<unsigned char>(4);
+			va.addInstanceBuffer(instances, positionLayout, 1, 0);
+			va.addInstanceBuffer(instances, colorLayout, 2, positionsSize);
+
+			double simulate = 0.0, start = Now();
+			for (int frame = 0; frame < FRAMES; frame++)
+			{
+				double mapping = Now();
+				unsigned char* mapped = (unsigned char*)instances.Map(0, bufferSize, true);
+				if (mapped)
+				{
+					cpu.Update(DT, { (float*)mapped, (unsigned int*)(mapped + positionsSize) });
+					instances.Unmap();
+				}
+				simulate += Now() - mapping;
+				renderer.Clear();
+				renderer.DrawInstanced(va, ib, cpuShader, PARTICLE_COUNT);
+				GLCall(glFinish());
+				glfwSwapBuffers(window);
+				glfwPollEvents();
+			}
+			std::cout << "  CPU simulate + write + draw: " << (Now() - start) / FRAMES << " ms (simulate + write "
+				<< simulate / FRAMES << " ms)" << std::endl;
+		}
+
+		/* GPU: dispatch and draw, the particles stay in the storage buffer */
+		{
+			VertexArray va;
+			va.addBuffer(quadBuffer, quadLayout);
+			IndexBuffer ib(quadIndices, 6);
+
+			double simulate = 0.0, start = Now();
+			for (int frame = 0; frame < FRAMES; frame++)
+			{
+				double dispatched = Now();
+				gpu.Simulate(renderer, update, DT);
+				GLCall(glFinish());
+				simulate += Now() - dispatched;
+				renderer.Clear();
+				gpu.Draw(renderer, va, ib, gpuShader);
+				GLCall(glFinish());
+				glfwSwapBuffers(window);
+				glfwPollEvents();
+			}
+			std::cout << "  GPU simulate + draw: " << (Now() - start) / FRAMES << " ms (simulate "
+				<< simulate / FRAMES << " ms)" << std::endl;
+
+			std::vector<GpuParticle> particles;
+			gpu.Read(particles);
+			const ParticleSettings& s = gpu.GetSettings();
+			unsigned int bad = 0;
+			for (const GpuParticle& p : particles)
+			{
+				float lifetime = 1.0f / p.velocity.w;
+				if (p.position.y < 0.0f || p.position.w > s.maxLife || lifetime < s.minLife - 1e-3f || lifetime > s.maxLife + 1e-3f)
+					bad++;
+			}
+			std::cout << "  after " << FRAMES + 1 << " steps " << bad << " particles out of range"
+				<< (bad == 0 ? " (ok)" : " (MISMATCH)") << std::endl;
+		}
+		GLCall(glDisable(GL_BLEND));
+
+		std::cout << "culling (" << OBJECT_COUNT << " objects, " << MESH_COUNT << " meshes):" << std::endl;
+		{
+			/* one pool each, a batch and a culler can't share a vertex array */
+			VertexBufferLayout layout;
+			layout.Push<float>(2);
+			GeometryPool cpuPool(layout, MESH_COUNT * 70, MESH_COUNT * 34 * 6);
+			GeometryPool gpuPool(layout, MESH_COUNT * 70, MESH_COUNT * 34 * 6);
+			std::vector<unsigned int> cpuMeshes(MESH_COUNT), gpuMeshes(MESH_COUNT);
+			std::mt19937 random(11);
+			std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+			for (unsigned int m = 0; m < MESH_COUNT; m++)
+			{
+				float inner = 0.3f + 0.5f * unit(random);
+				cpuMeshes[m] = AddStar(cpuPool, 3 + m % 32, inner);
+				gpuMeshes[m] = AddStar(gpuPool, 3 + m % 32, inner);
+			}
+
+			VertexBufferLayout instanceLayout;
+			instanceLayout.Push<float>(4);
+			instanceLayout.Push<float>(4);
+			MultiDrawBatch batch(cpuPool, instanceLayout, OBJECT_COUNT);
+			GpuCuller culler(gpuPool, OBJECT_COUNT, MESH_COUNT);
+			Shader cull("res/shading/cull.shader");
+			Shader draw("res/shading/multidraw.shader");
+
+			/* spread over x, y in -1..1, drawn where they are */
+			BoundsStore bounds;
+			std::vector<GpuCullObject> objects(OBJECT_COUNT);
+			for (unsigned int i = 0; i < OBJECT_COUNT; i++)
+			{
+				GpuCullObject& object = objects[i];
+				float scale = 0.002f + 0.01f * unit(random);
+				object.sphere = { unit(random) * 2.0f - 1.0f, unit(random) * 2.0f - 1.0f, 0.0f, scale };
+				object.transform = { object.sphere.x, object.sphere.y, scale, 0.0f };
+				object.color = { unit(random), unit(random), unit(random), 1.0f };
+				object.mesh = gpuMeshes[i % MESH_COUNT];
+				culler.Add(object);
+				bounds.AddSphere(&object.sphere.x, scale);
+			}
+
+			std::vector<unsigned int> visible;
+			double cpuMs = 0.0, gpuMs = 0.0;
+			unsigned int mismatches = 0, cpuVisible = 0;
+			for (int frame = 0; frame < FRAMES; frame++)
+			{
+				/* a window half as wide as the objects, sliding left to right */
+				float x = -0.5f + (float)frame / (FRAMES - 1);
+				Mat4 view = Mat4::Orthographic(x - 0.5f, x + 0.5f, -0.5f, 0.5f, -1.0f, 1.0f);
+				Frustum frustum(view.Data());
+
+				double start = Now();
+				unsigned int count = FrustumCuller::Cull(bounds, frustum, visible);
+				for (unsigned int v = 0; v < count; v++)
+				{
+					const GpuCullObject& object = objects[visible[v]];
+					batch.Add(cpuPool.GetRange(cpuMeshes[visible[v] % MESH_COUNT]), &object.transform);
+				}
+				renderer.Clear();
+				batch.Flush(draw);
+				GLCall(glFinish());
+				double culled = Now();
+				cpuMs += culled - start;
+
+				renderer.Clear();
+				culler.Cull(renderer, cull, frustum);
+				culler.Draw(draw);
+				GLCall(glFinish());
+				gpuMs += Now() - culled;
+				glfwSwapBuffers(window);
+				glfwPollEvents();
+
+				/* not timed, reads the counts back */
+				if (culler.GetVisibleCount() != count)
+					mismatches++;
+				cpuVisible += count;
+			}
+			std::cout << "  " << cpuVisible / FRAMES << " visible per frame on average" << std::endl;
+			std::cout << "  CPU cull + batch + draw: " << cpuMs / FRAMES << " ms" << std::endl;
+			std::cout << "  GPU cull + indirect draw: " << gpuMs / FRAMES << " ms" << std::endl;
+			std::cout << "  " << mismatches << " frames where the GPU kept a different count"
+				<< (mismatches == 0 ? " (ok)" : " (MISMATCH)") << std::endl;
+		}
+	}
+
+	glfwTerminate();
+	return 0;
+}
@@ -1,6 +1,7 @@
 #include "indexbuffer.h"
 
 #include "renderer.h"
+#include "DeletionQueue.h"
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
 	: m_Count(count) /* m_Count initialized to count */
@@ -14,7 +15,27 @@ IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
 
 IndexBuffer::~IndexBuffer()
 {
-	GLCall(glDeleteBuffers(1, &m_RendererID));
+	DeletionQueue::Delete(GLObjectType::BUFFER, m_RendererID);
+}
+
+IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_Count(other.m_Count)
+{
+	other.m_RendererID = 0;
+	other.m_Count = 0;
+}
+
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept
+{
+	if (this != &other)
+	{
+		DeletionQueue::Delete(GLObjectType::BUFFER, m_RendererID);
+		m_RendererID = other.m_RendererID;
+		m_Count = other.m_Count;
+		other.m_RendererID = 0;
+		other.m_Count = 0;
+	}
+	return *this;
 }
 
 void IndexBuffer::Bind() const
@@ -27,4 +48,11 @@ void IndexBuffer::Unbind() const
 {
 	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
 
+}
+
+void IndexBuffer::SetSubData(const unsigned int* data, unsigned int offset, unsigned int count)
+{
+	/* careful: this changes the element buffer of whatever vertex array is bound */
+	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
+	GLCall(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset * sizeof(unsigned int), count * sizeof(unsigned int), data));
 }
\ No newline at end of file
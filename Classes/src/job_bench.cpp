@@ -0,0 +1,175 @@
+/* job system benchmark
+	~ three CPU workloads, each run with 1 to N threads (N = hardware
+	  threads, at least 4 so the overhead of oversubscribing shows too)
+		1. transform: 4M points by a 4x4 matrix, even work per item,
+		   also run with different grain sizes
+		2. mandelbrot: 1024 x 1024, rows in the set cost far more than
+		   rows outside it, the idle threads have to steal
+		3. task tree: a job that starts two child jobs and waits for
+		   them, down to 2^16 leaves, nothing but scheduling overhead
+	~ prints the time, the speedup over 1 thread and how many jobs were
+	  stolen, and checks every result against the 1 thread run */
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <algorithm>
+
+#include "renderer.h"
+#include "JobSystem.h"
+
+#define POINT_COUNT (4 * 1024 * 1024)
+#define MANDELBROT_SIZE 1024
+#define MANDELBROT_ITERATIONS 256
+#define TREE_DEPTH 16
+#define REPEATS 5
+
+static double Now()
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void TransformPoints(JobSystem& jobs, unsigned int grain, const float* matrix, const float* input, float* output)
+{
+	jobs.ParallelFor(POINT_COUNT, grain, [=](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; i++)
+		{
+			const float* p = input + i * 3;
+			float* q = output + i * 3;
+			q[0] = matrix[0] * p[0] + matrix[4] * p[1] + matrix[8] * p[2] + matrix[12];
+			q[1] = matrix[1] * p[0] + matrix[5] * p[1] + matrix[9] * p[2] + matrix[13];
+			q[2] = matrix[2] * p[0] + matrix[6] * p[1] + matrix[10] * p[2] + matrix[14];
+		}
+	});
+}
+
+static void Mandelbrot(JobSystem& jobs, unsigned int* output)
+{
+	jobs.ParallelFor(MANDELBROT_SIZE, 1, [=](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int y = begin; y < end; y++)
+		{
+			for (unsigned int x = 0; x < MANDELBROT_SIZE; x++)
+			{
+				float cr = -2.0f + 2.5f * x / MANDELBROT_SIZE;
+				float ci = -1.25f + 2.5f * y / MANDELBROT_SIZE;
+				float zr = 0.0f, zi = 0.0f;
+				unsigned int n = 0;
+				while (n < MANDELBROT_ITERATIONS && zr * zr + zi * zi < 4.0f)
+				{
+					float t = zr * zr - zi * zi + cr;
+					zi = 2.0f * zr * zi + ci;
+					zr = t;
+					n++;
+				}
+				output[y * MANDELBROT_SIZE + x] = n;
+			}
+		}
+	});
+}
+
+/* counts the leaves of a binary tree of jobs */
+static void TaskTree(JobSystem* jobs, unsigned int depth, unsigned long long* leaves)
+{
+	if (depth == 0)
+	{
+		*leaves = 1;
+		return;
+	}
+
+	unsigned long long left = 0, right = 0;
+	JobCounter counter;
+	jobs->Run([=, &left]() { TaskTree(jobs, depth - 1, &left); }, &counter);
+	jobs->Run([=, &right]() { TaskTree(jobs, depth - 1, &right); }, &counter);
+	jobs->Wait(counter);
+	*leaves = left + right;
+}
+
+template<typename F>
+static double Measure(const F& function)
+{
+	double best = 1e30;
+	for (unsigned int i = 0; i < REPEATS; i++)
+	{
+		double start = Now();
+		function();
+		best = std::min(best, Now() - start);
+	}
+	return best;
+}
+
+static unsigned long long GetStolen(const JobSystem& jobs)
+{
+	unsigned long long stolen = 0;
+	for (unsigned int i = 0; i < jobs.GetThreadCount(); i++)
+		stolen += jobs.GetStolen(i);
+	return stolen;
+}
+
+int main(void)
+{
+	unsigned int hardware = std::thread::hardware_concurrency();
+	unsigned int maxThreads = std::max(hardware, 4u);
+	std::cout << hardware << " hardware threads" << std::endl;
+
+	float matrix[16] = { 0.8f, 0.1f, 0.0f, 0.0f, -0.1f, 0.8f, 0.2f, 0.0f, 0.0f, -0.2f, 0.9f, 0.0f, 1.0f, 2.0f, 3.0f, 1.0f };
+	std::vector<float> points(POINT_COUNT * 3);
+	for (unsigned int i = 0; i < POINT_COUNT * 3; i++)
+		points[i] = (float)(i % 1000) * 0.01f;
+	std::vector<float> transformed(POINT_COUNT * 3), reference(POINT_COUNT * 3);
+	std::vector<unsigned int> image(MANDELBROT_SIZE * MANDELBROT_SIZE), referenceImage(MANDELBROT_SIZE * MANDELBROT_SIZE);
+
+	double baseline[3] = {};
+	for (unsigned int threads = 1; threads <= maxThreads; threads++)
+	{
+		JobSystem jobs(threads);
+		std::cout << threads << " threads:" << std::endl;
+
+		double times[3];
+		unsigned long long stolen[3];
+		bool correct[3];
+
+		unsigned long long before = GetStolen(jobs);
+		times[0] = Measure([&]() { TransformPoints(jobs, 16384, matrix, points.data(), transformed.data()); });
+		stolen[0] = GetStolen(jobs) - before;
+		if (threads == 1)
+			reference = transformed;
+		correct[0] = transformed == reference;
+
+		before = GetStolen(jobs);
+		times[1] = Measure([&]() { Mandelbrot(jobs, image.data()); });
+		stolen[1] = GetStolen(jobs) - before;
+		if (threads == 1)
+			referenceImage = image;
+		correct[1] = image == referenceImage;
+
+		unsigned long long leaves = 0;
+		before = GetStolen(jobs);
+		times[2] = Measure([&]() { TaskTree(&jobs, TREE_DEPTH, &leaves); });
+		stolen[2] = GetStolen(jobs) - before;
+		correct[2] = leaves == (1ull << TREE_DEPTH);
+
+		const char* names[3] = { "transform", "mandelbrot", "task tree" };
+		for (unsigned int i = 0; i < 3; i++)
+		{
+			if (threads == 1)
+				baseline[i] = times[i];
+			std::cout << "  " << names[i] << ": " << times[i] << " ms, " << baseline[i] / times[i] << "x, "
+				<< stolen[i] / REPEATS << " steals" << (correct[i] ? "" : ", WRONG RESULT") << std::endl;
+		}
+
+		if (threads == std::min(hardware, maxThreads) || threads == maxThreads)
+		{
+			std::cout << "  transform grain:";
+			unsigned int grains[] = { 256, 4096, 65536, POINT_COUNT / threads };
+			for (unsigned int grain : grains)
+				std::cout << " " << grain << " = " << Measure([&]() { TransformPoints(jobs, grain, matrix, points.data(), transformed.data()); }) << " ms";
+			std::cout << std::endl;
+		}
+	}
+
+	return 0;
+}
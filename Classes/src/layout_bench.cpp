@@ -0,0 +1,136 @@
+/* shader reflection / vertex array cache benchmark
+	~ matches a few layouts against texture.shader (position, texCoord) and
+	  prints what MatchLayout makes of them: by name, by position, with a
+	  missing attribute, with an integer element where floats are expected
+	~ sets up MESH_COUNT meshes that share a vertex format
+		1. a VertexArray per mesh, layout matched to the shader every time
+		2. VertexArrayCache: matched once, vertex arrays built from the
+		   cached bindings
+	~ then looks every mesh up again, as a draw would */
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <memory>
+
+#include "renderer.h"
+#include "VertexArray.h"
+#include "VertexArrayCache.h"
+#include "indexbuffer.h"
+#include "shader.h"
+
+#define MESH_COUNT 5000
+
+static void Report(const Shader& shader, const char* what, const VertexBufferLayout& layout)
+{
+	std::vector<VertexAttributeBinding> bindings;
+	bool matched = shader.MatchLayout(layout, bindings);
+	std::cout << what << ": " << (matched ? "matches" : "rejected");
+	for (const VertexAttributeBinding& binding : bindings)
+		std::cout << ", element " << binding.element << " -> location " << binding.location << " (" << binding.count
+			<< " components at byte " << binding.offset << ")";
+	std::cout << std::endl;
+}
+
+int main(void)
+{
+	GLFWwindow* window;
+
+	/* Initialize the library */
+	if (!glfwInit())
+		return -1;
+
+	window = glfwCreateWindow(640, 480, "Vertex layout benchmark", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+
+	if (glewInit() != GLEW_OK)
+		std::cout << "Error!" << std::endl;
+
+	{
+		Shader shader("res/shading/texture.shader");
+		for (const ShaderAttribute& attribute : shader.GetAttributes())
+			std::cout << "attribute '" << attribute.name << "' at location " << attribute.location << ", type " << attribute.type << std::endl;
+
+		/* named, in a different order than the locations */
+		VertexBufferLayout named;
+		named.Push<float>(2, "texCoord");
+		named.Push<float>(2, "position");
+		Report(shader, "named, swapped", named);
+
+		VertexBufferLayout positional;
+		positional.Push<float>(2);
+		positional.Push<float>(2);
+		Report(shader, "positional", positional);
+
+		VertexBufferLayout missing;
+		missing.Push<float>(4, "position");
+		missing.Push<float>(3, "normal");
+		Report(shader, "missing texCoord", missing);
+
+		VertexBufferLayout colors;
+		colors.Push<float>(4, "position");
+		colors.Push<unsigned char>(4, "texCoord");
+		Report(shader, "normalized bytes for texCoord", colors);
+
+		/* setup cost */
+		float vertices[] = {
+			-0.5f, -0.5f, 0.0f, 0.0f,
+			 0.5f, -0.5f, 1.0f, 0.0f,
+			 0.5f,  0.5f, 1.0f, 1.0f,
+			-0.5f,  0.5f, 0.0f, 1.0f,
+		};
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+		VertexBufferLayout layout;
+		layout.Push<float>(2, "position");
+		layout.Push<float>(2, "texCoord");
+		std::vector<std::unique_ptr<VertexBuffer>> buffers;
+		for (int i = 0; i < MESH_COUNT; i++)
+			buffers.push_back(std::make_unique<VertexBuffer>(vertices, (unsigned int)sizeof(vertices)));
+		IndexBuffer ib(indices, 6);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		std::vector<std::unique_ptr<VertexArray>> arrays;
+		for (const std::unique_ptr<VertexBuffer>& buffer : buffers)
+		{
+			arrays.push_back(std::make_unique<VertexArray>());
+			arrays.back()->addBuffer(*buffer, layout, shader);
+		}
+		GLCall(glFinish());
+		double perMesh = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		VertexArrayCache cache;
+		start = std::chrono::high_resolution_clock::now();
+		bool valid = cache.Validate(shader, layout);
+		for (const std::unique_ptr<VertexBuffer>& buffer : buffers)
+			cache.Get(shader, *buffer, layout, &ib);
+		GLCall(glFinish());
+		double cached = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		start = std::chrono::high_resolution_clock::now();
+		unsigned int found = 0;
+		for (const std::unique_ptr<VertexBuffer>& buffer : buffers)
+			found += cache.Get(shader, *buffer, layout, &ib) != nullptr;
+		double lookups = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		std::cout << MESH_COUNT << " meshes: matched per mesh " << perMesh << " ms, cached " << cached << " ms (layout "
+			<< (valid ? "valid" : "invalid") << ", " << cache.GetLayoutCount() << " match, " << cache.GetVertexArrayCount()
+			<< " vertex arrays), lookups " << lookups << " ms (" << found << " found, " << cache.GetHits() << " hits)" << std::endl;
+
+		for (const std::unique_ptr<VertexBuffer>& buffer : buffers)
+			cache.Remove(*buffer);
+		std::cout << "after removing the buffers: " << cache.GetVertexArrayCount() << " vertex arrays" << std::endl;
+	}
+
+	glfwTerminate();
+	return 0;
+}
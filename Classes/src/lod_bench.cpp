@@ -0,0 +1,132 @@
+/* level of detail benchmark
+	~ builds the LOD chain of a bumpy UV sphere (or of an OBJ/PLY given on
+	  the command line) and prints triangles, error and build time per level
+	~ then flies a camera through a field of instances of it and counts
+	  the triangles that would be submitted with and without LOD, and how
+	  often instances switch level with and without hysteresis
+	~ CPU only, no window needed
+
+	usage: lod_bench [mesh.obj|mesh.ply] */
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+
+#include "MeshLoader.h"
+#include "MeshSimplifier.h"
+
+#define INSTANCE_COUNT 2000
+#define FIELD_SIZE 2000.0f
+#define FRAMES 300
+#define VIEWPORT_HEIGHT 1080.0f
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Milliseconds(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/* position(3) texcoord(2), the u = 0/1 column and the poles are seams */
+static void BuildSphere(unsigned int columns, unsigned int rows, MeshData& mesh)
+{
+	for (unsigned int y = 0; y <= rows; y++)
+		for (unsigned int x = 0; x <= columns; x++)
+		{
+			float u = (float)x / columns, v = (float)y / rows;
+			float theta = u * 6.2831853f, phi = v * 3.14159265f;
+			float radius = 1.0f + 0.03f * sinf(theta * 12.0f) * sinf(phi * 9.0f);
+			mesh.vertices.push_back(radius * sinf(phi) * cosf(theta));
+			mesh.vertices.push_back(radius * cosf(phi));
+			mesh.vertices.push_back(radius * sinf(phi) * sinf(theta));
+			mesh.vertices.push_back(u);
+			mesh.vertices.push_back(v);
+		}
+	for (unsigned int y = 0; y < rows; y++)
+		for (unsigned int x = 0; x < columns; x++)
+		{
+			unsigned int i0 = y * (columns + 1) + x, i1 = i0 + 1, i2 = i0 + columns + 1, i3 = i2 + 1;
+			unsigned int quad[6] = { i0, i2, i1, i1, i2, i3 };
+			mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+		}
+	mesh.layout.Push<float>(3);
+	mesh.layout.Push<float>(2);
+}
+
+int main(int argc, char** argv)
+{
+	MeshData mesh;
+	if (argc > 1)
+	{
+		if (!MeshLoader::Load(argv[1], mesh))
+			return 1;
+	}
+	else
+		BuildSphere(512, 256, mesh);
+
+	unsigned int stride = mesh.layout.GetStride();
+	unsigned int vertexCount = (unsigned int)(mesh.vertices.size() * sizeof(float) / stride);
+
+	Clock::time_point start = Clock::now();
+	std::vector<LodLevel> levels;
+	MeshSimplifier::BuildLodChain(mesh.vertices.data(), vertexCount, stride, mesh.indices.data(),
+		(unsigned int)mesh.indices.size(), levels, 8);
+	std::cout << vertexCount << " vertices, LOD chain built in " << Milliseconds(start) << " ms" << std::endl;
+
+	std::vector<float> errors;
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		std::cout << "level " << i << ": " << levels[i].indices.size() / 3 << " triangles, error " << levels[i].error << std::endl;
+		errors.push_back(levels[i].error);
+	}
+
+	/* instances scattered over a field, the camera flies across it */
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> position(-FIELD_SIZE * 0.5f, FIELD_SIZE * 0.5f);
+	std::vector<float> instances;
+	for (int i = 0; i < INSTANCE_COUNT; i++)
+	{
+		instances.push_back(position(random));
+		instances.push_back(position(random));
+	}
+
+	/* 60 degree vertical field of view */
+	float projection5 = 1.0f / tanf(30.0f * 3.14159265f / 180.0f);
+	float projection[16] = {};
+	projection[5] = projection5;
+	float pixelsPerUnit = LodSelector::GetPixelsPerUnit(projection, VIEWPORT_HEIGHT);
+
+	const float hysteresis[2] = { 0.0f, 0.25f };
+	for (float h : hysteresis)
+	{
+		std::vector<unsigned int> current(INSTANCE_COUNT, 0);
+		unsigned long long fullTriangles = 0, lodTriangles = 0, switches = 0;
+		double selectMs = 0.0;
+		for (int frame = 0; frame < FRAMES; frame++)
+		{
+			/* slow fly over, with a little back and forth sway */
+			float cameraX = -FIELD_SIZE * 0.5f + FIELD_SIZE * frame / FRAMES;
+			float cameraZ = 5.0f * sinf(frame * 0.7f);
+
+			start = Clock::now();
+			for (int i = 0; i < INSTANCE_COUNT; i++)
+			{
+				float dx = instances[i * 2] - cameraX, dz = instances[i * 2 + 1] - cameraZ;
+				float distance = sqrtf(dx * dx + dz * dz + 4.0f);
+				unsigned int level = LodSelector::Select(errors.data(), (unsigned int)errors.size(), distance,
+					pixelsPerUnit, current[i], 1.0f, h);
+				switches += level != current[i] ? 1 : 0;
+				current[i] = level;
+				lodTriangles += levels[level].indices.size() / 3;
+				fullTriangles += levels[0].indices.size() / 3;
+			}
+			selectMs += Milliseconds(start);
+		}
+		std::cout << "hysteresis " << h << ": " << lodTriangles / FRAMES << " triangles per frame (full detail "
+			<< fullTriangles / FRAMES << ", " << (double)fullTriangles / lodTriangles << "x fewer), "
+			<< switches << " level switches, " << selectMs / FRAMES << " ms selection per frame" << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,184 @@
+/* math library benchmark
+	~ checks the library first: TRS against T * R * S, Inverse and
+	  InverseAffine against identity, quaternion rotation against the
+	  rotation matrix, the batch routines against their scalar versions
+	~ then times, each against a plain scalar loop:
+		1. TransformPoints, 4M points in structure of arrays
+		2. Multiply, 1M pairs of matrices, and 2048 pairs that fit in cache
+		3. Multiply, one matrix times 1M matrices
+		4. Mat4 * Mat4 one at a time (the inline SSE operator) */
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+
+#include "VectorMath.h"
+
+#define POINT_COUNT (4 * 1024 * 1024)
+#define MATRIX_COUNT (1024 * 1024)
+#define CACHED_COUNT 2048
+#define REPEATS 5
+
+static double Now()
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static float MaxDifference(const Mat4& a, const Mat4& b)
+{
+	float difference = 0.0f;
+	for (int i = 0; i < 16; i++)
+		difference = fmaxf(difference, fabsf(a.Data()[i] - b.Data()[i]));
+	return difference;
+}
+
+static void Check(const char* name, float error, float tolerance)
+{
+	std::cout << "  " << name << ": " << error << (error <= tolerance ? "" : "  FAILED") << std::endl;
+}
+
+template<typename F>
+static double Measure(const F& function)
+{
+	double best = 1e30;
+	for (unsigned int i = 0; i < REPEATS; i++)
+	{
+		double start = Now();
+		function();
+		double milliseconds = Now() - start;
+		best = milliseconds < best ? milliseconds : best;
+	}
+	return best;
+}
+
+int main(void)
+{
+#if defined(MATH_AVX)
+	std::cout << "AVX path" << std::endl;
+#elif defined(MATH_SSE)
+	std::cout << "SSE path" << std::endl;
+#else
+	std::cout << "scalar path" << std::endl;
+#endif
+
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+	auto randomTRS = [&]()
+	{
+		Vec3 axis = Normalize(Vec3{ value(random), value(random), value(random) });
+		Quat q = Quat::FromAxisAngle(axis, value(random) * 3.0f);
+		Vec3 s = { 0.5f + fabsf(value(random)), 0.5f + fabsf(value(random)), 0.5f + fabsf(value(random)) };
+		return Mat4::TRS({ value(random) * 10.0f, value(random) * 10.0f, value(random) * 10.0f }, q, s);
+	};
+
+	std::cout << "largest errors:" << std::endl;
+	{
+		Vec3 axis = Normalize(Vec3{ 1.0f, 2.0f, 3.0f });
+		Quat q = Quat::FromAxisAngle(axis, 0.7f);
+		Vec3 t = { 1.0f, -2.0f, 3.0f }, s = { 2.0f, 0.5f, 1.5f };
+		Mat4 trs = Mat4::TRS(t, q, s);
+		Check("TRS vs T * R * S", MaxDifference(trs, Mat4::Translation(t) * Mat4::Rotation(q) * Mat4::Scale(s)), 1e-5f);
+		Check("Inverse(M) * M vs I", MaxDifference(Inverse(trs) * trs, Mat4::Identity()), 1e-5f);
+		Check("InverseAffine vs Inverse", MaxDifference(InverseAffine(trs), Inverse(trs)), 1e-5f);
+		Check("transpose twice", MaxDifference(Transpose(Transpose(trs)), trs), 0.0f);
+
+		Vec3 v = { 0.3f, -0.8f, 2.0f };
+		Vec3 rotated = Rotate(q, v), viaMatrix = TransformDirection(Mat4::Rotation(q), v);
+		Check("Rotate vs rotation matrix", Length(rotated - viaMatrix), 1e-5f);
+		Quat r = Quat::FromAxisAngle(Normalize(Vec3{ -1.0f, 0.5f, 0.2f }), 2.0f);
+		Check("Rotate(q * r) vs Rotate(q, Rotate(r))", Length(Rotate(q * r, v) - Rotate(q, Rotate(r, v))), 1e-5f);
+		Quat half = Slerp(Quat::Identity(), q, 0.5f);
+		Check("Slerp halfway squared vs q", MaxDifference(Mat4::Rotation(half * half), Mat4::Rotation(q)), 1e-5f);
+
+		Mat4 view = Mat4::LookAt({ 0.0f, 2.0f, 5.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f });
+		Vec3 eye = TransformPoint(InverseAffine(view), { 0.0f, 0.0f, 0.0f });
+		Check("LookAt eye", Length(eye - Vec3{ 0.0f, 2.0f, 5.0f }), 1e-5f);
+		Vec4 clip = Mat4::Perspective(1.0f, 4.0f / 3.0f, 0.1f, 200.0f) * Vec4{ 0.0f, 0.0f, -0.1f, 1.0f };
+		Check("Perspective near plane z / w vs -1", fabsf(clip.z / clip.w + 1.0f), 1e-5f);
+
+		Mat3 normal = NormalMatrix(trs);
+		Mat4 inverseTranspose = Transpose(Inverse(trs));
+		float error = 0.0f;
+		for (int c = 0; c < 3; c++)
+		{
+			error = fmaxf(error, fabsf(normal.columns[c].x - inverseTranspose.columns[c].x));
+			error = fmaxf(error, fabsf(normal.columns[c].y - inverseTranspose.columns[c].y));
+			error = fmaxf(error, fabsf(normal.columns[c].z - inverseTranspose.columns[c].z));
+		}
+		Check("NormalMatrix vs inverse transpose", error, 1e-5f);
+	}
+
+	std::vector<float> x(POINT_COUNT), y(POINT_COUNT), z(POINT_COUNT);
+	for (unsigned int i = 0; i < POINT_COUNT; i++)
+	{
+		x[i] = value(random) * 100.0f;
+		y[i] = value(random) * 100.0f;
+		z[i] = value(random) * 100.0f;
+	}
+	std::vector<float> outX(POINT_COUNT), outY(POINT_COUNT), outZ(POINT_COUNT);
+	std::vector<float> referenceX(POINT_COUNT), referenceY(POINT_COUNT), referenceZ(POINT_COUNT);
+	Mat4 model = randomTRS();
+
+	std::vector<Mat4> a(MATRIX_COUNT), b(MATRIX_COUNT), product(MATRIX_COUNT), reference(MATRIX_COUNT);
+	for (unsigned int i = 0; i < MATRIX_COUNT; i++)
+	{
+		a[i] = randomTRS();
+		b[i] = randomTRS();
+	}
+
+	/* an odd count so the scalar tail runs too */
+	unsigned int points = POINT_COUNT - 3;
+	BatchTransform::TransformPointsScalar(model, x.data(), y.data(), z.data(), referenceX.data(), referenceY.data(), referenceZ.data(), points);
+	BatchTransform::TransformPoints(model, x.data(), y.data(), z.data(), outX.data(), outY.data(), outZ.data(), points);
+	float pointError = 0.0f;
+	for (unsigned int i = 0; i < points; i++)
+	{
+		pointError = fmaxf(pointError, fabsf(outX[i] - referenceX[i]));
+		pointError = fmaxf(pointError, fabsf(outY[i] - referenceY[i]));
+		pointError = fmaxf(pointError, fabsf(outZ[i] - referenceZ[i]));
+	}
+	Check("TransformPoints vs scalar", pointError, 1e-3f);
+
+	BatchTransform::MultiplyScalar(a.data(), b.data(), reference.data(), MATRIX_COUNT);
+	BatchTransform::Multiply(a.data(), b.data(), product.data(), MATRIX_COUNT);
+	float matrixError = 0.0f;
+	for (unsigned int i = 0; i < MATRIX_COUNT; i++)
+		matrixError = fmaxf(matrixError, MaxDifference(product[i], reference[i]));
+	Check("Multiply vs scalar", matrixError, 1e-3f);
+
+	std::cout << "timings (best of " << REPEATS << "):" << std::endl;
+	double scalar = Measure([&]() { BatchTransform::TransformPointsScalar(model, x.data(), y.data(), z.data(), outX.data(), outY.data(), outZ.data(), POINT_COUNT); });
+	double simd = Measure([&]() { BatchTransform::TransformPoints(model, x.data(), y.data(), z.data(), outX.data(), outY.data(), outZ.data(), POINT_COUNT); });
+	std::cout << "  transform " << POINT_COUNT << " points: scalar " << scalar << " ms, SIMD " << simd << " ms, " << scalar / simd << "x" << std::endl;
+
+	scalar = Measure([&]() { BatchTransform::MultiplyScalar(a.data(), b.data(), product.data(), MATRIX_COUNT); });
+	simd = Measure([&]() { BatchTransform::Multiply(a.data(), b.data(), product.data(), MATRIX_COUNT); });
+	std::cout << "  multiply " << MATRIX_COUNT << " pairs: scalar " << scalar << " ms, SIMD " << simd << " ms, " << scalar / simd << "x" << std::endl;
+
+	/* the big batches stream 192 MB and wait on memory, this one stays in cache */
+	scalar = Measure([&]() { for (int r = 0; r < 128; r++) BatchTransform::MultiplyScalar(a.data(), b.data(), product.data(), CACHED_COUNT); });
+	simd = Measure([&]() { for (int r = 0; r < 128; r++) BatchTransform::Multiply(a.data(), b.data(), product.data(), CACHED_COUNT); });
+	std::cout << "  multiply " << CACHED_COUNT << " pairs 128 times (in cache): scalar " << scalar << " ms, SIMD " << simd << " ms, " << scalar / simd << "x" << std::endl;
+
+	Mat4 viewProjection = Mat4::Perspective(1.0f, 4.0f / 3.0f, 0.1f, 200.0f) * Mat4::LookAt({ 0.0f, 2.0f, 5.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f });
+	std::vector<Mat4> parents(MATRIX_COUNT, viewProjection);
+	scalar = Measure([&]() { BatchTransform::MultiplyScalar(parents.data(), b.data(), product.data(), MATRIX_COUNT); });
+	simd = Measure([&]() { BatchTransform::Multiply(viewProjection, b.data(), product.data(), MATRIX_COUNT); });
+	std::cout << "  one times " << MATRIX_COUNT << ": scalar " << scalar << " ms, SIMD " << simd << " ms, " << scalar / simd << "x" << std::endl;
+
+	simd = Measure([&]()
+	{
+		for (unsigned int i = 0; i < MATRIX_COUNT; i++)
+			product[i] = a[i] * b[i];
+	});
+	std::cout << "  operator* " << MATRIX_COUNT << " times: " << simd << " ms" << std::endl;
+
+	/* keeps the compiler from dropping the work */
+	float sum = 0.0f;
+	for (unsigned int i = 0; i < MATRIX_COUNT; i += 4096)
+		sum += product[i].Data()[0] + outX[i];
+	std::cout << "checksum " << sum << std::endl;
+	return 0;
+}
@@ -0,0 +1,38 @@
+/* meshconvert: converts an OBJ or PLY file into a binary .mesh file
+	~ usage: meshconvert input.obj|input.ply output.mesh [threads]
+	~ vertices are written as position(3) [texcoord(2)] [normal(3)] [color(4)]
+	  floats, attributes the source doesn't have are left out of the layout */
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+
+#include "MeshFile.h"
+#include "MeshLoader.h"
+
+int main(int argc, char** argv)
+{
+	if (argc != 3 && argc != 4)
+	{
+		std::cout << "usage: meshconvert input.obj|input.ply output.mesh [threads]" << std::endl;
+		return -1;
+	}
+
+	unsigned int threadCount = argc == 4 ? (unsigned int)atoi(argv[3]) : 0;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	MeshData mesh;
+	if (!MeshLoader::Load(argv[1], mesh, threadCount))
+		return -1;
+	auto loaded = std::chrono::high_resolution_clock::now();
+
+	if (!MeshFile::Write(argv[2], mesh.vertices.data(), (unsigned int)(mesh.vertices.size() * sizeof(float)),
+		mesh.indices.data(), (unsigned int)mesh.indices.size(), mesh.layout))
+		return -1;
+
+	std::cout << argv[2] << ": " << mesh.vertices.size() * sizeof(float) / mesh.layout.GetStride() << " vertices, "
+		<< mesh.indices.size() / 3 << " triangles (loaded in "
+		<< std::chrono::duration<double, std::milli>(loaded - start).count() << " ms)" << std::endl;
+	return 0;
+}
@@ -0,0 +1,175 @@
+/* multi-draw indirect benchmark
+	~ MESH_COUNT different meshes (stars with 3 to 34 points) live in one
+	  GeometryPool, every frame draws all of them once:
+		1. one glDrawElementsBaseVertex per mesh, the per draw values set
+		   with glVertexAttrib4fv right before each draw
+		2. MultiDrawBatch: one glMultiDrawElementsIndirect for everything
+	~ prints the CPU time spent submitting, the frame time up to glFinish
+	  and the GL calls per frame, and checks both paths draw the same image */
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+
+#include "renderer.h"
+#include "shader.h"
+#include "GeometryPool.h"
+#include "MultiDrawBatch.h"
+
+#define MESH_COUNT 4096
+#define FRAMES 30
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Milliseconds(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct DrawData
+{
+	float transform[4];	/* offset x, offset y, scale, unused */
+	float color[4];
+};
+
+int main(void)
+{
+	GLFWwindow* window;
+
+	/* Initialize the library */
+	if (!glfwInit())
+		return -1;
+
+	/* glMultiDrawElementsIndirect is GL 4.3 */
+	window = glfwCreateWindow(640, 480, "Multi-draw indirect benchmark", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+
+	if (glewInit() != GLEW_OK)
+		std::cout << "Error!" << std::endl;
+
+	std::cout << glGetString(GL_VERSION) << std::endl;
+
+	{
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		GeometryPool pool(layout, MESH_COUNT * 70, MESH_COUNT * 34 * 6);
+
+		/* every mesh different: star with its own point count and inner radius */
+		std::mt19937 random(11);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		std::vector<MeshRange> meshes(MESH_COUNT);
+		std::vector<unsigned int> handles(MESH_COUNT);
+		std::vector<float> vertices;
+		std::vector<unsigned int> indices;
+		for (unsigned int m = 0; m < MESH_COUNT; m++)
+		{
+			unsigned int points = 3 + m % 32;
+			float inner = 0.3f + 0.5f * unit(random);
+			vertices.assign({ 0.0f, 0.0f });
+			indices.clear();
+			for (unsigned int p = 0; p < points * 2; p++)
+			{
+				float angle = 3.14159265f * p / points;
+				float radius = p % 2 ? inner : 1.0f;
+				vertices.push_back(cosf(angle) * radius);
+				vertices.push_back(sinf(angle) * radius);
+				unsigned int next = (p + 1) % (points * 2);
+				indices.insert(indices.end(), { 0, p + 1, next + 1 });
+			}
+			handles[m] = pool.Add(vertices.data(), (unsigned int)vertices.size() / 2, indices.data(), (unsigned int)indices.size());
+		}
+		for (unsigned int m = 0; m < MESH_COUNT; m++)
+			meshes[m] = pool.GetRange(handles[m]);
+
+		std::vector<DrawData> draws(MESH_COUNT);
+		for (DrawData& draw : draws)
+		{
+			draw.transform[0] = unit(random) * 2.0f - 1.0f;
+			draw.transform[1] = unit(random) * 2.0f - 1.0f;
+			draw.transform[2] = 0.01f + 0.03f * unit(random);
+			draw.transform[3] = 0.0f;
+			draw.color[0] = unit(random);
+			draw.color[1] = unit(random);
+			draw.color[2] = unit(random);
+			draw.color[3] = 1.0f;
+		}
+
+		VertexBufferLayout instanceLayout;
+		instanceLayout.Push<float>(4);
+		instanceLayout.Push<float>(4);
+		MultiDrawBatch batch(pool, instanceLayout, MESH_COUNT);
+
+		Shader shader("res/shading/multidraw.shader");
+		std::vector<unsigned char> pixels[2];
+
+		for (int path = 0; path < 2; path++)
+		{
+			double submitMs = 0.0, frameMs = 0.0;
+			unsigned int calls = 0;
+			for (int frame = 0; frame < FRAMES; frame++)
+			{
+				Clock::time_point start = Clock::now();
+				GLCall(glClear(GL_COLOR_BUFFER_BIT));
+				if (path == 0)
+				{
+					/* with the instanced arrays switched off, the attributes read the
+					   current glVertexAttrib value instead */
+					shader.Bind();
+					pool.Bind();
+					GLCall(glDisableVertexAttribArray(1));
+					GLCall(glDisableVertexAttribArray(2));
+					for (unsigned int m = 0; m < MESH_COUNT; m++)
+					{
+						GLCall(glVertexAttrib4fv(1, draws[m].transform));
+						GLCall(glVertexAttrib4fv(2, draws[m].color));
+						GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, meshes[m].indexCount, GL_UNSIGNED_INT,
+							(const void*)(meshes[m].firstIndex * sizeof(unsigned int)), meshes[m].baseVertex));
+					}
+					GLCall(glEnableVertexAttribArray(1));
+					GLCall(glEnableVertexAttribArray(2));
+					calls = 3 * MESH_COUNT + 6;
+				}
+				else
+				{
+					for (unsigned int m = 0; m < MESH_COUNT; m++)
+						batch.Add(meshes[m], &draws[m]);
+					batch.Flush(shader);
+					/* clear, two uploads (and orphans), three binds, one draw */
+					calls = 8;
+				}
+				submitMs += Milliseconds(start);
+				GLCall(glFinish());
+				frameMs += Milliseconds(start);
+
+				if (frame == FRAMES - 1)
+				{
+					pixels[path].resize(640 * 480 * 4);
+					GLCall(glReadPixels(0, 0, 640, 480, GL_RGBA, GL_UNSIGNED_BYTE, pixels[path].data()));
+				}
+				glfwSwapBuffers(window);
+				glfwPollEvents();
+			}
+
+			std::cout << (path == 0 ? "glDrawElementsBaseVertex per mesh" : "glMultiDrawElementsIndirect") << ": "
+				<< MESH_COUNT << " meshes, ~" << calls << " GL calls, submit " << submitMs / FRAMES << " ms, frame "
+				<< frameMs / FRAMES << " ms" << std::endl;
+		}
+
+		std::cout << (pixels[0] == pixels[1] ? "both paths drew the same image" : "IMAGES DIFFER!") << std::endl;
+	}
+
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,235 @@
+/* occlusion culling benchmark on a synthetic city
+	~ a grid of box buildings with props scattered between (and behind)
+	  them, the camera walks the streets at eye height
+	~ per frame: frustum cull the props, rasterize the nearest buildings
+	  as occluders, build the depth pyramid and test the survivors
+	~ prints how many draws each stage removes and what it costs
+	~ every occluded prop is double checked with rays against the real
+	  buildings, none of its sample points may be visible
+	~ CPU only, no window needed */
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+#include "Culling.h"
+#include "Bvh.h"
+#include "OcclusionCuller.h"
+
+#define BLOCKS 32
+#define BLOCK_SIZE 40.0f
+#define BUILDING_SIZE 30.0f
+#define PROP_COUNT 200000
+#define OCCLUDER_COUNT 64
+#define FRAMES 16
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Milliseconds(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/* column major out = a * b */
+static void Multiply(const float* a, const float* b, float* out)
+{
+	for (int column = 0; column < 4; column++)
+		for (int row = 0; row < 4; row++)
+		{
+			float sum = 0.0f;
+			for (int k = 0; k < 4; k++)
+				sum += a[k * 4 + row] * b[column * 4 + k];
+			out[column * 4 + row] = sum;
+		}
+}
+
+static void Perspective(float fovY, float aspect, float zNear, float zFar, float* out)
+{
+	float f = 1.0f / tanf(fovY * 0.5f);
+	for (int i = 0; i < 16; i++)
+		out[i] = 0.0f;
+	out[0] = f / aspect;
+	out[5] = f;
+	out[10] = (zFar + zNear) / (zNear - zFar);
+	out[11] = -1.0f;
+	out[14] = 2.0f * zFar * zNear / (zNear - zFar);
+}
+
+/* camera at eye looking along the horizontal direction (dx, 0, dz), y up */
+static void LookAlong(const float eye[3], float dx, float dz, float* out)
+{
+	float f[3] = { dx, 0.0f, dz };
+	float s[3] = { -f[2], 0.0f, f[0] };
+	float u[3] = { 0.0f, 1.0f, 0.0f };
+	float view[16] = {
+		s[0], u[0], -f[0], 0.0f,
+		s[1], u[1], -f[1], 0.0f,
+		s[2], u[2], -f[2], 0.0f,
+		-(s[0] * eye[0] + s[1] * eye[1] + s[2] * eye[2]),
+		-(u[0] * eye[0] + u[1] * eye[1] + u[2] * eye[2]),
+		(f[0] * eye[0] + f[1] * eye[1] + f[2] * eye[2]), 1.0f
+	};
+	for (int i = 0; i < 16; i++)
+		out[i] = view[i];
+}
+
+static Aabb ToBox(const BoundsStore& bounds, unsigned int i)
+{
+	Aabb box;
+	box.min[0] = bounds.GetCenterX()[i] - bounds.GetExtentX()[i];
+	box.min[1] = bounds.GetCenterY()[i] - bounds.GetExtentY()[i];
+	box.min[2] = bounds.GetCenterZ()[i] - bounds.GetExtentZ()[i];
+	box.max[0] = bounds.GetCenterX()[i] + bounds.GetExtentX()[i];
+	box.max[1] = bounds.GetCenterY()[i] + bounds.GetExtentY()[i];
+	box.max[2] = bounds.GetCenterZ()[i] + bounds.GetExtentZ()[i];
+	return box;
+}
+
+static bool InsideFrustum(const Frustum& frustum, const float* p)
+{
+	for (unsigned int i = 0; i < 6; i++)
+	{
+		const Plane& plane = frustum.GetPlane(i);
+		if (plane.a * p[0] + plane.b * p[1] + plane.c * p[2] + plane.d < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+int main(void)
+{
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> height(20.0f, 90.0f);
+	std::uniform_real_distribution<float> ground(0.0f, BLOCKS * BLOCK_SIZE);
+	std::uniform_real_distribution<float> propSize(0.3f, 1.5f);
+	std::uniform_real_distribution<float> propHeight(0.0f, 4.0f);
+
+	/* buildings fill [i * BLOCK_SIZE, i * BLOCK_SIZE + BUILDING_SIZE], streets are the gaps */
+	BoundsStore buildings;
+	std::vector<Aabb> buildingBoxes;
+	for (int i = 0; i < BLOCKS; i++)
+		for (int j = 0; j < BLOCKS; j++)
+		{
+			float h = height(random);
+			float center[3] = { i * BLOCK_SIZE + BUILDING_SIZE * 0.5f, h * 0.5f, j * BLOCK_SIZE + BUILDING_SIZE * 0.5f };
+			float extents[3] = { BUILDING_SIZE * 0.5f, h * 0.5f, BUILDING_SIZE * 0.5f };
+			buildings.AddBox(center, extents);
+			buildingBoxes.push_back(ToBox(buildings, buildings.GetCount() - 1));
+		}
+	Bvh buildingBvh;
+	buildingBvh.Build(buildingBoxes.data(), (unsigned int)buildingBoxes.size());
+
+	BoundsStore props;
+	for (int i = 0; i < PROP_COUNT; i++)
+	{
+		float s = propSize(random);
+		float center[3] = { ground(random), propHeight(random) + s, ground(random) };
+		float extents[3] = { s, s, s };
+		props.AddBox(center, extents);
+	}
+
+	float projection[16];
+	Perspective(70.0f * 3.14159265f / 180.0f, 16.0f / 9.0f, 0.5f, 1500.0f, projection);
+
+	OcclusionCuller occlusion(256, 128);
+	std::vector<unsigned int> frustumVisible, occlusionVisible, occluderCandidates;
+	unsigned long long totalFrustum = 0, totalVisible = 0;
+	double totalMs = 0.0, totalFrustumMs = 0.0;
+	unsigned int falseCulls = 0;
+
+	const float directions[4][2] = { { 0.0f, -1.0f }, { 1.0f, 0.0f }, { 0.0f, 1.0f }, { -1.0f, 0.0f } };
+	for (int frame = 0; frame < FRAMES; frame++)
+	{
+		/* middle of a street, somewhere in the middle of the city */
+		int street = 8 + frame % 16;
+		float eye[3] = { street * BLOCK_SIZE + BUILDING_SIZE + (BLOCK_SIZE - BUILDING_SIZE) * 0.5f, 1.8f,
+			(8 + (frame * 5) % 16) * BLOCK_SIZE + BUILDING_SIZE + (BLOCK_SIZE - BUILDING_SIZE) * 0.5f };
+		const float* direction = directions[frame % 4];
+		float view[16], viewProjection[16];
+		LookAlong(eye, direction[0], direction[1], view);
+		Multiply(projection, view, viewProjection);
+		Frustum frustum(viewProjection);
+
+		Clock::time_point start = Clock::now();
+		FrustumCuller::Cull(props, frustum, frustumVisible);
+		double frustumMs = Milliseconds(start);
+
+		/* occluders: the closest buildings in view */
+		start = Clock::now();
+		FrustumCuller::Cull(buildings, frustum, occluderCandidates);
+		std::sort(occluderCandidates.begin(), occluderCandidates.end(), [&](unsigned int a, unsigned int b)
+		{
+			float da = 0.0f, db = 0.0f;
+			float ca[3] = { buildings.GetCenterX()[a] - eye[0], 0.0f, buildings.GetCenterZ()[a] - eye[2] };
+			float cb[3] = { buildings.GetCenterX()[b] - eye[0], 0.0f, buildings.GetCenterZ()[b] - eye[2] };
+			da = ca[0] * ca[0] + ca[2] * ca[2];
+			db = cb[0] * cb[0] + cb[2] * cb[2];
+			return da < db;
+		});
+		if (occluderCandidates.size() > OCCLUDER_COUNT)
+			occluderCandidates.resize(OCCLUDER_COUNT);
+
+		occlusion.BeginFrame(viewProjection);
+		for (unsigned int index : occluderCandidates)
+			occlusion.AddOccluder(buildingBoxes[index]);
+		occlusion.BuildPyramid();
+		occlusion.Cull(props, frustumVisible.data(), (unsigned int)frustumVisible.size(), occlusionVisible);
+		double frameMs = Milliseconds(start);
+
+		const OcclusionStats& stats = occlusion.GetStats();
+		std::cout << "frame " << frame << ": " << frustumVisible.size() << " after frustum, " << occlusionVisible.size()
+			<< " after occlusion (" << stats.occludedObjects << " culled), " << frameMs << " ms (raster "
+			<< stats.rasterizeMs << ", pyramid " << stats.pyramidMs << ", test " << stats.testMs << ", "
+			<< stats.occluderTriangles << " triangles)" << std::endl;
+
+		totalFrustum += frustumVisible.size();
+		totalVisible += occlusionVisible.size();
+		totalMs += frameMs;
+		totalFrustumMs += frustumMs;
+
+		/* every culled prop must be hidden at all of its sample points */
+		std::vector<bool> kept(PROP_COUNT, false);
+		for (unsigned int index : occlusionVisible)
+			kept[index] = true;
+		for (unsigned int index : frustumVisible)
+		{
+			if (kept[index])
+				continue;
+			Aabb box = ToBox(props, index);
+			for (int sample = 0; sample < 9; sample++)
+			{
+				float point[3];
+				for (int axis = 0; axis < 3; axis++)
+				{
+					float center = (box.min[axis] + box.max[axis]) * 0.5f;
+					float corner = (sample & (1 << axis)) ? box.max[axis] : box.min[axis];
+					point[axis] = sample == 8 ? center : center + (corner - center) * 0.99f;
+				}
+				if (!InsideFrustum(frustum, point))
+					continue;
+				Ray ray = { { eye[0], eye[1], eye[2] }, { point[0] - eye[0], point[1] - eye[1], point[2] - eye[2] } };
+				BvhHit hit;
+				if (!buildingBvh.Raycast(ray, hit, 1.0f))
+				{
+					falseCulls++;
+					break;
+				}
+			}
+		}
+	}
+
+	std::cout << "average: " << totalFrustum / FRAMES << " draws after frustum culling, " << totalVisible / FRAMES
+		<< " after occlusion culling (" << 100.0 * (1.0 - (double)totalVisible / totalFrustum) << "% fewer), "
+		<< totalMs / FRAMES << " ms occlusion + " << totalFrustumMs / FRAMES << " ms frustum per frame" << std::endl;
+
+	if (falseCulls)
+	{
+		std::cout << falseCulls << " visible props were culled!" << std::endl;
+		return 1;
+	}
+	std::cout << "no visible prop was culled" << std::endl;
+	return 0;
+}
@@ -0,0 +1,199 @@
+/* particle system benchmark
+	~ 1M particles in a fountain
+		1. simulate: scalar loop, SIMD kernel, SIMD kernel on a JobSystem
+		   of 1 to N threads (N = hardware threads, at least 4), and a
+		   check that the SIMD result matches the scalar one
+		2. write instance data: into a std::vector then glBufferSubData,
+		   or straight into the mapped VertexBuffer (serial and with jobs)
+		3. frames: map, Update (simulate + write in one pass) on the
+		   workers, unmap, one glDrawElementsInstanced
+	~ prints particles per millisecond for every step */
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+
+#include "renderer.h"
+#include "vertexbuffer.h"
+#include "VertexArray.h"
+#include "indexbuffer.h"
+#include "shader.h"
+#include "JobSystem.h"
+#include "VectorMath.h"
+#include "ParticleSystem.h"
+
+#define PARTICLE_COUNT (1024 * 1024)
+#define STEPS 20
+#define FRAMES 10
+#define DT (1.0f / 60.0f)
+
+static double Now()
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void Report(const char* name, double milliseconds, unsigned int runs)
+{
+	std::cout << "  " << name << ": " << milliseconds / runs << " ms, "
+		<< (unsigned long long)((double)PARTICLE_COUNT * runs / milliseconds) << " particles/ms" << std::endl;
+}
+
+int main(void)
+{
+	GLFWwindow* window;
+
+	/* Initialize the library */
+	if (!glfwInit())
+		return -1;
+
+	window = glfwCreateWindow(640, 480, "Particle benchmark", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+
+	if (glewInit() != GLEW_OK)
+		std::cout << "Error!" << std::endl;
+
+	{
+		unsigned int hardware = std::thread::hardware_concurrency();
+		unsigned int maxThreads = std::max(hardware, 4u);
+		std::cout << hardware << " hardware threads, " << PARTICLE_COUNT << " particles" << std::endl;
+
+		std::cout << "simulate:" << std::endl;
+		{
+			ParticleSystem scalar(PARTICLE_COUNT), simd(PARTICLE_COUNT);
+			double start = Now();
+			for (int i = 0; i < STEPS; i++)
+				scalar.SimulateScalar(DT);
+			Report("scalar", Now() - start, STEPS);
+
+			start = Now();
+			for (int i = 0; i < STEPS; i++)
+				simd.Simulate(DT);
+			Report("SIMD", Now() - start, STEPS);
+
+			float error = 0.0f;
+			for (unsigned int i = 0; i < PARTICLE_COUNT; i++)
+			{
+				error = fmaxf(error, fabsf(scalar.GetPositionX()[i] - simd.GetPositionX()[i]));
+				error = fmaxf(error, fabsf(scalar.GetPositionY()[i] - simd.GetPositionY()[i]));
+				error = fmaxf(error, fabsf(scalar.GetLife()[i] - simd.GetLife()[i]));
+			}
+			std::cout << "  largest difference SIMD vs scalar after " << STEPS << " steps: " << error << std::endl;
+
+			for (unsigned int threads = 1; threads <= maxThreads; threads++)
+			{
+				JobSystem jobs(threads);
+				start = Now();
+				for (int i = 0; i < STEPS; i++)
+					simd.Simulate(DT, &jobs);
+				std::string name = "SIMD, " + std::to_string(threads) + " threads";
+				Report(name.c_str(), Now() - start, STEPS);
+			}
+		}
+
+		float corners[] = {
+			-1.0f, -1.0f,
+			 1.0f, -1.0f,
+			 1.0f,  1.0f,
+			-1.0f,  1.0f,
+		};
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+		VertexBuffer vb(corners, sizeof(corners));
+		VertexBufferLayout layout;
+		layout.Push<float>(2, "corner");
+		VertexArray va;
+		va.addBuffer(vb, layout);
+		IndexBuffer ib(indices, 6);
+
+		/* positions for every particle, then colors, in one buffer */
+		unsigned int positionsSize = PARTICLE_COUNT * 4 * sizeof(float);
+		unsigned int bufferSize = positionsSize + PARTICLE_COUNT * sizeof(unsigned int);
+		VertexBuffer instances(nullptr, bufferSize);
+		VertexBufferLayout positionLayout, colorLayout;
+		positionLayout.Push<float>(4);
+		colorLayout.Push<unsigned char>(4);
+		va.addInstanceBuffer(instances, positionLayout, 1, 0);
+		va.addInstanceBuffer(instances, colorLayout, 2, positionsSize);
+
+		ParticleSystem particles(PARTICLE_COUNT);
+		std::cout << "write instance data:" << std::endl;
+		{
+			std::vector<unsigned char> staging(bufferSize);
+			ParticleInstances out = { (float*)staging.data(), (unsigned int*)(staging.data() + positionsSize) };
+			double start = Now();
+			for (int i = 0; i < STEPS; i++)
+			{
+				particles.Write(out);
+				instances.SetSubData(staging.data(), 0, bufferSize);
+				GLCall(glFinish());
+			}
+			Report("std::vector + glBufferSubData", Now() - start, STEPS);
+
+			for (unsigned int threads = 0; threads <= maxThreads; threads += threads ? maxThreads - 1 : 1)
+			{
+				std::unique_ptr<JobSystem> jobs = threads ? std::make_unique<JobSystem>(threads) : nullptr;
+				start = Now();
+				for (int i = 0; i < STEPS; i++)
+				{
+					unsigned char* mapped = (unsigned char*)instances.Map(0, bufferSize, true);
+					if (!mapped)
+						break;
+					particles.Write({ (float*)mapped, (unsigned int*)(mapped + positionsSize) }, jobs.get());
+					instances.Unmap();
+					GLCall(glFinish());
+				}
+				std::string name = "mapped VertexBuffer, " + (threads ? std::to_string(threads) + " threads" : std::string("serial"));
+				Report(name.c_str(), Now() - start, STEPS);
+			}
+		}
+
+		Shader shader("res/shading/particle.shader");
+		shader.Bind();
+		Mat4 viewProjection = Mat4::Perspective(1.0f, 4.0f / 3.0f, 0.1f, 100.0f) * Mat4::LookAt({ 0.0f, 3.0f, 10.0f }, { 0.0f, 1.5f, 0.0f }, { 0.0f, 1.0f, 0.0f });
+		shader.SetUniformMat4f("u_ViewProjection", viewProjection.Data());
+		GLCall(glEnable(GL_BLEND));
+		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE));
+		Renderer renderer;
+
+		std::cout << "frames (map, simulate + write on the workers, unmap, draw):" << std::endl;
+		JobSystem jobs(maxThreads);
+		double update = 0.0, draw = 0.0;
+		for (int frame = 0; frame < FRAMES; frame++)
+		{
+			double start = Now();
+			unsigned char* mapped = (unsigned char*)instances.Map(0, bufferSize, true);
+			if (mapped)
+			{
+				particles.Update(DT, { (float*)mapped, (unsigned int*)(mapped + positionsSize) }, &jobs);
+				instances.Unmap();
+			}
+			double updated = Now();
+			update += updated - start;
+
+			renderer.Clear();
+			renderer.DrawInstanced(va, ib, shader, PARTICLE_COUNT);
+			GLCall(glFinish());
+			draw += Now() - updated;
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		}
+		Report("update", update, FRAMES);
+		std::cout << "  draw: " << draw / FRAMES << " ms" << std::endl;
+	}
+
+	glfwTerminate();
+	return 0;
+}
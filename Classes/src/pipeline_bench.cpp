@@ -0,0 +1,210 @@
+/* pipeline state benchmark
+	~ DRAW_COUNT draws spread over a handful of pipelines (opaque, alpha
+	  blended, additive, wireframe, shadow with depth bias, UI without depth)
+		1. ad hoc: every draw sets its whole state with raw GL calls
+		2. PipelineStateTracker: only the fields that differ are set
+		3. queued: Submit/Flush sorts by pipeline first, so most draws
+		   don't change anything
+	~ prints GL state calls per frame and frame time */
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+
+#include "renderer.h"
+#include "VertexArray.h"
+#include "indexbuffer.h"
+#include "shader.h"
+#include "PipelineState.h"
+
+#define DRAW_COUNT 10000
+#define FRAMES 30
+
+/* what a draw did before pipeline objects: set everything it relies on */
+static unsigned int ApplyAdHoc(const PipelineStateDesc& desc)
+{
+	desc.shader->Bind();
+	if (desc.blend.enabled)
+	{
+		GLCall(glEnable(GL_BLEND));
+		GLCall(glBlendFuncSeparate(desc.blend.srcColor, desc.blend.dstColor, desc.blend.srcAlpha, desc.blend.dstAlpha));
+		GLCall(glBlendEquationSeparate(desc.blend.colorOp, desc.blend.alphaOp));
+	}
+	else
+	{
+		GLCall(glDisable(GL_BLEND));
+	}
+	if (desc.depth.test)
+	{
+		GLCall(glEnable(GL_DEPTH_TEST));
+		GLCall(glDepthFunc(desc.depth.func));
+	}
+	else
+	{
+		GLCall(glDisable(GL_DEPTH_TEST));
+	}
+	GLCall(glDepthMask(desc.depth.write));
+	if (desc.raster.cull)
+	{
+		GLCall(glEnable(GL_CULL_FACE));
+		GLCall(glCullFace(desc.raster.cullFace));
+	}
+	else
+	{
+		GLCall(glDisable(GL_CULL_FACE));
+	}
+	GLCall(glPolygonMode(GL_FRONT_AND_BACK, desc.raster.polygonMode));
+	if (desc.raster.depthBiasFactor != 0.0f || desc.raster.depthBiasUnits != 0.0f)
+	{
+		GLCall(glEnable(GL_POLYGON_OFFSET_FILL));
+		GLCall(glPolygonOffset(desc.raster.depthBiasFactor, desc.raster.depthBiasUnits));
+	}
+	else
+	{
+		GLCall(glDisable(GL_POLYGON_OFFSET_FILL));
+	}
+	return 7 + (desc.blend.enabled ? 2 : 0) + (desc.depth.test ? 1 : 0) + (desc.raster.cull ? 1 : 0) +
+		(desc.raster.depthBiasFactor != 0.0f || desc.raster.depthBiasUnits != 0.0f ? 1 : 0);
+}
+
+int main(void)
+{
+	GLFWwindow* window;
+
+	/* Initialize the library */
+	if (!glfwInit())
+		return -1;
+
+	window = glfwCreateWindow(640, 480, "Pipeline state benchmark", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+
+	if (glewInit() != GLEW_OK)
+		std::cout << "Error!" << std::endl;
+
+	{
+		float positions[] = {
+			-0.01f, -0.01f,
+			 0.01f, -0.01f,
+			 0.01f,  0.01f,
+			-0.01f,  0.01f,
+		};
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+		VertexArray va;
+		VertexBuffer vb(positions, 4 * 2 * sizeof(float));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		va.addBuffer(vb, layout);
+		IndexBuffer ib(indices, 6);
+
+		Shader shader("res/shading/basic.shader");
+		shader.Bind();
+		shader.SetUniform4f("u_Color", 0.2f, 0.3f, 0.8f, 0.5f);
+
+		PipelineCache cache;
+		PipelineStateDesc opaque;
+		opaque.shader = &shader;
+		opaque.layout = &layout;
+		opaque.depth.test = true;
+		opaque.raster.cull = true;
+
+		PipelineStateDesc blended = opaque;
+		blended.blend.enabled = true;
+		blended.blend.srcColor = blended.blend.srcAlpha = GL_SRC_ALPHA;
+		blended.blend.dstColor = blended.blend.dstAlpha = GL_ONE_MINUS_SRC_ALPHA;
+		blended.depth.write = false;
+
+		PipelineStateDesc additive = blended;
+		additive.blend.srcColor = additive.blend.dstColor = GL_ONE;
+
+		PipelineStateDesc wireframe = opaque;
+		wireframe.raster.polygonMode = GL_LINE;
+
+		PipelineStateDesc shadow = opaque;
+		shadow.raster.cullFace = GL_FRONT;
+		shadow.raster.depthBiasFactor = 1.1f;
+		shadow.raster.depthBiasUnits = 4.0f;
+
+		PipelineStateDesc ui = blended;
+		ui.depth.test = false;
+		ui.raster.cull = false;
+
+		const PipelineState* pipelines[] = {
+			cache.Get(opaque), cache.Get(blended), cache.Get(additive),
+			cache.Get(wireframe), cache.Get(shadow), cache.Get(ui)
+		};
+		/* the same description again is the same object */
+		PipelineStateDesc again = opaque;
+		std::cout << cache.GetCount() << " pipelines, cached lookup " << (cache.Get(again) == pipelines[0] ? "hits" : "misses") << std::endl;
+
+		/* a scene mostly opaque, draws in no particular order */
+		std::mt19937 random(5);
+		std::vector<const PipelineState*> draws(DRAW_COUNT);
+		for (const PipelineState*& draw : draws)
+		{
+			unsigned int roll = random() % 100;
+			draw = pipelines[roll < 60 ? 0 : roll < 75 ? 1 : roll < 80 ? 2 : roll < 85 ? 3 : roll < 95 ? 4 : 5];
+		}
+
+		Renderer renderer;
+		const char* names[] = { "ad hoc", "diffed", "queued" };
+		for (int path = 0; path < 3; path++)
+		{
+			unsigned long long calls = 0, transitions = 0;
+			double milliseconds = 0.0;
+			for (int frame = 0; frame < FRAMES; frame++)
+			{
+				auto start = std::chrono::high_resolution_clock::now();
+				renderer.Clear();
+				renderer.InvalidatePipeline();
+				unsigned int callsBefore = renderer.GetPipelineTracker().GetStateCalls();
+				unsigned int transitionsBefore = renderer.GetPipelineTracker().GetTransitions();
+
+				for (const PipelineState* draw : draws)
+				{
+					if (path == 0)
+					{
+						calls += ApplyAdHoc(draw->GetDesc());
+						va.Bind();
+						ib.Bind();
+						GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+					}
+					else if (path == 1)
+						renderer.Draw(va, ib, *draw);
+					else
+						renderer.Submit(va, ib, *draw);
+				}
+				if (path == 2)
+					renderer.Flush();
+				GLCall(glFinish());
+				milliseconds += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+				if (path > 0)
+				{
+					calls += renderer.GetPipelineTracker().GetStateCalls() - callsBefore;
+					transitions += renderer.GetPipelineTracker().GetTransitions() - transitionsBefore;
+				}
+				glfwSwapBuffers(window);
+				glfwPollEvents();
+			}
+
+			std::cout << names[path] << ": " << calls / FRAMES << " GL state calls per frame";
+			if (path > 0)
+				std::cout << " in " << transitions / FRAMES << " transitions";
+			std::cout << ", " << milliseconds / FRAMES << " ms per frame" << std::endl;
+		}
+	}
+
+	glfwTerminate();
+	return 0;
+}
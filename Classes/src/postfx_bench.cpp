@@ -0,0 +1,185 @@
+/* render target pool benchmark
+	~ a post processing frame: the scene goes into a 4x MSAA HDR target with
+	  depth, is resolved, blurred down a chain of half size targets (bloom)
+	  and back up, and the result is blitted to the window
+		1. every pass creates its own targets and framebuffer every frame
+		2. the passes Acquire/Release from a RenderTargetPool
+	~ the downsample and upsample chains use the same sizes, with the pool
+	  the upsample passes reuse the textures the downsample passes released */
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <memory>
+
+#include "renderer.h"
+#include "VertexArray.h"
+#include "indexbuffer.h"
+#include "shader.h"
+#include "FrameBuffer.h"
+#include "RenderTarget.h"
+#include "RenderTargetPool.h"
+
+#define WIDTH 1280
+#define HEIGHT 720
+#define BLOOM_LEVELS 5
+#define FRAMES 60
+
+int main(void)
+{
+	GLFWwindow* window;
+
+	/* Initialize the library */
+	if (!glfwInit())
+		return -1;
+
+	window = glfwCreateWindow(WIDTH, HEIGHT, "Render target pool benchmark", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+
+	if (glewInit() != GLEW_OK)
+		std::cout << "Error!" << std::endl;
+
+	{
+		float positions[] = {
+			-0.5f, -0.5f,
+			 0.5f, -0.5f,
+			 0.5f,  0.5f,
+			-0.5f,  0.5f,
+		};
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+		VertexArray va;
+		VertexBuffer vb(positions, 4 * 2 * sizeof(float));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		va.addBuffer(vb, layout);
+		IndexBuffer ib(indices, 6);
+
+		Shader shader("res/shading/basic.shader");
+		shader.Bind();
+		shader.SetUniform4f("u_Color", 0.2f, 0.3f, 0.8f, 1.0f);
+
+		Renderer renderer;
+		RenderTargetPool pool;
+
+		RenderTargetDesc sceneDesc = { WIDTH, HEIGHT, GL_RGBA16F, 4 };
+		RenderTargetDesc depthDesc = { WIDTH, HEIGHT, GL_DEPTH24_STENCIL8, 4 };
+		RenderTargetDesc resolvedDesc = { WIDTH, HEIGHT, GL_RGBA16F, 1 };
+
+		for (int path = 0; path < 2; path++)
+		{
+			double milliseconds = 0.0;
+			unsigned long long created = 0, memory = 0, requested = 0;
+			for (int frame = 0; frame < FRAMES; frame++)
+			{
+				auto start = std::chrono::high_resolution_clock::now();
+
+				/* per frame path: every target lives until the end of the frame */
+				std::vector<std::unique_ptr<RenderTarget>> frameTargets;
+				std::vector<std::unique_ptr<FrameBuffer>> frameBuffers;
+				auto acquire = [&](const RenderTargetDesc& desc) -> RenderTarget*
+				{
+					if (path == 1)
+						return pool.Acquire(desc);
+					frameTargets.push_back(std::make_unique<RenderTarget>(desc));
+					memory += frameTargets.back()->GetMemorySize();
+					created++;
+					return frameTargets.back().get();
+				};
+				auto release = [&](const RenderTarget* target)
+				{
+					if (path == 1)
+						pool.Release(target);
+				};
+				auto frameBuffer = [&](const RenderTarget* color, const RenderTarget* depth) -> FrameBuffer&
+				{
+					if (path == 1)
+						return pool.GetFrameBuffer(color, depth);
+					frameBuffers.push_back(std::make_unique<FrameBuffer>());
+					frameBuffers.back()->AttachColor(color);
+					if (depth)
+						frameBuffers.back()->AttachDepth(depth);
+					return *frameBuffers.back();
+				};
+
+				/* scene */
+				RenderTarget* scene = acquire(sceneDesc);
+				RenderTarget* depth = acquire(depthDesc);
+				FrameBuffer& sceneBuffer = frameBuffer(scene, depth);
+				sceneBuffer.Bind();
+				GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+				renderer.Draw(va, ib, shader);
+
+				/* resolve */
+				RenderTarget* resolved = acquire(resolvedDesc);
+				FrameBuffer& resolvedBuffer = frameBuffer(resolved, nullptr);
+				sceneBuffer.Blit(&resolvedBuffer, WIDTH, HEIGHT);
+				release(scene);
+				release(depth);
+
+				/* bloom down */
+				RenderTarget* chain[BLOOM_LEVELS + 1];
+				chain[0] = resolved;
+				for (int level = 1; level <= BLOOM_LEVELS; level++)
+				{
+					RenderTargetDesc desc = { (unsigned int)(WIDTH >> level), (unsigned int)(HEIGHT >> level), GL_RGBA16F, 1 };
+					chain[level] = acquire(desc);
+					FrameBuffer& source = frameBuffer(chain[level - 1], nullptr);
+					source.Blit(&frameBuffer(chain[level], nullptr), desc.width, desc.height);
+				}
+
+				/* bloom up, each level into a fresh target of the next size up */
+				RenderTarget* up = chain[BLOOM_LEVELS];
+				for (int level = BLOOM_LEVELS - 1; level >= 1; level--)
+				{
+					RenderTargetDesc desc = { (unsigned int)(WIDTH >> level), (unsigned int)(HEIGHT >> level), GL_RGBA16F, 1 };
+					release(chain[level]);
+					RenderTarget* target = acquire(desc);
+					frameBuffer(up, nullptr).Blit(&frameBuffer(target, nullptr), desc.width, desc.height);
+					release(up);
+					up = target;
+				}
+
+				/* composite to the window */
+				frameBuffer(up, nullptr).Blit(nullptr, WIDTH, HEIGHT);
+				release(up);
+				release(resolved);
+				FrameBuffer::BindDefault(WIDTH, HEIGHT);
+
+				glfwSwapBuffers(window);
+				glfwPollEvents();
+				if (path == 1)
+				{
+					const RenderTargetPoolStats& stats = pool.GetStats();
+					created += stats.created;
+					memory = stats.memory;
+					requested = stats.requestedMemory;
+					pool.EndFrame();
+				}
+				else
+					requested = memory / (frame + 1);
+
+				milliseconds += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			}
+
+			if (path == 0)
+				std::cout << "targets per frame: " << milliseconds / FRAMES << " ms per frame, " << (double)created / FRAMES
+					<< " targets created per frame, " << requested / (1024 * 1024) << " MB allocated per frame" << std::endl;
+			else
+				std::cout << "target pool: " << milliseconds / FRAMES << " ms per frame, " << created << " targets created in total, "
+					<< memory / (1024 * 1024) << " MB held for " << requested / (1024 * 1024) << " MB acquired per frame" << std::endl;
+		}
+	}
+
+	glfwTerminate();
+	return 0;
+}
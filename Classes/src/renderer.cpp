@@ -1,12 +1,19 @@
 #include "renderer.h"
 
 #include <iostream>
+#include <algorithm>
+
+#include "VertexArray.h"
+#include "indexbuffer.h"
+#include "shader.h"
+#include "CommandList.h"
+#include "JobSystem.h"
 
 void GLClearError()
 {
     /* while loop is equal to (glGetError() != GL_NO_ERROR
        or glGetError does not equal != GL_NO_ERROR */
-    while (!glGetError());
+    while (glGetError() != GL_NO_ERROR);
 }
 
 /* prints error messages to console
@@ -23,4 +30,169 @@ bool GLLogCall(const char* function, const char* file, int line)
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+Renderer::Renderer(FrameArena* arena)
+    : m_Arena(arena), m_Queue(FrameAllocator<DrawCommand>(arena)), m_SortScratch(FrameAllocator<DrawCommand>(arena)), m_LastFrameCount(0)
+{
+}
+
+DrawCommand DrawCommand::Make(const VertexArray& va, const IndexBuffer& ib, const Shader& shader)
+{
+    unsigned long long key = (unsigned long long)shader.GetRendererID() << 32 | va.GetRendererID();
+    return { key, &va, &ib, &shader, nullptr };
+}
+
+DrawCommand DrawCommand::Make(const VertexArray& va, const IndexBuffer& ib, const PipelineState& pipeline)
+{
+    /* top bit keeps pipeline draws apart from plain shader draws */
+    unsigned long long key = (1ull << 63) | (unsigned long long)pipeline.GetID() << 32 | va.GetRendererID();
+    return { key, &va, &ib, pipeline.GetDesc().shader, &pipeline };
+}
+
+void Renderer::Clear() const
+{
+    GLCall(glClear(GL_COLOR_BUFFER_BIT));
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const
+{
+    shader.Bind();
+    /* the tracker doesn't know this program is bound now */
+    m_Pipelines.Invalidate();
+    va.Bind();
+    ib.Bind();
+    GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const PipelineState& pipeline) const
+{
+    m_Pipelines.Apply(pipeline);
+    va.Bind();
+    ib.Bind();
+    GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+}
+
+void Renderer::DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const
+{
+    shader.Bind();
+    m_Pipelines.Invalidate();
+    va.Bind();
+    ib.Bind();
+    GLCall(glDrawElementsInstanced(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr, instanceCount));
+}
+
+void Renderer::Dispatch(const Shader& shader, unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ) const
+{
+    ASSERT(shader.IsCompute());
+    shader.Bind();
+    m_Pipelines.Invalidate();
+    GLCall(glDispatchCompute(groupsX, groupsY, groupsZ));
+}
+
+void Renderer::Barrier(unsigned int bits) const
+{
+    GLCall(glMemoryBarrier(bits));
+}
+
+void Renderer::SetPipelineState(const PipelineState& pipeline) const
+{
+    m_Pipelines.Apply(pipeline);
+}
+
+void Renderer::Submit(const VertexArray& va, const IndexBuffer& ib, const Shader& shader)
+{
+    /* last frame's draw count is a good guess for this one, one allocation
+       instead of the vector growing step by step */
+    if (m_Queue.empty())
+        m_Queue.reserve(m_LastFrameCount);
+
+    m_Queue.push_back(DrawCommand::Make(va, ib, shader));
+}
+
+void Renderer::Submit(const VertexArray& va, const IndexBuffer& ib, const PipelineState& pipeline)
+{
+    if (m_Queue.empty())
+        m_Queue.reserve(m_LastFrameCount);
+
+    m_Queue.push_back(DrawCommand::Make(va, ib, pipeline));
+}
+
+void Renderer::Submit(const CommandList* lists, unsigned int count, JobSystem* jobs)
+{
+    unsigned int start = (unsigned int)m_Queue.size();
+    unsigned int total = start;
+    for (unsigned int i = 0; i < count; i++)
+        total += lists[i].GetCount();
+    m_Queue.resize(total);
+
+    /* every list goes to its own range of the queue */
+    DrawCommand* queue = m_Queue.data();
+    auto copy = [&](unsigned int begin, unsigned int end)
+    {
+        unsigned int offset = start;
+        for (unsigned int i = 0; i < begin; i++)
+            offset += lists[i].GetCount();
+        for (unsigned int i = begin; i < end; i++)
+        {
+            std::copy(lists[i].GetCommands(), lists[i].GetCommands() + lists[i].GetCount(), queue + offset);
+            offset += lists[i].GetCount();
+        }
+    };
+
+    if (jobs && count > 1)
+        jobs->ParallelFor(count, 1, copy);
+    else
+        copy(0, count);
+}
+
+void Renderer::Flush(JobSystem* jobs)
+{
+    /* radix sort is stable, draws with the same key keep their submit order */
+    unsigned int count = (unsigned int)m_Queue.size();
+    m_SortScratch.resize(count);
+    const DrawCommand* sorted = CommandList::Sort(m_Queue.data(), m_SortScratch.data(), count, jobs);
+
+    const Shader* boundShader = nullptr;
+    const VertexArray* boundVertexArray = nullptr;
+    const IndexBuffer* boundIndexBuffer = nullptr;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const DrawCommand& command = sorted[i];
+        if (command.pipeline)
+        {
+            /* the tracker skips it when nothing changed */
+            m_Pipelines.Apply(*command.pipeline);
+            boundShader = command.shader;
+        }
+        else if (command.shader != boundShader)
+        {
+            command.shader->Bind();
+            boundShader = command.shader;
+            m_Pipelines.Invalidate();
+        }
+        if (command.va != boundVertexArray)
+        {
+            command.va->Bind();
+            boundVertexArray = command.va;
+            /* a new vertex array brings its own element buffer binding */
+            boundIndexBuffer = nullptr;
+        }
+        if (command.ib != boundIndexBuffer)
+        {
+            command.ib->Bind();
+            boundIndexBuffer = command.ib;
+        }
+        GLCall(glDrawElements(GL_TRIANGLES, command.ib->GetCount(), GL_UNSIGNED_INT, nullptr));
+    }
+
+    m_LastFrameCount = (unsigned int)m_Queue.size();
+    if (m_Arena)
+    {
+        /* the arena memory is only good until its Reset, drop it now */
+        FrameVector<DrawCommand>(FrameAllocator<DrawCommand>(m_Arena)).swap(m_Queue);
+        FrameVector<DrawCommand>(FrameAllocator<DrawCommand>(m_Arena)).swap(m_SortScratch);
+    }
+    else
+        m_Queue.clear();
+}
@@ -0,0 +1,201 @@
+/* render graph benchmark
+	~ shadow, scene, bloom and composite passes plus a debug overlay pass
+	  nothing reads, added out of order on purpose
+	~ prints the order the graph picked, the culled passes, per pass CPU
+	  and GPU time and how many textures the pool needed for all the
+	  transient targets
+	~ finally checks that a cycle between two passes is reported */
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <string>
+
+#include "renderer.h"
+#include "VertexArray.h"
+#include "indexbuffer.h"
+#include "shader.h"
+#include "FrameBuffer.h"
+#include "RenderTargetPool.h"
+#include "RenderGraph.h"
+
+#define WIDTH 1280
+#define HEIGHT 720
+#define BLOOM_LEVELS 4
+#define FRAMES 60
+
+int main(void)
+{
+	GLFWwindow* window;
+
+	/* Initialize the library */
+	if (!glfwInit())
+		return -1;
+
+	window = glfwCreateWindow(WIDTH, HEIGHT, "Render graph benchmark", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+
+	if (glewInit() != GLEW_OK)
+		std::cout << "Error!" << std::endl;
+
+	{
+		float positions[] = {
+			-0.5f, -0.5f,
+			 0.5f, -0.5f,
+			 0.5f,  0.5f,
+			-0.5f,  0.5f,
+		};
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+		VertexArray va;
+		VertexBuffer vb(positions, 4 * 2 * sizeof(float));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		va.addBuffer(vb, layout);
+		IndexBuffer ib(indices, 6);
+
+		Shader shader("res/shading/basic.shader");
+		shader.Bind();
+		shader.SetUniform4f("u_Color", 0.2f, 0.3f, 0.8f, 1.0f);
+
+		Renderer renderer;
+		RenderTargetPool pool;
+		RenderGraph graph(WIDTH, HEIGHT);
+
+		/* declared up front so the passes can be added in any order */
+		RenderGraphResource shadowMap = graph.CreateTexture("shadow map", { 2048, 2048, GL_DEPTH_COMPONENT32F, 1 });
+		RenderGraphResource sceneColor = graph.CreateTexture("scene color", { WIDTH, HEIGHT, GL_RGBA16F, 1 });
+		RenderGraphResource sceneDepth = graph.CreateTexture("scene depth", { WIDTH, HEIGHT, GL_DEPTH24_STENCIL8, 1 });
+		RenderGraphResource debugOverlay = graph.CreateTexture("debug overlay", { WIDTH, HEIGHT, GL_RGBA8, 1 });
+		RenderGraphResource bloom[BLOOM_LEVELS + 1], bloomUp[BLOOM_LEVELS + 1];
+		bloom[0] = sceneColor;
+		for (int level = 1; level <= BLOOM_LEVELS; level++)
+			bloom[level] = graph.CreateTexture("bloom down " + std::to_string(level), { (unsigned int)(WIDTH >> level), (unsigned int)(HEIGHT >> level), GL_RGBA16F, 1 });
+		for (int level = 0; level < BLOOM_LEVELS; level++)
+			bloomUp[level] = graph.CreateTexture("bloom up " + std::to_string(level), { (unsigned int)(WIDTH >> level), (unsigned int)(HEIGHT >> level), GL_RGBA16F, 1 });
+		bloomUp[BLOOM_LEVELS] = bloom[BLOOM_LEVELS];
+		RenderGraphResource backbuffer = graph.GetBackbuffer();
+
+		/* copies `source` into the pass's output */
+		auto blit = [](const RenderPassContext& context, RenderGraphResource source)
+		{
+			FrameBuffer* output = context.GetFrameBuffer();
+			context.GetFrameBuffer(source)->Blit(output,
+				output ? output->GetWidth() : WIDTH, output ? output->GetHeight() : HEIGHT);
+		};
+
+		graph.AddPass("composite", [&](RenderPassBuilder& builder)
+		{
+			builder.Read(bloomUp[0]);
+			builder.Write(backbuffer);
+		}, [&](const RenderPassContext& context)
+		{
+			blit(context, bloomUp[0]);
+		});
+
+		for (int level = 0; level < BLOOM_LEVELS; level++)
+		{
+			graph.AddPass("bloom up " + std::to_string(level), [&, level](RenderPassBuilder& builder)
+			{
+				builder.Read(bloomUp[level + 1]);
+				builder.Write(bloomUp[level]);
+			}, [&, level](const RenderPassContext& context)
+			{
+				blit(context, bloomUp[level + 1]);
+			});
+		}
+
+		graph.AddPass("debug overlay", [&](RenderPassBuilder& builder)
+		{
+			builder.Read(sceneDepth);
+			builder.Write(debugOverlay);
+		}, [&](const RenderPassContext& context)
+		{
+			context.BindOutput();
+			GLCall(glClear(GL_COLOR_BUFFER_BIT));
+		});
+
+		for (int level = 1; level <= BLOOM_LEVELS; level++)
+		{
+			graph.AddPass("bloom down " + std::to_string(level), [&, level](RenderPassBuilder& builder)
+			{
+				builder.Read(bloom[level - 1]);
+				builder.Write(bloom[level]);
+			}, [&, level](const RenderPassContext& context)
+			{
+				blit(context, bloom[level - 1]);
+			});
+		}
+
+		graph.AddPass("scene", [&](RenderPassBuilder& builder)
+		{
+			builder.Read(shadowMap);
+			builder.Write(sceneColor);
+			builder.Write(sceneDepth);
+		}, [&](const RenderPassContext& context)
+		{
+			context.BindOutput();
+			GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+			renderer.Draw(va, ib, shader);
+		});
+
+		graph.AddPass("shadow", [&](RenderPassBuilder& builder)
+		{
+			builder.Write(shadowMap);
+		}, [&](const RenderPassContext& context)
+		{
+			context.BindOutput();
+			GLCall(glClear(GL_DEPTH_BUFFER_BIT));
+			renderer.Draw(va, ib, shader);
+		});
+
+		if (!graph.Compile())
+			return -1;
+
+		std::cout << "execution order:";
+		for (unsigned int pass : graph.GetExecutionOrder())
+			std::cout << " " << graph.GetPassName(pass) << ",";
+		std::cout << std::endl << "culled:";
+		for (unsigned int pass = 0; pass < graph.GetPassCount(); pass++)
+			if (graph.IsCulled(pass))
+				std::cout << " " << graph.GetPassName(pass);
+		std::cout << std::endl;
+
+		unsigned long long requested = 0;
+		for (int frame = 0; frame < FRAMES; frame++)
+		{
+			graph.Execute(pool);
+			requested = pool.GetStats().requestedMemory;
+			pool.EndFrame();
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		}
+
+		for (const RenderPassTiming& timing : graph.GetTimings())
+			std::cout << "  " << timing.name << ": cpu " << timing.cpuMilliseconds << " ms, gpu " << timing.gpuMilliseconds << " ms" << std::endl;
+		const RenderTargetPoolStats& stats = pool.GetStats();
+		std::cout << stats.targets << " textures, " << stats.memory / (1024 * 1024) << " MB for "
+			<< requested / (1024 * 1024) << " MB of transient targets" << std::endl;
+
+		/* a cycle: each reads what the other writes */
+		RenderGraph cyclic(WIDTH, HEIGHT);
+		RenderGraphResource a = cyclic.CreateTexture("a", { 64, 64, GL_RGBA8, 1 });
+		RenderGraphResource b = cyclic.CreateTexture("b", { 64, 64, GL_RGBA8, 1 });
+		cyclic.AddPass("first", [&](RenderPassBuilder& builder) { builder.Read(a); builder.Write(b); builder.SetSideEffect(); },
+			[](const RenderPassContext&) {});
+		cyclic.AddPass("second", [&](RenderPassBuilder& builder) { builder.Read(b); builder.Write(a); },
+			[](const RenderPassContext&) {});
+		bool compiled = cyclic.Compile();
+		std::cout << "cycle detected: " << (compiled ? "no" : "yes") << std::endl;
+	}
+
+	glfwTerminate();
+	return 0;
+}
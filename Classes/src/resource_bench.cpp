@@ -0,0 +1,121 @@
+/* resource pool benchmark
+	~ BUFFER_COUNT vertex buffers, once as individually allocated objects
+	  (std::unique_ptr, the way Mesh/LodMesh hold them) and once in a
+	  ResourcePool, then walks all of them reading their IDs
+	~ churns the pool (destroy / create) and checks that every handle to a
+	  destroyed buffer is reported stale
+	~ counts how many buffers the pool frees per frame: none until the
+	  fence of the frame they were destroyed in has signalled */
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+
+#include "renderer.h"
+#include "vertexbuffer.h"
+#include "ResourcePool.h"
+#include "FrameSync.h"
+
+#define BUFFER_COUNT 20000
+#define WALKS 200
+#define CHURN 5000
+
+int main(void)
+{
+	GLFWwindow* window;
+
+	/* Initialize the library */
+	if (!glfwInit())
+		return -1;
+
+	window = glfwCreateWindow(640, 480, "Resource pool benchmark", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+
+	if (glewInit() != GLEW_OK)
+		std::cout << "Error!" << std::endl;
+
+	{
+		float positions[] = { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f };
+		FrameSync sync;
+
+		/* 1. individually allocated, shuffled like a long running heap would be */
+		std::vector<std::unique_ptr<VertexBuffer>> individual;
+		for (int i = 0; i < BUFFER_COUNT; i++)
+			individual.push_back(std::make_unique<VertexBuffer>(positions, (unsigned int)sizeof(positions)));
+		std::mt19937 random(3);
+		std::shuffle(individual.begin(), individual.end(), random);
+
+		/* 2. pooled */
+		ResourcePool<VertexBuffer> pool(sync);
+		std::vector<Handle<VertexBuffer>> handles;
+		for (int i = 0; i < BUFFER_COUNT; i++)
+			handles.push_back(pool.Create(positions, (unsigned int)sizeof(positions)));
+
+		unsigned long long sum = 0;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int walk = 0; walk < WALKS; walk++)
+			for (const std::unique_ptr<VertexBuffer>& buffer : individual)
+				sum += buffer->GetRendererID();
+		double individualTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		start = std::chrono::high_resolution_clock::now();
+		for (int walk = 0; walk < WALKS; walk++)
+			for (const VertexBuffer& buffer : pool)
+				sum += buffer.GetRendererID();
+		double poolTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		std::cout << "walk over " << BUFFER_COUNT << " buffers: individual " << individualTime / WALKS << " ms, pool "
+			<< poolTime / WALKS << " ms (" << sum % 7 << ")" << std::endl;
+		individual.clear();
+
+		/* churn: destroy random buffers and create new ones, old handles must go stale */
+		std::vector<Handle<VertexBuffer>> destroyed;
+		for (int i = 0; i < CHURN; i++)
+		{
+			unsigned int index = random() % handles.size();
+			pool.Destroy(handles[index]);
+			destroyed.push_back(handles[index]);
+			handles[index] = pool.Create(positions, (unsigned int)sizeof(positions));
+		}
+		unsigned int stale = 0, alive = 0;
+		for (Handle<VertexBuffer> handle : destroyed)
+			stale += pool.Get(handle) == nullptr;
+		for (Handle<VertexBuffer> handle : handles)
+			alive += pool.Get(handle) != nullptr;
+		std::cout << "after " << CHURN << " destroy/create: " << stale << "/" << destroyed.size() << " old handles stale, "
+			<< alive << "/" << handles.size() << " live handles valid, " << pool.GetCount() << " in pool" << std::endl;
+
+		/* deferred destruction: the destroyed buffers were never drawn with,
+		   but the pool can't know that, they wait for the frame's fence */
+		unsigned int freed = pool.Collect();
+		std::cout << "frame " << sync.GetCurrentFrame() << ": " << freed << " freed before its fence, "
+			<< pool.GetRetiredCount() << " waiting" << std::endl;
+		for (int frame = 0; frame < 4; frame++)
+		{
+			GLCall(glClear(GL_COLOR_BUFFER_BIT));
+			glfwSwapBuffers(window);
+			sync.EndFrame();
+			if (frame == 2)
+				sync.WaitIdle();
+			freed = pool.Collect();
+			std::cout << "after frame " << frame << ": " << freed << " freed, " << pool.GetRetiredCount() << " waiting, "
+				<< sync.GetFramesInFlight() << " frames in flight" << std::endl;
+		}
+	}
+
+	glfwTerminate();
+	return 0;
+}
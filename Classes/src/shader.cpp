@@ -4,19 +4,57 @@
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <cstring>
 
 #include "renderer.h"
+#include "DeletionQueue.h"
 
 Shader::Shader(const std::string& filepath)
-	: m_FilePath(filepath), m_RendererID(0)
+	: m_FilePath(filepath), m_RendererID(0), m_UniformStats(), m_WorkGroupSize()
 {
     ShaderProgramSource source = ParseShader(filepath);
-    m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);   
+    if (source.VertexSource.empty() && !source.ComputeSource.empty())
+        m_RendererID = CreateComputeShader(source.ComputeSource);
+    else
+        m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);   
+    ReflectUniforms();
+    ReflectAttributes();
 }
 
 Shader::~Shader()
 {
-    GLCall(glDeleteProgram(m_RendererID));
+    DeletionQueue::Delete(GLObjectType::PROGRAM, m_RendererID);
+}
+
+Shader::Shader(Shader&& other) noexcept
+    : m_FilePath(std::move(other.m_FilePath)), m_RendererID(other.m_RendererID),
+    m_UniformLocationCache(std::move(other.m_UniformLocationCache)), m_Uniforms(std::move(other.m_Uniforms)),
+    m_UniformIndices(std::move(other.m_UniformIndices)), m_UniformData(std::move(other.m_UniformData)),
+    m_Attributes(std::move(other.m_Attributes)), m_UniformStats(other.m_UniformStats)
+{
+    for (int i = 0; i < 3; i++)
+        m_WorkGroupSize[i] = other.m_WorkGroupSize[i];
+    other.m_RendererID = 0;
+}
+
+Shader& Shader::operator=(Shader&& other) noexcept
+{
+    if (this != &other)
+    {
+        DeletionQueue::Delete(GLObjectType::PROGRAM, m_RendererID);
+        m_FilePath = std::move(other.m_FilePath);
+        m_RendererID = other.m_RendererID;
+        m_UniformLocationCache = std::move(other.m_UniformLocationCache);
+        m_Uniforms = std::move(other.m_Uniforms);
+        m_UniformIndices = std::move(other.m_UniformIndices);
+        m_UniformData = std::move(other.m_UniformData);
+        m_UniformStats = other.m_UniformStats;
+        m_Attributes = std::move(other.m_Attributes);
+        for (int i = 0; i < 3; i++)
+            m_WorkGroupSize[i] = other.m_WorkGroupSize[i];
+        other.m_RendererID = 0;
+    }
+    return *this;
 }
 
 
@@ -27,11 +65,11 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
     // enum class sets shader mode
     enum class ShaderType
     {
-        NONE = -1, VERTEX = 0, FRAGMENT = 1
+        NONE = -1, VERTEX = 0, FRAGMENT = 1, COMPUTE = 2
     };
 
     std::string line;
-    std::stringstream ss[2];
+    std::stringstream ss[3];
     ShaderType type = ShaderType::NONE;
     while (getline(stream, line))
     {
@@ -41,15 +79,18 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
                 type = ShaderType::VERTEX;
             else if (line.find("fragment") != std::string::npos)
                 type = ShaderType::FRAGMENT;
+            else if (line.find("compute") != std::string::npos)
+                type = ShaderType::COMPUTE;
         }
-        else
+        else if (type != ShaderType::NONE)
         {
+            /* lines before the first #shader belong to no stage */
             ss[(int)type] << line << "\n";
         }
     }
 
-    // returns two strings (vertex & type)
-    return { ss[0].str(), ss[1].str() };
+    // returns three strings (vertex, fragment & compute)
+    return { ss[0].str(), ss[1].str(), ss[2].str() };
 }
 
 unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
@@ -67,7 +108,7 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
         GLCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
         char* message = (char*)alloca(length * sizeof(char));
         GLCall(glGetShaderInfoLog(id, length, &length, message));
-        std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << std::endl;
+        std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : type == GL_COMPUTE_SHADER ? "compute" : "fragment") << std::endl;
         std::cout << message << std::endl;
         GLCall(glDeleteShader(id));
         return 0;
@@ -94,6 +135,32 @@ unsigned int Shader::CreateShader(const std::string& vertexShader, const std::st
     return program;
 }
 
+/* compute programs are GL 4.3, a single stage linked on its own */
+unsigned int Shader::CreateComputeShader(const std::string& computeShader)
+{
+    unsigned int program = glCreateProgram();
+    unsigned int cs = CompileShader(GL_COMPUTE_SHADER, computeShader);
+
+    GLCall(glAttachShader(program, cs));
+    GLCall(glLinkProgram(program));
+    GLCall(glDeleteShader(cs));
+
+    int linked = 0;
+    GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+    if (linked == GL_FALSE)
+    {
+        std::cout << "Failed to link compute shader " << m_FilePath << std::endl;
+        return program;
+    }
+
+    /* local_size_x/y/z, to work out how many groups a dispatch needs */
+    int size[3] = { 0, 0, 0 };
+    GLCall(glGetProgramiv(program, GL_COMPUTE_WORK_GROUP_SIZE, size));
+    for (int i = 0; i < 3; i++)
+        m_WorkGroupSize[i] = (unsigned int)size[i];
+    return program;
+}
+
 void Shader::Bind() const
 {
     GLCall(glUseProgram(m_RendererID));
@@ -104,9 +171,631 @@ void Shader::Unbind() const
     GLCall(glUseProgram(0));
 }
 
+/* lists every active uniform with glGetActiveUniform and gives each one
+   room in the shadow copy
+    ~ arrays are reported as "name[0]", they're stored under "name"
+    ~ uniforms in uniform blocks have no location and are left out */
+void Shader::ReflectUniforms()
+{
+    m_Uniforms.clear();
+    m_UniformIndices.clear();
+    m_UniformData.clear();
+
+    int count = 0, maxLength = 0;
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &count));
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+    std::vector<char> buffer(maxLength + 1);
+    for (int i = 0; i < count; i++)
+    {
+        int length = 0, arraySize = 0;
+        GLenum type = 0;
+        GLCall(glGetActiveUniform(m_RendererID, i, (GLsizei)buffer.size(), &length, &arraySize, &type, buffer.data()));
+        std::string name(buffer.data(), length);
+        GLCall(int location = glGetUniformLocation(m_RendererID, name.c_str()));
+        if (location == -1)
+            continue;
+
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+            name.resize(name.size() - 3);
+
+        ShaderUniform uniform;
+        uniform.location = location;
+        uniform.type = type;
+        uniform.arraySize = arraySize;
+        uniform.offset = (unsigned int)m_UniformData.size();
+        uniform.size = GetUniformTypeSize(type) * arraySize;
+        uniform.uploadedSize = 0;
+        m_UniformData.resize(m_UniformData.size() + uniform.size);
+
+        m_UniformIndices[name] = (unsigned int)m_Uniforms.size();
+        m_UniformLocationCache[name] = location;
+        m_Uniforms.push_back(uniform);
+    }
+}
+
+/* lists the vertex shader's active inputs, built-ins (gl_VertexID...)
+   have no location and are left out */
+void Shader::ReflectAttributes()
+{
+    m_Attributes.clear();
+
+    int count = 0, maxLength = 0;
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_ATTRIBUTES, &count));
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength));
+    std::vector<char> buffer(maxLength + 1);
+    for (int i = 0; i < count; i++)
+    {
+        int length = 0, arraySize = 0;
+        GLenum type = 0;
+        GLCall(glGetActiveAttrib(m_RendererID, i, (GLsizei)buffer.size(), &length, &arraySize, &type, buffer.data()));
+        std::string name(buffer.data(), length);
+        GLCall(int location = glGetAttribLocation(m_RendererID, name.c_str()));
+        if (location == -1)
+            continue;
+
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+            name.resize(name.size() - 3);
+        m_Attributes.push_back({ name, location, type, arraySize });
+    }
+}
+
+bool Shader::MatchLayout(const VertexBufferLayout& layout, std::vector<VertexAttributeBinding>& bindings) const
+{
+    bindings.clear();
+    const auto& elements = layout.GetElements();
+
+    bool named = false;
+    std::vector<unsigned int> offsets;
+    unsigned int offset = 0;
+    for (const auto& element : elements)
+    {
+        named |= !element.name.empty();
+        offsets.push_back(offset);
+        offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+    }
+
+    bool matched = true;
+    for (const ShaderAttribute& attribute : m_Attributes)
+    {
+        unsigned int index = (unsigned int)elements.size();
+        for (unsigned int i = 0; i < elements.size(); i++)
+        {
+            if (named ? elements[i].name == attribute.name : (int)i == attribute.location)
+            {
+                index = i;
+                break;
+            }
+        }
+        if (index == elements.size())
+        {
+            std::cout << "Shader '" << m_FilePath << "': attribute '" << attribute.name << "' has no element in the layout" << std::endl;
+            matched = false;
+            continue;
+        }
+
+        const auto& element = elements[index];
+        unsigned int components, columns;
+        bool integer;
+        if (!GetAttributeShape(attribute.type, components, columns, integer))
+        {
+            std::cout << "Shader '" << m_FilePath << "': attribute '" << attribute.name << "' has a type (" << attribute.type
+                << ") that can't be fed from a layout" << std::endl;
+            matched = false;
+            continue;
+        }
+        if (integer && element.type == GL_FLOAT)
+        {
+            std::cout << "Shader '" << m_FilePath << "': integer attribute '" << attribute.name << "' is fed floats" << std::endl;
+            matched = false;
+            continue;
+        }
+
+        /* matrices and arrays take one location per column / element */
+        unsigned int locations = columns * attribute.arraySize;
+        if (locations > 1)
+        {
+            if (element.count != components * locations)
+            {
+                std::cout << "Shader '" << m_FilePath << "': attribute '" << attribute.name << "' needs " << components * locations
+                    << " components, the layout has " << element.count << std::endl;
+                matched = false;
+                continue;
+            }
+            unsigned int size = components * VertexBufferElement::GetSizeOfType(element.type);
+            for (unsigned int i = 0; i < locations; i++)
+                bindings.push_back({ attribute.location + i, index, components, offsets[index] + i * size, integer });
+            continue;
+        }
+
+        /* fewer is fine, GL fills in 0, 0, 0, 1 (vec4 position from 2 floats) */
+        if (element.count > components)
+        {
+            std::cout << "Shader '" << m_FilePath << "': warning, attribute '" << attribute.name << "' has " << components
+                << " components, the layout gives " << element.count << " (the rest are ignored)" << std::endl;
+        }
+        unsigned int count = element.count < components ? element.count : components;
+        bindings.push_back({ (unsigned int)attribute.location, index, count, offsets[index], integer });
+    }
+
+    if (!matched)
+        bindings.clear();
+    return matched;
+}
+
+/* "name[n]" -> "name" and n, false for anything else */
+static bool SplitArrayElement(const std::string& name, std::string& array, unsigned int& element)
+{
+    size_t bracket = name.rfind('[');
+    if (bracket == std::string::npos || bracket == 0 || name.back() != ']' || bracket + 2 >= name.size())
+        return false;
+
+    element = 0;
+    for (size_t i = bracket + 1; i + 1 < name.size(); i++)
+    {
+        if (name[i] < '0' || name[i] > '9' || element > 0xFFFFFFF)
+            return false;
+        element = element * 10 + (name[i] - '0');
+    }
+    array = name.substr(0, bracket);
+    return true;
+}
+
+int Shader::UpdateUniform(const std::string& name, const void* data, unsigned int size)
+{
+    int location;
+    unsigned int start = 0;	/* bytes into the uniform's shadow copy */
+    auto found = m_UniformIndices.find(name);
+    if (found != m_UniformIndices.end())
+        location = m_Uniforms[found->second].location;
+    else
+    {
+        /* a single array element ("u_Lights[2]") goes into its array's
+           shadow copy at that element, unknown names warn once and are
+           skipped */
+        location = (int)GetUniformLocation(name);
+        if (location == -1)
+            return -1;
+
+        std::string array;
+        unsigned int element;
+        if (SplitArrayElement(name, array, element))
+            found = m_UniformIndices.find(array);
+        if (found == m_UniformIndices.end() || element >= (unsigned int)m_Uniforms[found->second].arraySize)
+        {
+            m_UniformStats.uploads++;
+            return location;
+        }
+        const ShaderUniform& uniform = m_Uniforms[found->second];
+        start = element * (uniform.size / uniform.arraySize);
+    }
+
+    ShaderUniform& uniform = m_Uniforms[found->second];
+    if (start + size > uniform.size)
+    {
+        std::cout << "Warning: uniform '" << name << "' is set with " << size << " bytes, it only has " << uniform.size - start << std::endl;
+        size = uniform.size - start;
+    }
+
+    unsigned char* shadow = &m_UniformData[uniform.offset + start];
+    if (start + size <= uniform.uploadedSize && memcmp(shadow, data, size) == 0)
+    {
+        m_UniformStats.skipped++;
+        return -1;
+    }
+
+    memcpy(shadow, data, size);
+    /* the known prefix only grows when this write joins onto it */
+    if (start <= uniform.uploadedSize && start + size > uniform.uploadedSize)
+        uniform.uploadedSize = start + size;
+    m_UniformStats.uploads++;
+    return location;
+}
+
+void Shader::InvalidateUniforms()
+{
+    for (ShaderUniform& uniform : m_Uniforms)
+        uniform.uploadedSize = 0;
+}
+
+void Shader::SetUniform1i(const std::string& name, int value)
+{
+    int location = UpdateUniform(name, &value, sizeof(value));
+    if (location != -1)
+    {
+        GLCall(glUniform1i(location, value));
+    }
+}
+
+void Shader::SetUniform2i(const std::string& name, int v0, int v1)
+{
+    int values[2] = { v0, v1 };
+    int location = UpdateUniform(name, values, sizeof(values));
+    if (location != -1)
+    {
+        GLCall(glUniform2i(location, v0, v1));
+    }
+}
+
+void Shader::SetUniform3i(const std::string& name, int v0, int v1, int v2)
+{
+    int values[3] = { v0, v1, v2 };
+    int location = UpdateUniform(name, values, sizeof(values));
+    if (location != -1)
+    {
+        GLCall(glUniform3i(location, v0, v1, v2));
+    }
+}
+
+void Shader::SetUniform4i(const std::string& name, int v0, int v1, int v2, int v3)
+{
+    int values[4] = { v0, v1, v2, v3 };
+    int location = UpdateUniform(name, values, sizeof(values));
+    if (location != -1)
+    {
+        GLCall(glUniform4i(location, v0, v1, v2, v3));
+    }
+}
+
+void Shader::SetUniform1ui(const std::string& name, unsigned int value)
+{
+    int location = UpdateUniform(name, &value, sizeof(value));
+    if (location != -1)
+    {
+        GLCall(glUniform1ui(location, value));
+    }
+}
+
+void Shader::SetUniform2ui(const std::string& name, unsigned int v0, unsigned int v1)
+{
+    unsigned int values[2] = { v0, v1 };
+    int location = UpdateUniform(name, values, sizeof(values));
+    if (location != -1)
+    {
+        GLCall(glUniform2ui(location, v0, v1));
+    }
+}
+
+void Shader::SetUniform3ui(const std::string& name, unsigned int v0, unsigned int v1, unsigned int v2)
+{
+    unsigned int values[3] = { v0, v1, v2 };
+    int location = UpdateUniform(name, values, sizeof(values));
+    if (location != -1)
+    {
+        GLCall(glUniform3ui(location, v0, v1, v2));
+    }
+}
+
+void Shader::SetUniform4ui(const std::string& name, unsigned int v0, unsigned int v1, unsigned int v2, unsigned int v3)
+{
+    unsigned int values[4] = { v0, v1, v2, v3 };
+    int location = UpdateUniform(name, values, sizeof(values));
+    if (location != -1)
+    {
+        GLCall(glUniform4ui(location, v0, v1, v2, v3));
+    }
+}
+
+void Shader::SetUniform1f(const std::string& name, float value)
+{
+    int location = UpdateUniform(name, &value, sizeof(value));
+    if (location != -1)
+    {
+        GLCall(glUniform1f(location, value));
+    }
+}
+
+void Shader::SetUniform2f(const std::string& name, float v0, float v1)
+{
+    float values[2] = { v0, v1 };
+    int location = UpdateUniform(name, values, sizeof(values));
+    if (location != -1)
+    {
+        GLCall(glUniform2f(location, v0, v1));
+    }
+}
+
+void Shader::SetUniform3f(const std::string& name, float v0, float v1, float v2)
+{
+    float values[3] = { v0, v1, v2 };
+    int location = UpdateUniform(name, values, sizeof(values));
+    if (location != -1)
+    {
+        GLCall(glUniform3f(location, v0, v1, v2));
+    }
+}
+
 void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
 {
-    GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
+    float values[4] = { v0, v1, v2, v3 };
+    int location = UpdateUniform(name, values, sizeof(values));
+    if (location != -1)
+    {
+        GLCall(glUniform4f(location, v0, v1, v2, v3));
+    }
+}
+
+void Shader::SetUniformMat2f(const std::string& name, const float* matrix)
+{
+    int location = UpdateUniform(name, matrix, 4 * sizeof(float));
+    if (location != -1)
+    {
+        GLCall(glUniformMatrix2fv(location, 1, GL_FALSE, matrix));
+    }
+}
+
+void Shader::SetUniformMat3f(const std::string& name, const float* matrix)
+{
+    int location = UpdateUniform(name, matrix, 9 * sizeof(float));
+    if (location != -1)
+    {
+        GLCall(glUniformMatrix3fv(location, 1, GL_FALSE, matrix));
+    }
+}
+
+void Shader::SetUniformMat4f(const std::string& name, const float* matrix)
+{
+    int location = UpdateUniform(name, matrix, 16 * sizeof(float));
+    if (location != -1)
+    {
+        GLCall(glUniformMatrix4fv(location, 1, GL_FALSE, matrix));
+    }
+}
+
+void Shader::SetUniform1iv(const std::string& name, int count, const int* values)
+{
+    int location = UpdateUniform(name, values, count * sizeof(int));
+    if (location != -1)
+    {
+        GLCall(glUniform1iv(location, count, values));
+    }
+}
+
+void Shader::SetUniform2iv(const std::string& name, int count, const int* values)
+{
+    int location = UpdateUniform(name, values, count * 2 * sizeof(int));
+    if (location != -1)
+    {
+        GLCall(glUniform2iv(location, count, values));
+    }
+}
+
+void Shader::SetUniform3iv(const std::string& name, int count, const int* values)
+{
+    int location = UpdateUniform(name, values, count * 3 * sizeof(int));
+    if (location != -1)
+    {
+        GLCall(glUniform3iv(location, count, values));
+    }
+}
+
+void Shader::SetUniform4iv(const std::string& name, int count, const int* values)
+{
+    int location = UpdateUniform(name, values, count * 4 * sizeof(int));
+    if (location != -1)
+    {
+        GLCall(glUniform4iv(location, count, values));
+    }
+}
+
+void Shader::SetUniform1uiv(const std::string& name, int count, const unsigned int* values)
+{
+    int location = UpdateUniform(name, values, count * sizeof(unsigned int));
+    if (location != -1)
+    {
+        GLCall(glUniform1uiv(location, count, values));
+    }
+}
+
+void Shader::SetUniform2uiv(const std::string& name, int count, const unsigned int* values)
+{
+    int location = UpdateUniform(name, values, count * 2 * sizeof(unsigned int));
+    if (location != -1)
+    {
+        GLCall(glUniform2uiv(location, count, values));
+    }
+}
+
+void Shader::SetUniform3uiv(const std::string& name, int count, const unsigned int* values)
+{
+    int location = UpdateUniform(name, values, count * 3 * sizeof(unsigned int));
+    if (location != -1)
+    {
+        GLCall(glUniform3uiv(location, count, values));
+    }
+}
+
+void Shader::SetUniform4uiv(const std::string& name, int count, const unsigned int* values)
+{
+    int location = UpdateUniform(name, values, count * 4 * sizeof(unsigned int));
+    if (location != -1)
+    {
+        GLCall(glUniform4uiv(location, count, values));
+    }
+}
+
+void Shader::SetUniform1fv(const std::string& name, int count, const float* values)
+{
+    int location = UpdateUniform(name, values, count * sizeof(float));
+    if (location != -1)
+    {
+        GLCall(glUniform1fv(location, count, values));
+    }
+}
+
+void Shader::SetUniform2fv(const std::string& name, int count, const float* values)
+{
+    int location = UpdateUniform(name, values, count * 2 * sizeof(float));
+    if (location != -1)
+    {
+        GLCall(glUniform2fv(location, count, values));
+    }
+}
+
+void Shader::SetUniform3fv(const std::string& name, int count, const float* values)
+{
+    int location = UpdateUniform(name, values, count * 3 * sizeof(float));
+    if (location != -1)
+    {
+        GLCall(glUniform3fv(location, count, values));
+    }
+}
+
+void Shader::SetUniform4fv(const std::string& name, int count, const float* values)
+{
+    int location = UpdateUniform(name, values, count * 4 * sizeof(float));
+    if (location != -1)
+    {
+        GLCall(glUniform4fv(location, count, values));
+    }
+}
+
+void Shader::SetUniformMat2fv(const std::string& name, int count, const float* matrices)
+{
+    int location = UpdateUniform(name, matrices, count * 4 * sizeof(float));
+    if (location != -1)
+    {
+        GLCall(glUniformMatrix2fv(location, count, GL_FALSE, matrices));
+    }
+}
+
+void Shader::SetUniformMat3fv(const std::string& name, int count, const float* matrices)
+{
+    int location = UpdateUniform(name, matrices, count * 9 * sizeof(float));
+    if (location != -1)
+    {
+        GLCall(glUniformMatrix3fv(location, count, GL_FALSE, matrices));
+    }
+}
+
+void Shader::SetUniformMat4fv(const std::string& name, int count, const float* matrices)
+{
+    int location = UpdateUniform(name, matrices, count * 16 * sizeof(float));
+    if (location != -1)
+    {
+        GLCall(glUniformMatrix4fv(location, count, GL_FALSE, matrices));
+    }
+}
+
+void Shader::SetUniformMat2x3fv(const std::string& name, int count, const float* matrices)
+{
+    int location = UpdateUniform(name, matrices, count * 6 * sizeof(float));
+    if (location != -1)
+    {
+        GLCall(glUniformMatrix2x3fv(location, count, GL_FALSE, matrices));
+    }
+}
+
+void Shader::SetUniformMat3x2fv(const std::string& name, int count, const float* matrices)
+{
+    int location = UpdateUniform(name, matrices, count * 6 * sizeof(float));
+    if (location != -1)
+    {
+        GLCall(glUniformMatrix3x2fv(location, count, GL_FALSE, matrices));
+    }
+}
+
+void Shader::SetUniformMat2x4fv(const std::string& name, int count, const float* matrices)
+{
+    int location = UpdateUniform(name, matrices, count * 8 * sizeof(float));
+    if (location != -1)
+    {
+        GLCall(glUniformMatrix2x4fv(location, count, GL_FALSE, matrices));
+    }
+}
+
+void Shader::SetUniformMat4x2fv(const std::string& name, int count, const float* matrices)
+{
+    int location = UpdateUniform(name, matrices, count * 8 * sizeof(float));
+    if (location != -1)
+    {
+        GLCall(glUniformMatrix4x2fv(location, count, GL_FALSE, matrices));
+    }
+}
+
+void Shader::SetUniformMat3x4fv(const std::string& name, int count, const float* matrices)
+{
+    int location = UpdateUniform(name, matrices, count * 12 * sizeof(float));
+    if (location != -1)
+    {
+        GLCall(glUniformMatrix3x4fv(location, count, GL_FALSE, matrices));
+    }
+}
+
+void Shader::SetUniformMat4x3fv(const std::string& name, int count, const float* matrices)
+{
+    int location = UpdateUniform(name, matrices, count * 12 * sizeof(float));
+    if (location != -1)
+    {
+        GLCall(glUniformMatrix4x3fv(location, count, GL_FALSE, matrices));
+    }
+}
+
+bool Shader::GetAttributeShape(unsigned int type, unsigned int& components, unsigned int& columns, bool& integer)
+{
+    columns = 1;
+    integer = false;
+    switch (type)
+    {
+    case GL_FLOAT:          components = 1; return true;
+    case GL_FLOAT_VEC2:     components = 2; return true;
+    case GL_FLOAT_VEC3:     components = 3; return true;
+    case GL_FLOAT_VEC4:     components = 4; return true;
+    case GL_FLOAT_MAT2:     components = 2; columns = 2; return true;
+    case GL_FLOAT_MAT3:     components = 3; columns = 3; return true;
+    case GL_FLOAT_MAT4:     components = 4; columns = 4; return true;
+    case GL_FLOAT_MAT2x3:   components = 3; columns = 2; return true;
+    case GL_FLOAT_MAT2x4:   components = 4; columns = 2; return true;
+    case GL_FLOAT_MAT3x2:   components = 2; columns = 3; return true;
+    case GL_FLOAT_MAT3x4:   components = 4; columns = 3; return true;
+    case GL_FLOAT_MAT4x2:   components = 2; columns = 4; return true;
+    case GL_FLOAT_MAT4x3:   components = 3; columns = 4; return true;
+    }
+
+    integer = true;
+    switch (type)
+    {
+    case GL_INT: case GL_UNSIGNED_INT:                      components = 1; return true;
+    case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2:            components = 2; return true;
+    case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3:            components = 3; return true;
+    case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4:            components = 4; return true;
+    }
+    /* doubles would need glVertexAttribLPointer */
+    components = 0;
+    return false;
+}
+
+unsigned int Shader::GetUniformTypeSize(unsigned int type)
+{
+    switch (type)
+    {
+    case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: case GL_BOOL:
+        return 4;
+    case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2: case GL_DOUBLE:
+        return 8;
+    case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3:
+        return 12;
+    case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4:
+    case GL_FLOAT_MAT2: case GL_DOUBLE_VEC2:
+        return 16;
+    case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT3x2: case GL_DOUBLE_VEC3:
+        return 24;
+    case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT4x2: case GL_DOUBLE_VEC4: case GL_DOUBLE_MAT2:
+        return 32;
+    case GL_FLOAT_MAT3:
+        return 36;
+    case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x3: case GL_DOUBLE_MAT2x3: case GL_DOUBLE_MAT3x2:
+        return 48;
+    case GL_FLOAT_MAT4: case GL_DOUBLE_MAT2x4: case GL_DOUBLE_MAT4x2:
+        return 64;
+    case GL_DOUBLE_MAT3:
+        return 72;
+    case GL_DOUBLE_MAT3x4: case GL_DOUBLE_MAT4x3:
+        return 96;
+    case GL_DOUBLE_MAT4:
+        return 128;
+    }
+    /* samplers and images are set with glUniform1i */
+    return 4;
 }
 
 unsigned int Shader::GetUniformLocation(const std::string& name)
@@ -115,7 +804,7 @@ unsigned int Shader::GetUniformLocation(const std::string& name)
         return m_UniformLocationCache[name];
 
     GLCall(unsigned int location = glGetUniformLocation(m_RendererID, name.c_str()));
-    if (location == -1)
+    if ((int)location == -1)
         std::cout << "Warning: uniform '" << name << "' doesn't exist!" << std::endl;
    
     m_UniformLocationCache[name] = location;
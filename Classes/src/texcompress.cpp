@@ -0,0 +1,156 @@
+/* texcompress: offline block compression into DDS
+	~ usage: texcompress bc1|bc3|bc7 input.ppm|input.pam output.dds [--fast]
+	~ input is binary PPM (P6, RGB) or PAM (P7, RGB or RGB_ALPHA)
+	~ the full mip chain is built with a box filter and compressed level by level,
+	  --fast switches to the SIMD bounding box encoder */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <charconv>
+
+#include "BlockCompression.h"
+#include "TextureFile.h"
+
+/* reads a PPM/PAM header token, skipping whitespace and comments */
+static std::string ReadToken(std::istream& stream)
+{
+	std::string token;
+	char c;
+	while (stream.get(c))
+	{
+		if (c == '#')
+		{
+			while (stream.get(c) && c != '\n');
+			continue;
+		}
+		if (isspace((unsigned char)c))
+		{
+			if (!token.empty())
+				break;
+			continue;
+		}
+		token += c;
+	}
+	return token;
+}
+
+/* a header number, 0 (which no field accepts) when the token isn't one */
+static unsigned int ReadNumber(std::istream& stream)
+{
+	std::string token = ReadToken(stream);
+	unsigned int value = 0;
+	std::from_chars_result result = std::from_chars(token.data(), token.data() + token.size(), value);
+	if (result.ec != std::errc() || result.ptr != token.data() + token.size())
+		return 0;
+	return value;
+}
+
+static bool LoadImage(const std::string& filepath, std::vector<unsigned char>& rgba, unsigned int& width, unsigned int& height)
+{
+	std::ifstream stream(filepath, std::ios::binary);
+	if (!stream)
+	{
+		std::cout << "Failed to open '" << filepath << "'" << std::endl;
+		return false;
+	}
+
+	std::string magic = ReadToken(stream);
+	unsigned int channels = 0, maxValue = 0;
+	if (magic == "P6")
+	{
+		width = ReadNumber(stream);
+		height = ReadNumber(stream);
+		maxValue = ReadNumber(stream);
+		channels = 3;
+	}
+	else if (magic == "P7")
+	{
+		for (std::string token = ReadToken(stream); !token.empty() && token != "ENDHDR"; token = ReadToken(stream))
+		{
+			if (token == "WIDTH") width = ReadNumber(stream);
+			else if (token == "HEIGHT") height = ReadNumber(stream);
+			else if (token == "DEPTH") channels = ReadNumber(stream);
+			else if (token == "MAXVAL") maxValue = ReadNumber(stream);
+			else if (token == "TUPLTYPE") ReadToken(stream);
+		}
+	}
+
+	if ((channels != 3 && channels != 4) || maxValue != 255 || width == 0 || height == 0)
+	{
+		std::cout << "'" << filepath << "' is not an 8 bit RGB/RGBA PPM or PAM image" << std::endl;
+		return false;
+	}
+
+	std::vector<unsigned char> pixels((size_t)width * height * channels);
+	stream.read((char*)pixels.data(), pixels.size());
+	if (!stream)
+	{
+		std::cout << "'" << filepath << "' is truncated" << std::endl;
+		return false;
+	}
+
+	rgba.resize((size_t)width * height * 4);
+	for (size_t i = 0; i < (size_t)width * height; i++)
+	{
+		memcpy(&rgba[i * 4], &pixels[i * channels], 3);
+		rgba[i * 4 + 3] = channels == 4 ? pixels[i * 4 + 3] : 255;
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc != 4 && argc != 5)
+	{
+		std::cout << "usage: texcompress bc1|bc3|bc7 input.ppm|input.pam output.dds [--fast]" << std::endl;
+		return -1;
+	}
+
+	std::string name = argv[1];
+	BlockFormat format;
+	if (name == "bc1") format = BlockFormat::BC1;
+	else if (name == "bc3") format = BlockFormat::BC3;
+	else if (name == "bc7") format = BlockFormat::BC7;
+	else
+	{
+		std::cout << "Unknown format '" << name << "'" << std::endl;
+		return -1;
+	}
+	CompressionQuality quality = argc == 5 && std::string(argv[4]) == "--fast" ? CompressionQuality::FAST : CompressionQuality::QUALITY;
+
+	std::vector<unsigned char> image;
+	unsigned int width = 0, height = 0;
+	if (!LoadImage(argv[2], image, width, height))
+		return -1;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	std::vector<std::vector<unsigned char>> levels;
+	size_t pixelCount = 0;
+	unsigned int levelWidth = width, levelHeight = height;
+	std::vector<unsigned char> next;
+	while (true)
+	{
+		levels.emplace_back(BlockCompressor::GetCompressedSize(format, levelWidth, levelHeight));
+		BlockCompressor::Compress(format, image.data(), levelWidth, levelHeight, levels.back().data(), quality);
+		pixelCount += (size_t)levelWidth * levelHeight;
+
+		if (levelWidth == 1 && levelHeight == 1)
+			break;
+		BlockCompressor::Downsample(image.data(), levelWidth, levelHeight, next);
+		image.swap(next);
+		levelWidth = levelWidth > 1 ? levelWidth / 2 : 1;
+		levelHeight = levelHeight > 1 ? levelHeight / 2 : 1;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	if (!TextureFile::WriteDds(argv[3], BlockCompressor::GetGLFormat(format), width, height, levels))
+		return -1;
+
+	std::cout << argv[3] << ": " << width << "x" << height << ", " << levels.size() << " levels, "
+		<< pixelCount / seconds / 1e6 << " Mpixels/s" << std::endl;
+	return 0;
+}
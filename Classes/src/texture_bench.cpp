@@ -0,0 +1,165 @@
+/* texture upload benchmark
+	~ streams the same set of big RGBA8 images into textures twice:
+		1. synchronous glTexSubImage2D from client memory, one image per frame
+		2. through TextureStreamer (PBO ring, fixed byte budget per frame)
+	~ prints upload bandwidth and the average/worst frame time of each run,
+	  the frame itself is just the quad from the other demos */
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <memory>
+
+#include "renderer.h"
+#include "vertexbuffer.h"
+#include "indexbuffer.h"
+#include "VertexArray.h"
+#include "shader.h"
+#include "Texture.h"
+#include "TextureStreamer.h"
+
+#define IMAGE_SIZE 2048
+#define IMAGE_COUNT 16
+
+struct FrameStats
+{
+	double totalMs = 0.0;
+	double worstMs = 0.0;
+	unsigned int frames = 0;
+
+	void Add(double ms)
+	{
+		totalMs += ms;
+		worstMs = ms > worstMs ? ms : worstMs;
+		frames++;
+	}
+};
+
+static void PrintResult(const char* name, const FrameStats& stats, double seconds, double bytes)
+{
+	std::cout << name << ": " << bytes / seconds / (1024.0 * 1024.0) << " MB/s, "
+		<< stats.frames << " frames, avg " << stats.totalMs / stats.frames << " ms, worst "
+		<< stats.worstMs << " ms" << std::endl;
+}
+
+int main(void)
+{
+	GLFWwindow* window;
+
+	/* Initialize the library */
+	if (!glfwInit())
+		return -1;
+
+	/* Create a windowed mode window and its OpenGL context */
+	window = glfwCreateWindow(640, 480, "Texture upload benchmark", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+
+	/* no vsync, we want to see the real frame cost */
+	glfwSwapInterval(0);
+
+	if (glewInit() != GLEW_OK)
+		std::cout << "Error!" << std::endl;
+
+	std::cout << glGetString(GL_VERSION) << std::endl;
+
+	{
+		float positions[] = {
+			-0.5f, -0.5f,
+			 0.5f, -0.5f,
+			 0.5f,  0.5f,
+			-0.5f,  0.5f,
+		};
+
+		unsigned int indices[] = {
+			0, 1, 2,
+			2, 3, 0
+		};
+
+		VertexArray va;
+		VertexBuffer vb(positions, 4 * 2 * sizeof(float));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		va.addBuffer(vb, layout);
+		IndexBuffer ib(indices, 6);
+
+		Shader shader("res/shading/basic.shader");
+		shader.Bind();
+		shader.SetUniform4f("u_Color", 0.2f, 0.3f, 0.8f, 1.0f);
+
+		/* procedural source images, different per image so nothing gets cached */
+		const unsigned int imageBytes = IMAGE_SIZE * IMAGE_SIZE * 4;
+		std::vector<std::vector<unsigned char>> images(IMAGE_COUNT, std::vector<unsigned char>(imageBytes));
+		for (unsigned int i = 0; i < IMAGE_COUNT; i++)
+		{
+			for (unsigned int p = 0; p < imageBytes; p++)
+				images[i][p] = (unsigned char)(p * 31 + i * 7);
+		}
+
+		std::vector<std::unique_ptr<Texture>> textures;
+		for (unsigned int i = 0; i < IMAGE_COUNT; i++)
+			textures.push_back(std::make_unique<Texture>(IMAGE_SIZE, IMAGE_SIZE, GL_RGBA8));
+
+		auto drawFrame = [&]()
+		{
+			GLCall(glClear(GL_COLOR_BUFFER_BIT));
+			shader.Bind();
+			va.Bind();
+			ib.Bind();
+			GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr));
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		};
+
+		typedef std::chrono::high_resolution_clock Clock;
+		double uploadedBytes = (double)imageBytes * IMAGE_COUNT;
+
+		/* 1. synchronous uploads, the driver has to copy (or wait) inside the call */
+		{
+			GLCall(glFinish());
+			FrameStats stats;
+			auto start = Clock::now();
+			for (unsigned int i = 0; i < IMAGE_COUNT; i++)
+			{
+				auto frameStart = Clock::now();
+				textures[i]->SetData(images[i].data(), GL_RGBA, GL_UNSIGNED_BYTE);
+				textures[i]->GenerateMipmaps();
+				drawFrame();
+				stats.Add(std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count());
+			}
+			GLCall(glFinish());
+			PrintResult("glTexSubImage2D", stats, std::chrono::duration<double>(Clock::now() - start).count(), uploadedBytes);
+		}
+
+		/* 2. PBO streaming, 3 staging buffers of 8 MB and a 16 MB budget per frame */
+		{
+			TextureStreamer streamer(3, 8 * 1024 * 1024, 16 * 1024 * 1024);
+			for (unsigned int i = 0; i < IMAGE_COUNT; i++)
+				streamer.Queue(*textures[i], images[i].data(), GL_RGBA, GL_UNSIGNED_BYTE);
+
+			GLCall(glFinish());
+			FrameStats stats;
+			auto start = Clock::now();
+			while (!streamer.IsIdle())
+			{
+				auto frameStart = Clock::now();
+				streamer.Update();
+				drawFrame();
+				stats.Add(std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count());
+			}
+			GLCall(glFinish());
+			PrintResult("PBO streaming", stats, std::chrono::duration<double>(Clock::now() - start).count(), uploadedBytes);
+		}
+	}
+
+	glfwTerminate();
+	return 0;
+}
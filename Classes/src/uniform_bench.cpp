@@ -0,0 +1,118 @@
+/* uniform shadow copy benchmark
+	~ OBJECT_COUNT objects share one program, each sets u_Color before its
+	  draw, the colors come from MATERIAL_COUNT materials and the objects
+	  are sorted by material (as a render queue would)
+		1. every set uploads (shadow copy invalidated before each set, what
+		   SetUniform4f did before)
+		2. the shadow copy skips sets that don't change the value
+	~ checks the value GL ends up with against the last one set */
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <random>
+
+#include "renderer.h"
+#include "VertexArray.h"
+#include "indexbuffer.h"
+#include "shader.h"
+
+#define OBJECT_COUNT 20000
+#define MATERIAL_COUNT 16
+#define FRAMES 30
+
+int main(void)
+{
+	GLFWwindow* window;
+
+	/* Initialize the library */
+	if (!glfwInit())
+		return -1;
+
+	window = glfwCreateWindow(640, 480, "Uniform benchmark", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+
+	if (glewInit() != GLEW_OK)
+		std::cout << "Error!" << std::endl;
+
+	{
+		float positions[] = {
+			-0.01f, -0.01f,
+			 0.01f, -0.01f,
+			 0.01f,  0.01f,
+			-0.01f,  0.01f,
+		};
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+		VertexArray va;
+		VertexBuffer vb(positions, 4 * 2 * sizeof(float));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		va.addBuffer(vb, layout);
+		IndexBuffer ib(indices, 6);
+
+		Shader shader("res/shading/basic.shader");
+		shader.Bind();
+		for (const ShaderUniform& uniform : shader.GetUniforms())
+			std::cout << "uniform at location " << uniform.location << ", type " << uniform.type
+				<< ", " << uniform.size << " bytes" << std::endl;
+
+		std::mt19937 random(11);
+		std::vector<unsigned int> materials(OBJECT_COUNT);
+		for (unsigned int& material : materials)
+			material = random() % MATERIAL_COUNT;
+		std::sort(materials.begin(), materials.end());
+
+		for (int path = 0; path < 2; path++)
+		{
+			UniformStats before = shader.GetUniformStats();
+			double milliseconds = 0.0;
+			float last[4] = {};
+			for (int frame = 0; frame < FRAMES; frame++)
+			{
+				auto start = std::chrono::high_resolution_clock::now();
+				GLCall(glClear(GL_COLOR_BUFFER_BIT));
+				va.Bind();
+				ib.Bind();
+				for (unsigned int material : materials)
+				{
+					if (path == 0)
+						shader.InvalidateUniforms();
+					last[0] = material / (float)MATERIAL_COUNT;
+					last[1] = 0.3f;
+					last[2] = 0.8f;
+					last[3] = 1.0f;
+					shader.SetUniform4f("u_Color", last[0], last[1], last[2], last[3]);
+					GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+				}
+				GLCall(glFinish());
+				milliseconds += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+				glfwSwapBuffers(window);
+				glfwPollEvents();
+			}
+
+			float actual[4];
+			GLCall(glGetUniformfv(shader.GetRendererID(), glGetUniformLocation(shader.GetRendererID(), "u_Color"), actual));
+			bool match = std::equal(actual, actual + 4, last);
+
+			const UniformStats& after = shader.GetUniformStats();
+			std::cout << (path == 0 ? "always upload" : "shadow copy") << ": "
+				<< (after.uploads - before.uploads) / FRAMES << " uploads, " << (after.skipped - before.skipped) / FRAMES
+				<< " skipped per frame, " << milliseconds / FRAMES << " ms per frame, GL value "
+				<< (match ? "matches" : "DOESN'T match") << std::endl;
+		}
+	}
+
+	glfwTerminate();
+	return 0;
+}
@@ -1,18 +1,36 @@
 #include "vertexbuffer.h"
 
 #include "renderer.h"
+#include "DeletionQueue.h"
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
 {
 	GLCall(glGenBuffers(1, &m_RendererID));
 	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
-	GLCall(glBufferData(GL_ARRAY_BUFFER, 6 * 2 * sizeof(float), data, GL_STATIC_DRAW));
+	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
 
 }
 
 VertexBuffer::~VertexBuffer()
 {
-	GLCall(glDeleteBuffers(1, &m_RendererID));
+	DeletionQueue::Delete(GLObjectType::BUFFER, m_RendererID);
+}
+
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID)
+{
+	other.m_RendererID = 0;
+}
+
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept
+{
+	if (this != &other)
+	{
+		DeletionQueue::Delete(GLObjectType::BUFFER, m_RendererID);
+		m_RendererID = other.m_RendererID;
+		other.m_RendererID = 0;
+	}
+	return *this;
 }
 
 void VertexBuffer::Bind() const
@@ -25,4 +43,25 @@ void VertexBuffer::Unbind() const
 {
 	GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
 
+}
+
+void VertexBuffer::SetSubData(const void* data, unsigned int offset, unsigned int size)
+{
+	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	GLCall(glBufferSubData(GL_ARRAY_BUFFER, offset, size, data));
+}
+
+void* VertexBuffer::Map(unsigned int offset, unsigned int size, bool orphan)
+{
+	GLbitfield access = GL_MAP_WRITE_BIT | (orphan ? GL_MAP_INVALIDATE_BUFFER_BIT : GL_MAP_INVALIDATE_RANGE_BIT);
+	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	GLCall(void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, access));
+	return mapped;
+}
+
+bool VertexBuffer::Unmap()
+{
+	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	GLCall(GLboolean intact = glUnmapBuffer(GL_ARRAY_BUFFER));
+	return intact == GL_TRUE;
 }
\ No newline at end of file